@@ -19,5 +19,8 @@ if [ $? -ne 0 ]; then
 fi
 
 cd bin
-./JkEng.Physics.PerformanceTests
+
+# Write the benchmark results as JSON so runs can be compared across
+# commits, for example with Google Benchmark's tools/compare.py.
+./JkEng.Physics.Benchmarks --benchmark_out=JkEng.Physics.Benchmarks.json --benchmark_out_format=json
 
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+namespace JkEng::Physics::Benchmarks
+{
+    // The time each iteration took per body, in nanoseconds.  Rates are
+    // per second of the benchmark's time, so inverting one counted in
+    // billionths of a body gives nanoseconds per body.
+    inline benchmark::Counter NanosecondsPerBody(int64_t bodyCount)
+    {
+        return benchmark::Counter(
+            bodyCount * 1e-9,
+            benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+    }
+
+    // total, counted over every iteration, as the mean per iteration.
+    inline benchmark::Counter PerIteration(double total)
+    {
+        return benchmark::Counter(total, benchmark::Counter::kAvgIterations);
+    }
+}
@@ -0,0 +1,195 @@
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <JkEng/Physics/Engine.h>
+
+#include "BenchmarkCounters.h"
+
+using namespace JkEng;
+using namespace JkEng::Physics;
+using namespace JkEng::Physics::Benchmarks;
+
+// Times scenes whose bodies come and go: a field of targets with
+// projectiles fired into it every step, each removed after a fixed number
+// of steps, and removing bodies between steps from scenes of growing size.
+namespace
+{
+    constexpr int TargetCount = 2000;
+    constexpr int ProjectilesPerStep = 50;
+    constexpr int ProjectileLifetime = 60;
+
+    // How many bodies are removed from each scene, every 7th so removals
+    // are spread over the scene, and how many between steps when timing
+    // the steps.
+    constexpr int64_t RemovalCount = 1000;
+    constexpr uint32_t RemovalStride = 7;
+    constexpr uint32_t RemovalsPerStep = 100;
+
+    // Each benchmark iteration is one step, after adding a volley of
+    // projectiles and removing the oldest volley.  The field fills up with
+    // projectiles before timing starts, so every step does both.
+    //
+    // Arguments:
+    //   broadphase - a BroadphaseType.
+    //
+    // Counters:
+    //   collisions_per_step - how many collisions projectiles were told about
+    //                         each step.
+    void BM_Update_ProjectileChurn(benchmark::State& state)
+    {
+        auto broadphase = static_cast<BroadphaseType>(state.range(0));
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> positionDistribution(0.0f, 500.0f);
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(broadphase);
+        sceneDefinition.GridCellSize(4.0f);
+        for (int i = 0; i < TargetCount; i++)
+        {
+            sceneDefinition.AddMovableAabb2d(
+                MovableAabb2dDefinition(
+                    nullptr,
+                    glm::vec2(positionDistribution(random), positionDistribution(random)),
+                    glm::vec2(2.0f, 2.0f),
+                    nullptr,
+                    std::any()
+                )
+            );
+        }
+
+        Engine engine;
+        auto scene = engine.CreateScene(sceneDefinition);
+        std::vector<BodyHandle> projectiles;
+        projectiles.reserve(ProjectilesPerStep * ProjectileLifetime);
+        uint64_t collisionCount = 0;
+        auto step = [&]()
+        {
+            if (projectiles.size() >= ProjectilesPerStep * ProjectileLifetime)
+            {
+                for (int i = 0; i < ProjectilesPerStep; i++)
+                {
+                    scene->RemoveBody(projectiles[i]);
+                }
+                projectiles.erase(projectiles.begin(), projectiles.begin() + ProjectilesPerStep);
+            }
+
+            for (int i = 0; i < ProjectilesPerStep; i++)
+            {
+                AfterCreatePtr<IMovableAabb2d> projectile;
+                projectiles.push_back(scene->AddBody(
+                    MovableAabb2dDefinition(
+                        &projectile,
+                        glm::vec2(positionDistribution(random), 0.0f),
+                        glm::vec2(0.5f, 0.5f),
+                        [&](const IReadOnlyAabb2d&) { collisionCount++; },
+                        std::any()
+                    )
+                ));
+                projectile->Velocity(glm::vec2(0.0f, 500.0f));
+            }
+
+            scene->Update(IScene::StepTime);
+        };
+
+        for (int i = 0; i < ProjectileLifetime; i++)
+        {
+            step();
+        }
+
+        collisionCount = 0;
+        for (auto _ : state)
+        {
+            step();
+        }
+
+        state.counters["collisions_per_step"] = PerIteration(collisionCount);
+    }
+
+    // The scene BM_RemoveBody and BM_Update_AfterRemoveBody remove bodies
+    // from, built from their arguments:
+    //   bodies    - the number of movable AABBs.
+    //   partition - 1 to partition the broadphase by collision filter, with
+    //               half the bodies in each of two categories.
+    std::unique_ptr<IScene> CreateRemovalScene(Engine& engine, benchmark::State& state)
+    {
+        auto bodyCount = static_cast<int>(state.range(0));
+        bool partition = state.range(1) != 0;
+        std::mt19937 random(42);
+        float levelSize = 4.0f * std::sqrt(static_cast<float>(bodyCount));
+        std::uniform_real_distribution<float> positionDistribution(0.0f, levelSize);
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(BroadphaseType::SweepAndPrune);
+        sceneDefinition.PartitionBroadphaseByCollisionFilter(partition);
+        for (int i = 0; i < bodyCount; i++)
+        {
+            MovableAabb2dDefinition definition(
+                nullptr,
+                glm::vec2(positionDistribution(random), positionDistribution(random)),
+                glm::vec2(2.0f, 2.0f),
+                nullptr,
+                std::any());
+            definition.CollisionFilter(i % 2 == 0 ? 1u : 2u, DefaultCollisionMask);
+            sceneDefinition.AddMovableAabb2d(definition);
+        }
+
+        // Step once so the broadphase has lists to keep up to date.
+        auto scene = engine.CreateScene(sceneDefinition);
+        scene->Update(IScene::StepTime);
+        return scene;
+    }
+
+    // Each benchmark iteration removes one body between steps, which should
+    // cost the same however many bodies the scene holds.  A scene only has
+    // so many bodies to remove, so the iterations are fixed.
+    void BM_RemoveBody(benchmark::State& state)
+    {
+        Engine engine;
+        auto scene = CreateRemovalScene(engine, state);
+
+        uint32_t removed = 0;
+        for (auto _ : state)
+        {
+            scene->RemoveBody(scene->HandleOf(removed++ * RemovalStride));
+        }
+    }
+
+    // Each benchmark iteration is the step after removing RemovalsPerStep
+    // bodies, which pays for taking them out of the broadphase's lists.
+    void BM_Update_AfterRemoveBody(benchmark::State& state)
+    {
+        Engine engine;
+        auto scene = CreateRemovalScene(engine, state);
+
+        uint32_t removed = 0;
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            for (uint32_t i = 0; i < RemovalsPerStep; i++)
+            {
+                scene->RemoveBody(scene->HandleOf(removed++ * RemovalStride));
+            }
+            state.ResumeTiming();
+
+            scene->Update(IScene::StepTime);
+        }
+    }
+
+    void RemovalArguments(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "bodies", "partition" });
+        benchmark->ArgsProduct({ { 10000, 100000 }, { 0, 1 } });
+    }
+}
+
+BENCHMARK(BM_Update_ProjectileChurn)
+    ->ArgName("broadphase")
+    ->Arg(static_cast<int64_t>(BroadphaseType::UniformGrid))
+    ->Arg(static_cast<int64_t>(BroadphaseType::SweepAndPrune))
+    ->Arg(static_cast<int64_t>(BroadphaseType::DynamicTree))
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RemoveBody)->Apply(RemovalArguments)->Iterations(RemovalCount)->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_Update_AfterRemoveBody)->Apply(RemovalArguments)->Iterations(RemovalCount / RemovalsPerStep)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,146 @@
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <JkEng/Physics/Engine.h>
+
+#include "BenchmarkCounters.h"
+
+using namespace JkEng;
+using namespace JkEng::Physics;
+using namespace JkEng::Physics::Benchmarks;
+
+// Compares the broadphases on moving AABBs laid out a few different ways.
+// Each benchmark iteration is one step of a scene built before timing
+// starts, whose AABBs are put back where they started now and then so the
+// layout stays what was asked for.
+//
+// Arguments, in order:
+//   distribution - a Distribution.
+//   broadphase   - a BroadphaseType.
+//
+// Counters:
+//   collisions_per_step - how many collisions the AABBs were told about
+//                         each step.
+namespace
+{
+    enum class Distribution : int64_t
+    {
+        // Spread evenly over the level.
+        Uniform,
+
+        // Packed into a handful of small groups.
+        Clustered,
+
+        // Spread evenly but with a few AABBs many times larger than the rest.
+        MixedSize
+    };
+
+    constexpr int ObjectCount = 2000;
+    constexpr int64_t ResetEverySteps = 600;
+
+    void BM_Update_Distribution(benchmark::State& state)
+    {
+        auto distribution = static_cast<Distribution>(state.range(0));
+        auto broadphase = static_cast<BroadphaseType>(state.range(1));
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> levelDistribution(0.0f, 1000.0f);
+        std::normal_distribution<float> clusterDistribution(0.0f, 15.0f);
+        std::uniform_real_distribution<float> sizeDistribution(2.0f, 6.0f);
+        std::uniform_real_distribution<float> velocityDistribution(-20.0f, 20.0f);
+
+        std::vector<glm::vec2> clusterCenters;
+        for (int i = 0; i < 8; i++)
+        {
+            clusterCenters.emplace_back(levelDistribution(random), levelDistribution(random));
+        }
+
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(broadphase);
+        sceneDefinition.GridCellSize(8.0f);
+        sceneDefinition.SweepAndPruneAxes(SweepAndPruneAxes::Both);
+
+        uint64_t collisionCount = 0;
+        std::vector<glm::vec2> startPositions(ObjectCount);
+        auto aabbs = std::make_unique<AfterCreatePtr<IMovableAabb2d>[]>(ObjectCount);
+        for (int i = 0; i < ObjectCount; i++)
+        {
+            glm::vec2 position;
+            glm::vec2 size(sizeDistribution(random), sizeDistribution(random));
+            switch (distribution)
+            {
+                case Distribution::Clustered:
+                    position = clusterCenters[i % clusterCenters.size()]
+                        + glm::vec2(clusterDistribution(random), clusterDistribution(random));
+                    break;
+                case Distribution::MixedSize:
+                    position = glm::vec2(levelDistribution(random), levelDistribution(random));
+                    if (i % 100 == 0)
+                    {
+                        size *= 25.0f;
+                    }
+                    break;
+                case Distribution::Uniform:
+                default:
+                    position = glm::vec2(levelDistribution(random), levelDistribution(random));
+                    break;
+            }
+
+            startPositions[i] = position;
+            sceneDefinition.AddMovableAabb2d(
+                MovableAabb2dDefinition(
+                    &aabbs[i],
+                    position,
+                    size,
+                    [&](const IReadOnlyAabb2d&) { collisionCount++; },
+                    std::any()
+                )
+            );
+        }
+
+        Engine engine;
+        auto scene = engine.CreateScene(sceneDefinition);
+        for (int i = 0; i < ObjectCount; i++)
+        {
+            aabbs[i]->Velocity(glm::vec2(velocityDistribution(random), velocityDistribution(random)));
+        }
+
+        int64_t steps = 0;
+        for (auto _ : state)
+        {
+            scene->Update(IScene::StepTime);
+            if (++steps % ResetEverySteps == 0)
+            {
+                state.PauseTiming();
+                for (int i = 0; i < ObjectCount; i++)
+                {
+                    aabbs[i]->Position(startPositions[i]);
+                }
+                state.ResumeTiming();
+            }
+        }
+
+        state.counters["collisions_per_step"] = PerIteration(collisionCount);
+    }
+
+    void DistributionArguments(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "distribution", "broadphase" });
+        for (auto distribution : { Distribution::Uniform, Distribution::Clustered, Distribution::MixedSize })
+        {
+            for (auto broadphase : {
+                BroadphaseType::AllPairs,
+                BroadphaseType::UniformGrid,
+                BroadphaseType::SweepAndPrune,
+                BroadphaseType::DynamicTree })
+            {
+                benchmark->Args({ static_cast<int64_t>(distribution), static_cast<int64_t>(broadphase) });
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_Update_Distribution)->Apply(DistributionArguments)->Unit(benchmark::kMicrosecond);
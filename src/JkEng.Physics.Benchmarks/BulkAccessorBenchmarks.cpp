@@ -0,0 +1,121 @@
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <JkEng/Physics/Engine.h>
+
+#include "BenchmarkCounters.h"
+
+using namespace JkEng;
+using namespace JkEng::Physics;
+using namespace JkEng::Physics::Benchmarks;
+
+// Times moving every enemy each frame, once through IMovableAabb2d per
+// body and once through IScene's bulk accessors.  Each benchmark
+// iteration reads every position and writes every velocity once.
+//
+// Arguments:
+//   bodies - the number of movable AABBs.
+//
+// Counters:
+//   ns_per_body - the time to read one AABB's position and write its
+//                 velocity.
+namespace
+{
+    std::unique_ptr<IScene> CreateBulkAccessorScene(
+        Engine& engine,
+        std::vector<AfterCreatePtr<IMovableAabb2d>>& bodies)
+    {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> positionDistribution(0.0f, 300.0f);
+        SceneDefinition sceneDefinition;
+        for (auto& body : bodies)
+        {
+            sceneDefinition.AddMovableAabb2d(
+                MovableAabb2dDefinition(
+                    &body,
+                    glm::vec2(positionDistribution(random), positionDistribution(random)),
+                    glm::vec2(2.0f, 2.0f),
+                    nullptr,
+                    std::any()
+                )
+            );
+        }
+        return engine.CreateScene(sceneDefinition);
+    }
+
+    void BM_ReadPositionsWriteVelocities_EachBody(benchmark::State& state)
+    {
+        auto bodyCount = static_cast<uint32_t>(state.range(0));
+        Engine engine;
+        std::vector<AfterCreatePtr<IMovableAabb2d>> bodies(bodyCount);
+        auto scene = CreateBulkAccessorScene(engine, bodies);
+
+        for (auto _ : state)
+        {
+            for (auto& body : bodies)
+            {
+                glm::vec2 position = body->Position();
+                body->Velocity(glm::vec2(150.0f, 150.0f) - position);
+            }
+        }
+
+        state.counters["ns_per_body"] = NanosecondsPerBody(bodyCount);
+    }
+
+    void BM_ReadPositionsWriteVelocities_BulkByHandle(benchmark::State& state)
+    {
+        auto bodyCount = static_cast<uint32_t>(state.range(0));
+        Engine engine;
+        std::vector<AfterCreatePtr<IMovableAabb2d>> bodies(bodyCount);
+        auto scene = CreateBulkAccessorScene(engine, bodies);
+        std::vector<BodyHandle> handles;
+        for (uint32_t bodyId = 0; bodyId < bodyCount; bodyId++)
+        {
+            handles.push_back(scene->HandleOf(bodyId));
+        }
+        std::vector<glm::vec2> positions(scene->BodyIdCount());
+        std::vector<glm::vec2> velocities(bodyCount);
+
+        for (auto _ : state)
+        {
+            scene->Positions(positions);
+            for (uint32_t bodyId = 0; bodyId < bodyCount; bodyId++)
+            {
+                velocities[bodyId] = glm::vec2(150.0f, 150.0f) - positions[bodyId];
+            }
+            scene->SetVelocities(handles, velocities);
+        }
+
+        state.counters["ns_per_body"] = NanosecondsPerBody(bodyCount);
+    }
+
+    void BM_ReadPositionsWriteVelocities_BulkByBodyId(benchmark::State& state)
+    {
+        auto bodyCount = static_cast<uint32_t>(state.range(0));
+        Engine engine;
+        std::vector<AfterCreatePtr<IMovableAabb2d>> bodies(bodyCount);
+        auto scene = CreateBulkAccessorScene(engine, bodies);
+        std::vector<glm::vec2> positions(scene->BodyIdCount());
+        std::vector<glm::vec2> velocities(scene->BodyIdCount());
+
+        for (auto _ : state)
+        {
+            scene->Positions(positions);
+            for (uint32_t bodyId = 0; bodyId < bodyCount; bodyId++)
+            {
+                velocities[bodyId] = glm::vec2(150.0f, 150.0f) - positions[bodyId];
+            }
+            scene->SetVelocities(velocities);
+        }
+
+        state.counters["ns_per_body"] = NanosecondsPerBody(bodyCount);
+    }
+}
+
+BENCHMARK(BM_ReadPositionsWriteVelocities_EachBody)->ArgName("bodies")->Arg(5000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ReadPositionsWriteVelocities_BulkByHandle)->ArgName("bodies")->Arg(5000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ReadPositionsWriteVelocities_BulkByBodyId)->ArgName("bodies")->Arg(5000)->Unit(benchmark::kMicrosecond);
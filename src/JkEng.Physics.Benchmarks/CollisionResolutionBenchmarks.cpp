@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <JkEng/Physics/Engine.h>
+
+#include "BenchmarkCounters.h"
+
+using namespace JkEng;
+using namespace JkEng::Physics;
+using namespace JkEng::Physics::Benchmarks;
+
+// Times crates dropped into a walled pit, pushed apart from each other and
+// the pit by the built in resolution rather than by collision handlers.
+// Each benchmark iteration drops the crates of a new scene, built while
+// timing is paused, for StepCount steps.
+//
+// Arguments:
+//   resolve - 1 to turn SceneDefinition::ResolveCollisions on.
+//
+// Counters:
+//   lowest - how low the lowest crate ended up, below the pit's floor if
+//            any fell through it.
+namespace
+{
+    constexpr int CrateCount = 10000;
+    constexpr int StepCount = 120;
+    constexpr uint32_t PitSize = 400;
+
+    std::unique_ptr<IScene> CreatePit(
+        Engine& engine,
+        bool resolveCollisions,
+        std::vector<AfterCreatePtr<IMovableAabb2d>>& crates)
+    {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> xDistribution(1.0f, PitSize - 3.0f);
+        std::uniform_real_distribution<float> yDistribution(1.0f, PitSize - 3.0f);
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(BroadphaseType::UniformGrid);
+        sceneDefinition.GridCellSize(4.0f);
+        sceneDefinition.ResolveCollisions(resolveCollisions);
+
+        TileGridDefinition pit(glm::vec2(0.0f, 0.0f), PitSize, PitSize, 1.0f, std::any());
+        for (uint32_t i = 0; i < PitSize; i++)
+        {
+            pit.SetSolid(i, 0);
+            pit.SetSolid(0, i);
+            pit.SetSolid(PitSize - 1, i);
+        }
+        sceneDefinition.AddTileGrid(pit);
+
+        for (auto& crate : crates)
+        {
+            sceneDefinition.AddMovableAabb2d(
+                MovableAabb2dDefinition(
+                    &crate,
+                    glm::vec2(xDistribution(random), yDistribution(random)),
+                    glm::vec2(1.5f, 1.5f),
+                    nullptr,
+                    std::any()
+                )
+            );
+        }
+
+        auto scene = engine.CreateScene(sceneDefinition);
+        for (auto& crate : crates)
+        {
+            crate->Acceleration(glm::vec2(0.0f, -30.0f));
+        }
+        return scene;
+    }
+
+    void BM_DropCrates(benchmark::State& state)
+    {
+        bool resolveCollisions = state.range(0) != 0;
+        Engine engine;
+        float lowest = PitSize;
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            std::vector<AfterCreatePtr<IMovableAabb2d>> crates(CrateCount);
+            auto scene = CreatePit(engine, resolveCollisions, crates);
+            state.ResumeTiming();
+
+            for (int step = 0; step < StepCount; step++)
+            {
+                scene->Update(IScene::StepTime);
+            }
+
+            state.PauseTiming();
+            for (auto& crate : crates)
+            {
+                lowest = std::min(lowest, crate->Position().y);
+            }
+            scene.reset();
+            state.ResumeTiming();
+        }
+
+        state.counters["lowest"] = lowest;
+    }
+}
+
+BENCHMARK(BM_DropCrates)->ArgName("resolve")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,101 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <JkEng/Physics/Engine.h>
+
+#include "BenchmarkCounters.h"
+
+using namespace JkEng;
+using namespace JkEng::Physics;
+using namespace JkEng::Physics::Benchmarks;
+
+// Times volleys of bullets fired across a field of targets.  Each bullet
+// moves further than a target's width every step, so without sweeping it
+// only hits the targets it happens to land on.  Each benchmark iteration
+// is one volley, from the bullets being put back at the edge of the field
+// to them leaving the other side.
+//
+// Arguments, in order:
+//   steps_per_second - the scene's steps per second.
+//   fast             - 1 to sweep the bullets, see
+//                      MovableAabb2dDefinition::IsFast.
+//
+// Counters:
+//   hits_per_volley - how many targets the bullets hit each volley.
+namespace
+{
+    constexpr int TargetCount = 2000;
+    constexpr int BulletCount = 500;
+    constexpr float BulletSpeed = 600.0f;
+    constexpr float FieldSize = 500.0f;
+    constexpr uint32_t BulletCategory = 0x2;
+
+    void BM_FireVolley(benchmark::State& state)
+    {
+        float stepDuration = 1.0f / state.range(0);
+        bool isFast = state.range(1) != 0;
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> positionDistribution(0.0f, FieldSize);
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(BroadphaseType::DynamicTree);
+        sceneDefinition.StepDuration(stepDuration);
+        for (int i = 0; i < TargetCount; i++)
+        {
+            sceneDefinition.AddMovableAabb2d(
+                MovableAabb2dDefinition(
+                    nullptr,
+                    glm::vec2(positionDistribution(random), positionDistribution(random)),
+                    glm::vec2(2.0f, 2.0f),
+                    nullptr,
+                    std::any()
+                )
+            );
+        }
+
+        uint64_t hitCount = 0;
+        std::vector<AfterCreatePtr<IMovableAabb2d>> bullets(BulletCount);
+        std::vector<float> bulletYs(BulletCount);
+        for (int i = 0; i < BulletCount; i++)
+        {
+            bulletYs[i] = positionDistribution(random);
+            MovableAabb2dDefinition bullet(
+                &bullets[i],
+                glm::vec2(0.0f, bulletYs[i]),
+                glm::vec2(0.25f, 0.25f),
+                [&](const IReadOnlyAabb2d&) { hitCount++; },
+                std::any()
+            );
+            bullet.CollisionFilter(BulletCategory, ~BulletCategory);
+            bullet.IsFast(isFast);
+            sceneDefinition.AddMovableAabb2d(bullet);
+        }
+
+        Engine engine;
+        auto scene = engine.CreateScene(sceneDefinition);
+        int stepsPerVolley = static_cast<int>(FieldSize / BulletSpeed / stepDuration) + 1;
+        for (auto _ : state)
+        {
+            for (int i = 0; i < BulletCount; i++)
+            {
+                bullets[i]->Position(glm::vec2(0.0f, bulletYs[i]));
+                bullets[i]->Velocity(glm::vec2(BulletSpeed, 0.0f));
+            }
+            for (int step = 0; step < stepsPerVolley; step++)
+            {
+                scene->Update(stepDuration);
+            }
+        }
+
+        state.counters["hits_per_volley"] = PerIteration(hitCount);
+    }
+}
+
+BENCHMARK(BM_FireVolley)
+    ->ArgNames({ "steps_per_second", "fast" })
+    ->Args({ 60, 0 })
+    ->Args({ 240, 0 })
+    ->Args({ 30, 1 })
+    ->Unit(benchmark::kMicrosecond);
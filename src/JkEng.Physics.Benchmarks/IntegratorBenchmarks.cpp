@@ -0,0 +1,61 @@
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkCounters.h"
+#include "CpuFeatures.h"
+#include "Integrator.h"
+
+using namespace JkEng::Physics;
+using namespace JkEng::Physics::Benchmarks;
+
+// Times only the integration step of Scene::Update for each instruction
+// set, skipping those the CPU does not support.  Each benchmark iteration
+// integrates every AABB once.
+//
+// Arguments:
+//   instruction_set - an InstructionSet.
+//
+// Counters:
+//   ns_per_body - the time to integrate one AABB.
+namespace
+{
+    constexpr int ObjectCount = 100000;
+
+    void BM_Integrate(benchmark::State& state)
+    {
+        auto instructionSet = static_cast<InstructionSet>(state.range(0));
+        if (!CpuFeatures::IsSupported(instructionSet))
+        {
+            state.SkipWithError("Instruction set not supported by this CPU");
+            return;
+        }
+
+        AabbStorage aabbs;
+        for (int i = 0; i < ObjectCount; i++)
+        {
+            aabbs.Add(
+                glm::vec2(i * 6.0f, 0.0f),
+                glm::vec2(5.0f, 10.0f),
+                glm::vec2(1.0f, 2.0f),
+                glm::vec2(0.0f, -9.8f),
+                nullptr,
+                std::any());
+        }
+
+        Integrator integrator(instructionSet);
+        for (auto _ : state)
+        {
+            integrator.Integrate(aabbs, 1.0f / 60.0f);
+        }
+
+        state.counters["ns_per_body"] = NanosecondsPerBody(ObjectCount);
+    }
+}
+
+BENCHMARK(BM_Integrate)
+    ->ArgName("instruction_set")
+    ->Arg(static_cast<int64_t>(InstructionSet::Scalar))
+    ->Arg(static_cast<int64_t>(InstructionSet::Sse2))
+    ->Arg(static_cast<int64_t>(InstructionSet::Avx2))
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <JkEng/Physics/Engine.h>
+
+#include "BenchmarkCounters.h"
+
+using namespace JkEng;
+using namespace JkEng::Physics;
+using namespace JkEng::Physics::Benchmarks;
+
+// Compares how long the render thread is held up each frame when it calls
+// Update itself with how long it is held up when a physics thread steps
+// the scene and the render thread only reads snapshots and queues writes.
+// Each benchmark iteration is one frame: half the AABBs are given a new
+// velocity and every position is read for drawing.  The physics thread
+// is given the rest of a 60 Hz frame, outside the timing, to step.
+//
+// Arguments:
+//   bodies - the number of movable AABBs.
+//
+// Counters:
+//   steps_per_frame - how many steps the physics thread took per frame.
+namespace
+{
+    constexpr int64_t FrameCount = 120;
+
+    SceneDefinition CreatePhysicsThreadSceneDefinition(int bodyCount)
+    {
+        std::mt19937 random(42);
+        float levelSize = 4.0f * std::sqrt(static_cast<float>(bodyCount));
+        std::uniform_real_distribution<float> levelDistribution(0.0f, levelSize);
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(BroadphaseType::DynamicTree);
+        for (int i = 0; i < bodyCount; i++)
+        {
+            sceneDefinition.AddMovableAabb2d(
+                MovableAabb2dDefinition(
+                    nullptr,
+                    glm::vec2(levelDistribution(random), levelDistribution(random)),
+                    glm::vec2(2.0f, 2.0f),
+                    [](const IReadOnlyAabb2d&) { },
+                    std::any()
+                )
+            );
+        }
+        return sceneDefinition;
+    }
+
+    void BM_RenderThreadFrame_UpdateInline(benchmark::State& state)
+    {
+        auto bodyCount = static_cast<uint32_t>(state.range(0));
+        Engine engine;
+        auto scene = engine.CreateScene(CreatePhysicsThreadSceneDefinition(bodyCount));
+        std::vector<glm::vec2> positions(scene->BodyIdCount());
+
+        int frame = 0;
+        for (auto _ : state)
+        {
+            for (uint32_t bodyId = 0; bodyId < bodyCount; bodyId += 2)
+            {
+                scene->Body(scene->HandleOf(bodyId))->Velocity(glm::vec2(std::sin(frame * 0.1f) * 10.0f, 0.0f));
+            }
+            scene->Update(IScene::StepTime);
+            scene->InterpolatedPositions(positions);
+            frame++;
+        }
+    }
+
+    void BM_RenderThreadFrame_PhysicsThread(benchmark::State& state)
+    {
+        auto bodyCount = static_cast<uint32_t>(state.range(0));
+        Engine engine;
+        auto threadedScene = engine.CreateThreadedScene(CreatePhysicsThreadSceneDefinition(bodyCount));
+        std::vector<BodyHandle> handles;
+        for (uint32_t bodyId = 0; bodyId < bodyCount; bodyId++)
+        {
+            handles.push_back(threadedScene->Scene().HandleOf(bodyId));
+        }
+        std::vector<glm::vec2> positions(bodyCount);
+
+        threadedScene->Start();
+        auto nextFrame = std::chrono::steady_clock::now();
+        int frame = 0;
+        for (auto _ : state)
+        {
+            for (uint32_t bodyId = 0; bodyId < bodyCount; bodyId += 2)
+            {
+                threadedScene->SetVelocity(handles[bodyId], glm::vec2(std::sin(frame * 0.1f) * 10.0f, 0.0f));
+            }
+            const SceneSnapshot& snapshot = threadedScene->LatestSnapshot();
+            float alpha = std::clamp(
+                std::chrono::duration<float>(std::chrono::steady_clock::now() - snapshot.stepTime).count() / IScene::StepTime,
+                0.0f,
+                1.0f);
+            for (uint32_t bodyId = 0; bodyId < snapshot.BodyIdCount(); bodyId++)
+            {
+                positions[bodyId] = snapshot.InterpolatedPosition(bodyId, alpha);
+            }
+            frame++;
+
+            state.PauseTiming();
+            nextFrame += std::chrono::microseconds(16667);
+            std::this_thread::sleep_until(nextFrame);
+            state.ResumeTiming();
+        }
+        threadedScene->Stop();
+
+        state.counters["steps_per_frame"] = PerIteration(threadedScene->LatestSnapshot().stepCount);
+    }
+}
+
+// Wall time, since the physics thread competes with the render thread for
+// caches and memory bandwidth, and a fixed number of frames, since every
+// physics thread frame lasts 1/60th of a second however little is timed.
+BENCHMARK(BM_RenderThreadFrame_UpdateInline)
+    ->ArgName("bodies")->Arg(10000)->Iterations(FrameCount)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RenderThreadFrame_PhysicsThread)
+    ->ArgName("bodies")->Arg(10000)->Iterations(FrameCount)->UseRealTime()->Unit(benchmark::kMicrosecond);
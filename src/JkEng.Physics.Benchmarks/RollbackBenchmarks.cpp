@@ -0,0 +1,92 @@
+#include <cstdint>
+#include <memory>
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include <JkEng/Physics/Engine.h>
+
+#include "BenchmarkCounters.h"
+
+using namespace JkEng;
+using namespace JkEng::Physics;
+using namespace JkEng::Physics::Benchmarks;
+
+// Times saving every frame and rolling back a few frames at a time, the
+// way rollback netcode does when late input arrives.  Each benchmark
+// iteration is one SaveState or RestoreState of a scene that has taken a
+// step, so it has contacts to save.
+//
+// Arguments:
+//   bodies - the number of movable AABBs.
+//
+// Counters:
+//   ns_per_body - the time to save or restore one AABB.
+namespace
+{
+    std::unique_ptr<IScene> CreateRollbackScene(Engine& engine, int bodyCount)
+    {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> positionDistribution(0.0f, 100.0f);
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(BroadphaseType::DynamicTree);
+        for (int i = 0; i < bodyCount; i++)
+        {
+            sceneDefinition.AddMovableAabb2d(
+                MovableAabb2dDefinition(
+                    nullptr,
+                    glm::vec2(positionDistribution(random), positionDistribution(random)),
+                    glm::vec2(2.0f, 2.0f),
+                    nullptr,
+                    std::any()
+                )
+            );
+        }
+        auto scene = engine.CreateScene(sceneDefinition);
+        scene->Update(IScene::StepTime);
+        return scene;
+    }
+
+    void BM_SaveState(benchmark::State& state)
+    {
+        auto bodyCount = static_cast<int>(state.range(0));
+        Engine engine;
+        auto scene = CreateRollbackScene(engine, bodyCount);
+
+        uint32_t frame = 0;
+        for (auto _ : state)
+        {
+            scene->SaveState(frame++);
+        }
+
+        state.counters["ns_per_body"] = NanosecondsPerBody(bodyCount);
+    }
+
+    // Restores the 8 frames the scene keeps by default in turn.
+    void BM_RestoreState(benchmark::State& state)
+    {
+        constexpr uint32_t SavedFrames = 8;
+        auto bodyCount = static_cast<int>(state.range(0));
+        Engine engine;
+        auto scene = CreateRollbackScene(engine, bodyCount);
+        for (uint32_t frame = 0; frame < SavedFrames; frame++)
+        {
+            scene->SaveState(frame);
+        }
+
+        uint32_t frame = 0;
+        for (auto _ : state)
+        {
+            if (!scene->RestoreState(frame++ % SavedFrames))
+            {
+                state.SkipWithError("RestoreState found no saved frame");
+                break;
+            }
+        }
+
+        state.counters["ns_per_body"] = NanosecondsPerBody(bodyCount);
+    }
+}
+
+BENCHMARK(BM_SaveState)->ArgName("bodies")->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RestoreState)->ArgName("bodies")->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,158 @@
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <JkEng/Physics/BasicScene.h>
+#include <JkEng/Physics/CollisionHandlerPolicies.h>
+#include <JkEng/Physics/Scene.h>
+
+#include "BenchmarkCounters.h"
+
+using namespace JkEng;
+using namespace JkEng::Physics;
+using namespace JkEng::Physics::Benchmarks;
+
+// Times the same crowded scene stepped by Scene, which calls its
+// broadphase through IBroadphase and a std::function per body, and by
+// BasicScene instantiations that know the broadphase and how collisions
+// are handled at compile time.  Every handler counts the collisions it is
+// told about, except with NoHandlers, which calls nothing.  Each benchmark
+// iteration is one step.
+//
+// Arguments:
+//   bodies - the number of movable AABBs.
+//
+// Counters:
+//   ns_per_body_step    - the time per AABB per step.
+//   collisions_per_step - how many collisions the handlers were told about
+//                         each step.
+namespace
+{
+    struct CountCollision
+    {
+        uint64_t* collisionCount;
+
+        void operator()(IMovableAabb2d& /*body*/, const ReadOnlyAabb2dView& /*otherBody*/) const
+        {
+            (*collisionCount)++;
+        }
+    };
+
+    uint64_t functionPointerCollisionCount = 0;
+
+    void CountFunctionPointerCollision(IMovableAabb2d& /*body*/, const ReadOnlyAabb2dView& /*otherBody*/)
+    {
+        functionPointerCollisionCount++;
+    }
+
+    // Steps the scene createScene builds from a crowded sweep and prune
+    // scene, whose movable AABBs count their own collisions into
+    // collisionCount if bodyHandlers is true.
+    template<typename CreateScene>
+    void UpdateSpecializedScene(
+        benchmark::State& state,
+        bool bodyHandlers,
+        uint64_t& collisionCount,
+        CreateScene createScene)
+    {
+        auto bodyCount = static_cast<int>(state.range(0));
+        std::mt19937 random(42);
+        float levelSize = 2.0f * std::sqrt(static_cast<float>(bodyCount));
+        std::uniform_real_distribution<float> levelDistribution(0.0f, levelSize);
+        std::uniform_real_distribution<float> velocityDistribution(-20.0f, 20.0f);
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(BroadphaseType::SweepAndPrune);
+        std::vector<AfterCreatePtr<IMovableAabb2d>> bodies(bodyCount);
+        for (auto& body : bodies)
+        {
+            MovableAabb2dDefinition definition(
+                &body,
+                glm::vec2(levelDistribution(random), levelDistribution(random)),
+                glm::vec2(2.0f, 2.0f),
+                nullptr,
+                std::any());
+            if (bodyHandlers)
+            {
+                definition.CollisionViewHandler([&collisionCount](const ReadOnlyAabb2dView&)
+                {
+                    collisionCount++;
+                });
+            }
+            sceneDefinition.AddMovableAabb2d(definition);
+        }
+
+        auto scene = createScene(sceneDefinition);
+        for (auto& body : bodies)
+        {
+            body->Velocity(glm::vec2(velocityDistribution(random), velocityDistribution(random)));
+        }
+
+        collisionCount = 0;
+        for (auto _ : state)
+        {
+            scene->Update(IScene::StepTime);
+        }
+
+        state.counters["ns_per_body_step"] = NanosecondsPerBody(bodyCount);
+        state.counters["collisions_per_step"] = PerIteration(collisionCount);
+    }
+
+    void BM_Update_Scene(benchmark::State& state)
+    {
+        uint64_t collisionCount = 0;
+        UpdateSpecializedScene(state, true, collisionCount, [](const SceneDefinition& definition)
+        {
+            return std::make_unique<Scene>(definition);
+        });
+    }
+
+    void BM_Update_SweepAndPruneFunctionHandlers(benchmark::State& state)
+    {
+        uint64_t collisionCount = 0;
+        UpdateSpecializedScene(state, true, collisionCount, [](const SceneDefinition& definition)
+        {
+            return std::make_unique<BasicScene<SweepAndPruneBroadphase, FunctionHandlers>>(definition);
+        });
+    }
+
+    void BM_Update_SweepAndPruneFunctionPointerHandlers(benchmark::State& state)
+    {
+        UpdateSpecializedScene(state, false, functionPointerCollisionCount, [](const SceneDefinition& definition)
+        {
+            return std::make_unique<BasicScene<SweepAndPruneBroadphase, FunctionPointerHandlers>>(
+                definition,
+                FunctionPointerHandlers(&CountFunctionPointerCollision));
+        });
+    }
+
+    void BM_Update_SweepAndPruneFunctorHandlers(benchmark::State& state)
+    {
+        uint64_t collisionCount = 0;
+        UpdateSpecializedScene(state, false, collisionCount, [&collisionCount](const SceneDefinition& definition)
+        {
+            return std::make_unique<BasicScene<SweepAndPruneBroadphase, FunctorHandlers<CountCollision>>>(
+                definition,
+                FunctorHandlers<CountCollision>(CountCollision{ &collisionCount }));
+        });
+    }
+
+    void BM_Update_SweepAndPruneNoHandlers(benchmark::State& state)
+    {
+        uint64_t collisionCount = 0;
+        UpdateSpecializedScene(state, false, collisionCount, [](SceneDefinition definition)
+        {
+            definition.CollisionHandlers(false);
+            return std::make_unique<BasicScene<SweepAndPruneBroadphase, NoHandlers>>(definition);
+        });
+    }
+}
+
+BENCHMARK(BM_Update_Scene)->ArgName("bodies")->Arg(10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Update_SweepAndPruneFunctionHandlers)->ArgName("bodies")->Arg(10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Update_SweepAndPruneFunctionPointerHandlers)->ArgName("bodies")->Arg(10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Update_SweepAndPruneFunctorHandlers)->ArgName("bodies")->Arg(10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Update_SweepAndPruneNoHandlers)->ArgName("bodies")->Arg(10000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,119 @@
+#include <cstdint>
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include <JkEng/Physics/Engine.h>
+
+#include "BenchmarkCounters.h"
+
+using namespace JkEng;
+using namespace JkEng::Physics;
+using namespace JkEng::Physics::Benchmarks;
+
+// Times a scene of AABBs piled on a floor that never move, updated with
+// and without sleeping, and the same with a few AABBs kept moving beside
+// it.  Each benchmark iteration is one step, after enough steps before
+// timing starts for the idle AABBs to fall asleep.
+//
+// Arguments, in order:
+//   broadphase         - a BroadphaseType.
+//   steps_before_sleep - SceneDefinition::StepsBeforeSleep, 0 to never
+//                        sleep.
+//   moving             - how many AABBs keep moving above the idle ones.
+//
+// Counters:
+//   ns_per_body_step - the time per AABB per step.
+namespace
+{
+    constexpr int AabbCount = 10000;
+    constexpr int64_t TurnEverySteps = 600;
+
+    void BM_Update_IdleScene(benchmark::State& state)
+    {
+        auto broadphase = static_cast<BroadphaseType>(state.range(0));
+        auto stepsBeforeSleep = static_cast<uint32_t>(state.range(1));
+        auto movingAabbCount = static_cast<int>(state.range(2));
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> positionDistribution(0.0f, 400.0f);
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(broadphase);
+        sceneDefinition.GridCellSize(2.0f);
+        sceneDefinition.StepsBeforeSleep(stepsBeforeSleep);
+        for (int i = 0; i < AabbCount; i++)
+        {
+            sceneDefinition.AddMovableAabb2d(
+                MovableAabb2dDefinition(
+                    nullptr,
+                    glm::vec2(positionDistribution(random), positionDistribution(random)),
+                    glm::vec2(2.0f, 2.0f),
+                    [](const IReadOnlyAabb2d&) { },
+                    std::any()
+                )
+            );
+        }
+
+        // Above the idle AABBs so they never wake them.  They turn around
+        // every TurnEverySteps steps so they stay above the idle ones however
+        // long the benchmark runs.
+        for (int i = 0; i < movingAabbCount; i++)
+        {
+            sceneDefinition.AddMovableAabb2d(
+                MovableAabb2dDefinition(
+                    nullptr,
+                    glm::vec2(positionDistribution(random), 420.0f + (i % 10) * 4.0f),
+                    glm::vec2(2.0f, 2.0f),
+                    [](const IReadOnlyAabb2d&) { },
+                    std::any()
+                )
+            );
+        }
+
+        Engine engine;
+        auto scene = engine.CreateScene(sceneDefinition);
+        auto setMovingVelocities = [&](float speed)
+        {
+            for (int i = 0; i < movingAabbCount; i++)
+            {
+                scene->Body(scene->HandleOf(AabbCount + i))->Velocity(glm::vec2(i % 2 == 0 ? speed : -speed, 0.0f));
+            }
+        };
+        setMovingVelocities(20.0f);
+
+        for (uint32_t i = 0; i <= stepsBeforeSleep; i++)
+        {
+            scene->Update(IScene::StepTime);
+        }
+
+        int64_t steps = 0;
+        float speed = 20.0f;
+        for (auto _ : state)
+        {
+            scene->Update(IScene::StepTime);
+            if (movingAabbCount > 0 && ++steps % TurnEverySteps == 0)
+            {
+                state.PauseTiming();
+                speed = -speed;
+                setMovingVelocities(speed);
+                state.ResumeTiming();
+            }
+        }
+
+        state.counters["ns_per_body_step"] = NanosecondsPerBody(AabbCount + movingAabbCount);
+    }
+
+    void IdleSceneArguments(benchmark::internal::Benchmark* benchmark)
+    {
+        constexpr int64_t MovingAabbCount = 100;
+        benchmark->ArgNames({ "broadphase", "steps_before_sleep", "moving" });
+        for (int64_t stepsBeforeSleep : { 0, 30 })
+        {
+            benchmark->Args({ static_cast<int64_t>(BroadphaseType::UniformGrid), stepsBeforeSleep, 0 });
+            benchmark->Args({ static_cast<int64_t>(BroadphaseType::DynamicTree), stepsBeforeSleep, 0 });
+            benchmark->Args({ static_cast<int64_t>(BroadphaseType::UniformGrid), stepsBeforeSleep, MovingAabbCount });
+            benchmark->Args({ static_cast<int64_t>(BroadphaseType::SweepAndPrune), stepsBeforeSleep, MovingAabbCount });
+        }
+    }
+}
+
+BENCHMARK(BM_Update_IdleScene)->Apply(IdleSceneArguments)->Unit(benchmark::kMicrosecond);
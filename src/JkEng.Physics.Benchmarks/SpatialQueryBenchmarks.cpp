@@ -0,0 +1,177 @@
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <JkEng/Physics/Engine.h>
+
+#include "BenchmarkCounters.h"
+
+using namespace JkEng;
+using namespace JkEng::Physics;
+using namespace JkEng::Physics::Benchmarks;
+
+// Times queries made against a field of movable and static AABBs and a
+// tile grid, such as picking, line of sight checks and target selection.
+// Each benchmark iteration is one query from a random point, unless its
+// comment says otherwise.
+//
+// Counters:
+//   results_per_query - how many bodies or hits each query found.
+namespace
+{
+    constexpr int MovableCount = 10000;
+    constexpr int StaticCount = 10000;
+    constexpr float FieldSize = 1000.0f;
+
+    // The scene every query is made against, and the random numbers to
+    // make them with.
+    struct QueryField
+    {
+        Engine engine;
+        std::unique_ptr<IScene> scene;
+        std::mt19937 random{ 42 };
+        std::uniform_real_distribution<float> positionDistribution{ 0.0f, FieldSize };
+
+        explicit QueryField(uint32_t threadCount)
+        {
+            SceneDefinition sceneDefinition;
+            sceneDefinition.ThreadCount(threadCount);
+            for (int i = 0; i < MovableCount; i++)
+            {
+                sceneDefinition.AddMovableAabb2d(
+                    MovableAabb2dDefinition(nullptr, RandomPosition(), glm::vec2(2.0f, 2.0f), nullptr, std::any()));
+            }
+            for (int i = 0; i < StaticCount; i++)
+            {
+                sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(RandomPosition(), glm::vec2(4.0f, 4.0f), std::any()));
+            }
+
+            std::bernoulli_distribution isSolidDistribution(0.02);
+            TileGridDefinition tileGrid(glm::vec2(0.0f, 0.0f), 500, 500, 2.0f, std::any());
+            for (uint32_t row = 0; row < 500; row++)
+            {
+                for (uint32_t column = 0; column < 500; column++)
+                {
+                    tileGrid.SetSolid(column, row, isSolidDistribution(random));
+                }
+            }
+            sceneDefinition.AddTileGrid(tileGrid);
+            scene = engine.CreateScene(sceneDefinition);
+        }
+
+        glm::vec2 RandomPosition()
+        {
+            return glm::vec2(positionDistribution(random), positionDistribution(random));
+        }
+    };
+
+    void BM_QueryRegion(benchmark::State& state)
+    {
+        QueryField field(1);
+        std::vector<uint32_t> bodyIds(256);
+        uint64_t resultCount = 0;
+        for (auto _ : state)
+        {
+            resultCount += field.scene->QueryRegion(field.RandomPosition(), glm::vec2(20.0f, 20.0f), bodyIds);
+        }
+
+        state.counters["results_per_query"] = PerIteration(resultCount);
+    }
+
+    void BM_RaycastAll(benchmark::State& state)
+    {
+        QueryField field(1);
+        std::vector<RaycastHit> hits(16);
+        std::uniform_real_distribution<float> directionDistribution(-100.0f, 100.0f);
+        uint64_t resultCount = 0;
+        for (auto _ : state)
+        {
+            glm::vec2 origin = field.RandomPosition();
+            glm::vec2 direction(directionDistribution(field.random), directionDistribution(field.random));
+            resultCount += field.scene->RaycastAll(origin, direction, hits);
+        }
+
+        state.counters["results_per_query"] = PerIteration(resultCount);
+    }
+
+    void BM_NearestK(benchmark::State& state)
+    {
+        QueryField field(1);
+        std::vector<NearestBody> nearest(8);
+        uint64_t resultCount = 0;
+        for (auto _ : state)
+        {
+            resultCount += field.scene->NearestK(field.RandomPosition(), nearest);
+        }
+
+        state.counters["results_per_query"] = PerIteration(resultCount);
+    }
+
+    // Movable AABBs are moved every step, so the first query after each step
+    // pays for bringing the scene's query tree up to date.  Each benchmark
+    // iteration is QueriesPerStep queries after a step taken while timing is
+    // paused, for a fixed number of steps so the AABBs stay on the field.
+    void BM_QueryRegion_BetweenSteps(benchmark::State& state)
+    {
+        constexpr int QueriesPerStep = 100;
+        QueryField field(1);
+        std::vector<glm::vec2> velocities(field.scene->BodyIdCount());
+        std::uniform_real_distribution<float> velocityDistribution(-20.0f, 20.0f);
+        for (auto& velocity : velocities)
+        {
+            velocity = glm::vec2(velocityDistribution(field.random), velocityDistribution(field.random));
+        }
+        field.scene->SetVelocities(velocities);
+
+        std::vector<uint32_t> bodyIds(256);
+        uint64_t resultCount = 0;
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            field.scene->Update(IScene::StepTime);
+            state.ResumeTiming();
+
+            for (int i = 0; i < QueriesPerStep; i++)
+            {
+                resultCount += field.scene->QueryRegion(field.RandomPosition(), glm::vec2(20.0f, 20.0f), bodyIds);
+            }
+        }
+
+        state.counters["results_per_query"] = PerIteration(static_cast<double>(resultCount) / QueriesPerStep);
+    }
+
+    // Line of sight checks from random points towards random targets.  Each
+    // benchmark iteration is one RaycastBatch of RayCount rays.
+    //
+    // Arguments:
+    //   threads - SceneDefinition::ThreadCount.
+    void BM_RaycastBatch(benchmark::State& state)
+    {
+        constexpr int RayCount = 10000;
+        QueryField field(static_cast<uint32_t>(state.range(0)));
+        std::vector<Ray> rays(RayCount);
+        for (auto& ray : rays)
+        {
+            glm::vec2 origin = field.RandomPosition();
+            ray = { origin, field.RandomPosition() - origin };
+        }
+
+        std::vector<RaycastHit> hits(RayCount);
+        uint64_t resultCount = 0;
+        for (auto _ : state)
+        {
+            resultCount += field.scene->RaycastBatch(rays, hits);
+        }
+
+        state.counters["results_per_query"] = PerIteration(static_cast<double>(resultCount) / RayCount);
+    }
+}
+
+BENCHMARK(BM_QueryRegion)->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_RaycastAll)->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_NearestK)->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_QueryRegion_BetweenSteps)->Iterations(600)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RaycastBatch)->ArgName("threads")->Arg(1)->Arg(4)->UseRealTime()->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,140 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <JkEng/Physics/Engine.h>
+
+#include "BenchmarkCounters.h"
+
+using namespace JkEng;
+using namespace JkEng::Physics;
+using namespace JkEng::Physics::Benchmarks;
+
+// Compares a tile level added as movable AABBs with the same level added
+// as static AABBs and as a tile grid.  Each row of tiles has gaps and the
+// moving AABBs fall through the level.  Each benchmark iteration is one
+// step, and the moving AABBs are put back where they started now and then
+// so they never fall out of the level.
+//
+// Arguments, in order:
+//   broadphase - a BroadphaseType.
+//   tiles      - a Tiles.
+//
+// Counters:
+//   tiles - how many tiles the level has.
+namespace
+{
+    enum class Tiles : int64_t
+    {
+        Movable,
+        Static,
+        TileGrid
+    };
+
+    constexpr int TileColumns = 200;
+    constexpr int TileRows = 50;
+    constexpr int MovingCount = 500;
+    constexpr int64_t ResetEverySteps = 100;
+
+    void BM_Update_TileLevel(benchmark::State& state)
+    {
+        auto broadphase = static_cast<BroadphaseType>(state.range(0));
+        auto tiles = static_cast<Tiles>(state.range(1));
+        std::mt19937 random(42);
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(broadphase);
+        sceneDefinition.GridCellSize(2.0f);
+        TileGridDefinition tileGrid(glm::vec2(0.0f, 0.0f), TileColumns, TileRows * 4, 1.0f, std::any());
+
+        std::uniform_int_distribution<int> gapDistribution(0, 3);
+        int tileCount = 0;
+        for (int row = 0; row < TileRows; row++)
+        {
+            for (int column = 0; column < TileColumns; column++)
+            {
+                if (gapDistribution(random) == 0)
+                {
+                    continue;
+                }
+
+                glm::vec2 position(column * 1.0f, row * 4.0f);
+                glm::vec2 size(1.0f, 1.0f);
+                if (tiles == Tiles::Static)
+                {
+                    sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(position, size, std::any()));
+                }
+                else if (tiles == Tiles::TileGrid)
+                {
+                    tileGrid.SetSolid(column, row * 4);
+                }
+                else
+                {
+                    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, position, size, nullptr, std::any()));
+                }
+                tileCount++;
+            }
+        }
+        if (tiles == Tiles::TileGrid)
+        {
+            sceneDefinition.AddTileGrid(tileGrid);
+        }
+
+        std::uniform_real_distribution<float> xDistribution(0.0f, TileColumns * 1.0f);
+        std::uniform_real_distribution<float> yDistribution(0.0f, TileRows * 4.0f);
+        std::vector<AfterCreatePtr<IMovableAabb2d>> movingAabbs(MovingCount);
+        std::vector<glm::vec2> startPositions(MovingCount);
+        for (int i = 0; i < MovingCount; i++)
+        {
+            startPositions[i] = glm::vec2(xDistribution(random), yDistribution(random));
+            sceneDefinition.AddMovableAabb2d(
+                MovableAabb2dDefinition(
+                    &movingAabbs[i],
+                    startPositions[i],
+                    glm::vec2(0.8f, 0.8f),
+                    [](const IReadOnlyAabb2d&) { },
+                    std::any()
+                )
+            );
+        }
+
+        Engine engine;
+        auto scene = engine.CreateScene(sceneDefinition);
+        for (auto& movingAabb : movingAabbs)
+        {
+            movingAabb->Velocity(glm::vec2(0.0f, -10.0f));
+        }
+
+        int64_t steps = 0;
+        for (auto _ : state)
+        {
+            scene->Update(IScene::StepTime);
+            if (++steps % ResetEverySteps == 0)
+            {
+                state.PauseTiming();
+                for (int i = 0; i < MovingCount; i++)
+                {
+                    movingAabbs[i]->Position(startPositions[i]);
+                }
+                state.ResumeTiming();
+            }
+        }
+
+        state.counters["tiles"] = tileCount;
+    }
+
+    void TileLevelArguments(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "broadphase", "tiles" });
+        for (auto broadphase : { BroadphaseType::UniformGrid, BroadphaseType::DynamicTree })
+        {
+            for (auto tiles : { Tiles::Movable, Tiles::Static, Tiles::TileGrid })
+            {
+                benchmark->Args({ static_cast<int64_t>(broadphase), static_cast<int64_t>(tiles) });
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_Update_TileLevel)->Apply(TileLevelArguments)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,111 @@
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <JkEng/Physics/Engine.h>
+
+#include "BenchmarkCounters.h"
+
+using namespace JkEng;
+using namespace JkEng::Physics;
+using namespace JkEng::Physics::Benchmarks;
+
+// Times how Update scales with SceneDefinition::ThreadCount for each
+// broadphase.  AABBs are spread evenly over a level sized so each one
+// overlaps about one other at a time, and are put back where they started
+// now and then so they stay that way.  Each benchmark iteration is one
+// step, timed in wall time since the work is spread over threads.
+//
+// Arguments, in order:
+//   broadphase - a BroadphaseType.
+//   bodies     - the number of movable AABBs.
+//   threads    - SceneDefinition::ThreadCount.
+//
+// Counters:
+//   ns_per_body_step - the time per AABB per step.
+namespace
+{
+    constexpr int64_t ResetEverySteps = 600;
+
+    void BM_Update_ThreadCount(benchmark::State& state)
+    {
+        auto broadphase = static_cast<BroadphaseType>(state.range(0));
+        auto objectCount = static_cast<int>(state.range(1));
+        auto threadCount = static_cast<uint32_t>(state.range(2));
+        std::mt19937 random(42);
+        float levelSize = 4.0f * std::sqrt(static_cast<float>(objectCount));
+        std::uniform_real_distribution<float> levelDistribution(0.0f, levelSize);
+        std::uniform_real_distribution<float> sizeDistribution(1.0f, 3.0f);
+        std::uniform_real_distribution<float> velocityDistribution(-20.0f, 20.0f);
+
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(broadphase);
+        sceneDefinition.GridCellSize(4.0f);
+        sceneDefinition.SweepAndPruneAxes(SweepAndPruneAxes::Both);
+        sceneDefinition.ThreadCount(threadCount);
+
+        auto aabbs = std::make_unique<AfterCreatePtr<IMovableAabb2d>[]>(objectCount);
+        std::vector<glm::vec2> startPositions(objectCount);
+        for (int i = 0; i < objectCount; i++)
+        {
+            startPositions[i] = glm::vec2(levelDistribution(random), levelDistribution(random));
+            sceneDefinition.AddMovableAabb2d(
+                MovableAabb2dDefinition(
+                    &aabbs[i],
+                    startPositions[i],
+                    glm::vec2(sizeDistribution(random), sizeDistribution(random)),
+                    [](const IReadOnlyAabb2d&) { },
+                    std::any()
+                )
+            );
+        }
+
+        Engine engine;
+        auto scene = engine.CreateScene(sceneDefinition);
+        for (int i = 0; i < objectCount; i++)
+        {
+            aabbs[i]->Velocity(glm::vec2(velocityDistribution(random), velocityDistribution(random)));
+        }
+
+        int64_t steps = 0;
+        for (auto _ : state)
+        {
+            scene->Update(IScene::StepTime);
+            if (++steps % ResetEverySteps == 0)
+            {
+                state.PauseTiming();
+                for (int i = 0; i < objectCount; i++)
+                {
+                    aabbs[i]->Position(startPositions[i]);
+                }
+                state.ResumeTiming();
+            }
+        }
+
+        state.counters["ns_per_body_step"] = NanosecondsPerBody(objectCount);
+    }
+
+    // All pairs is quadratic, so it stops at 5000 AABBs.
+    void ThreadCountArguments(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "broadphase", "bodies", "threads" });
+        for (auto broadphase : {
+            BroadphaseType::AllPairs,
+            BroadphaseType::UniformGrid,
+            BroadphaseType::SweepAndPrune,
+            BroadphaseType::DynamicTree })
+        {
+            int64_t bodyCount = broadphase == BroadphaseType::AllPairs ? 5000 : 100000;
+            for (int64_t threadCount : { 1, 2, 4, 8 })
+            {
+                benchmark->Args({ static_cast<int64_t>(broadphase), bodyCount, threadCount });
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_Update_ThreadCount)->Apply(ThreadCountArguments)->UseRealTime()->Unit(benchmark::kMicrosecond);
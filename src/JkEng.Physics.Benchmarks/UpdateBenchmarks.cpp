@@ -0,0 +1,162 @@
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <JkEng/Physics/Engine.h>
+
+#include "BenchmarkCounters.h"
+
+using namespace JkEng;
+using namespace JkEng::Physics;
+using namespace JkEng::Physics::Benchmarks;
+
+// Times Scene::Update over a sweep of scenes so scaling curves and
+// regressions show up in the JSON output, see build-performance.sh.  Each
+// benchmark iteration is one step of a scene built before timing starts.
+//
+// Arguments, in order:
+//   bodies     - the number of movable AABBs.
+//   broadphase - a BroadphaseType.
+//   density    - the percentage of the world's area covered by AABBs.
+//   sizes      - a SizeDistribution.
+//   speed      - how fast every AABB moves, in units per second, each in
+//                a random direction.
+//
+// Counters:
+//   ns_per_body_step - the time per AABB per step, which stays flat for
+//                      broadphases that scale linearly.
+//   contacts_per_step - how many overlapping pairs each step found.
+namespace
+{
+    enum class SizeDistribution : int64_t
+    {
+        // Every AABB is 1x1.
+        Uniform,
+
+        // One AABB in 20 is 8x8 and the rest are 1x1, which is hard on
+        // broadphases tuned for one size.
+        Mixed
+    };
+
+    constexpr float SmallSize = 1.0f;
+    constexpr float LargeSize = 8.0f;
+    constexpr int LargeEvery = 20;
+    constexpr int64_t WrapEverySteps = 60;
+
+    void BM_Update(benchmark::State& state)
+    {
+        auto bodyCount = static_cast<int>(state.range(0));
+        auto broadphase = static_cast<BroadphaseType>(state.range(1));
+        float density = state.range(2) / 100.0f;
+        auto sizes = static_cast<SizeDistribution>(state.range(3));
+        auto speed = static_cast<float>(state.range(4));
+
+        float meanArea = sizes == SizeDistribution::Uniform
+            ? SmallSize * SmallSize
+            : (LargeSize * LargeSize + (LargeEvery - 1) * SmallSize * SmallSize) / LargeEvery;
+        float worldSize = std::sqrt(bodyCount * meanArea / density);
+
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> positionDistribution(0.0f, worldSize);
+        std::uniform_real_distribution<float> angleDistribution(0.0f, 6.2831853f);
+
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(broadphase);
+        sceneDefinition.GridCellSize(2.0f * SmallSize);
+        std::vector<AfterCreatePtr<IMovableAabb2d>> bodies(bodyCount);
+        for (int i = 0; i < bodyCount; i++)
+        {
+            float size = sizes == SizeDistribution::Mixed && i % LargeEvery == 0 ? LargeSize : SmallSize;
+            sceneDefinition.AddMovableAabb2d(
+                MovableAabb2dDefinition(
+                    &bodies[i],
+                    glm::vec2(positionDistribution(random), positionDistribution(random)),
+                    glm::vec2(size, size),
+                    nullptr,
+                    std::any()
+                )
+            );
+        }
+
+        uint64_t contactCount = 0;
+        sceneDefinition.ContactsHandler([&](std::span<const Contact> contacts)
+        {
+            contactCount += contacts.size();
+        });
+
+        Engine engine;
+        auto scene = engine.CreateScene(sceneDefinition);
+        for (auto& body : bodies)
+        {
+            float angle = angleDistribution(random);
+            body->Velocity(glm::vec2(std::cos(angle) * speed, std::sin(angle) * speed));
+        }
+
+        // Moving AABBs are wrapped back into the world now and then, outside
+        // the timing, so the density stays what was asked for.
+        int64_t steps = 0;
+        for (auto _ : state)
+        {
+            scene->Update(IScene::StepTime);
+            if (speed > 0.0f && ++steps % WrapEverySteps == 0)
+            {
+                state.PauseTiming();
+                for (auto& body : bodies)
+                {
+                    glm::vec2 position = body->Position();
+                    body->Position(glm::vec2(
+                        position.x - std::floor(position.x / worldSize) * worldSize,
+                        position.y - std::floor(position.y / worldSize) * worldSize));
+                }
+                state.ResumeTiming();
+            }
+        }
+
+        state.counters["ns_per_body_step"] = NanosecondsPerBody(bodyCount);
+        state.counters["contacts_per_step"] = PerIteration(contactCount);
+    }
+
+    // All pairs is quadratic, so it stops at 10k AABBs where a single step
+    // already takes a large fraction of a second.
+    void UpdateArguments(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "bodies", "broadphase", "density", "sizes", "speed" });
+        for (int64_t bodyCount : { 100, 1000, 10000, 100000 })
+        {
+            for (auto broadphase : {
+                BroadphaseType::AllPairs,
+                BroadphaseType::UniformGrid,
+                BroadphaseType::SweepAndPrune,
+                BroadphaseType::DynamicTree })
+            {
+                if (broadphase == BroadphaseType::AllPairs && bodyCount > 10000)
+                {
+                    continue;
+                }
+
+                for (int64_t density : { 5, 30 })
+                {
+                    for (auto sizes : { SizeDistribution::Uniform, SizeDistribution::Mixed })
+                    {
+                        for (int64_t speed : { 0, 30 })
+                        {
+                            benchmark->Args({
+                                bodyCount,
+                                static_cast<int64_t>(broadphase),
+                                density,
+                                static_cast<int64_t>(sizes),
+                                speed });
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_Update)->Apply(UpdateArguments)->Unit(benchmark::kMicrosecond);
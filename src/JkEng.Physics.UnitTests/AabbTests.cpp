@@ -1,5 +1,6 @@
 #include <string>
 #include <sstream>
+#include <utility>
 
 #include <gtest/gtest.h>
 
@@ -17,10 +18,18 @@ public:
     }
 
 protected:
+    AabbStorage _storage;
+
     static void DoNothingCollisionHandler(const IReadOnlyAabb2d&)
     {
 
     }
+
+    template<typename... Args>
+    Aabb Add(Args&&... args)
+    {
+        return Aabb(_storage, _storage.Add(std::forward<Args>(args)...));
+    }
 };
 
 struct TestObjectInfo
@@ -45,7 +54,7 @@ TEST_F(AabbTests, Constructor_GivenConstructedWithPositionAndSize_VerifyAllPrope
     glm::vec2 velocity(1.0f, 2.0f);
     glm::vec2 acceleration(-0.5f, -0.2f);
     TestObjectInfo objectInfo(123, "test-string");
-    Aabb a(position, size, velocity, acceleration,
+    Aabb a = Add(position, size, velocity, acceleration,
         DoNothingCollisionHandler, objectInfo);
 
     EXPECT_EQ(a.LeftXMin(), position.x);
@@ -77,7 +86,7 @@ TEST_F(AabbTests, Constructor_GivenConstructedWithXMinMaxYMinMax_VerifyAllProper
     glm::vec2 velocity(1.0f, 2.0f);
     glm::vec2 acceleration(-0.5f, -0.2f);
     TestObjectInfo objectInfo(123, "test-string");
-    Aabb a(leftXMin, rightXMax, bottomYMin, topYMax,
+    Aabb a = Add(leftXMin, rightXMax, bottomYMin, topYMax,
         velocity, acceleration, DoNothingCollisionHandler, objectInfo);
 
     EXPECT_EQ(a.LeftXMin(), leftXMin);
@@ -108,9 +117,9 @@ TEST_F(AabbTests, Constructors_GivenEquivalentObjectsMadeWithDifferentConstructo
     float topYMax = 11.0f;
     glm::vec2 velocity(1.0f, 2.0f);
     glm::vec2 acceleration(-0.5f, -0.2f);
-    Aabb a(leftXMin, rightXMax, bottomYMin, topYMax,
+    Aabb a = Add(leftXMin, rightXMax, bottomYMin, topYMax,
         velocity, acceleration, DoNothingCollisionHandler, TestObjectInfo());
-    Aabb b(
+    Aabb b = Add(
         glm::vec2(leftXMin, bottomYMin),
         glm::vec2(rightXMax - leftXMin, topYMax - bottomYMin),
         velocity,
@@ -135,8 +144,8 @@ TEST_F(AabbTests, Constructors_GivenEquivalentObjectsMadeWithDifferentConstructo
 TEST_F(AabbTests, IsColliding_XOverlapYNoOverlap_ReturnsFalse)
 {
     // Use leftXMin, rightXMax, bottomYMin, topYMax constructor
-    Aabb a(50.0f, 100.0f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
-    Aabb b(99.9f, 150.0f, 9.0f, 9.9f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb a = Add(50.0f, 100.0f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb b = Add(99.9f, 150.0f, 9.0f, 9.9f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
     EXPECT_FALSE(a.IsColliding(b));
     EXPECT_FALSE(b.IsColliding(a));
 }
@@ -144,8 +153,8 @@ TEST_F(AabbTests, IsColliding_XOverlapYNoOverlap_ReturnsFalse)
 TEST_F(AabbTests, IsColliding_XNoOverlapYOverlap_ReturnsFalse)
 {
     // Use leftXMin, rightXMax, bottomYMin, topYMax constructor
-    Aabb a(50.0f, 100.0f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
-    Aabb b(100.1f, 150.0f, 9.0f, 10.1f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb a = Add(50.0f, 100.0f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb b = Add(100.1f, 150.0f, 9.0f, 10.1f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
     EXPECT_FALSE(a.IsColliding(b));
     EXPECT_FALSE(b.IsColliding(a));
 }
@@ -153,8 +162,8 @@ TEST_F(AabbTests, IsColliding_XNoOverlapYOverlap_ReturnsFalse)
 TEST_F(AabbTests, IsColliding_XTouchingYOverlap_ReturnsTrue)
 {
     // Use leftXMin, rightXMax, bottomYMin, topYMax constructor
-    Aabb a(50.0f, 100.0f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
-    Aabb b(100.0f, 150.0f, 9.0f, 10.1f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb a = Add(50.0f, 100.0f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb b = Add(100.0f, 150.0f, 9.0f, 10.1f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
     EXPECT_TRUE(a.IsColliding(b));
     EXPECT_TRUE(b.IsColliding(a));
 }
@@ -162,8 +171,8 @@ TEST_F(AabbTests, IsColliding_XTouchingYOverlap_ReturnsTrue)
 TEST_F(AabbTests, IsColliding_XOverlapYTouching_ReturnsTrue)
 {
     // Use leftXMin, rightXMax, bottomYMin, topYMax constructor
-    Aabb a(50.0f, 100.0f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
-    Aabb b(99.9f, 150.0f, 9.0f, 10.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb a = Add(50.0f, 100.0f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb b = Add(99.9f, 150.0f, 9.0f, 10.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
     EXPECT_TRUE(a.IsColliding(b));
     EXPECT_TRUE(b.IsColliding(a));
 }
@@ -171,8 +180,8 @@ TEST_F(AabbTests, IsColliding_XOverlapYTouching_ReturnsTrue)
 TEST_F(AabbTests, IsColliding_XOverlapYOverlap_ReturnsTrue)
 {
     // Use leftXMin, rightXMax, bottomYMin, topYMax constructor
-    Aabb a(50.0f, 100.0f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
-    Aabb b(99.9f, 150.0f, 9.0f, 10.1f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb a = Add(50.0f, 100.0f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb b = Add(99.9f, 150.0f, 9.0f, 10.1f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
     EXPECT_TRUE(a.IsColliding(b));
     EXPECT_TRUE(b.IsColliding(a));
 }
@@ -180,8 +189,8 @@ TEST_F(AabbTests, IsColliding_XOverlapYOverlap_ReturnsTrue)
 TEST_F(AabbTests, IsColliding_ACompletelyInsideB_ReturnsTrue)
 {
     // Use leftXMin, rightXMax, bottomYMin, topYMax constructor
-    Aabb a(75.0f, 80.0f, 60.0f, 65.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
-    Aabb b(60.0f, 90.0f, 30.0f, 70.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb a = Add(75.0f, 80.0f, 60.0f, 65.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb b = Add(60.0f, 90.0f, 30.0f, 70.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
     EXPECT_TRUE(a.IsColliding(b));
     EXPECT_TRUE(b.IsColliding(a));
 }
@@ -189,8 +198,8 @@ TEST_F(AabbTests, IsColliding_ACompletelyInsideB_ReturnsTrue)
 TEST_F(AabbTests, IsColliding_XOverlapYAligned_ReturnsTrue)
 {
     // Use leftXMin, rightXMax, bottomYMin, topYMax constructor
-    Aabb a(50.0f, 100.0f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
-    Aabb b(0.0f, 150.1f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb a = Add(50.0f, 100.0f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb b = Add(0.0f, 150.1f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
     EXPECT_TRUE(a.IsColliding(b));
     EXPECT_TRUE(b.IsColliding(a));
 }
@@ -198,8 +207,8 @@ TEST_F(AabbTests, IsColliding_XOverlapYAligned_ReturnsTrue)
 TEST_F(AabbTests, IsColliding_XAlignedYOverlap_ReturnsTrue)
 {
     // Use leftXMin, rightXMax, bottomYMin, topYMax constructor
-    Aabb a(50.0f, 100.0f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
-    Aabb b(50.0f, 100.0f, 10.9, 12.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb a = Add(50.0f, 100.0f, 10.0f, 11.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
+    Aabb b = Add(50.0f, 100.0f, 10.9, 12.0f, glm::vec2(), glm::vec2(), DoNothingCollisionHandler, TestObjectInfo());
     EXPECT_TRUE(a.IsColliding(b));
     EXPECT_TRUE(b.IsColliding(a));
 }
@@ -207,7 +216,7 @@ TEST_F(AabbTests, IsColliding_XAlignedYOverlap_ReturnsTrue)
 TEST_F(AabbTests, ObjectInfoAs_GivenCalledWithWrongType_ThrowsBadAnyCast)
 {
     TestObjectInfo objectInfo(123, "test-string");
-    Aabb a(glm::vec2(50.0f, 25.0f), glm::vec2(5.0f, 10.0f), glm::vec2(), glm::vec2(), DoNothingCollisionHandler, objectInfo);
+    Aabb a = Add(glm::vec2(50.0f, 25.0f), glm::vec2(5.0f, 10.0f), glm::vec2(), glm::vec2(), DoNothingCollisionHandler, objectInfo);
 
     ASSERT_THROW(
         a.ObjectInfoAs<std::string>(),
@@ -218,7 +227,7 @@ TEST_F(AabbTests, ObjectInfoAs_GivenCalledWithWrongType_ThrowsBadAnyCast)
 TEST_F(AabbTests, ObjectInfoAs_GivenConstReference_ReturnsExpectedInfo)
 {
     TestObjectInfo objectInfo(123, "test-string");
-    Aabb a(glm::vec2(50.0f, 25.0f), glm::vec2(5.0f, 10.0f), glm::vec2(), glm::vec2(), DoNothingCollisionHandler, objectInfo);
+    Aabb a = Add(glm::vec2(50.0f, 25.0f), glm::vec2(5.0f, 10.0f), glm::vec2(), glm::vec2(), DoNothingCollisionHandler, objectInfo);
 
     const Aabb& constRefA = a;
 
@@ -231,7 +240,7 @@ TEST_F(AabbTests, ObjectInfoAs_GivenConstReference_ReturnsExpectedInfo)
 TEST_F(AabbTests, ObjectInfoAs_GivenModifiedViaReference_ConstObjectInfoAsReflectsChanges)
 {
     TestObjectInfo objectInfo(123, "test-string");
-    Aabb a(glm::vec2(50.0f, 25.0f), glm::vec2(5.0f, 10.0f), glm::vec2(), glm::vec2(), DoNothingCollisionHandler, objectInfo);
+    Aabb a = Add(glm::vec2(50.0f, 25.0f), glm::vec2(5.0f, 10.0f), glm::vec2(), glm::vec2(), DoNothingCollisionHandler, objectInfo);
     const Aabb& constRefA = a;
 
     // modify one value via non-const ObjectInfoAs
@@ -246,7 +255,7 @@ TEST_F(AabbTests, ObjectInfoAs_GivenModifiedViaReference_ConstObjectInfoAsReflec
 TEST_F(AabbTests, Position_GivenNewPositionSet_OldPositionSavedInPreviousPosition)
 {
     glm::vec2 initialPosition(50.0f, 25.0f);
-    Aabb a(initialPosition, glm::vec2(5.0f, 10.0f), glm::vec2(), glm::vec2(), DoNothingCollisionHandler, nullptr);
+    Aabb a = Add(initialPosition, glm::vec2(5.0f, 10.0f), glm::vec2(), glm::vec2(), DoNothingCollisionHandler, nullptr);
 
     glm::vec2 newPosition1(51.0f, 26.0f);
     a.Position(newPosition1);
@@ -259,3 +268,30 @@ TEST_F(AabbTests, Position_GivenNewPositionSet_OldPositionSavedInPreviousPositio
 
     EXPECT_EQ(newPosition2, a.Position());
 }
+
+TEST_F(AabbTests, PreStepState_GivenWritesWhilePreserving_ReturnsValuesFromBeforeFirstWrite)
+{
+    TestObjectInfo objectInfo(123, "test-string");
+    Aabb a = Add(glm::vec2(50.0f, 25.0f), glm::vec2(5.0f, 10.0f), glm::vec2(1.0f, 2.0f), glm::vec2(), DoNothingCollisionHandler, objectInfo);
+    a.UserData(7);
+
+    _storage.BeginPreservingPreStepState();
+    a.Position(glm::vec2(0.0f, 0.0f));
+    a.Velocity(glm::vec2(3.0f, 4.0f));
+    a.UserData(8);
+    a.ObjectInfoAs<TestObjectInfo>().s = "modified";
+
+    EXPECT_EQ(_storage.PreStepBounds(0).minX, 50.0f);
+    EXPECT_EQ(_storage.PreStepBounds(0).maxY, 35.0f);
+    EXPECT_EQ(_storage.PreStepVelocity(0), glm::vec2(1.0f, 2.0f));
+    EXPECT_EQ(_storage.PreStepUserData(0), 7u);
+    EXPECT_EQ(std::any_cast<const TestObjectInfo&>(_storage.PreStepObjectInfo(0)).s, "test-string");
+    EXPECT_EQ(a.Position(), glm::vec2(0.0f, 0.0f));
+    EXPECT_EQ(a.UserData(), 8u);
+
+    _storage.EndPreservingPreStepState();
+
+    EXPECT_EQ(_storage.PreStepBounds(0).minX, 0.0f);
+    EXPECT_EQ(_storage.PreStepUserData(0), 8u);
+    EXPECT_EQ(std::any_cast<const TestObjectInfo&>(_storage.PreStepObjectInfo(0)).s, "modified");
+}
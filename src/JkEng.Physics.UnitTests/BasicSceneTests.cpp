@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <JkEng/Physics/BasicScene.h>
+#include <JkEng/Physics/CollisionHandlerPolicies.h>
+#include <JkEng/Physics/Engine.h>
+
+using namespace testing;
+using namespace JkEng;
+using namespace JkEng::Physics;
+
+namespace
+{
+    // Each collision as the user data of the body and the id of the body
+    // it hit.
+    typedef std::vector<std::pair<uint64_t, uint32_t>> Collisions;
+
+    struct RecordCollision
+    {
+        Collisions* collisions;
+
+        void operator()(IMovableAabb2d& body, const ReadOnlyAabb2dView& otherBody) const
+        {
+            collisions->push_back({ body.UserData(), otherBody.BodyId() });
+        }
+    };
+
+    Collisions functionPointerCollisions;
+
+    void RecordFunctionPointerCollision(IMovableAabb2d& body, const ReadOnlyAabb2dView& otherBody)
+    {
+        functionPointerCollisions.push_back({ body.UserData(), otherBody.BodyId() });
+    }
+}
+
+class BasicSceneTests : public Test
+{
+public:
+    BasicSceneTests()
+    {
+
+    }
+
+protected:
+    Engine _engine;
+
+    // Overlapping bodies whose user data is their body id, and a static
+    // AABB among them.  With recordInto, each body records its collisions
+    // through a collision view handler of its own.
+    static SceneDefinition CreateDefinition(Collisions* recordInto)
+    {
+        std::mt19937 random(8);
+        std::uniform_real_distribution<float> positionDistribution(0.0f, 20.0f);
+        SceneDefinition sceneDefinition;
+        for (uint32_t i = 0; i < 60; i++)
+        {
+            MovableAabb2dDefinition definition(
+                nullptr,
+                glm::vec2(positionDistribution(random), positionDistribution(random)),
+                glm::vec2(2.0f, 2.0f),
+                nullptr,
+                std::any());
+            definition.UserData(i);
+            if (recordInto != nullptr)
+            {
+                definition.CollisionViewHandler([recordInto, i](const ReadOnlyAabb2dView& otherBody)
+                {
+                    recordInto->push_back({ i, otherBody.BodyId() });
+                });
+            }
+            sceneDefinition.AddMovableAabb2d(definition);
+        }
+        sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(glm::vec2(8.0f, 8.0f), glm::vec2(4.0f, 4.0f), std::any()));
+        return sceneDefinition;
+    }
+
+    static Collisions Sorted(Collisions collisions)
+    {
+        std::sort(collisions.begin(), collisions.end());
+        return collisions;
+    }
+};
+
+TEST_F(BasicSceneTests, Update_GivenSceneWideHandlerPolicies_CallsThemForTheSameCollisionsAsBodyHandlers)
+{
+    Collisions expectedCollisions;
+    auto scene = _engine.CreateScene(CreateDefinition(&expectedCollisions));
+    scene->Update(IScene::StepTime);
+    ASSERT_FALSE(expectedCollisions.empty());
+
+    Collisions functorCollisions;
+    BasicScene<SweepAndPruneBroadphase, FunctorHandlers<RecordCollision>> functorScene(
+        CreateDefinition(nullptr),
+        FunctorHandlers<RecordCollision>(RecordCollision{ &functorCollisions }));
+    functorScene.Update(IScene::StepTime);
+
+    functionPointerCollisions.clear();
+    BasicScene<UniformGridBroadphase, FunctionPointerHandlers> functionPointerScene(
+        CreateDefinition(nullptr),
+        FunctionPointerHandlers(&RecordFunctionPointerCollision));
+    functionPointerScene.Update(IScene::StepTime);
+
+    ASSERT_EQ(Sorted(functorCollisions), Sorted(expectedCollisions));
+    ASSERT_EQ(Sorted(functionPointerCollisions), Sorted(expectedCollisions));
+}
+
+TEST_F(BasicSceneTests, Update_GivenFunctorHandlers_FunctorCanWriteTheBody)
+{
+    auto moveAway = [](IMovableAabb2d& body, const ReadOnlyAabb2dView&)
+    {
+        body.Position(glm::vec2(100.0f, 100.0f));
+    };
+    SceneDefinition sceneDefinition;
+    AfterCreatePtr<IMovableAabb2d> body0;
+    AfterCreatePtr<IMovableAabb2d> body1;
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(&body0, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(&body1, glm::vec2(0.5f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    BasicScene<AllPairsBroadphase, FunctorHandlers<decltype(moveAway)>> scene(
+        sceneDefinition,
+        FunctorHandlers<decltype(moveAway)>(moveAway));
+
+    scene.Update(IScene::StepTime);
+
+    // Both sides of a contact are dispatched together, so body 1 is told
+    // about it even though body 0 has already moved away.
+    ASSERT_EQ(body0->Position(), glm::vec2(100.0f, 100.0f));
+    ASSERT_EQ(body1->Position(), glm::vec2(100.0f, 100.0f));
+}
+
+TEST_F(BasicSceneTests, AddBody_GivenBodyHandlerWithSceneWideHandlerPolicy_Throws)
+{
+    SceneDefinition sceneDefinition;
+    BasicScene<IBroadphase, FunctionPointerHandlers> scene(
+        sceneDefinition,
+        FunctionPointerHandlers(&RecordFunctionPointerCollision));
+    MovableAabb2dDefinition withoutHandler(nullptr, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any());
+    MovableAabb2dDefinition withHandler(
+        nullptr, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), [](const IReadOnlyAabb2d&) { }, std::any());
+
+    ASSERT_NO_THROW(scene.AddBody(withoutHandler));
+    ASSERT_THROW(scene.AddBody(withHandler), std::invalid_argument);
+    ASSERT_THROW(FunctionPointerHandlers(nullptr), std::invalid_argument);
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ContactPairCache.h"
+
+using namespace testing;
+using namespace JkEng::Physics;
+
+class ContactPairCacheTests : public Test
+{
+public:
+    ContactPairCacheTests()
+    {
+
+    }
+
+protected:
+    ContactPairCache _cache;
+
+    std::vector<ContactEvent> Update(std::vector<Contact> contacts)
+    {
+        std::vector<ContactEvent> events;
+        _cache.Update(contacts, events);
+        return events;
+    }
+};
+
+TEST_F(ContactPairCacheTests, Update_GivenContactThatStartsStaysAndStops_EmitsBeginPersistEnd)
+{
+    auto firstEvents = Update({ { 1, 2 } });
+    auto secondEvents = Update({ { 1, 2 } });
+    auto thirdEvents = Update({ });
+    auto fourthEvents = Update({ });
+
+    ASSERT_EQ(firstEvents, (std::vector<ContactEvent>{ { { 1, 2 }, ContactEventType::Begin } }));
+    ASSERT_EQ(secondEvents, (std::vector<ContactEvent>{ { { 1, 2 }, ContactEventType::Persist } }));
+    ASSERT_EQ(thirdEvents, (std::vector<ContactEvent>{ { { 1, 2 }, ContactEventType::End } }));
+    ASSERT_TRUE(fourthEvents.empty());
+    ASSERT_EQ(_cache.Count(), 0u);
+}
+
+TEST_F(ContactPairCacheTests, Update_GivenMixOfEvents_EmitsThemInContactOrder)
+{
+    Update({ { 0, 1 }, { 0, 3 }, { 2, 5 } });
+
+    auto events = Update({ { 0, 2 }, { 0, 3 }, { 4, 5 } });
+
+    std::vector<ContactEvent> expected = {
+        { { 0, 1 }, ContactEventType::End },
+        { { 0, 2 }, ContactEventType::Begin },
+        { { 0, 3 }, ContactEventType::Persist },
+        { { 2, 5 }, ContactEventType::End },
+        { { 4, 5 }, ContactEventType::Begin } };
+    ASSERT_EQ(events, expected);
+}
+
+TEST_F(ContactPairCacheTests, Update_GivenRandomContactsOverManySteps_MatchesSetBasedReference)
+{
+    // Enough contacts coming and going to force rehashing and many
+    // removals from the middle of probe runs.
+    std::mt19937 random(777);
+    std::uniform_int_distribution<uint32_t> bodyDistribution(0, 200);
+    std::set<Contact> previous;
+    for (int step = 0; step < 200; step++)
+    {
+        std::set<Contact> current;
+        int contactCount = static_cast<int>(bodyDistribution(random)) * 5;
+        for (int i = 0; i < contactCount; i++)
+        {
+            uint32_t bodyA = bodyDistribution(random);
+            uint32_t bodyB = bodyDistribution(random);
+            if (bodyA != bodyB)
+            {
+                current.insert({ std::min(bodyA, bodyB), std::max(bodyA, bodyB) });
+            }
+        }
+        // Keep about half of the last step's contacts so most steps have
+        // every kind of event.
+        for (auto& contact : previous)
+        {
+            if (bodyDistribution(random) % 2 == 0)
+            {
+                current.insert(contact);
+            }
+        }
+
+        std::vector<ContactEvent> expected;
+        for (auto& contact : current)
+        {
+            expected.push_back({ contact, previous.contains(contact) ? ContactEventType::Persist : ContactEventType::Begin });
+        }
+        for (auto& contact : previous)
+        {
+            if (!current.contains(contact))
+            {
+                expected.push_back({ contact, ContactEventType::End });
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+
+        ASSERT_EQ(Update(std::vector<Contact>(current.begin(), current.end())), expected) << "step " << step;
+        ASSERT_EQ(_cache.Count(), current.size());
+        for (auto& contact : current)
+        {
+            ASSERT_TRUE(_cache.Contains(contact));
+        }
+        previous = std::move(current);
+    }
+}
+
+TEST_F(ContactPairCacheTests, RemoveBodies_GivenBodiesWithContacts_ForgetsTheirContactsWithoutEndEvents)
+{
+    Update({ { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 4 } });
+
+    std::vector<uint32_t> removedBodyIds = { 1, 4 };
+    _cache.RemoveBodies(removedBodyIds);
+    auto events = Update({ { 1, 2 }, { 2, 3 } });
+
+    std::vector<ContactEvent> expected = {
+        { { 1, 2 }, ContactEventType::Begin },
+        { { 2, 3 }, ContactEventType::Persist } };
+    ASSERT_EQ(events, expected);
+    ASSERT_EQ(_cache.Count(), 2u);
+}
+
+TEST_F(ContactPairCacheTests, Freeze_GivenFrozenContactMissingFromUpdates_EmitsNothingUntilThawed)
+{
+    Update({ { 0, 1 }, { 2, 3 } });
+
+    std::vector<Contact> frozen = { { 0, 1 } };
+    _cache.Freeze(frozen);
+    auto frozenEvents = Update({ { 2, 3 } });
+    _cache.Thaw(frozen);
+    auto thawedEvents = Update({ { 2, 3 } });
+
+    std::vector<ContactEvent> expectedFrozenEvents = { { { 2, 3 }, ContactEventType::Persist } };
+    std::vector<ContactEvent> expectedThawedEvents = {
+        { { 0, 1 }, ContactEventType::End },
+        { { 2, 3 }, ContactEventType::Persist } };
+    ASSERT_EQ(frozenEvents, expectedFrozenEvents);
+    ASSERT_EQ(thawedEvents, expectedThawedEvents);
+}
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "DynamicAabbTree.h"
+
+using namespace testing;
+using namespace JkEng::Physics;
+
+class DynamicAabbTreeTests : public Test
+{
+public:
+    DynamicAabbTreeTests()
+    {
+
+    }
+
+protected:
+    std::vector<Bounds> _bounds;
+
+    void AddRandomBounds(int count)
+    {
+        std::mt19937 random(2468);
+        std::uniform_real_distribution<float> positionDistribution(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> sizeDistribution(0.5f, 20.0f);
+        for (int i = 0; i < count; i++)
+        {
+            float x = positionDistribution(random);
+            float y = positionDistribution(random);
+            _bounds.push_back({ x, y, x + sizeDistribution(random), y + sizeDistribution(random) });
+        }
+    }
+
+    static std::vector<std::pair<uint32_t, uint32_t>> TreePairs(DynamicAabbTree& tree)
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+        tree.ForEachOverlappingPair(
+            [&](uint32_t index0, uint32_t index1)
+            {
+                pairs.emplace_back(std::min(index0, index1), std::max(index0, index1));
+            });
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t>> BruteForcePairs(const std::vector<bool>& inTree) const
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+        for (uint32_t i = 0; i < _bounds.size(); i++)
+        {
+            for (uint32_t j = i + 1; j < _bounds.size(); j++)
+            {
+                if (inTree[i] && inTree[j] && _bounds[i].Overlaps(_bounds[j]))
+                {
+                    pairs.emplace_back(i, j);
+                }
+            }
+        }
+        return pairs;
+    }
+};
+
+TEST_F(DynamicAabbTreeTests, ForEachOverlappingPair_GivenEmptyTree_DoesNotCallCallback)
+{
+    DynamicAabbTree tree;
+    ASSERT_TRUE(TreePairs(tree).empty());
+}
+
+TEST_F(DynamicAabbTreeTests, ForEachOverlappingPair_GivenLeavesInsertedAndRemoved_ReportsEachOverlappingPairOnce)
+{
+    AddRandomBounds(200);
+    DynamicAabbTree tree;
+    std::vector<int32_t> leaves;
+    for (uint32_t i = 0; i < _bounds.size(); i++)
+    {
+        leaves.push_back(tree.Insert(_bounds[i], i));
+    }
+
+    // Remove every third leaf so the tree has to rebalance.
+    std::vector<bool> inTree(_bounds.size(), true);
+    for (uint32_t i = 0; i < _bounds.size(); i += 3)
+    {
+        tree.Remove(leaves[i]);
+        inTree[i] = false;
+    }
+
+    auto expectedPairs = BruteForcePairs(inTree);
+    ASSERT_FALSE(expectedPairs.empty());
+    ASSERT_EQ(TreePairs(tree), expectedPairs);
+}
+
+TEST_F(DynamicAabbTreeTests, ForEachOverlappingPair_GivenLeavesMovedThenRefitOrRebuilt_ReportsSamePairsAsBruteForce)
+{
+    AddRandomBounds(200);
+    DynamicAabbTree tree;
+    std::vector<int32_t> leaves;
+    for (uint32_t i = 0; i < _bounds.size(); i++)
+    {
+        leaves.push_back(tree.Insert(_bounds[i], i));
+    }
+    std::vector<bool> inTree(_bounds.size(), true);
+
+    for (uint32_t i = 0; i < _bounds.size(); i++)
+    {
+        _bounds[i] = { _bounds[i].minX + 7.0f, _bounds[i].minY, _bounds[i].maxX + 9.0f, _bounds[i].maxY };
+        tree.SetLeafBounds(leaves[i], _bounds[i]);
+    }
+    tree.Refit();
+    ASSERT_EQ(TreePairs(tree), BruteForcePairs(inTree));
+
+    float costBeforeRebuild = tree.Cost();
+    tree.Rebuild();
+    ASSERT_EQ(TreePairs(tree), BruteForcePairs(inTree));
+    ASSERT_LE(tree.Cost(), costBeforeRebuild * 1.5f);
+}
+
+TEST_F(DynamicAabbTreeTests, Reinsert_GivenNewBounds_LeafIsReportedAtNewBounds)
+{
+    DynamicAabbTree tree;
+    int32_t leaf0 = tree.Insert({ 0.0f, 0.0f, 1.0f, 1.0f }, 0);
+    tree.Insert({ 10.0f, 10.0f, 11.0f, 11.0f }, 1);
+    tree.Insert({ 20.0f, 20.0f, 21.0f, 21.0f }, 2);
+    ASSERT_TRUE(TreePairs(tree).empty());
+
+    tree.Reinsert(leaf0, { 10.5f, 10.5f, 12.0f, 12.0f });
+
+    auto pairs = TreePairs(tree);
+    ASSERT_EQ(pairs.size(), 1u);
+    EXPECT_EQ(pairs[0], std::make_pair(0u, 1u));
+}
+
+TEST_F(DynamicAabbTreeTests, ForEachLeafClosestFirst_GivenNearestSearch_FindsNearestLeafAndSkipsFarOnes)
+{
+    AddRandomBounds(200);
+    DynamicAabbTree tree;
+    for (uint32_t i = 0; i < _bounds.size(); i++)
+    {
+        tree.Insert(_bounds[i], i);
+    }
+    tree.Rebuild();
+
+    std::mt19937 random(1357);
+    std::uniform_real_distribution<float> positionDistribution(-120.0f, 120.0f);
+    std::vector<int32_t> stack;
+    for (int query = 0; query < 50; query++)
+    {
+        float x = positionDistribution(random);
+        float y = positionDistribution(random);
+        auto distance = [&](const Bounds& bounds) { return bounds.DistanceSquaredTo(x, y); };
+
+        float nearest = std::numeric_limits<float>::infinity();
+        uint32_t visitedCount = 0;
+        tree.ForEachLeafClosestFirst(
+            [&](const Bounds& bounds) { return distance(bounds) < nearest; },
+            distance,
+            stack,
+            [&](uint32_t userIndex)
+            {
+                nearest = std::min(nearest, distance(_bounds[userIndex]));
+                visitedCount++;
+            });
+
+        float expectedNearest = std::numeric_limits<float>::infinity();
+        for (auto& bounds : _bounds)
+        {
+            expectedNearest = std::min(expectedNearest, distance(bounds));
+        }
+        ASSERT_EQ(nearest, expectedNearest) << "Query " << query;
+        ASSERT_LT(visitedCount, _bounds.size() / 4) << "Query " << query;
+    }
+}
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Aabb.h"
+#include "AllPairsBroadphase.h"
+#include "DynamicTreeBroadphase.h"
+#include "WorkerPool.h"
+
+using namespace testing;
+using namespace JkEng::Physics;
+
+class DynamicTreeBroadphaseTests : public Test
+{
+public:
+    DynamicTreeBroadphaseTests()
+    {
+
+    }
+
+protected:
+    AabbStorage _aabbs;
+
+    static std::vector<OverlappingPair> FindSortedPairs(IBroadphase& broadphase, const AabbStorage& aabbs)
+    {
+        std::vector<OverlappingPair> pairs;
+        broadphase.FindOverlappingPairs(aabbs, pairs);
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+    static std::vector<OverlappingPair> FindSortedPairs(IBroadphase& broadphase, const AabbStorage& aabbs, WorkerPool& workers)
+    {
+        std::vector<std::vector<OverlappingPair>> pairsPerWorker(workers.WorkerCount());
+        broadphase.FindOverlappingPairs(aabbs, workers, pairsPerWorker);
+
+        std::vector<OverlappingPair> pairs;
+        for (auto& workerPairs : pairsPerWorker)
+        {
+            pairs.insert(pairs.end(), workerPairs.begin(), workerPairs.end());
+        }
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+};
+
+TEST_F(DynamicTreeBroadphaseTests, FindOverlappingPairs_GivenMixedSizesMovingSlowlyAndQuickly_ReportsSamePairsAsAllPairs)
+{
+    std::mt19937 random(1357);
+    std::uniform_real_distribution<float> positionDistribution(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> smallSizeDistribution(0.5f, 4.0f);
+    for (int i = 0; i < 400; i++)
+    {
+        // Every 50th AABB is much larger than the rest.
+        float scale = i % 50 == 0 ? 30.0f : 1.0f;
+        _aabbs.Add(
+            glm::vec2(positionDistribution(random), positionDistribution(random)),
+            glm::vec2(smallSizeDistribution(random), smallSizeDistribution(random)) * scale,
+            glm::vec2(), glm::vec2(), nullptr, std::any());
+    }
+
+    AllPairsBroadphase allPairs;
+    DynamicTreeBroadphase tree(1.0f);
+
+    // Small moves mostly stay inside the margin, medium moves re-insert a
+    // few leaves and large moves refit or rebuild the whole tree.
+    for (float maxMove : { 0.2f, 0.2f, 2.0f, 25.0f, 0.5f, 60.0f })
+    {
+        std::uniform_real_distribution<float> moveDistribution(-maxMove, maxMove);
+        for (uint32_t i = 0; i < _aabbs.Count(); i += (maxMove < 1.0f ? 1 : 7))
+        {
+            Aabb aabb(_aabbs, i);
+            aabb.Position(aabb.Position() + glm::vec2(moveDistribution(random), moveDistribution(random)));
+        }
+
+        ASSERT_EQ(FindSortedPairs(tree, _aabbs), FindSortedPairs(allPairs, _aabbs));
+    }
+}
+
+TEST_F(DynamicTreeBroadphaseTests, FindOverlappingPairs_GivenWorkerPoolAndMovingAabbs_ReportsSamePairsAsAllPairs)
+{
+    std::mt19937 random(8642);
+    std::uniform_real_distribution<float> positionDistribution(-300.0f, 300.0f);
+    std::uniform_real_distribution<float> sizeDistribution(0.5f, 6.0f);
+    for (int i = 0; i < 1500; i++)
+    {
+        _aabbs.Add(
+            glm::vec2(positionDistribution(random), positionDistribution(random)),
+            glm::vec2(sizeDistribution(random), sizeDistribution(random)),
+            glm::vec2(), glm::vec2(), nullptr, std::any());
+    }
+
+    AllPairsBroadphase allPairs;
+    DynamicTreeBroadphase tree(1.0f);
+    WorkerPool workers(4);
+
+    for (float maxMove : { 0.0f, 0.5f, 5.0f, 40.0f })
+    {
+        std::uniform_real_distribution<float> moveDistribution(-maxMove, maxMove);
+        for (uint32_t i = 0; i < _aabbs.Count(); i++)
+        {
+            Aabb aabb(_aabbs, i);
+            aabb.Position(aabb.Position() + glm::vec2(moveDistribution(random), moveDistribution(random)));
+        }
+
+        ASSERT_EQ(FindSortedPairs(tree, _aabbs, workers), FindSortedPairs(allPairs, _aabbs));
+    }
+}
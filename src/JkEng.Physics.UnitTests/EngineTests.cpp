@@ -1,7 +1,22 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include <JkEng/Physics/Engine.h>
 
+#include "Bounds.h"
+
 using namespace testing;
 using namespace JkEng;
 using namespace JkEng::Physics;
@@ -535,3 +550,2099 @@ TEST_F(EngineTests, Update_Given3UpdatesWithDeltaTimeOverStepTime_SceneNotSimula
     // Assert
     EXPECT_FLOAT_EQ(scene->TimeNotYetSimulated(), 0.3 * IScene::StepTime);
 }
+
+TEST_F(EngineTests, Update_GivenEachBroadphase_CollisionHandlersAreCalledInSameOrderAsAllPairs)
+{
+    auto runScene = [this](BroadphaseType broadphase)
+    {
+        std::vector<std::pair<int, int>> calls;
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(broadphase);
+        sceneDefinition.GridCellSize(4.0f);
+
+        // A row of AABBs where each overlaps its neighbours plus one
+        // large AABB overlapping all of them.
+        for (int i = 0; i < 10; i++)
+        {
+            sceneDefinition.AddMovableAabb2d(
+                MovableAabb2dDefinition(
+                    nullptr,
+                    glm::vec2(i * 3.0f, 0.0f),
+                    glm::vec2(5.0f, 10.0f),
+                    [&calls, i](const IReadOnlyAabb2d& other)
+                    {
+                        calls.emplace_back(i, other.ObjectInfoAs<int>());
+                    },
+                    std::any(i)
+                )
+            );
+        }
+        sceneDefinition.AddMovableAabb2d(
+            MovableAabb2dDefinition(
+                nullptr,
+                glm::vec2(-1.0f, -1.0f),
+                glm::vec2(40.0f, 40.0f),
+                [&calls](const IReadOnlyAabb2d& other)
+                {
+                    calls.emplace_back(10, other.ObjectInfoAs<int>());
+                },
+                std::any(10)
+            )
+        );
+
+        auto scene = _engine.CreateScene(sceneDefinition);
+        scene->Update(IScene::StepTime);
+        return calls;
+    };
+
+    auto allPairsCalls = runScene(BroadphaseType::AllPairs);
+
+    ASSERT_EQ(allPairsCalls.size(), 2u * (9u + 10u));
+    ASSERT_EQ(runScene(BroadphaseType::UniformGrid), allPairsCalls);
+    ASSERT_EQ(runScene(BroadphaseType::SweepAndPrune), allPairsCalls);
+    ASSERT_EQ(runScene(BroadphaseType::DynamicTree), allPairsCalls);
+}
+
+TEST_F(EngineTests, Update_GivenEachBroadphaseAndThreadCount_CollisionHandlersAreCalledInSameOrderAsSingleThreaded)
+{
+    auto runScene = [this](BroadphaseType broadphase, uint32_t threadCount)
+    {
+        std::vector<std::pair<int, int>> calls;
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(broadphase);
+        sceneDefinition.ThreadCount(threadCount);
+
+        // A grid of AABBs where each overlaps its neighbours, large enough
+        // that the work is split into several tasks.
+        int index = 0;
+        for (int y = 0; y < 40; y++)
+        {
+            for (int x = 0; x < 40; x++)
+            {
+                sceneDefinition.AddMovableAabb2d(
+                    MovableAabb2dDefinition(
+                        nullptr,
+                        glm::vec2(x * 3.0f, y * 3.0f),
+                        glm::vec2(4.0f, 4.0f),
+                        [&calls, index](const IReadOnlyAabb2d& other)
+                        {
+                            calls.emplace_back(index, other.ObjectInfoAs<int>());
+                        },
+                        std::any(index)
+                    )
+                );
+                index++;
+            }
+        }
+
+        auto scene = _engine.CreateScene(sceneDefinition);
+        scene->Update(IScene::StepTime);
+        return calls;
+    };
+
+    for (auto broadphase : {
+        BroadphaseType::AllPairs,
+        BroadphaseType::UniformGrid,
+        BroadphaseType::SweepAndPrune,
+        BroadphaseType::DynamicTree })
+    {
+        auto singleThreadedCalls = runScene(broadphase, 1);
+
+        ASSERT_FALSE(singleThreadedCalls.empty());
+        ASSERT_EQ(runScene(broadphase, 2), singleThreadedCalls);
+        ASSERT_EQ(runScene(broadphase, 4), singleThreadedCalls);
+    }
+}
+
+TEST_F(EngineTests, Update_GivenContactsHandler_ReceivesSortedContactsOncePerStepInsteadOfCollisionHandlers)
+{
+    SceneDefinition sceneDefinition;
+    bool collisionHandlerWasCalled = false;
+    auto collisionHandler = [&](const IReadOnlyAabb2d&) { collisionHandlerWasCalled = true; };
+
+    // Body 1 overlaps bodies 0 and 2, body 3 overlaps nothing.
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(0.0f, 0.0f), glm::vec2(2.0f, 2.0f), collisionHandler, std::any()));
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(1.0f, 0.0f), glm::vec2(2.0f, 2.0f), collisionHandler, std::any()));
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(2.5f, 0.0f), glm::vec2(2.0f, 2.0f), collisionHandler, std::any()));
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(50.0f, 0.0f), glm::vec2(2.0f, 2.0f), collisionHandler, std::any()));
+
+    std::vector<std::vector<Contact>> contactsPerCall;
+    sceneDefinition.ContactsHandler([&](std::span<const Contact> contacts)
+    {
+        contactsPerCall.emplace_back(contacts.begin(), contacts.end());
+    });
+
+    auto scene = _engine.CreateScene(sceneDefinition);
+    scene->Update(IScene::StepTime * 2.0f);
+
+    std::vector<Contact> expectedContacts = { { 0, 1 }, { 1, 2 } };
+    ASSERT_EQ(contactsPerCall.size(), 2u);
+    EXPECT_EQ(contactsPerCall[0], expectedContacts);
+    EXPECT_EQ(contactsPerCall[1], expectedContacts);
+    EXPECT_FALSE(collisionHandlerWasCalled);
+}
+
+TEST_F(EngineTests, Update_GivenAabbMovingThroughAnother_ContactEventHandlersReceiveBeginPersistAndEnd)
+{
+    std::vector<ContactEventType> moverEvents;
+    std::vector<ContactEventType> wallEvents;
+
+    AfterCreatePtr<IMovableAabb2d> moverPtr;
+    MovableAabb2dDefinition mover(&moverPtr, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any());
+    mover.ContactEventHandler([&](ContactEventType type, const IReadOnlyAabb2d&) { moverEvents.push_back(type); });
+
+    // The wall only wants to know when contacts start and stop.
+    MovableAabb2dDefinition wall(nullptr, glm::vec2(2.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any());
+    wall.ContactEventHandler([&](ContactEventType type, const IReadOnlyAabb2d&) { wallEvents.push_back(type); }, false);
+
+    SceneDefinition sceneDefinition;
+    sceneDefinition.AddMovableAabb2d(mover);
+    sceneDefinition.AddMovableAabb2d(wall);
+    auto scene = _engine.CreateScene(sceneDefinition);
+
+    // One unit per step, so the mover touches the wall after steps 1, 2
+    // and 3.
+    moverPtr->Velocity(glm::vec2(1.0f / IScene::StepTime, 0.0f));
+    for (int step = 0; step < 5; step++)
+    {
+        scene->Update(IScene::StepTime);
+    }
+
+    std::vector<ContactEventType> expectedMoverEvents = {
+        ContactEventType::Begin, ContactEventType::Persist, ContactEventType::Persist, ContactEventType::End };
+    std::vector<ContactEventType> expectedWallEvents = { ContactEventType::Begin, ContactEventType::End };
+    ASSERT_EQ(moverEvents, expectedMoverEvents);
+    ASSERT_EQ(wallEvents, expectedWallEvents);
+}
+
+TEST_F(EngineTests, Update_GivenContactEventsHandler_ReceivesEventsForEveryStep)
+{
+    SceneDefinition sceneDefinition;
+    AfterCreatePtr<IMovableAabb2d> aabb0;
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(&aabb0, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(0.5f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+
+    std::vector<ContactEvent> events;
+    sceneDefinition.ContactEventsHandler([&](std::span<const ContactEvent> stepEvents)
+    {
+        events.insert(events.end(), stepEvents.begin(), stepEvents.end());
+    });
+
+    auto scene = _engine.CreateScene(sceneDefinition);
+    scene->Update(IScene::StepTime * 2.0f);
+    aabb0->Position(glm::vec2(10.0f, 0.0f));
+    scene->Update(IScene::StepTime);
+
+    std::vector<ContactEvent> expected = {
+        { { 0, 1 }, ContactEventType::Begin },
+        { { 0, 1 }, ContactEventType::Persist },
+        { { 0, 1 }, ContactEventType::End } };
+    ASSERT_EQ(events, expected);
+}
+
+TEST_F(EngineTests, Update_GivenCollisionHandlerChangesItsOwnAabb_LaterHandlersSeeStateFromBeforeTheChange)
+{
+    SceneDefinition sceneDefinition;
+
+    // All three overlap, so body 0's handler runs for the 0-1 pair before
+    // body 2's runs for the 0-2 pair.
+    AfterCreatePtr<IMovableAabb2d> aabb0;
+    MovableAabb2dDefinition definition0(
+        &aabb0,
+        glm::vec2(0.0f, 0.0f),
+        glm::vec2(2.0f, 2.0f),
+        [&](const IReadOnlyAabb2d&)
+        {
+            aabb0->Velocity(glm::vec2(5.0f, 5.0f));
+            aabb0->UserData(8);
+        },
+        std::any());
+    definition0.UserData(7);
+    sceneDefinition.AddMovableAabb2d(definition0);
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(1.0f, 0.0f), glm::vec2(2.0f, 2.0f), nullptr, std::any()));
+
+    std::vector<uint32_t> otherBodyIds;
+    std::vector<uint64_t> otherUserData;
+    std::vector<glm::vec2> otherVelocities;
+    MovableAabb2dDefinition definition2(nullptr, glm::vec2(0.0f, 1.0f), glm::vec2(2.0f, 2.0f), nullptr, std::any());
+    definition2.CollisionViewHandler([&](const ReadOnlyAabb2dView& other)
+    {
+        otherBodyIds.push_back(other.BodyId());
+        otherUserData.push_back(other.UserData());
+        otherVelocities.push_back(other.Velocity());
+    });
+    sceneDefinition.AddMovableAabb2d(definition2);
+
+    auto scene = _engine.CreateScene(sceneDefinition);
+    scene->Update(IScene::StepTime);
+
+    std::vector<uint32_t> expectedBodyIds = { 0, 1 };
+    std::vector<uint64_t> expectedUserData = { 7, 0 };
+    std::vector<glm::vec2> expectedVelocities = { glm::vec2(), glm::vec2() };
+    ASSERT_EQ(otherBodyIds, expectedBodyIds);
+    ASSERT_EQ(otherUserData, expectedUserData);
+    ASSERT_EQ(otherVelocities, expectedVelocities);
+    ASSERT_EQ(aabb0->UserData(), 8u);
+    ASSERT_EQ(aabb0->Velocity(), glm::vec2(5.0f, 5.0f));
+}
+
+TEST_F(EngineTests, Update_GivenStaticAabbs_OnlyPairsWithMovableAabbsAreReportedAfterMovablePairs)
+{
+    for (uint32_t threadCount : { 1u, 4u })
+    {
+        SceneDefinition sceneDefinition;
+        sceneDefinition.ThreadCount(threadCount);
+
+        sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(0.5f, 0.5f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+        sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(1.0f, 1.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+
+        // A row of touching floor tiles, the first two under body 0, and
+        // one more far away from everything.
+        for (int tile = 0; tile < 4; tile++)
+        {
+            sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(glm::vec2(tile * 1.0f, -0.5f), glm::vec2(1.0f, 1.0f), std::any()));
+        }
+        sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(glm::vec2(40.0f, 0.0f), glm::vec2(1.0f, 1.0f), std::any()));
+
+        std::vector<Contact> contacts;
+        sceneDefinition.ContactsHandler([&](std::span<const Contact> stepContacts)
+        {
+            contacts.assign(stepContacts.begin(), stepContacts.end());
+        });
+
+        auto scene = _engine.CreateScene(sceneDefinition);
+        scene->Update(IScene::StepTime);
+
+        // Static bodies are numbered after the two movable ones.
+        std::vector<Contact> expectedContacts = { { 0, 1 }, { 0, 2 }, { 0, 3 } };
+        ASSERT_EQ(contacts, expectedContacts);
+    }
+}
+
+TEST_F(EngineTests, Update_GivenMovableAabbTouchingStaticAabb_CollisionHandlerSeesStaticAabb)
+{
+    SceneDefinition sceneDefinition;
+    std::vector<uint32_t> otherBodyIds;
+    std::vector<uint64_t> otherUserData;
+    MovableAabb2dDefinition movable(nullptr, glm::vec2(0.0f, 0.5f), glm::vec2(1.0f, 1.0f), nullptr, std::any());
+    movable.CollisionViewHandler([&](const ReadOnlyAabb2dView& other)
+    {
+        otherBodyIds.push_back(other.BodyId());
+        otherUserData.push_back(other.UserData());
+    });
+    sceneDefinition.AddMovableAabb2d(movable);
+
+    StaticAabb2dDefinition floor(glm::vec2(-5.0f, 0.0f), glm::vec2(10.0f, 1.0f), std::any());
+    floor.UserData(42);
+    sceneDefinition.AddStaticAabb2d(floor);
+
+    auto scene = _engine.CreateScene(sceneDefinition);
+    scene->Update(IScene::StepTime);
+
+    std::vector<uint32_t> expectedBodyIds = { 1 };
+    std::vector<uint64_t> expectedUserData = { 42 };
+    ASSERT_EQ(otherBodyIds, expectedBodyIds);
+    ASSERT_EQ(otherUserData, expectedUserData);
+}
+
+TEST_F(EngineTests, Update_GivenCollisionFilters_OnlyPairsWhoseFiltersMatchAreReported)
+{
+    const uint32_t playerCategory = 0x1;
+    const uint32_t bulletCategory = 0x2;
+
+    for (auto broadphase : { BroadphaseType::AllPairs, BroadphaseType::UniformGrid, BroadphaseType::SweepAndPrune, BroadphaseType::DynamicTree })
+    {
+        for (bool partition : { false, true })
+        {
+            SceneDefinition sceneDefinition;
+            sceneDefinition.Broadphase(broadphase);
+            sceneDefinition.PartitionBroadphaseByCollisionFilter(partition);
+
+            // Two overlapping bullets on top of a player, and a wall that
+            // bullets pass through.
+            for (int i = 0; i < 2; i++)
+            {
+                MovableAabb2dDefinition bullet(nullptr, glm::vec2(i * 0.5f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any());
+                bullet.CollisionFilter(bulletCategory, ~bulletCategory);
+                sceneDefinition.AddMovableAabb2d(bullet);
+            }
+            MovableAabb2dDefinition player(nullptr, glm::vec2(0.0f, 0.0f), glm::vec2(2.0f, 2.0f), nullptr, std::any());
+            player.CollisionFilter(playerCategory, DefaultCollisionMask);
+            sceneDefinition.AddMovableAabb2d(player);
+            StaticAabb2dDefinition wall(glm::vec2(-1.0f, -1.0f), glm::vec2(4.0f, 1.0f), std::any());
+            wall.CollisionFilter(DefaultCollisionCategory, playerCategory);
+            sceneDefinition.AddStaticAabb2d(wall);
+
+            std::vector<Contact> contacts;
+            sceneDefinition.ContactsHandler([&](std::span<const Contact> stepContacts)
+            {
+                contacts.assign(stepContacts.begin(), stepContacts.end());
+            });
+
+            auto scene = _engine.CreateScene(sceneDefinition);
+            scene->Update(IScene::StepTime);
+
+            std::vector<Contact> expectedContacts = { { 0, 2 }, { 1, 2 }, { 2, 3 } };
+            ASSERT_EQ(contacts, expectedContacts);
+        }
+    }
+}
+
+TEST_F(EngineTests, Update_GivenTileGrid_OnlyBodiesTouchingSolidCellsCollideWithIt)
+{
+    for (auto broadphase : { BroadphaseType::AllPairs, BroadphaseType::DynamicTree })
+    {
+        for (uint32_t threadCount : { 1u, 2u })
+        {
+            // A floor of solid cells with a gap in it, and a wall that a
+            // fast body crosses within one step.
+            SceneDefinition sceneDefinition;
+            sceneDefinition.Broadphase(broadphase);
+            sceneDefinition.ThreadCount(threadCount);
+            TileGridDefinition level(glm::vec2(0.0f, 0.0f), 16, 8, 2.0f, std::string("level"));
+            for (uint32_t column = 0; column < 16; column++)
+            {
+                level.SetSolid(column, 0, column != 4);
+            }
+            level.SetSolid(10, 4);
+            level.UserData(99);
+            sceneDefinition.AddTileGrid(level);
+
+            std::vector<const std::string*> objectInfos;
+            auto recordObjectInfo = [&](const IReadOnlyAabb2d& other)
+            {
+                objectInfos.push_back(&other.ObjectInfoAs<std::string>());
+            };
+            sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(1.0f, 1.5f), glm::vec2(1.0f, 1.0f), recordObjectInfo, std::any()));
+            sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(8.5f, 1.5f), glm::vec2(1.0f, 1.0f), recordObjectInfo, std::any()));
+            sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(6.0f, 6.0f), glm::vec2(1.0f, 1.0f), recordObjectInfo, std::any()));
+            AfterCreatePtr<IMovableAabb2d> bullet;
+            MovableAabb2dDefinition bulletDefinition(&bullet, glm::vec2(24.0f, 8.5f), glm::vec2(0.5f, 0.5f), recordObjectInfo, std::any());
+            bulletDefinition.IsFast(true);
+            sceneDefinition.AddMovableAabb2d(bulletDefinition);
+
+            std::vector<Contact> contacts;
+            sceneDefinition.ContactEventsHandler([&](std::span<const ContactEvent> events)
+            {
+                for (auto& event : events)
+                {
+                    contacts.push_back(event.contact);
+                }
+            });
+
+            auto scene = _engine.CreateScene(sceneDefinition);
+            bullet->Velocity(glm::vec2(-8.0f * 60.0f, 0.0f));
+            scene->Update(IScene::StepTime);
+
+            // The first body rests on the floor, the second is over the
+            // gap and the third is in the air.
+            std::vector<Contact> expectedContacts = { { 0, 4 }, { 3, 4 } };
+            ASSERT_EQ(contacts, expectedContacts);
+            ASSERT_EQ(objectInfos.size(), 2u);
+            ASSERT_EQ(*objectInfos[0], "level");
+            ASSERT_TRUE(scene->IsValid(scene->HandleOf(4)));
+            ASSERT_THROW(scene->RemoveBody(scene->HandleOf(4)), std::invalid_argument);
+        }
+    }
+}
+
+TEST_F(EngineTests, SpatialQueries_GivenRandomScene_MatchTestingEveryBody)
+{
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> positionDistribution(0.0f, 100.0f);
+    std::uniform_real_distribution<float> sizeDistribution(0.5f, 6.0f);
+    std::uniform_real_distribution<float> directionDistribution(-60.0f, 60.0f);
+    std::bernoulli_distribution isSolidDistribution(0.05);
+
+    // Bounds of every body by id, with tile grid cells listed separately.
+    const uint32_t movableCount = 200;
+    const uint32_t staticCount = 100;
+    const uint32_t tileGridBodyId = movableCount + staticCount;
+    std::vector<Bounds> bodyBounds;
+    std::vector<uint32_t> bodyCategories;
+    std::vector<Bounds> solidCells;
+
+    SceneDefinition sceneDefinition;
+    for (uint32_t i = 0; i < movableCount + staticCount; i++)
+    {
+        glm::vec2 position(positionDistribution(random), positionDistribution(random));
+        glm::vec2 size(sizeDistribution(random), sizeDistribution(random));
+        uint32_t category = 1u << (i % 3);
+        if (i < movableCount)
+        {
+            MovableAabb2dDefinition definition(nullptr, position, size, nullptr, std::any());
+            definition.CollisionFilter(category, DefaultCollisionMask);
+            sceneDefinition.AddMovableAabb2d(definition);
+        }
+        else
+        {
+            StaticAabb2dDefinition definition(position, size, std::any());
+            definition.CollisionFilter(category, DefaultCollisionMask);
+            sceneDefinition.AddStaticAabb2d(definition);
+        }
+        bodyBounds.push_back({ position.x, position.y, position.x + size.x, position.y + size.y });
+        bodyCategories.push_back(category);
+    }
+
+    TileGridDefinition tileGrid(glm::vec2(20.0f, 30.0f), 40, 20, 2.0f, std::any());
+    for (uint32_t row = 0; row < 20; row++)
+    {
+        for (uint32_t column = 0; column < 40; column++)
+        {
+            if (isSolidDistribution(random))
+            {
+                tileGrid.SetSolid(column, row);
+                float minX = 20.0f + column * 2.0f;
+                float minY = 30.0f + row * 2.0f;
+                solidCells.push_back({ minX, minY, minX + 2.0f, minY + 2.0f });
+            }
+        }
+    }
+    tileGrid.CollisionFilter(0x1, DefaultCollisionMask);
+    sceneDefinition.AddTileGrid(tileGrid);
+    bodyCategories.push_back(0x1);
+
+    auto scene = _engine.CreateScene(sceneDefinition);
+    std::vector<uint32_t> bodyIds(1000);
+    std::vector<RaycastHit> hits(1000);
+    std::vector<NearestBody> nearest(5);
+    for (int i = 0; i < 300; i++)
+    {
+        uint32_t categoryMask = i % 2 == 0 ? DefaultCollisionMask : 0x1 | 0x4;
+        glm::vec2 position(positionDistribution(random), positionDistribution(random));
+        glm::vec2 size(sizeDistribution(random) * 3.0f, sizeDistribution(random) * 3.0f);
+        glm::vec2 direction(directionDistribution(random), directionDistribution(random));
+        Bounds region = { position.x, position.y, position.x + size.x, position.y + size.y };
+        Bounds point = { position.x, position.y, position.x, position.y };
+
+        std::vector<uint32_t> expectedInRegion;
+        std::vector<uint32_t> expectedAtPoint;
+        std::vector<RaycastHit> expectedHits;
+        std::vector<NearestBody> expectedNearest;
+        for (uint32_t bodyId = 0; bodyId <= tileGridBodyId; bodyId++)
+        {
+            if ((bodyCategories[bodyId] & categoryMask) == 0)
+            {
+                continue;
+            }
+
+            bool inRegion = false;
+            bool atPoint = false;
+            bool isHit = false;
+            float fraction = 2.0f;
+            float distanceSquared = std::numeric_limits<float>::infinity();
+            auto& shapes = bodyId == tileGridBodyId ? solidCells : bodyBounds;
+            for (size_t shape = bodyId == tileGridBodyId ? 0 : bodyId; shape < (bodyId == tileGridBodyId ? shapes.size() : bodyId + 1); shape++)
+            {
+                float shapeFraction;
+                inRegion |= shapes[shape].Overlaps(region);
+                atPoint |= shapes[shape].Overlaps(point);
+                if (point.OverlapsWhileMoving(shapes[shape], direction.x, direction.y, shapeFraction))
+                {
+                    isHit = true;
+                    fraction = std::min(fraction, shapeFraction);
+                }
+                distanceSquared = std::min(distanceSquared, shapes[shape].DistanceSquaredTo(position.x, position.y));
+            }
+
+            if (inRegion)
+            {
+                expectedInRegion.push_back(bodyId);
+            }
+            if (atPoint)
+            {
+                expectedAtPoint.push_back(bodyId);
+            }
+            if (isHit)
+            {
+                expectedHits.push_back({ bodyId, fraction });
+            }
+            expectedNearest.push_back({ bodyId, std::sqrt(distanceSquared) });
+        }
+
+        uint32_t count = scene->QueryRegion(position, size, bodyIds, categoryMask);
+        std::vector<uint32_t> inRegion(bodyIds.begin(), bodyIds.begin() + count);
+        std::sort(inRegion.begin(), inRegion.end());
+        ASSERT_EQ(inRegion, expectedInRegion) << "Iteration " << i;
+
+        count = scene->QueryPoint(position, bodyIds, categoryMask);
+        std::vector<uint32_t> atPoint(bodyIds.begin(), bodyIds.begin() + count);
+        std::sort(atPoint.begin(), atPoint.end());
+        ASSERT_EQ(atPoint, expectedAtPoint) << "Iteration " << i;
+
+        auto byFraction = [](const RaycastHit& hit0, const RaycastHit& hit1)
+        {
+            return hit0.fraction != hit1.fraction ? hit0.fraction < hit1.fraction : hit0.bodyId < hit1.bodyId;
+        };
+        std::sort(expectedHits.begin(), expectedHits.end(), byFraction);
+        count = scene->RaycastAll(position, direction, hits, categoryMask);
+        ASSERT_EQ(count, expectedHits.size()) << "Iteration " << i;
+        for (uint32_t hit = 0; hit < count; hit++)
+        {
+            ASSERT_EQ(hits[hit].bodyId, expectedHits[hit].bodyId) << "Iteration " << i;
+            ASSERT_NEAR(hits[hit].fraction, expectedHits[hit].fraction, 0.0001f) << "Iteration " << i;
+        }
+
+        RaycastHit firstHit;
+        ASSERT_EQ(scene->Raycast(position, direction, firstHit, categoryMask), !expectedHits.empty()) << "Iteration " << i;
+        if (!expectedHits.empty())
+        {
+            ASSERT_EQ(firstHit.bodyId, expectedHits[0].bodyId) << "Iteration " << i;
+        }
+
+        std::sort(expectedNearest.begin(), expectedNearest.end(), [](const NearestBody& body0, const NearestBody& body1)
+        {
+            return body0.distance != body1.distance ? body0.distance < body1.distance : body0.bodyId < body1.bodyId;
+        });
+        ASSERT_EQ(scene->NearestK(position, nearest, categoryMask), nearest.size()) << "Iteration " << i;
+        for (size_t body = 0; body < nearest.size(); body++)
+        {
+            ASSERT_EQ(nearest[body].bodyId, expectedNearest[body].bodyId) << "Iteration " << i;
+            ASSERT_NEAR(nearest[body].distance, expectedNearest[body].distance, 0.0001f) << "Iteration " << i;
+        }
+    }
+}
+
+TEST_F(EngineTests, SpatialQueries_GivenBuffersTooSmall_ReturnTotalAndKeepClosest)
+{
+    SceneDefinition sceneDefinition;
+    for (int i = 0; i < 5; i++)
+    {
+        sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(i * 2.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    }
+    auto scene = _engine.CreateScene(sceneDefinition);
+
+    std::vector<uint32_t> bodyIds(2);
+    ASSERT_EQ(scene->QueryRegion(glm::vec2(-1.0f, -1.0f), glm::vec2(20.0f, 3.0f), bodyIds), 5u);
+
+    // Cast from the right so the bodies are hit in descending id order.
+    std::vector<RaycastHit> hits(2);
+    ASSERT_EQ(scene->RaycastAll(glm::vec2(20.0f, 0.5f), glm::vec2(-30.0f, 0.0f), hits), 5u);
+    ASSERT_EQ(hits[0].bodyId, 4u);
+    ASSERT_EQ(hits[1].bodyId, 3u);
+
+    std::vector<NearestBody> nearest(10);
+    ASSERT_EQ(scene->NearestK(glm::vec2(0.5f, 0.5f), nearest), 5u);
+    ASSERT_EQ(nearest[0].bodyId, 0u);
+    ASSERT_EQ(nearest[0].distance, 0.0f);
+    ASSERT_EQ(nearest[4].bodyId, 4u);
+}
+
+TEST_F(EngineTests, SpatialQueries_GivenBodiesChangedBetweenQueries_SeeTheScene)
+{
+    SceneDefinition sceneDefinition;
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(10.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    auto scene = _engine.CreateScene(sceneDefinition);
+    std::vector<uint32_t> bodyIds(4);
+    auto queryAt = [&](glm::vec2 point)
+    {
+        uint32_t count = scene->QueryPoint(point, bodyIds);
+        std::vector<uint32_t> found(bodyIds.begin(), bodyIds.begin() + count);
+        std::sort(found.begin(), found.end());
+        return found;
+    };
+    ASSERT_EQ(queryAt(glm::vec2(0.5f, 0.5f)), std::vector<uint32_t>({ 0 }));
+
+    scene->Body(scene->HandleOf(0))->Position(glm::vec2(20.0f, 0.0f));
+    ASSERT_EQ(queryAt(glm::vec2(0.5f, 0.5f)), std::vector<uint32_t>());
+    ASSERT_EQ(queryAt(glm::vec2(20.5f, 0.5f)), std::vector<uint32_t>({ 0 }));
+
+    scene->Body(scene->HandleOf(1))->Size(glm::vec2(12.0f, 1.0f));
+    ASSERT_EQ(queryAt(glm::vec2(20.5f, 0.5f)), std::vector<uint32_t>({ 0, 1 }));
+
+    BodyHandle added = scene->AddBody(MovableAabb2dDefinition(nullptr, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    ASSERT_EQ(queryAt(glm::vec2(0.5f, 0.5f)), std::vector<uint32_t>({ added.bodyId }));
+
+    // Body 1 is swapped into body 0's index when body 0 is removed.
+    scene->RemoveBody(scene->HandleOf(0));
+    ASSERT_EQ(queryAt(glm::vec2(20.5f, 0.5f)), std::vector<uint32_t>({ 1 }));
+
+    std::vector<glm::vec2> velocities(scene->BodyIdCount());
+    velocities[added.bodyId] = glm::vec2(0.0f, 100.0f / IScene::StepTime);
+    scene->SetVelocities(velocities);
+    ASSERT_EQ(queryAt(glm::vec2(0.5f, 0.5f)), std::vector<uint32_t>({ added.bodyId }));
+    scene->Update(IScene::StepTime);
+    ASSERT_EQ(queryAt(glm::vec2(0.5f, 0.5f)), std::vector<uint32_t>());
+    ASSERT_EQ(queryAt(glm::vec2(0.5f, 100.5f)), std::vector<uint32_t>({ added.bodyId }));
+
+    std::vector<NearestBody> nearest(1);
+    ASSERT_EQ(scene->NearestK(glm::vec2(0.5f, 90.0f), nearest), 1u);
+    ASSERT_EQ(nearest[0].bodyId, added.bodyId);
+    RaycastHit hit;
+    ASSERT_TRUE(scene->Raycast(glm::vec2(0.5f, 50.0f), glm::vec2(0.0f, 100.0f), hit));
+    ASSERT_EQ(hit.bodyId, added.bodyId);
+}
+
+TEST_F(EngineTests, SpatialQueryBatches_GivenAnyThreadCount_MatchSingleQueries)
+{
+    for (uint32_t threadCount : { 1u, 4u })
+    {
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> positionDistribution(0.0f, 200.0f);
+        std::uniform_real_distribution<float> directionDistribution(-50.0f, 50.0f);
+
+        SceneDefinition sceneDefinition;
+        sceneDefinition.ThreadCount(threadCount);
+        for (int i = 0; i < 500; i++)
+        {
+            glm::vec2 position(positionDistribution(random), positionDistribution(random));
+            if (i % 2 == 0)
+            {
+                sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, position, glm::vec2(3.0f, 3.0f), nullptr, std::any()));
+            }
+            else
+            {
+                sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(position, glm::vec2(3.0f, 3.0f), std::any()));
+            }
+        }
+        auto scene = _engine.CreateScene(sceneDefinition);
+
+        std::vector<Ray> rays(1000);
+        std::vector<Region> regions(1000);
+        for (size_t i = 0; i < rays.size(); i++)
+        {
+            rays[i] = { glm::vec2(positionDistribution(random), positionDistribution(random)),
+                glm::vec2(directionDistribution(random), directionDistribution(random)) };
+            regions[i] = { glm::vec2(positionDistribution(random), positionDistribution(random)), glm::vec2(10.0f, 10.0f) };
+        }
+
+        const uint32_t bodyIdsPerRegion = 4;
+        std::vector<RaycastHit> hits(rays.size());
+        std::vector<uint32_t> bodyIds(regions.size() * bodyIdsPerRegion);
+        std::vector<uint32_t> counts(regions.size());
+        uint32_t hitCount = scene->RaycastBatch(rays, hits);
+        scene->QueryRegionBatch(regions, bodyIds, counts);
+
+        uint32_t expectedHitCount = 0;
+        for (size_t i = 0; i < rays.size(); i++)
+        {
+            RaycastHit expectedHit = { RaycastHit::NoBody, 1.0f };
+            expectedHitCount += scene->Raycast(rays[i].origin, rays[i].direction, expectedHit);
+            ASSERT_EQ(hits[i], expectedHit) << "Thread count " << threadCount << ", ray " << i;
+
+            std::vector<uint32_t> expectedBodyIds(bodyIdsPerRegion);
+            ASSERT_EQ(counts[i], scene->QueryRegion(regions[i].position, regions[i].size, expectedBodyIds))
+                << "Thread count " << threadCount << ", region " << i;
+            for (uint32_t j = 0; j < std::min(counts[i], bodyIdsPerRegion); j++)
+            {
+                ASSERT_EQ(bodyIds[i * bodyIdsPerRegion + j], expectedBodyIds[j]) << "Thread count " << threadCount << ", region " << i;
+            }
+        }
+        ASSERT_EQ(hitCount, expectedHitCount) << "Thread count " << threadCount;
+        ASSERT_GT(hitCount, 0u);
+    }
+}
+
+TEST_F(EngineTests, SpatialQueryBatches_GivenTooFewOutputs_Throw)
+{
+    auto scene = _engine.CreateScene(SceneDefinition());
+    std::vector<Ray> rays(2);
+    std::vector<RaycastHit> hits(1);
+    ASSERT_THROW(scene->RaycastBatch(rays, hits), std::invalid_argument);
+
+    std::vector<Region> regions(2);
+    std::vector<uint32_t> bodyIds(2);
+    std::vector<uint32_t> counts(1);
+    ASSERT_THROW(scene->QueryRegionBatch(regions, bodyIds, counts), std::invalid_argument);
+}
+
+TEST_F(EngineTests, SpatialQueryBatches_GivenUpdateOnAnotherThread_SeeWholeSteps)
+{
+    // A column of bodies moving right together, each with a ray cast at
+    // it from the left.  A batch that saw part of a step would hit some
+    // of them further along than others.
+    constexpr uint32_t BodyCount = 2000;
+    SceneDefinition sceneDefinition;
+    sceneDefinition.ThreadCount(4);
+    std::vector<Ray> rays;
+    for (uint32_t i = 0; i < BodyCount; i++)
+    {
+        sceneDefinition.AddMovableAabb2d(
+            MovableAabb2dDefinition(nullptr, glm::vec2(10.0f, i * 2.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+        rays.push_back({ glm::vec2(0.0f, i * 2.0f + 0.5f), glm::vec2(100.0f, 0.0f) });
+    }
+    auto scene = _engine.CreateScene(sceneDefinition);
+    scene->SetVelocities(std::vector<glm::vec2>(BodyCount, glm::vec2(6.0f, 0.0f)));
+
+    std::atomic<bool> isUpdating = true;
+    std::thread updateThread([&]()
+    {
+        for (int step = 0; step < 200; step++)
+        {
+            scene->Update(IScene::StepTime);
+        }
+        isUpdating = false;
+    });
+
+    std::vector<RaycastHit> hits(BodyCount);
+    std::vector<float> fractionsSeen;
+    while (isUpdating)
+    {
+        ASSERT_EQ(scene->RaycastBatch(rays, hits), BodyCount);
+        for (uint32_t i = 0; i < BodyCount; i++)
+        {
+            ASSERT_EQ(hits[i].bodyId, i);
+            ASSERT_EQ(hits[i].fraction, hits[0].fraction) << "Batch " << fractionsSeen.size();
+        }
+        fractionsSeen.push_back(hits[0].fraction);
+    }
+    updateThread.join();
+
+    ASSERT_TRUE(std::is_sorted(fractionsSeen.begin(), fractionsSeen.end()));
+}
+
+TEST_F(EngineTests, SpatialQueries_GivenCallFromHandler_SeeStepInProgress)
+{
+    SceneDefinition sceneDefinition;
+    IScene* scenePointer = nullptr;
+    uint32_t foundCount = 0;
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(
+        nullptr,
+        glm::vec2(0.0f, 0.0f),
+        glm::vec2(2.0f, 2.0f),
+        [&](const IReadOnlyAabb2d&)
+        {
+            std::vector<uint32_t> bodyIds(4);
+            foundCount = scenePointer->QueryPoint(glm::vec2(1.5f, 1.5f), bodyIds);
+
+            std::vector<Ray> rays = { { glm::vec2(-1.0f, 1.5f), glm::vec2(10.0f, 0.0f) } };
+            std::vector<RaycastHit> hits(1);
+            scenePointer->RaycastBatch(rays, hits);
+        },
+        std::any()));
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(1.0f, 1.0f), glm::vec2(2.0f, 2.0f), nullptr, std::any()));
+    auto scene = _engine.CreateScene(sceneDefinition);
+    scenePointer = scene.get();
+
+    scene->Update(IScene::StepTime);
+    ASSERT_EQ(foundCount, 2u);
+}
+
+TEST_F(EngineTests, Update_GivenResolveCollisions_SplitsSeparationByMass)
+{
+    SceneDefinition sceneDefinition;
+    sceneDefinition.ResolveCollisions(true);
+
+    // Bodies 0 and 1 overlap by 2 along x and 4 along y, bodies 2 and 3
+    // the same with body 2 three times as heavy, and body 4 is immovable.
+    AfterCreatePtr<IMovableAabb2d> bodies[6];
+    auto addBody = [&](int i, glm::vec2 position, float mass, bool isImmovable)
+    {
+        MovableAabb2dDefinition definition(&bodies[i], position, glm::vec2(4.0f, 4.0f), nullptr, std::any());
+        definition.Mass(mass);
+        definition.IsImmovable(isImmovable);
+        sceneDefinition.AddMovableAabb2d(definition);
+    };
+    addBody(0, glm::vec2(0.0f, 0.0f), 1.0f, false);
+    addBody(1, glm::vec2(2.0f, 0.0f), 1.0f, false);
+    addBody(2, glm::vec2(0.0f, 20.0f), 3.0f, false);
+    addBody(3, glm::vec2(2.0f, 20.0f), 1.0f, false);
+    addBody(4, glm::vec2(0.0f, 40.0f), 1.0f, true);
+    addBody(5, glm::vec2(2.0f, 40.0f), 1.0f, false);
+
+    auto scene = _engine.CreateScene(sceneDefinition);
+    bodies[1]->Velocity(glm::vec2(-3.0f, 0.0f));
+    scene->Update(IScene::StepTime);
+
+    // Velocities are applied before collisions are found, so the moves are
+    // measured from where the step left the bodies.
+    float stepMove = -3.0f * IScene::StepTime;
+    float overlap = 2.0f - stepMove;
+    EXPECT_FLOAT_EQ(bodies[0]->Position().x, -overlap / 2.0f);
+    EXPECT_FLOAT_EQ(bodies[1]->Position().x, 2.0f + stepMove + overlap / 2.0f);
+    EXPECT_EQ(bodies[1]->Velocity(), glm::vec2(0.0f, 0.0f));
+    EXPECT_FLOAT_EQ(bodies[2]->Position().x, -0.5f);
+    EXPECT_FLOAT_EQ(bodies[3]->Position().x, 3.5f);
+    EXPECT_EQ(bodies[4]->Position(), glm::vec2(0.0f, 40.0f));
+    EXPECT_EQ(bodies[5]->Position(), glm::vec2(4.0f, 40.0f));
+    EXPECT_EQ(bodies[0]->Position().y, 0.0f);
+}
+
+TEST_F(EngineTests, Update_GivenResolveCollisions_BodySlidesAlongStaticAndTileGridFloors)
+{
+    for (bool isTileGrid : { false, true })
+    {
+        SceneDefinition sceneDefinition;
+        sceneDefinition.ResolveCollisions(true);
+
+        // A floor along y = [0, 1].  Separate static AABBs for each tile
+        // would catch the body on their seams, which tile grids avoid.
+        if (isTileGrid)
+        {
+            TileGridDefinition tileGrid(glm::vec2(0.0f, 0.0f), 100, 2, 1.0f, std::any());
+            for (uint32_t column = 0; column < 100; column++)
+            {
+                tileGrid.SetSolid(column, 0);
+            }
+            sceneDefinition.AddTileGrid(tileGrid);
+        }
+        else
+        {
+            sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(glm::vec2(0.0f, 0.0f), glm::vec2(100.0f, 1.0f), std::any()));
+        }
+
+        AfterCreatePtr<IMovableAabb2d> body;
+        sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(&body, glm::vec2(2.0f, 1.5f), glm::vec2(1.5f, 1.5f), nullptr, std::any()));
+        auto scene = _engine.CreateScene(sceneDefinition);
+        body->Velocity(glm::vec2(20.0f, 0.0f));
+        body->Acceleration(glm::vec2(0.0f, -40.0f));
+
+        for (int i = 0; i < 120; i++)
+        {
+            scene->Update(IScene::StepTime);
+            ASSERT_GE(body->Position().y, 1.0f - 0.0001f) << (isTileGrid ? "Tile grid" : "Static AABB") << ", step " << i;
+        }
+        EXPECT_NEAR(body->Position().y, 1.0f, 0.0001f) << (isTileGrid ? "Tile grid" : "Static AABB");
+        EXPECT_NEAR(body->Position().x, 2.0f + 20.0f * 120 * IScene::StepTime, 0.01f) << (isTileGrid ? "Tile grid" : "Static AABB");
+        EXPECT_EQ(body->Velocity().x, 20.0f);
+    }
+}
+
+TEST_F(EngineTests, Update_GivenResolveCollisionsWithBodiesAddedOntoStaticAndTileGrid_OnlyPushesAddedBodies)
+{
+    // Bodies added after creation have ids after the static AABB and the
+    // tile grid, so they are bodyB of their contacts.
+    SceneDefinition sceneDefinition;
+    sceneDefinition.ResolveCollisions(true);
+    AfterCreatePtr<IMovableAabb2d> bystander;
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(&bystander, glm::vec2(50.0f, 50.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(glm::vec2(0.0f, 0.0f), glm::vec2(10.0f, 1.0f), std::any()));
+    TileGridDefinition tileGrid(glm::vec2(20.0f, 0.0f), 10, 2, 1.0f, std::any());
+    for (uint32_t column = 0; column < 10; column++)
+    {
+        tileGrid.SetSolid(column, 0);
+    }
+    sceneDefinition.AddTileGrid(tileGrid);
+    auto scene = _engine.CreateScene(sceneDefinition);
+
+    AfterCreatePtr<IMovableAabb2d> onStatic;
+    AfterCreatePtr<IMovableAabb2d> onTileGrid;
+    BodyHandle onStaticHandle = scene->AddBody(
+        MovableAabb2dDefinition(&onStatic, glm::vec2(2.0f, 0.75f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    BodyHandle onTileGridHandle = scene->AddBody(
+        MovableAabb2dDefinition(&onTileGrid, glm::vec2(22.0f, 0.75f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    ASSERT_GT(onStaticHandle.bodyId, 1u);
+    ASSERT_GT(onTileGridHandle.bodyId, 2u);
+
+    scene->Update(IScene::StepTime);
+
+    EXPECT_EQ(bystander->Position(), glm::vec2(50.0f, 50.0f));
+    EXPECT_NEAR(onStatic->Position().x, 2.0f, 0.0001f);
+    EXPECT_NEAR(onStatic->Position().y, 1.0f, 0.0001f);
+    EXPECT_NEAR(onTileGrid->Position().x, 22.0f, 0.0001f);
+    EXPECT_NEAR(onTileGrid->Position().y, 1.0f, 0.0001f);
+}
+
+TEST_F(EngineTests, Update_GivenResolveCollisionsWithEachBroadphaseAndThreadCount_EndsWithSamePositions)
+{
+    auto runScene = [this](BroadphaseType broadphase, uint32_t threadCount)
+    {
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> positionDistribution(0.0f, 60.0f);
+        std::uniform_real_distribution<float> velocityDistribution(-10.0f, 10.0f);
+        std::uniform_real_distribution<float> massDistribution(0.5f, 4.0f);
+
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(broadphase);
+        sceneDefinition.ThreadCount(threadCount);
+        sceneDefinition.ResolveCollisions(true);
+        std::vector<AfterCreatePtr<IMovableAabb2d>> bodies(1000);
+        for (auto& body : bodies)
+        {
+            MovableAabb2dDefinition definition(
+                &body,
+                glm::vec2(positionDistribution(random), positionDistribution(random)),
+                glm::vec2(2.0f, 2.0f),
+                nullptr,
+                std::any());
+            definition.Mass(massDistribution(random));
+            sceneDefinition.AddMovableAabb2d(definition);
+        }
+        sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(glm::vec2(20.0f, 20.0f), glm::vec2(20.0f, 20.0f), std::any()));
+
+        auto scene = _engine.CreateScene(sceneDefinition);
+        for (auto& body : bodies)
+        {
+            body->Velocity(glm::vec2(velocityDistribution(random), velocityDistribution(random)));
+        }
+        scene->Update(IScene::StepTime * 30.0f);
+
+        std::vector<glm::vec2> positions;
+        for (auto& body : bodies)
+        {
+            positions.push_back(body->Position());
+        }
+        return positions;
+    };
+
+    auto expectedPositions = runScene(BroadphaseType::AllPairs, 1);
+    for (auto broadphase : {
+        BroadphaseType::AllPairs,
+        BroadphaseType::UniformGrid,
+        BroadphaseType::SweepAndPrune,
+        BroadphaseType::DynamicTree })
+    {
+        ASSERT_EQ(runScene(broadphase, 1), expectedPositions);
+        ASSERT_EQ(runScene(broadphase, 4), expectedPositions);
+    }
+}
+
+TEST_F(EngineTests, MovableAabb2dDefinitionMass_GivenZero_Throws)
+{
+    MovableAabb2dDefinition definition(nullptr, glm::vec2(), glm::vec2(1.0f, 1.0f), nullptr, std::any());
+    ASSERT_THROW(definition.Mass(0.0f), std::invalid_argument);
+}
+
+TEST_F(EngineTests, RestoreState_GivenSavedFrame_ResimulatesSamePositionsAndContactEvents)
+{
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> positionDistribution(0.0f, 40.0f);
+    std::uniform_real_distribution<float> velocityDistribution(-20.0f, 20.0f);
+
+    SceneDefinition sceneDefinition;
+    sceneDefinition.Broadphase(BroadphaseType::SweepAndPrune);
+    sceneDefinition.ResolveCollisions(true);
+    std::vector<ContactEvent> events;
+    sceneDefinition.ContactEventsHandler([&](std::span<const ContactEvent> stepEvents)
+    {
+        events.insert(events.end(), stepEvents.begin(), stepEvents.end());
+    });
+
+    std::vector<AfterCreatePtr<IMovableAabb2d>> bodies(200);
+    for (auto& body : bodies)
+    {
+        sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(
+            &body,
+            glm::vec2(positionDistribution(random), positionDistribution(random)),
+            glm::vec2(2.0f, 2.0f),
+            nullptr,
+            std::any()));
+    }
+    auto scene = _engine.CreateScene(sceneDefinition);
+    for (auto& body : bodies)
+    {
+        body->Velocity(glm::vec2(velocityDistribution(random), velocityDistribution(random)));
+        body->Acceleration(glm::vec2(0.0f, -10.0f));
+    }
+
+    // Runs frames [firstFrame, 20), saving each, and returns the positions
+    // after every frame along with the events from it.
+    auto runFrames = [&](uint32_t firstFrame)
+    {
+        std::vector<std::pair<std::vector<glm::vec2>, std::vector<ContactEvent>>> frames;
+        for (uint32_t frame = firstFrame; frame < 20; frame++)
+        {
+            scene->SaveState(frame);
+            events.clear();
+            scene->Update(IScene::StepTime * 1.5f);
+
+            std::vector<glm::vec2> positions;
+            for (auto& body : bodies)
+            {
+                positions.push_back(body->Position());
+            }
+            frames.emplace_back(positions, events);
+        }
+        return frames;
+    };
+
+    auto expectedFrames = runFrames(0);
+    ASSERT_TRUE(scene->RestoreState(14));
+    auto frames = runFrames(14);
+    ASSERT_EQ(frames.size(), 6u);
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        ASSERT_EQ(frames[i].first, expectedFrames[14 + i].first) << "Frame " << 14 + i;
+        ASSERT_EQ(frames[i].second, expectedFrames[14 + i].second) << "Frame " << 14 + i;
+    }
+    ASSERT_FALSE(expectedFrames[14].second.empty());
+}
+
+TEST_F(EngineTests, RestoreState_GivenFrameNotSavedReplacedOrFromBeforeBodiesChanged_ReturnsFalseAndChangesNothing)
+{
+    SceneDefinition sceneDefinition;
+    sceneDefinition.SavedStateCount(4);
+    AfterCreatePtr<IMovableAabb2d> body;
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(&body, glm::vec2(), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    auto scene = _engine.CreateScene(sceneDefinition);
+
+    ASSERT_FALSE(scene->RestoreState(0));
+    for (uint32_t frame = 0; frame < 5; frame++)
+    {
+        body->Position(glm::vec2(frame, 0.0f));
+        scene->SaveState(frame);
+    }
+    body->Position(glm::vec2(100.0f, 0.0f));
+
+    // Frame 4 went into frame 0's buffer.
+    ASSERT_FALSE(scene->RestoreState(0));
+    ASSERT_EQ(body->Position(), glm::vec2(100.0f, 0.0f));
+    ASSERT_TRUE(scene->RestoreState(1));
+    ASSERT_EQ(body->Position(), glm::vec2(1.0f, 0.0f));
+
+    scene->RemoveBody(scene->AddBody(MovableAabb2dDefinition(nullptr, glm::vec2(), glm::vec2(1.0f, 1.0f), nullptr, std::any())));
+    ASSERT_FALSE(scene->RestoreState(4));
+    ASSERT_EQ(body->Position(), glm::vec2(1.0f, 0.0f));
+}
+
+TEST_F(EngineTests, SavedStateCount_GivenZero_Throws)
+{
+    SceneDefinition sceneDefinition;
+    ASSERT_THROW(sceneDefinition.SavedStateCount(0), std::invalid_argument);
+}
+
+TEST_F(EngineTests, ThreadedScene_GivenStarted_StepsLikeUpdateAndPublishesEachStep)
+{
+    SceneDefinition sceneDefinition;
+    sceneDefinition.StepDuration(1.0f / 240.0f);
+    for (int i = 0; i < 20; i++)
+    {
+        sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(
+            nullptr,
+            glm::vec2(i * 3.0f, 0.0f),
+            glm::vec2(2.0f, 2.0f),
+            nullptr,
+            std::any()));
+    }
+    auto threadedScene = _engine.CreateThreadedScene(sceneDefinition);
+    auto scene = _engine.CreateScene(sceneDefinition);
+    for (uint32_t bodyId = 0; bodyId < 20; bodyId++)
+    {
+        threadedScene->SetVelocity(threadedScene->Scene().HandleOf(bodyId), glm::vec2(bodyId * 10.0f, 5.0f));
+        threadedScene->SetAcceleration(threadedScene->Scene().HandleOf(bodyId), glm::vec2(0.0f, -10.0f));
+        scene->Body(scene->HandleOf(bodyId))->Velocity(glm::vec2(bodyId * 10.0f, 5.0f));
+        scene->Body(scene->HandleOf(bodyId))->Acceleration(glm::vec2(0.0f, -10.0f));
+    }
+
+    threadedScene->Start();
+    ASSERT_TRUE(threadedScene->IsRunning());
+    ASSERT_EQ(threadedScene->LatestSnapshot().stepCount, 0u);
+    ASSERT_EQ(threadedScene->LatestSnapshot().positions[1], glm::vec2(3.0f, 0.0f));
+
+    uint64_t lastStepCount = 0;
+    auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (lastStepCount < 30 && std::chrono::steady_clock::now() < timeout)
+    {
+        const SceneSnapshot& snapshot = threadedScene->LatestSnapshot();
+        ASSERT_GE(snapshot.stepCount, lastStepCount);
+        lastStepCount = snapshot.stepCount;
+        std::this_thread::yield();
+    }
+    threadedScene->Stop();
+    ASSERT_FALSE(threadedScene->IsRunning());
+
+    // Every step is published, so the last snapshot is the scene as the
+    // thread left it.
+    const SceneSnapshot& snapshot = threadedScene->LatestSnapshot();
+    ASSERT_GE(snapshot.stepCount, 30u);
+    for (uint64_t step = 0; step < snapshot.stepCount; step++)
+    {
+        scene->Update(scene->StepDuration());
+    }
+    ASSERT_EQ(snapshot.BodyIdCount(), 20u);
+    for (uint32_t bodyId = 0; bodyId < 20; bodyId++)
+    {
+        IMovableAabb2d* body = scene->Body(scene->HandleOf(bodyId));
+        ASSERT_EQ(snapshot.positions[bodyId], body->Position()) << "Body " << bodyId;
+        ASSERT_EQ(snapshot.velocities[bodyId], body->Velocity()) << "Body " << bodyId;
+        ASSERT_EQ(snapshot.positions[bodyId], threadedScene->Scene().Body(threadedScene->Scene().HandleOf(bodyId))->Position());
+        ASSERT_EQ(snapshot.InterpolatedPosition(bodyId, 0.0f), snapshot.previousPositions[bodyId]);
+        ASSERT_EQ(snapshot.InterpolatedPosition(bodyId, 1.0f), snapshot.positions[bodyId]);
+    }
+}
+
+TEST_F(EngineTests, ThreadedScene_GivenWritesQueued_AppliesThemInOrderAndIgnoresStaleHandles)
+{
+    SceneDefinition sceneDefinition;
+    for (int i = 0; i < 3; i++)
+    {
+        sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(
+            nullptr,
+            glm::vec2(i * 10.0f, 0.0f),
+            glm::vec2(1.0f, 1.0f),
+            nullptr,
+            std::any()));
+    }
+    sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(glm::vec2(0.0f, -10.0f), glm::vec2(5.0f, 1.0f), std::any()));
+    auto threadedScene = _engine.CreateThreadedScene(sceneDefinition);
+    IScene& scene = threadedScene->Scene();
+    BodyHandle body0 = scene.HandleOf(0);
+    BodyHandle body1 = scene.HandleOf(1);
+    BodyHandle body2 = scene.HandleOf(2);
+    BodyHandle staticBody = scene.HandleOf(3);
+
+    threadedScene->SetPosition(body0, glm::vec2(1.0f, 2.0f));
+    threadedScene->SetPosition(body0, glm::vec2(3.0f, 4.0f));
+    threadedScene->SetSize(body0, glm::vec2(5.0f, 6.0f));
+    threadedScene->SetUserData(body0, 42);
+    threadedScene->RemoveBody(body1);
+    threadedScene->SetPosition(body1, glm::vec2(7.0f, 8.0f));
+    threadedScene->RemoveBody(staticBody);
+    threadedScene->SetVelocity(body2, glm::vec2(1.0f, 0.0f));
+
+    // Nothing is applied until the next step or Stop.
+    ASSERT_EQ(scene.Body(body0)->Position(), glm::vec2(0.0f, 0.0f));
+    threadedScene->Stop();
+
+    ASSERT_EQ(scene.Body(body0)->Position(), glm::vec2(3.0f, 4.0f));
+    ASSERT_EQ(scene.Body(body0)->Size(), glm::vec2(5.0f, 6.0f));
+    ASSERT_EQ(scene.Body(body0)->UserData(), 42u);
+    ASSERT_FALSE(scene.IsValid(body1));
+    ASSERT_TRUE(scene.IsValid(staticBody));
+    ASSERT_EQ(scene.Body(body2)->Velocity(), glm::vec2(1.0f, 0.0f));
+}
+
+TEST_F(EngineTests, ThreadedScene_GivenHandlerThatThrows_StopRethrowsAndSceneCanRestart)
+{
+    // Body 0's handler moves it before throwing, which makes the scene
+    // keep a copy of its state from before the move.  Once restarted,
+    // body 1's handler must be shown where body 0 is now.
+    bool shouldThrow = true;
+    std::atomic<bool> hasThrown = false;
+    std::atomic<bool> hasSeenBody0 = false;
+    glm::vec2 seenBody0Position;
+    AfterCreatePtr<IMovableAabb2d> body0;
+    SceneDefinition sceneDefinition;
+    sceneDefinition.StepDuration(1.0f / 240.0f);
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(
+        &body0,
+        glm::vec2(0.0f, 0.0f),
+        glm::vec2(1.0f, 1.0f),
+        [&](const IReadOnlyAabb2d&)
+        {
+            if (shouldThrow)
+            {
+                body0->Position(glm::vec2(0.25f, 0.0f));
+                hasThrown = true;
+                throw std::runtime_error("handler failed");
+            }
+        },
+        std::any()));
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(
+        nullptr,
+        glm::vec2(0.0f, 0.0f),
+        glm::vec2(1.0f, 1.0f),
+        [&](const IReadOnlyAabb2d& other)
+        {
+            if (!hasSeenBody0)
+            {
+                seenBody0Position = other.Position();
+                hasSeenBody0 = true;
+            }
+        },
+        std::any()));
+    auto threadedScene = _engine.CreateThreadedScene(sceneDefinition);
+
+    threadedScene->Start();
+    auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (threadedScene->IsRunning() && std::chrono::steady_clock::now() < timeout)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(hasThrown);
+    ASSERT_FALSE(threadedScene->IsRunning());
+    ASSERT_THROW(threadedScene->Stop(), std::runtime_error);
+    ASSERT_EQ(threadedScene->LatestSnapshot().stepCount, 0u);
+    ASSERT_FALSE(hasSeenBody0);
+
+    // Bodies are added and removed straight away again, not kept for the
+    // end of a dispatch that was never finished.
+    IScene& scene = threadedScene->Scene();
+    BodyHandle added = scene.AddBody(MovableAabb2dDefinition(nullptr, glm::vec2(10.0f, 10.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    scene.RemoveBody(added);
+    ASSERT_FALSE(scene.IsValid(added));
+
+    shouldThrow = false;
+    threadedScene->Start();
+    while (!hasSeenBody0 && std::chrono::steady_clock::now() < timeout)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_NO_THROW(threadedScene->Stop());
+    ASSERT_GT(threadedScene->LatestSnapshot().stepCount, 0u);
+    ASSERT_TRUE(hasSeenBody0);
+    ASSERT_EQ(seenBody0Position, glm::vec2(0.25f, 0.0f));
+}
+
+TEST_F(EngineTests, ThreadedScene_GivenBodyUsedFromAnotherThreadWhileRunning_ThrowsExceptForObjectInfo)
+{
+    AfterCreatePtr<IMovableAabb2d> body;
+    SceneDefinition sceneDefinition;
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(
+        &body,
+        glm::vec2(0.0f, 0.0f),
+        glm::vec2(1.0f, 1.0f),
+        nullptr,
+        std::string("crate")));
+    auto threadedScene = _engine.CreateThreadedScene(sceneDefinition);
+    IScene& scene = threadedScene->Scene();
+    BodyHandle handle = scene.HandleOf(0);
+    std::vector<glm::vec2> positions(scene.BodyIdCount(), glm::vec2(2.0f, 0.0f));
+
+    threadedScene->Start();
+    ASSERT_TRUE(threadedScene->IsRunning());
+    ASSERT_THROW(body->Position(glm::vec2(1.0f, 0.0f)), std::logic_error);
+    ASSERT_THROW(body->Velocity(glm::vec2(1.0f, 0.0f)), std::logic_error);
+    ASSERT_THROW(body->UserData(7), std::logic_error);
+    ASSERT_THROW(scene.SetPositions(positions), std::logic_error);
+    ASSERT_THROW(body->Position(), std::logic_error);
+    ASSERT_THROW(body->Velocity(), std::logic_error);
+    ASSERT_THROW(body->UserData(), std::logic_error);
+    ASSERT_THROW(scene.Positions(positions), std::logic_error);
+    ASSERT_THROW(scene.InterpolatedPositions(positions), std::logic_error);
+
+    // Object info is the caller's, so the render thread can still read it,
+    // and the snapshot is how it reads where bodies are.
+    ASSERT_EQ(body->ObjectInfoAs<std::string>(), "crate");
+    ASSERT_EQ(std::as_const(*body).ObjectInfoAs<std::string>(), "crate");
+    ASSERT_EQ(threadedScene->LatestSnapshot().positions[handle.bodyId], glm::vec2(0.0f, 0.0f));
+    threadedScene->SetPosition(handle, glm::vec2(3.0f, 0.0f));
+    threadedScene->Stop();
+
+    // Once stopped the body can be used again.
+    ASSERT_FALSE(threadedScene->IsRunning());
+    ASSERT_EQ(body->Position(), glm::vec2(3.0f, 0.0f));
+    ASSERT_EQ(body->UserData(), 0u);
+    body->Position(glm::vec2(4.0f, 0.0f));
+    ASSERT_EQ(body->Position(), glm::vec2(4.0f, 0.0f));
+}
+
+TEST_F(EngineTests, BulkAccessors_GivenRandomWrites_MatchWritingEachBodyAndSkipOtherHandles)
+{
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> distribution(-20.0f, 20.0f);
+    SceneDefinition sceneDefinition;
+    sceneDefinition.StepsBeforeSleep(3);
+    for (int i = 0; i < 50; i++)
+    {
+        sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(
+            nullptr,
+            glm::vec2(distribution(random), distribution(random)),
+            glm::vec2(1.0f + i % 3, 2.0f),
+            nullptr,
+            std::any()));
+    }
+    sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(glm::vec2(0.0f, -30.0f), glm::vec2(10.0f, 1.0f), std::any()));
+    auto bulkScene = _engine.CreateScene(sceneDefinition);
+    auto scene = _engine.CreateScene(sceneDefinition);
+    BodyHandle removedBody = scene->HandleOf(7);
+    bulkScene->RemoveBody(removedBody);
+    scene->RemoveBody(removedBody);
+
+    // Let everything fall asleep so the writes have to wake bodies.
+    bulkScene->Update(IScene::StepTime * 5.0f);
+    scene->Update(IScene::StepTime * 5.0f);
+    ASSERT_TRUE(scene->IsSleeping(scene->HandleOf(0)));
+
+    std::vector<BodyHandle> bodies;
+    std::vector<glm::vec2> positions;
+    std::vector<glm::vec2> velocities;
+    std::vector<glm::vec2> accelerations;
+    for (uint32_t bodyId = 0; bodyId < scene->BodyIdCount(); bodyId += 2)
+    {
+        bodies.push_back(scene->HandleOf(bodyId));
+        positions.emplace_back(distribution(random), distribution(random));
+        velocities.emplace_back(distribution(random), distribution(random));
+        accelerations.emplace_back(distribution(random), distribution(random));
+    }
+    bodies.push_back(removedBody);
+    bodies.push_back(scene->HandleOf(50));
+    bodies.push_back(BodyHandle());
+    bodies.push_back(scene->HandleOf(0));
+    for (int i = 0; i < 4; i++)
+    {
+        positions.emplace_back(distribution(random), distribution(random));
+        velocities.emplace_back(distribution(random), distribution(random));
+        accelerations.emplace_back(distribution(random), distribution(random));
+    }
+
+    bulkScene->SetPositions(bodies, positions);
+    bulkScene->SetVelocities(bodies, velocities);
+    bulkScene->SetAccelerations(bodies, accelerations);
+    for (size_t i = 0; i < bodies.size(); i++)
+    {
+        if (IMovableAabb2d* body = scene->Body(bodies[i]))
+        {
+            body->Position(positions[i]);
+            body->Velocity(velocities[i]);
+            body->Acceleration(accelerations[i]);
+        }
+    }
+    ASSERT_FALSE(bulkScene->IsSleeping(bulkScene->HandleOf(0)));
+    ASSERT_TRUE(bulkScene->IsSleeping(bulkScene->HandleOf(1)));
+    bulkScene->Update(IScene::StepTime * 2.0f);
+    scene->Update(IScene::StepTime * 2.0f);
+
+    std::vector<glm::vec2> bulkPositions(scene->BodyIdCount(), glm::vec2(-1.0f));
+    std::vector<glm::vec2> bulkVelocities(scene->BodyIdCount(), glm::vec2(-1.0f));
+    std::vector<glm::vec2> bulkAccelerations(scene->BodyIdCount(), glm::vec2(-1.0f));
+    bulkScene->Positions(bulkPositions);
+    bulkScene->Velocities(bulkVelocities);
+    bulkScene->Accelerations(bulkAccelerations);
+    for (uint32_t bodyId = 0; bodyId < scene->BodyIdCount(); bodyId++)
+    {
+        IMovableAabb2d* body = scene->Body(scene->HandleOf(bodyId));
+        if (body == nullptr)
+        {
+            ASSERT_EQ(bulkPositions[bodyId], glm::vec2(-1.0f)) << "Body " << bodyId;
+            continue;
+        }
+        ASSERT_EQ(bulkPositions[bodyId], body->Position()) << "Body " << bodyId;
+        ASSERT_EQ(bulkVelocities[bodyId], body->Velocity()) << "Body " << bodyId;
+        ASSERT_EQ(bulkAccelerations[bodyId], body->Acceleration()) << "Body " << bodyId;
+        ASSERT_EQ(bulkScene->Body(bulkScene->HandleOf(bodyId))->Size(), body->Size()) << "Body " << bodyId;
+    }
+}
+
+TEST_F(EngineTests, BulkAccessors_GivenSpansIndexedByBodyId_MatchWritingEachBody)
+{
+    std::mt19937 random(6);
+    std::uniform_real_distribution<float> distribution(-20.0f, 20.0f);
+    SceneDefinition sceneDefinition;
+    sceneDefinition.StepsBeforeSleep(3);
+    for (int i = 0; i < 50; i++)
+    {
+        sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(
+            nullptr,
+            glm::vec2(distribution(random), distribution(random)),
+            glm::vec2(1.0f + i % 3, 2.0f),
+            nullptr,
+            std::any()));
+    }
+    sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(glm::vec2(0.0f, -30.0f), glm::vec2(10.0f, 1.0f), std::any()));
+
+    // Once with every body awake and once with them all asleep, which
+    // takes the path that wakes them.
+    for (float sleepTime : { 0.0f, IScene::StepTime * 5.0f })
+    {
+        auto bulkScene = _engine.CreateScene(sceneDefinition);
+        auto scene = _engine.CreateScene(sceneDefinition);
+        bulkScene->RemoveBody(bulkScene->HandleOf(7));
+        scene->RemoveBody(scene->HandleOf(7));
+        bulkScene->Update(sleepTime);
+        scene->Update(sleepTime);
+        ASSERT_EQ(bulkScene->IsSleeping(bulkScene->HandleOf(0)), sleepTime > 0.0f);
+
+        std::vector<glm::vec2> positions(scene->BodyIdCount());
+        std::vector<glm::vec2> velocities(scene->BodyIdCount());
+        std::vector<glm::vec2> accelerations(scene->BodyIdCount());
+        for (uint32_t bodyId = 0; bodyId < scene->BodyIdCount(); bodyId++)
+        {
+            positions[bodyId] = glm::vec2(distribution(random), distribution(random));
+            velocities[bodyId] = glm::vec2(distribution(random), distribution(random));
+            accelerations[bodyId] = glm::vec2(distribution(random), distribution(random));
+            if (IMovableAabb2d* body = scene->Body(scene->HandleOf(bodyId)))
+            {
+                body->Position(positions[bodyId]);
+                body->Velocity(velocities[bodyId]);
+                body->Acceleration(accelerations[bodyId]);
+            }
+        }
+        bulkScene->SetPositions(positions);
+        bulkScene->SetVelocities(velocities);
+        bulkScene->SetAccelerations(accelerations);
+        ASSERT_FALSE(bulkScene->IsSleeping(bulkScene->HandleOf(0)));
+        bulkScene->Update(IScene::StepTime * 2.0f);
+        scene->Update(IScene::StepTime * 2.0f);
+
+        std::vector<glm::vec2> bulkPositions(scene->BodyIdCount());
+        bulkScene->Positions(bulkPositions);
+        for (uint32_t bodyId = 0; bodyId < scene->BodyIdCount(); bodyId++)
+        {
+            if (IMovableAabb2d* body = scene->Body(scene->HandleOf(bodyId)))
+            {
+                ASSERT_EQ(bulkPositions[bodyId], body->Position()) << "Body " << bodyId;
+                ASSERT_EQ(bulkScene->Body(bulkScene->HandleOf(bodyId))->Velocity(), body->Velocity()) << "Body " << bodyId;
+            }
+        }
+    }
+}
+
+TEST_F(EngineTests, BulkAccessors_GivenSpansOfWrongSize_Throw)
+{
+    SceneDefinition sceneDefinition;
+    for (int i = 0; i < 3; i++)
+    {
+        sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    }
+    auto scene = _engine.CreateScene(sceneDefinition);
+    std::vector<glm::vec2> values(2);
+    std::vector<BodyHandle> bodies = { scene->HandleOf(0) };
+
+    ASSERT_THROW(scene->Positions(values), std::invalid_argument);
+    ASSERT_THROW(scene->Velocities(values), std::invalid_argument);
+    ASSERT_THROW(scene->Accelerations(values), std::invalid_argument);
+    ASSERT_THROW(scene->SetPositions(bodies, values), std::invalid_argument);
+    ASSERT_THROW(scene->SetVelocities(bodies, values), std::invalid_argument);
+    ASSERT_THROW(scene->SetAccelerations(bodies, values), std::invalid_argument);
+    ASSERT_THROW(scene->SetPositions(values), std::invalid_argument);
+    ASSERT_THROW(scene->SetVelocities(values), std::invalid_argument);
+    ASSERT_THROW(scene->SetAccelerations(values), std::invalid_argument);
+    ASSERT_EQ(scene->Body(bodies[0])->Position(), glm::vec2(0.0f, 0.0f));
+}
+
+TEST_F(EngineTests, Update_GivenCollisionHandlersOff_EachBroadphaseReportsSameContactEventsAsWithThemOn)
+{
+    auto runScene = [this](BroadphaseType broadphase, bool partitioned, bool collisionHandlers)
+    {
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> positionDistribution(0.0f, 30.0f);
+        std::uniform_real_distribution<float> velocityDistribution(-10.0f, 10.0f);
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(broadphase);
+        sceneDefinition.PartitionBroadphaseByCollisionFilter(partitioned);
+        sceneDefinition.CollisionHandlers(collisionHandlers);
+        std::vector<ContactEvent> events;
+        sceneDefinition.ContactEventsHandler([&](std::span<const ContactEvent> stepEvents)
+        {
+            events.insert(events.end(), stepEvents.begin(), stepEvents.end());
+        });
+
+        std::vector<AfterCreatePtr<IMovableAabb2d>> bodies(100);
+        for (auto& body : bodies)
+        {
+            sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(
+                &body,
+                glm::vec2(positionDistribution(random), positionDistribution(random)),
+                glm::vec2(2.0f, 2.0f),
+                nullptr,
+                std::any()));
+        }
+        sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(glm::vec2(10.0f, 10.0f), glm::vec2(5.0f, 5.0f), std::any()));
+        auto scene = _engine.CreateScene(sceneDefinition);
+        for (auto& body : bodies)
+        {
+            body->Velocity(glm::vec2(velocityDistribution(random), velocityDistribution(random)));
+        }
+        scene->Update(IScene::StepTime * 30.0f);
+        return events;
+    };
+
+    auto expectedEvents = runScene(BroadphaseType::AllPairs, false, true);
+    ASSERT_FALSE(expectedEvents.empty());
+    for (auto broadphase : {
+        BroadphaseType::AllPairs,
+        BroadphaseType::UniformGrid,
+        BroadphaseType::SweepAndPrune,
+        BroadphaseType::DynamicTree })
+    {
+        for (bool partitioned : { false, true })
+        {
+            ASSERT_EQ(runScene(broadphase, partitioned, false), expectedEvents)
+                << "Broadphase " << static_cast<int>(broadphase) << " partitioned " << partitioned;
+        }
+    }
+}
+
+TEST_F(EngineTests, AddBody_GivenCollisionHandlerWhenCollisionHandlersOff_Throws)
+{
+    SceneDefinition sceneDefinition;
+    sceneDefinition.CollisionHandlers(false);
+    auto scene = _engine.CreateScene(sceneDefinition);
+
+    MovableAabb2dDefinition withoutHandler(nullptr, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any());
+    MovableAabb2dDefinition withHandler(
+        nullptr, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), [](const IReadOnlyAabb2d&) { }, std::any());
+    MovableAabb2dDefinition withViewHandler(nullptr, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any());
+    withViewHandler.CollisionViewHandler([](const ReadOnlyAabb2dView&) { });
+
+    ASSERT_NO_THROW(scene->AddBody(withoutHandler));
+    ASSERT_THROW(scene->AddBody(withHandler), std::invalid_argument);
+    ASSERT_THROW(scene->AddBody(withViewHandler), std::invalid_argument);
+    ASSERT_EQ(scene->BodyIdCount(), 1u);
+
+    sceneDefinition.AddMovableAabb2d(withHandler);
+    ASSERT_THROW(_engine.CreateScene(sceneDefinition), std::invalid_argument);
+}
+
+TEST_F(EngineTests, RemoveBody_GivenBody_HandleStopsMatchingAndIdIsReusedWithNewGeneration)
+{
+    SceneDefinition sceneDefinition;
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(glm::vec2(0.0f, -1.0f), glm::vec2(1.0f, 1.0f), std::any()));
+    auto scene = _engine.CreateScene(sceneDefinition);
+
+    AfterCreatePtr<IMovableAabb2d> addedPtr;
+    BodyHandle added = scene->AddBody(MovableAabb2dDefinition(&addedPtr, glm::vec2(5.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+
+    // Ids after the movable and static AABBs of the definition.
+    ASSERT_EQ(added.bodyId, 2u);
+    ASSERT_TRUE(scene->IsValid(added));
+    ASSERT_EQ(scene->Body(added), addedPtr.operator->());
+
+    scene->RemoveBody(added);
+    scene->RemoveBody(added);
+    BodyHandle readded = scene->AddBody(MovableAabb2dDefinition(nullptr, glm::vec2(5.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+
+    ASSERT_FALSE(scene->IsValid(added));
+    ASSERT_EQ(scene->Body(added), nullptr);
+    ASSERT_EQ(readded.bodyId, added.bodyId);
+    ASSERT_NE(readded.generation, added.generation);
+    ASSERT_EQ(scene->HandleOf(readded.bodyId), readded);
+    ASSERT_FALSE(scene->IsValid(BodyHandle()));
+    ASSERT_THROW(scene->RemoveBody(scene->HandleOf(1)), std::invalid_argument);
+}
+
+TEST_F(EngineTests, RemoveBody_GivenOtherBodiesRemoved_RemainingBodiesKeepTheirIdsAndPointers)
+{
+    SceneDefinition sceneDefinition;
+    std::vector<AfterCreatePtr<IMovableAabb2d>> aabbs(4);
+    for (int i = 0; i < 4; i++)
+    {
+        sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(&aabbs[i], glm::vec2(i * 10.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any(i)));
+    }
+
+    std::vector<Contact> contacts;
+    sceneDefinition.ContactsHandler([&](std::span<const Contact> stepContacts)
+    {
+        contacts.assign(stepContacts.begin(), stepContacts.end());
+    });
+
+    auto scene = _engine.CreateScene(sceneDefinition);
+
+    // Removing body 0 moves the last AABB into its place.
+    scene->RemoveBody(scene->HandleOf(0));
+    aabbs[3]->Position(glm::vec2(20.5f, 0.0f));
+    scene->Update(IScene::StepTime);
+
+    std::vector<Contact> expectedContacts = { { 2, 3 } };
+    ASSERT_EQ(contacts, expectedContacts);
+    ASSERT_EQ(aabbs[3]->ObjectInfoAs<int>(), 3);
+    ASSERT_EQ(scene->Body(scene->HandleOf(3)), aabbs[3].operator->());
+}
+
+TEST_F(EngineTests, RemoveBody_GivenCalledFromCollisionHandler_BodyIsRemovedOnceEveryHandlerHasRun)
+{
+    SceneDefinition sceneDefinition;
+    IScene* scenePtr = nullptr;
+    std::vector<std::pair<int, int>> calls;
+    for (int i = 0; i < 3; i++)
+    {
+        sceneDefinition.AddMovableAabb2d(
+            MovableAabb2dDefinition(
+                nullptr,
+                glm::vec2(i * 0.5f, 0.0f),
+                glm::vec2(1.0f, 1.0f),
+                [&, i](const IReadOnlyAabb2d& other)
+                {
+                    calls.emplace_back(i, other.ObjectInfoAs<int>());
+
+                    // Body 0 removes itself on its first collision.
+                    if (i == 0)
+                    {
+                        scenePtr->RemoveBody(scenePtr->HandleOf(0));
+                    }
+                },
+                std::any(i)
+            )
+        );
+    }
+
+    auto scene = _engine.CreateScene(sceneDefinition);
+    scenePtr = scene.get();
+    scene->Update(IScene::StepTime);
+
+    std::vector<std::pair<int, int>> expectedCalls = { { 0, 1 }, { 1, 0 }, { 0, 2 }, { 2, 0 }, { 1, 2 }, { 2, 1 } };
+    ASSERT_EQ(calls, expectedCalls);
+    ASSERT_FALSE(scene->IsValid(BodyHandle{ 0, 1 }));
+
+    calls.clear();
+    scene->Update(IScene::StepTime);
+
+    expectedCalls = { { 1, 2 }, { 2, 1 } };
+    ASSERT_EQ(calls, expectedCalls);
+}
+
+TEST_F(EngineTests, RemoveBody_GivenBodyWithContacts_ContactsEndWithoutEventsAndReusedIdBegins)
+{
+    SceneDefinition sceneDefinition;
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(0.5f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+
+    std::vector<ContactEvent> events;
+    sceneDefinition.ContactEventsHandler([&](std::span<const ContactEvent> stepEvents)
+    {
+        events.insert(events.end(), stepEvents.begin(), stepEvents.end());
+    });
+
+    auto scene = _engine.CreateScene(sceneDefinition);
+    scene->Update(IScene::StepTime);
+    scene->RemoveBody(scene->HandleOf(1));
+    scene->AddBody(MovableAabb2dDefinition(nullptr, glm::vec2(-0.5f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    scene->Update(IScene::StepTime);
+
+    std::vector<ContactEvent> expected = {
+        { { 0, 1 }, ContactEventType::Begin },
+        { { 0, 1 }, ContactEventType::Begin } };
+    ASSERT_EQ(events, expected);
+}
+
+TEST_F(EngineTests, Update_GivenBodiesAddedAndRemovedBetweenSteps_EachBroadphaseReportsEveryOverlappingPair)
+{
+    struct Setup
+    {
+        BroadphaseType broadphase;
+        bool partition;
+        uint32_t threadCount;
+    };
+
+    std::vector<Setup> setups;
+    for (auto broadphase : { BroadphaseType::AllPairs, BroadphaseType::UniformGrid, BroadphaseType::SweepAndPrune, BroadphaseType::DynamicTree })
+    {
+        setups.push_back({ broadphase, false, 1 });
+        setups.push_back({ broadphase, true, 1 });
+        setups.push_back({ broadphase, false, 4 });
+    }
+
+    for (auto& setup : setups)
+    {
+        std::mt19937 random(1234);
+
+        // Positions and sizes are multiples of 0.25 so every bound is exact.
+        std::uniform_int_distribution<int> coordinateDistribution(0, 160);
+        std::uniform_int_distribution<int> sizeDistribution(1, 12);
+        std::uniform_int_distribution<uint32_t> categoryDistribution(0, 2);
+        auto randomDefinition = [&]()
+        {
+            MovableAabb2dDefinition definition(
+                nullptr,
+                glm::vec2(coordinateDistribution(random) * 0.25f, coordinateDistribution(random) * 0.25f),
+                glm::vec2(sizeDistribution(random) * 0.25f, sizeDistribution(random) * 0.25f),
+                nullptr,
+                std::any());
+
+            // Category 4 only turns up once bodies start being added, so
+            // the partitioned broadphase has to make a new partition.
+            uint32_t category = 1u << categoryDistribution(random);
+            definition.CollisionFilter(category, category == 2u ? ~2u : DefaultCollisionMask);
+            return definition;
+        };
+
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(setup.broadphase);
+        sceneDefinition.PartitionBroadphaseByCollisionFilter(setup.partition);
+        sceneDefinition.ThreadCount(setup.threadCount);
+        sceneDefinition.GridCellSize(2.0f);
+        std::uniform_int_distribution<uint32_t> initialCategoryDistribution(0, 1);
+        for (int i = 0; i < 100; i++)
+        {
+            auto definition = randomDefinition();
+            uint32_t category = 1u << initialCategoryDistribution(random);
+            definition.CollisionFilter(category, category == 2u ? ~2u : DefaultCollisionMask);
+            sceneDefinition.AddMovableAabb2d(definition);
+        }
+
+        std::vector<Contact> contacts;
+        sceneDefinition.ContactsHandler([&](std::span<const Contact> stepContacts)
+        {
+            contacts.assign(stepContacts.begin(), stepContacts.end());
+        });
+
+        auto scene = _engine.CreateScene(sceneDefinition);
+        std::vector<BodyHandle> bodies;
+        std::vector<std::pair<uint32_t, uint32_t>> filters;
+        for (uint32_t bodyId = 0; bodyId < 100; bodyId++)
+        {
+            bodies.push_back(scene->HandleOf(bodyId));
+            auto& definition = sceneDefinition.MovableAabb2dDefinitions()[bodyId];
+            filters.emplace_back(definition.CollisionCategory(), definition.CollisionMask());
+        }
+
+        for (int step = 0; step < 20; step++)
+        {
+            for (int change = 0; change < 15; change++)
+            {
+                size_t victim = std::uniform_int_distribution<size_t>(0, bodies.size() - 1)(random);
+                scene->RemoveBody(bodies[victim]);
+                bodies[victim] = bodies.back();
+                bodies.pop_back();
+                filters[victim] = filters.back();
+                filters.pop_back();
+
+                auto definition = randomDefinition();
+                bodies.push_back(scene->AddBody(definition));
+                filters.emplace_back(definition.CollisionCategory(), definition.CollisionMask());
+
+                // And move one that stays.
+                size_t moved = std::uniform_int_distribution<size_t>(0, bodies.size() - 1)(random);
+                scene->Body(bodies[moved])->Position(
+                    glm::vec2(coordinateDistribution(random) * 0.25f, coordinateDistribution(random) * 0.25f));
+            }
+
+            scene->Update(IScene::StepTime);
+
+            std::vector<Contact> expectedContacts;
+            for (size_t i = 0; i < bodies.size(); i++)
+            {
+                for (size_t j = i + 1; j < bodies.size(); j++)
+                {
+                    auto* body0 = scene->Body(bodies[i]);
+                    auto* body1 = scene->Body(bodies[j]);
+                    glm::vec2 min0 = body0->Position();
+                    glm::vec2 max0 = min0 + body0->Size();
+                    glm::vec2 min1 = body1->Position();
+                    glm::vec2 max1 = min1 + body1->Size();
+                    bool overlaps = min0.x <= max1.x && max0.x >= min1.x && min0.y <= max1.y && max0.y >= min1.y;
+                    bool filtersMatch = (filters[i].first & filters[j].second) != 0 && (filters[j].first & filters[i].second) != 0;
+                    if (overlaps && filtersMatch)
+                    {
+                        uint32_t bodyId0 = bodies[i].bodyId;
+                        uint32_t bodyId1 = bodies[j].bodyId;
+                        expectedContacts.push_back({ std::min(bodyId0, bodyId1), std::max(bodyId0, bodyId1) });
+                    }
+                }
+            }
+            std::sort(expectedContacts.begin(), expectedContacts.end());
+
+            ASSERT_FALSE(expectedContacts.empty());
+            ASSERT_EQ(contacts, expectedContacts)
+                << "broadphase " << static_cast<int>(setup.broadphase)
+                << " partition " << setup.partition
+                << " threads " << setup.threadCount
+                << " step " << step;
+        }
+    }
+}
+
+TEST_F(EngineTests, Update_GivenBodyAtRestForStepsBeforeSleep_BodySleepsAndStopsMoving)
+{
+    SceneDefinition sceneDefinition;
+    sceneDefinition.StepsBeforeSleep(3);
+    AfterCreatePtr<IMovableAabb2d> aabb;
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(&aabb, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    auto scene = _engine.CreateScene(sceneDefinition);
+    BodyHandle handle = scene->HandleOf(0);
+
+    // Slow enough to count as at rest, so it still drifts until it sleeps.
+    aabb->Velocity(glm::vec2(0.01f, 0.0f));
+    scene->Update(IScene::StepTime * 2.0f);
+    bool isSleepingAfterTwoSteps = scene->IsSleeping(handle);
+    scene->Update(IScene::StepTime);
+    glm::vec2 positionWhenAsleep = aabb->Position();
+    scene->Update(IScene::StepTime * 10.0f);
+
+    ASSERT_FALSE(isSleepingAfterTwoSteps);
+    ASSERT_TRUE(scene->IsSleeping(handle));
+    ASSERT_EQ(aabb->Position(), positionWhenAsleep);
+    ASSERT_EQ(aabb->Velocity(), glm::vec2(0.0f, 0.0f));
+
+    aabb->Velocity(glm::vec2(10.0f, 0.0f));
+    ASSERT_FALSE(scene->IsSleeping(handle));
+    scene->Update(IScene::StepTime);
+    ASSERT_GT(aabb->Position().x, positionWhenAsleep.x);
+}
+
+TEST_F(EngineTests, Update_GivenAwakeBodyTouchingSleepingIsland_WakesEveryBodyInTheIsland)
+{
+    SceneDefinition sceneDefinition;
+    sceneDefinition.StepsBeforeSleep(2);
+    std::vector<std::pair<int, int>> calls;
+    auto addAabb = [&](AfterCreatePtr<IMovableAabb2d>* ptr, glm::vec2 position, int id)
+    {
+        sceneDefinition.AddMovableAabb2d(
+            MovableAabb2dDefinition(
+                ptr,
+                position,
+                glm::vec2(1.0f, 1.0f),
+                [&calls, id](const IReadOnlyAabb2d& other)
+                {
+                    calls.emplace_back(id, other.ObjectInfoAs<int>());
+                },
+                std::any(id)
+            )
+        );
+    };
+
+    // Bodies 0 and 1 touch and sleep together, body 2 sleeps alone and
+    // body 3 is thrown at body 1.
+    AfterCreatePtr<IMovableAabb2d> mover;
+    addAabb(nullptr, glm::vec2(0.0f, 0.0f), 0);
+    addAabb(nullptr, glm::vec2(0.5f, 0.0f), 1);
+    addAabb(nullptr, glm::vec2(20.0f, 0.0f), 2);
+    addAabb(&mover, glm::vec2(1.75f, 10.0f), 3);
+    auto scene = _engine.CreateScene(sceneDefinition);
+
+    scene->Update(IScene::StepTime * 2.0f);
+    ASSERT_TRUE(scene->IsSleeping(scene->HandleOf(0)));
+    ASSERT_TRUE(scene->IsSleeping(scene->HandleOf(1)));
+    ASSERT_TRUE(scene->IsSleeping(scene->HandleOf(2)));
+
+    // Sleeping pairs are not tested.
+    calls.clear();
+    scene->Update(IScene::StepTime);
+    ASSERT_TRUE(calls.empty());
+
+    mover->Position(glm::vec2(1.25f, 0.0f));
+    mover->Velocity(glm::vec2(0.0f, -1.0f));
+    scene->Update(IScene::StepTime);
+
+    std::vector<std::pair<int, int>> expectedCalls = { { 0, 1 }, { 1, 0 }, { 1, 3 }, { 3, 1 } };
+    ASSERT_EQ(calls, expectedCalls);
+    ASSERT_FALSE(scene->IsSleeping(scene->HandleOf(0)));
+    ASSERT_FALSE(scene->IsSleeping(scene->HandleOf(1)));
+    ASSERT_TRUE(scene->IsSleeping(scene->HandleOf(2)));
+}
+
+TEST_F(EngineTests, Update_GivenSleepingBodiesInContact_ContactPersistsWithoutEventsUntilTheyWake)
+{
+    SceneDefinition sceneDefinition;
+    sceneDefinition.StepsBeforeSleep(2);
+    AfterCreatePtr<IMovableAabb2d> aabb0;
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(&aabb0, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(0.5f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(glm::vec2(0.0f, -1.0f), glm::vec2(2.0f, 1.0f), std::any()));
+
+    std::vector<std::vector<ContactEvent>> eventsPerStep;
+    sceneDefinition.ContactEventsHandler([&](std::span<const ContactEvent> stepEvents)
+    {
+        eventsPerStep.emplace_back(stepEvents.begin(), stepEvents.end());
+    });
+
+    auto scene = _engine.CreateScene(sceneDefinition);
+    scene->Update(IScene::StepTime * 4.0f);
+
+    // Waking body 0 wakes body 1 too, and both contacts carry on.
+    aabb0->Velocity(glm::vec2(0.0f, 0.0f));
+    scene->Update(IScene::StepTime);
+
+    // Then body 0 leaves both.
+    aabb0->Position(glm::vec2(10.0f, 0.0f));
+    scene->Update(IScene::StepTime);
+
+    std::vector<std::vector<ContactEvent>> expected = {
+        { { { 0, 1 }, ContactEventType::Begin }, { { 0, 2 }, ContactEventType::Begin }, { { 1, 2 }, ContactEventType::Begin } },
+        { { { 0, 1 }, ContactEventType::Persist }, { { 0, 2 }, ContactEventType::Persist }, { { 1, 2 }, ContactEventType::Persist } },
+        { },
+        { },
+        { { { 0, 1 }, ContactEventType::Persist }, { { 0, 2 }, ContactEventType::Persist }, { { 1, 2 }, ContactEventType::Persist } },
+        { { { 0, 1 }, ContactEventType::End }, { { 0, 2 }, ContactEventType::End }, { { 1, 2 }, ContactEventType::Persist } } };
+    ASSERT_EQ(eventsPerStep, expected);
+}
+
+TEST_F(EngineTests, Update_GivenSleepingEnabled_EachBroadphaseAndThreadCountReportsSameContacts)
+{
+    auto runScene = [this](BroadphaseType broadphase, bool partition, uint32_t threadCount)
+    {
+        std::mt19937 random(77);
+        std::uniform_real_distribution<float> positionDistribution(0.0f, 60.0f);
+        SceneDefinition sceneDefinition;
+        sceneDefinition.Broadphase(broadphase);
+        sceneDefinition.PartitionBroadphaseByCollisionFilter(partition);
+        sceneDefinition.ThreadCount(threadCount);
+        sceneDefinition.GridCellSize(2.0f);
+        sceneDefinition.StepsBeforeSleep(5);
+
+        // Half of the bodies rest and half keep moving through them.
+        std::vector<std::unique_ptr<AfterCreatePtr<IMovableAabb2d>>> movers;
+        for (int i = 0; i < 400; i++)
+        {
+            movers.push_back(std::make_unique<AfterCreatePtr<IMovableAabb2d>>());
+            MovableAabb2dDefinition definition(
+                movers.back().get(),
+                glm::vec2(positionDistribution(random), positionDistribution(random)),
+                glm::vec2(1.5f, 1.5f),
+                nullptr,
+                std::any());
+            definition.CollisionFilter(1u << (i % 2), DefaultCollisionMask);
+            sceneDefinition.AddMovableAabb2d(definition);
+        }
+        sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(glm::vec2(0.0f, 0.0f), glm::vec2(60.0f, 1.0f), std::any()));
+
+        std::vector<std::vector<Contact>> contactsPerStep;
+        sceneDefinition.ContactsHandler([&](std::span<const Contact> stepContacts)
+        {
+            contactsPerStep.emplace_back(stepContacts.begin(), stepContacts.end());
+        });
+
+        auto scene = _engine.CreateScene(sceneDefinition);
+        for (int i = 0; i < 400; i += 2)
+        {
+            (*movers[i])->Velocity(glm::vec2(20.0f, 0.0f));
+        }
+        for (int step = 0; step < 30; step++)
+        {
+            scene->Update(IScene::StepTime);
+        }
+        return contactsPerStep;
+    };
+
+    auto expected = runScene(BroadphaseType::AllPairs, false, 1);
+    ASSERT_EQ(expected.size(), 30u);
+    for (auto broadphase : { BroadphaseType::AllPairs, BroadphaseType::UniformGrid, BroadphaseType::SweepAndPrune, BroadphaseType::DynamicTree })
+    {
+        ASSERT_EQ(runScene(broadphase, false, 4), expected);
+        ASSERT_EQ(runScene(broadphase, true, 1), expected);
+    }
+}
+
+TEST_F(EngineTests, InterpolatedPositions_GivenPartOfAStepNotYetSimulated_BlendsLastTwoSteps)
+{
+    SceneDefinition sceneDefinition;
+    AfterCreatePtr<IMovableAabb2d> mover;
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(&mover, glm::vec2(10.0f, 20.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), std::any()));
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(-5.0f, -5.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    auto scene = _engine.CreateScene(sceneDefinition);
+
+    // One unit per step along x.
+    mover->Velocity(glm::vec2(1.0f / IScene::StepTime, 0.0f));
+    scene->Update(IScene::StepTime * 1.25f);
+
+    const glm::vec2 untouched(-1.0f, -1.0f);
+    std::vector<glm::vec2> positions(scene->BodyIdCount(), untouched);
+    scene->InterpolatedPositions(positions);
+
+    ASSERT_EQ(positions.size(), 3u);
+    EXPECT_NEAR(positions[0].x, 10.25f, 0.001f);
+    EXPECT_NEAR(positions[0].y, 20.0f, 0.001f);
+    EXPECT_EQ(positions[1], glm::vec2(-5.0f, -5.0f));
+    EXPECT_EQ(positions[2], untouched);
+
+    std::vector<glm::vec2> tooFewPositions(2);
+    ASSERT_THROW(scene->InterpolatedPositions(tooFewPositions), std::invalid_argument);
+}
+
+TEST_F(EngineTests, InterpolatedPositions_GivenBodiesAddedAndRemoved_WritesEachAtItsBodyId)
+{
+    SceneDefinition sceneDefinition;
+    for (int i = 0; i < 3; i++)
+    {
+        sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(i * 10.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    }
+    auto scene = _engine.CreateScene(sceneDefinition);
+    scene->RemoveBody(scene->HandleOf(0));
+    BodyHandle added = scene->AddBody(MovableAabb2dDefinition(nullptr, glm::vec2(5.0f, 5.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+
+    std::vector<glm::vec2> positions(scene->BodyIdCount());
+    scene->InterpolatedPositions(positions);
+
+    ASSERT_EQ(added.bodyId, 0u);
+    EXPECT_EQ(positions[0], glm::vec2(5.0f, 5.0f));
+    EXPECT_EQ(positions[1], glm::vec2(10.0f, 0.0f));
+    EXPECT_EQ(positions[2], glm::vec2(20.0f, 0.0f));
+}
+
+TEST_F(EngineTests, Update_GivenFastBodiesMovingPastAabbsWithinOneStep_OnlyAabbsOnTheirPathsAreHit)
+{
+    for (auto broadphase : { BroadphaseType::AllPairs, BroadphaseType::UniformGrid, BroadphaseType::SweepAndPrune, BroadphaseType::DynamicTree })
+    {
+        for (bool partition : { false, true })
+        {
+            for (uint32_t threadCount : { 1u, 2u })
+            {
+                for (bool isFast : { false, true })
+                {
+                    SceneDefinition sceneDefinition;
+                    sceneDefinition.Broadphase(broadphase);
+                    sceneDefinition.PartitionBroadphaseByCollisionFilter(partition);
+                    sceneDefinition.ThreadCount(threadCount);
+                    sceneDefinition.StepDuration(1.0f / 30.0f);
+
+                    // A bullet that passes a thin target and wall, and one
+                    // moving diagonally whose swept bounds cover a decoy
+                    // that its path misses.
+                    std::vector<AfterCreatePtr<IMovableAabb2d>> bullets(2);
+                    MovableAabb2dDefinition bullet(&bullets[0], glm::vec2(0.0f, 0.0f), glm::vec2(0.5f, 0.5f), nullptr, std::any());
+                    bullet.IsFast(isFast);
+                    sceneDefinition.AddMovableAabb2d(bullet);
+                    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(7.0f, -1.0f), glm::vec2(0.2f, 2.0f), nullptr, std::any()));
+                    MovableAabb2dDefinition diagonalBullet(&bullets[1], glm::vec2(0.0f, 20.0f), glm::vec2(0.5f, 0.5f), nullptr, std::any());
+                    diagonalBullet.IsFast(isFast);
+                    sceneDefinition.AddMovableAabb2d(diagonalBullet);
+                    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(nullptr, glm::vec2(8.0f, 20.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+                    sceneDefinition.AddStaticAabb2d(StaticAabb2dDefinition(glm::vec2(5.0f, -1.0f), glm::vec2(0.1f, 2.0f), std::any()));
+
+                    std::vector<Contact> contacts;
+                    sceneDefinition.ContactsHandler([&](std::span<const Contact> stepContacts)
+                    {
+                        contacts.assign(stepContacts.begin(), stepContacts.end());
+                    });
+
+                    auto scene = _engine.CreateScene(sceneDefinition);
+                    bullets[0]->Velocity(glm::vec2(300.0f, 0.0f));
+                    bullets[1]->Velocity(glm::vec2(300.0f, 300.0f));
+                    scene->Update(1.0f / 30.0f);
+
+                    ASSERT_NEAR(bullets[0]->Position().x, 10.0f, 0.0001f);
+                    std::vector<Contact> expectedContacts;
+                    if (isFast)
+                    {
+                        expectedContacts = { { 0, 1 }, { 0, 4 } };
+                    }
+                    ASSERT_EQ(contacts, expectedContacts);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(EngineTests, Update_GivenFastBodyPassingThroughTarget_CollisionHandlersAreCalledForTheStepItPassed)
+{
+    int bulletCollisionCount = 0;
+    int targetCollisionCount = 0;
+    AfterCreatePtr<IMovableAabb2d> bullet;
+    SceneDefinition sceneDefinition;
+    sceneDefinition.StepDuration(1.0f / 30.0f);
+    MovableAabb2dDefinition bulletDefinition(
+        &bullet,
+        glm::vec2(0.0f, 0.0f),
+        glm::vec2(0.5f, 0.5f),
+        [&](const IReadOnlyAabb2d&) { bulletCollisionCount++; },
+        std::any());
+    bulletDefinition.IsFast(true);
+    sceneDefinition.AddMovableAabb2d(bulletDefinition);
+    sceneDefinition.AddMovableAabb2d(
+        MovableAabb2dDefinition(
+            nullptr,
+            glm::vec2(5.0f, 0.0f),
+            glm::vec2(0.5f, 0.5f),
+            [&](const IReadOnlyAabb2d&) { targetCollisionCount++; },
+            std::any()));
+    auto scene = _engine.CreateScene(sceneDefinition);
+    bullet->Velocity(glm::vec2(300.0f, 0.0f));
+
+    scene->Update(1.0f / 30.0f);
+    scene->Update(1.0f / 30.0f);
+
+    ASSERT_EQ(bulletCollisionCount, 1);
+    ASSERT_EQ(targetCollisionCount, 1);
+}
+
+TEST_F(EngineTests, Update_GivenStepDuration_StepsOncePerStepDuration)
+{
+    AfterCreatePtr<IMovableAabb2d> movableAabb;
+    SceneDefinition sceneDefinition;
+    sceneDefinition.StepDuration(1.0f / 30.0f);
+    sceneDefinition.AddMovableAabb2d(MovableAabb2dDefinition(&movableAabb, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), nullptr, std::any()));
+    auto scene = _engine.CreateScene(sceneDefinition);
+    movableAabb->Velocity(glm::vec2(30.0f, 0.0f));
+
+    scene->Update(1.0f / 60.0f);
+    ASSERT_EQ(movableAabb->Position(), glm::vec2(0.0f, 0.0f));
+
+    scene->Update(1.0f / 60.0f);
+    ASSERT_EQ(scene->StepDuration(), 1.0f / 30.0f);
+    ASSERT_NEAR(movableAabb->Position().x, 1.0f, 0.0001f);
+}
+
+TEST_F(EngineTests, ThreadCount_GivenZero_Throws)
+{
+    SceneDefinition sceneDefinition;
+
+    ASSERT_THROW(sceneDefinition.ThreadCount(0), std::invalid_argument);
+}
+
+TEST_F(EngineTests, GridCellSize_GivenZero_Throws)
+{
+    SceneDefinition sceneDefinition;
+
+    ASSERT_THROW(sceneDefinition.GridCellSize(0.0f), std::invalid_argument);
+}
+
+TEST_F(EngineTests, StepDuration_GivenZero_Throws)
+{
+    SceneDefinition sceneDefinition;
+
+    ASSERT_THROW(sceneDefinition.StepDuration(0.0f), std::invalid_argument);
+}
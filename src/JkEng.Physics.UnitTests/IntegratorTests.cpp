@@ -0,0 +1,143 @@
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "CpuFeatures.h"
+#include "Integrator.h"
+
+using namespace testing;
+using namespace JkEng::Physics;
+
+class IntegratorTests : public Test
+{
+public:
+    IntegratorTests()
+    {
+
+    }
+
+protected:
+    // Not a multiple of any SIMD width so the scalar tail is exercised.
+    static constexpr int AabbCount = 37;
+
+    static AabbStorage CreateRandomAabbs()
+    {
+        std::mt19937 random(8642);
+        std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+        AabbStorage aabbs;
+        for (int i = 0; i < AabbCount; i++)
+        {
+            glm::vec2 position(distribution(random), distribution(random));
+            glm::vec2 size(std::abs(distribution(random)), std::abs(distribution(random)));
+            glm::vec2 velocity(distribution(random), distribution(random));
+            glm::vec2 acceleration(distribution(random), distribution(random));
+            aabbs.Add(position, size, velocity, acceleration, nullptr, std::any());
+        }
+        return aabbs;
+    }
+
+    static std::vector<float> Flatten(const AabbStorage& aabbs)
+    {
+        std::vector<float> values;
+        for (auto array : { aabbs.MinX(), aabbs.MinY(), aabbs.MaxX(), aabbs.MaxY(), aabbs.VelocityX(), aabbs.VelocityY() })
+        {
+            values.insert(values.end(), array, array + aabbs.Count());
+        }
+        return values;
+    }
+};
+
+TEST_F(IntegratorTests, Integrate_GivenScalar_MovesCornersByVelocityAfterAddingAcceleration)
+{
+    AabbStorage aabbs;
+    aabbs.Add(glm::vec2(1.0f, 2.0f), glm::vec2(3.0f, 4.0f), glm::vec2(10.0f, 20.0f), glm::vec2(-5.0f, 2.0f), nullptr, std::any());
+    Integrator integrator(InstructionSet::Scalar);
+
+    integrator.Integrate(aabbs, 0.5f);
+
+    EXPECT_FLOAT_EQ(aabbs.VelocityX()[0], 7.5f);
+    EXPECT_FLOAT_EQ(aabbs.VelocityY()[0], 21.0f);
+    EXPECT_FLOAT_EQ(aabbs.MinX()[0], 1.0f + 3.75f);
+    EXPECT_FLOAT_EQ(aabbs.MinY()[0], 2.0f + 10.5f);
+    EXPECT_FLOAT_EQ(aabbs.MaxX()[0], 4.0f + 3.75f);
+    EXPECT_FLOAT_EQ(aabbs.MaxY()[0], 6.0f + 10.5f);
+}
+
+TEST_F(IntegratorTests, Integrate_GivenEachSupportedInstructionSet_MatchesScalarBitForBit)
+{
+    AabbStorage expected = CreateRandomAabbs();
+    Integrator scalar(InstructionSet::Scalar);
+    for (int step = 0; step < 10; step++)
+    {
+        scalar.Integrate(expected, 1.0f / 60.0f);
+    }
+
+    for (auto instructionSet : { InstructionSet::Sse2, InstructionSet::Avx2 })
+    {
+        if (!CpuFeatures::IsSupported(instructionSet))
+        {
+            continue;
+        }
+
+        AabbStorage actual = CreateRandomAabbs();
+        Integrator integrator(instructionSet);
+        for (int step = 0; step < 10; step++)
+        {
+            integrator.Integrate(actual, 1.0f / 60.0f);
+        }
+
+        ASSERT_EQ(Flatten(actual), Flatten(expected));
+    }
+}
+
+TEST_F(IntegratorTests, IntegrateAwake_GivenEachInstructionSet_LeavesSleepingAabbsAndMovesAwakeOnesLikeIntegrate)
+{
+    AabbStorage expected = CreateRandomAabbs();
+    AabbStorage initial = CreateRandomAabbs();
+    Integrator scalar(InstructionSet::Scalar);
+    scalar.Integrate(expected, 1.0f / 60.0f);
+
+    // Every third AABB sleeps.
+    auto sleepEveryThird = [](AabbStorage& aabbs)
+    {
+        for (uint32_t i = 0; i < aabbs.Count(); i += 3)
+        {
+            aabbs.IsAwake()[i] = 0;
+        }
+    };
+    sleepEveryThird(expected);
+    sleepEveryThird(initial);
+    auto expectedValues = Flatten(expected);
+    auto initialValues = Flatten(initial);
+    for (size_t value = 0; value < expectedValues.size(); value++)
+    {
+        if ((value % AabbCount) % 3 == 0)
+        {
+            expectedValues[value] = initialValues[value];
+        }
+    }
+
+    for (auto instructionSet : { InstructionSet::Scalar, InstructionSet::Sse2, InstructionSet::Avx2 })
+    {
+        if (!CpuFeatures::IsSupported(instructionSet))
+        {
+            continue;
+        }
+
+        AabbStorage actual = CreateRandomAabbs();
+        sleepEveryThird(actual);
+        Integrator integrator(instructionSet);
+        integrator.IntegrateAwake(actual, 0, actual.Count(), 1.0f / 60.0f);
+
+        ASSERT_EQ(Flatten(actual), expectedValues);
+    }
+}
+
+TEST_F(IntegratorTests, Constructor_GivenNoInstructionSet_SelectsBestSupported)
+{
+    Integrator integrator;
+
+    ASSERT_EQ(integrator.SelectedInstructionSet(), CpuFeatures::BestSupportedInstructionSet());
+    ASSERT_TRUE(CpuFeatures::IsSupported(integrator.SelectedInstructionSet()));
+}
@@ -0,0 +1,165 @@
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "CpuFeatures.h"
+#include "OverlapTester.h"
+
+using namespace testing;
+using namespace JkEng::Physics;
+
+class OverlapTesterTests : public Test
+{
+public:
+    OverlapTesterTests()
+    {
+
+    }
+
+protected:
+    static AabbStorage CreateRandomAabbs(int count)
+    {
+        std::mt19937 random(1357);
+        std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+        std::uniform_real_distribution<float> size(0.0f, 20.0f);
+        AabbStorage aabbs;
+        for (int i = 0; i < count; i++)
+        {
+            aabbs.Add(
+                glm::vec2(position(random), position(random)),
+                glm::vec2(size(random), size(random)),
+                glm::vec2(0.0f, 0.0f),
+                glm::vec2(0.0f, 0.0f),
+                nullptr,
+                std::any());
+        }
+        return aabbs;
+    }
+
+    static std::vector<uint32_t> Hits(
+        const OverlapTester& tester,
+        const Bounds& bounds,
+        CandidateBounds candidates,
+        uint32_t candidateCount)
+    {
+        std::vector<uint64_t> hitWords;
+        tester.Test(bounds, candidates, candidateCount, hitWords);
+
+        std::vector<uint32_t> hits;
+        OverlapTester::ForEachHit(hitWords.data(), candidateCount, [&](uint32_t hit)
+        {
+            hits.push_back(hit);
+        });
+        return hits;
+    }
+};
+
+TEST_F(OverlapTesterTests, Test_GivenScalar_HitsAreTheCandidatesThatOverlap)
+{
+    AabbStorage aabbs = CreateRandomAabbs(150);
+    OverlapTester tester(InstructionSet::Scalar);
+    Bounds bounds = { -10.0f, -10.0f, 10.0f, 10.0f };
+
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 0; i < aabbs.Count(); i++)
+    {
+        if (bounds.Overlaps(aabbs.BoundsOf(i)))
+        {
+            expected.push_back(i);
+        }
+    }
+
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(Hits(tester, bounds, CandidateBounds::Of(aabbs), aabbs.Count()), expected);
+}
+
+TEST_F(OverlapTesterTests, Test_GivenTouchingEdges_ReportsHit)
+{
+    AabbStorage aabbs;
+    aabbs.Add(1.0f, 2.0f, 0.0f, 1.0f, glm::vec2(0.0f), glm::vec2(0.0f), nullptr, std::any());
+    aabbs.Add(-1.0f, 0.0f, -1.0f, 0.0f, glm::vec2(0.0f), glm::vec2(0.0f), nullptr, std::any());
+    aabbs.Add(1.5f, 2.0f, 0.0f, 1.0f, glm::vec2(0.0f), glm::vec2(0.0f), nullptr, std::any());
+
+    for (auto instructionSet : { InstructionSet::Scalar, InstructionSet::Sse2, InstructionSet::Avx2 })
+    {
+        if (!CpuFeatures::IsSupported(instructionSet))
+        {
+            continue;
+        }
+
+        OverlapTester tester(instructionSet);
+        std::vector<uint32_t> expected = { 0, 1 };
+        ASSERT_EQ(Hits(tester, { 0.0f, 0.0f, 1.0f, 1.0f }, CandidateBounds::Of(aabbs), aabbs.Count()), expected);
+    }
+}
+
+TEST_F(OverlapTesterTests, Test_GivenEachSupportedInstructionSet_MatchesScalarForEveryCandidateCount)
+{
+    AabbStorage aabbs = CreateRandomAabbs(200);
+    OverlapTester scalar(InstructionSet::Scalar);
+    Bounds bounds = { -20.0f, -5.0f, 15.0f, 25.0f };
+
+    for (auto instructionSet : { InstructionSet::Sse2, InstructionSet::Avx2 })
+    {
+        if (!CpuFeatures::IsSupported(instructionSet))
+        {
+            continue;
+        }
+
+        OverlapTester tester(instructionSet);
+
+        // Covers empty, partial blocks, exact blocks and multiple words,
+        // starting at offsets that are not a multiple of the block size.
+        for (uint32_t offset : { 0u, 3u })
+        {
+            for (uint32_t count : { 0u, 1u, 7u, 8u, 9u, 63u, 64u, 65u, 128u, 197u })
+            {
+                auto candidates = CandidateBounds::Of(aabbs).Offset(offset);
+                ASSERT_EQ(Hits(tester, bounds, candidates, count), Hits(scalar, bounds, candidates, count))
+                    << "count " << count << " offset " << offset;
+            }
+        }
+    }
+}
+
+TEST_F(OverlapTesterTests, Test_GivenPackedCandidatesAfterSwapRemove_HitsFollowPackedOrder)
+{
+    AabbStorage aabbs = CreateRandomAabbs(20);
+    PackedCandidateBounds packed;
+    for (uint32_t i = 0; i < aabbs.Count(); i++)
+    {
+        packed.Add(aabbs, i);
+    }
+    packed.SwapRemove(2);
+
+    // Index 19 was moved into position 2.
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < aabbs.Count(); i++)
+    {
+        order.push_back(i);
+    }
+    order[2] = order.back();
+    order.pop_back();
+
+    OverlapTester tester;
+    Bounds bounds = { -30.0f, -30.0f, 0.0f, 0.0f };
+    std::vector<uint32_t> expected;
+    for (uint32_t position = 0; position < order.size(); position++)
+    {
+        if (bounds.Overlaps(aabbs.BoundsOf(order[position])))
+        {
+            expected.push_back(position);
+        }
+    }
+
+    ASSERT_EQ(packed.Count(), 19u);
+    ASSERT_EQ(Hits(tester, bounds, packed.Candidates(), packed.Count()), expected);
+}
+
+TEST_F(OverlapTesterTests, Constructor_GivenNoInstructionSet_SelectsBestSupported)
+{
+    OverlapTester tester;
+
+    ASSERT_EQ(tester.SelectedInstructionSet(), CpuFeatures::BestSupportedInstructionSet());
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "AllPairsBroadphase.h"
+#include "DynamicTreeBroadphase.h"
+#include "PartitionedBroadphase.h"
+#include "SweepAndPruneBroadphase.h"
+#include "UniformGridBroadphase.h"
+#include "WorkerPool.h"
+
+using namespace testing;
+using namespace JkEng::Physics;
+
+class PartitionedBroadphaseTests : public Test
+{
+public:
+    PartitionedBroadphaseTests()
+    {
+
+    }
+
+protected:
+    static constexpr uint32_t PlayerCategory = 0x1;
+    static constexpr uint32_t BulletCategory = 0x2;
+    static constexpr uint32_t PickupCategory = 0x4;
+
+    AabbStorage _aabbs;
+
+    // Players collide with everything, bullets with everything but
+    // bullets and pickups only with players.
+    void AddRandomAabbs(std::mt19937& random, int count)
+    {
+        std::uniform_real_distribution<float> positionDistribution(-150.0f, 150.0f);
+        std::uniform_real_distribution<float> sizeDistribution(0.5f, 10.0f);
+        std::uniform_int_distribution<int> kindDistribution(0, 2);
+        for (int i = 0; i < count; i++)
+        {
+            uint32_t index = _aabbs.Add(
+                glm::vec2(positionDistribution(random), positionDistribution(random)),
+                glm::vec2(sizeDistribution(random), sizeDistribution(random)),
+                glm::vec2(), glm::vec2(), nullptr, std::any());
+            switch (kindDistribution(random))
+            {
+                case 0:
+                    _aabbs.CollisionCategory()[index] = PlayerCategory;
+                    _aabbs.CollisionMask()[index] = DefaultCollisionMask;
+                    break;
+                case 1:
+                    _aabbs.CollisionCategory()[index] = BulletCategory;
+                    _aabbs.CollisionMask()[index] = ~BulletCategory;
+                    break;
+                default:
+                    _aabbs.CollisionCategory()[index] = PickupCategory;
+                    _aabbs.CollisionMask()[index] = PlayerCategory;
+                    break;
+            }
+        }
+    }
+
+    static std::vector<std::unique_ptr<IBroadphase>> CreateEachPartitionedBroadphase()
+    {
+        std::vector<std::unique_ptr<IBroadphase>> broadphases;
+        broadphases.push_back(std::make_unique<PartitionedBroadphase>([] { return std::make_unique<AllPairsBroadphase>(); }));
+        broadphases.push_back(std::make_unique<PartitionedBroadphase>([] { return std::make_unique<UniformGridBroadphase>(8.0f); }));
+        broadphases.push_back(std::make_unique<PartitionedBroadphase>([] { return std::make_unique<SweepAndPruneBroadphase>(SweepAndPruneAxes::Both); }));
+        broadphases.push_back(std::make_unique<PartitionedBroadphase>([] { return std::make_unique<DynamicTreeBroadphase>(1.0f); }));
+        return broadphases;
+    }
+
+    static std::vector<OverlappingPair> FindSortedPairs(IBroadphase& broadphase, const AabbStorage& aabbs)
+    {
+        std::vector<OverlappingPair> pairs;
+        broadphase.FindOverlappingPairs(aabbs, pairs);
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+    static std::vector<OverlappingPair> FindSortedPairs(IBroadphase& broadphase, const AabbStorage& aabbs, WorkerPool& workers)
+    {
+        std::vector<std::vector<OverlappingPair>> pairsPerWorker(workers.WorkerCount());
+        broadphase.FindOverlappingPairs(aabbs, workers, pairsPerWorker);
+
+        std::vector<OverlappingPair> pairs;
+        for (auto& workerPairs : pairsPerWorker)
+        {
+            pairs.insert(pairs.end(), workerPairs.begin(), workerPairs.end());
+        }
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+};
+
+TEST_F(PartitionedBroadphaseTests, FindOverlappingPairs_GivenFilteredAabbsMovingAround_ReportsSamePairsAsAllPairs)
+{
+    std::mt19937 random(4321);
+    AddRandomAabbs(random, 800);
+    AllPairsBroadphase allPairs;
+    auto broadphases = CreateEachPartitionedBroadphase();
+    WorkerPool workers(3);
+
+    std::uniform_real_distribution<float> moveDistribution(-3.0f, 3.0f);
+    for (int step = 0; step < 3; step++)
+    {
+        auto expectedPairs = FindSortedPairs(allPairs, _aabbs);
+        ASSERT_FALSE(expectedPairs.empty());
+        for (auto& broadphase : broadphases)
+        {
+            ASSERT_EQ(FindSortedPairs(*broadphase, _aabbs), expectedPairs);
+            ASSERT_EQ(FindSortedPairs(*broadphase, _aabbs, workers), expectedPairs);
+        }
+
+        for (uint32_t i = 0; i < _aabbs.Count(); i++)
+        {
+            float moveX = moveDistribution(random);
+            float moveY = moveDistribution(random);
+            _aabbs.MinX()[i] += moveX;
+            _aabbs.MaxX()[i] += moveX;
+            _aabbs.MinY()[i] += moveY;
+            _aabbs.MaxY()[i] += moveY;
+        }
+    }
+}
+
+TEST_F(PartitionedBroadphaseTests, FindOverlappingPairs_GivenPairsOfOneCategoryThatIgnoresItself_ReportsNoPairs)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        uint32_t index = _aabbs.Add(glm::vec2(i * 0.5f, 0.0f), glm::vec2(1.0f, 1.0f), glm::vec2(), glm::vec2(), nullptr, std::any());
+        _aabbs.CollisionCategory()[index] = BulletCategory;
+        _aabbs.CollisionMask()[index] = ~BulletCategory;
+    }
+    PartitionedBroadphase broadphase([] { return std::make_unique<AllPairsBroadphase>(); });
+
+    ASSERT_TRUE(FindSortedPairs(broadphase, _aabbs).empty());
+}
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "StaticAabbTree.h"
+
+using namespace testing;
+using namespace JkEng::Physics;
+
+class StaticAabbTreeTests : public Test
+{
+public:
+    StaticAabbTreeTests()
+    {
+
+    }
+
+protected:
+    AabbStorage _movableAabbs;
+    std::vector<StaticAabb2dDefinition> _staticDefinitions;
+
+    void AddRandomAabbs(std::mt19937& random, int movableCount, int staticCount)
+    {
+        std::uniform_real_distribution<float> positionDistribution(-200.0f, 200.0f);
+        std::uniform_real_distribution<float> sizeDistribution(0.5f, 12.0f);
+        for (int i = 0; i < movableCount; i++)
+        {
+            _movableAabbs.Add(
+                glm::vec2(positionDistribution(random), positionDistribution(random)),
+                glm::vec2(sizeDistribution(random), sizeDistribution(random)),
+                glm::vec2(), glm::vec2(), nullptr, std::any());
+        }
+        for (int i = 0; i < staticCount; i++)
+        {
+            _staticDefinitions.emplace_back(
+                glm::vec2(positionDistribution(random), positionDistribution(random)),
+                glm::vec2(sizeDistribution(random), sizeDistribution(random)),
+                std::any());
+        }
+    }
+};
+
+TEST_F(StaticAabbTreeTests, FindOverlappingPairs_GivenRandomAabbs_ReportsSamePairsAsTestingEveryPair)
+{
+    std::mt19937 random(9753);
+    AddRandomAabbs(random, 300, 700);
+    StaticAabbTree tree(_staticDefinitions);
+
+    std::vector<OverlappingPair> expectedPairs;
+    for (uint32_t i = 0; i < _movableAabbs.Count(); i++)
+    {
+        for (uint32_t j = 0; j < tree.Aabbs().Count(); j++)
+        {
+            if (_movableAabbs.BoundsOf(i).Overlaps(tree.Aabbs().BoundsOf(j)))
+            {
+                expectedPairs.push_back({ i, j });
+            }
+        }
+    }
+
+    std::vector<int32_t> stack;
+    std::vector<OverlappingPair> actualPairs;
+    tree.FindOverlappingPairs(_movableAabbs, 0, _movableAabbs.Count(), stack, actualPairs);
+    std::sort(actualPairs.begin(), actualPairs.end());
+
+    ASSERT_FALSE(expectedPairs.empty());
+    ASSERT_EQ(actualPairs, expectedPairs);
+}
+
+TEST_F(StaticAabbTreeTests, FindOverlappingPairs_GivenNoStaticAabbs_ReportsNoPairs)
+{
+    std::mt19937 random(1);
+    AddRandomAabbs(random, 50, 0);
+    StaticAabbTree tree(_staticDefinitions);
+
+    std::vector<int32_t> stack;
+    std::vector<OverlappingPair> pairs;
+    tree.FindOverlappingPairs(_movableAabbs, 0, _movableAabbs.Count(), stack, pairs);
+
+    ASSERT_TRUE(pairs.empty());
+}
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Aabb.h"
+#include "AllPairsBroadphase.h"
+#include "SweepAndPruneBroadphase.h"
+#include "WorkerPool.h"
+
+using namespace testing;
+using namespace JkEng::Physics;
+
+class SweepAndPruneBroadphaseTests : public Test
+{
+public:
+    SweepAndPruneBroadphaseTests()
+    {
+
+    }
+
+protected:
+    AabbStorage _aabbs;
+
+    void AddAabb(glm::vec2 position, glm::vec2 size)
+    {
+        _aabbs.Add(position, size, glm::vec2(), glm::vec2(), nullptr, std::any());
+    }
+
+    void AddRandomAabbs(int count)
+    {
+        std::mt19937 random(4321);
+        std::uniform_real_distribution<float> positionDistribution(-200.0f, 200.0f);
+        std::uniform_real_distribution<float> sizeDistribution(0.5f, 40.0f);
+        for (int i = 0; i < count; i++)
+        {
+            AddAabb(
+                glm::vec2(positionDistribution(random), positionDistribution(random)),
+                glm::vec2(sizeDistribution(random), sizeDistribution(random)));
+        }
+    }
+
+    static std::vector<OverlappingPair> FindSortedPairs(IBroadphase& broadphase, const AabbStorage& aabbs)
+    {
+        std::vector<OverlappingPair> pairs;
+        broadphase.FindOverlappingPairs(aabbs, pairs);
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+    static std::vector<OverlappingPair> FindSortedPairs(IBroadphase& broadphase, const AabbStorage& aabbs, WorkerPool& workers)
+    {
+        std::vector<std::vector<OverlappingPair>> pairsPerWorker(workers.WorkerCount());
+        broadphase.FindOverlappingPairs(aabbs, workers, pairsPerWorker);
+
+        std::vector<OverlappingPair> pairs;
+        for (auto& workerPairs : pairsPerWorker)
+        {
+            pairs.insert(pairs.end(), workerPairs.begin(), workerPairs.end());
+        }
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+};
+
+TEST_F(SweepAndPruneBroadphaseTests, FindOverlappingPairs_GivenAabbsOnlyTouchingEdges_ReportsPair)
+{
+    AddAabb(glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f));
+    AddAabb(glm::vec2(1.0f, 0.0f), glm::vec2(1.0f, 1.0f));
+    SweepAndPruneBroadphase broadphase(SweepAndPruneAxes::X);
+
+    auto pairs = FindSortedPairs(broadphase, _aabbs);
+
+    ASSERT_EQ(pairs.size(), 1u);
+    EXPECT_EQ(pairs[0].index0, 0u);
+    EXPECT_EQ(pairs[0].index1, 1u);
+}
+
+TEST_F(SweepAndPruneBroadphaseTests, FindOverlappingPairs_GivenAabbsOverlappingOnSweptAxisOnly_ReportsNoPairs)
+{
+    AddAabb(glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f));
+    AddAabb(glm::vec2(0.5f, 5.0f), glm::vec2(1.0f, 1.0f));
+    SweepAndPruneBroadphase broadphase(SweepAndPruneAxes::X);
+
+    auto pairs = FindSortedPairs(broadphase, _aabbs);
+
+    ASSERT_TRUE(pairs.empty());
+}
+
+TEST_F(SweepAndPruneBroadphaseTests, FindOverlappingPairs_GivenAabbsMovedBetweenCalls_ReportsSamePairsAsAllPairsForEachAxes)
+{
+    AllPairsBroadphase allPairs;
+
+    for (auto axes : { SweepAndPruneAxes::X, SweepAndPruneAxes::Y, SweepAndPruneAxes::Both })
+    {
+        _aabbs = AabbStorage();
+        AddRandomAabbs(300);
+        SweepAndPruneBroadphase sweepAndPrune(axes);
+        std::mt19937 random(99);
+        std::uniform_real_distribution<float> moveDistribution(-3.0f, 3.0f);
+
+        // Move the AABBs a little between calls so the persisted endpoint
+        // lists have to be re-sorted.
+        for (int call = 0; call < 10; call++)
+        {
+            for (uint32_t i = 0; i < _aabbs.Count(); i++)
+            {
+                Aabb aabb(_aabbs, i);
+                aabb.Position(aabb.Position() + glm::vec2(moveDistribution(random), moveDistribution(random)));
+            }
+
+            auto expectedPairs = FindSortedPairs(allPairs, _aabbs);
+            auto actualPairs = FindSortedPairs(sweepAndPrune, _aabbs);
+
+            ASSERT_FALSE(expectedPairs.empty());
+            ASSERT_EQ(actualPairs, expectedPairs);
+        }
+    }
+}
+
+TEST_F(SweepAndPruneBroadphaseTests, FindOverlappingPairs_GivenAabbsAddedAndRemovedBetweenCalls_ReportsSamePairsAsAllPairsForEachAxes)
+{
+    AllPairsBroadphase allPairs;
+
+    for (auto axes : { SweepAndPruneAxes::X, SweepAndPruneAxes::Y, SweepAndPruneAxes::Both })
+    {
+        _aabbs = AabbStorage();
+        AddRandomAabbs(300);
+        SweepAndPruneBroadphase sweepAndPrune(axes);
+        std::mt19937 random(77);
+        std::uniform_real_distribution<float> positionDistribution(-200.0f, 200.0f);
+
+        // Several removals between calls, including of AABBs added since
+        // the last call and of the last AABB, leave endpoints of removed
+        // AABBs and renamed ones for the next sort to sort out.
+        for (int call = 0; call < 10; call++)
+        {
+            for (int change = 0; change < 20; change++)
+            {
+                uint32_t lastIndex = _aabbs.Count() - 1;
+                uint32_t index = change % 5 == 0
+                    ? lastIndex
+                    : std::uniform_int_distribution<uint32_t>(0, lastIndex)(random);
+                _aabbs.SwapRemove(index);
+                sweepAndPrune.AabbRemoved(_aabbs, index, lastIndex);
+
+                AddAabb(glm::vec2(positionDistribution(random), positionDistribution(random)), glm::vec2(10.0f, 10.0f));
+                sweepAndPrune.AabbAdded(_aabbs, _aabbs.Count() - 1);
+            }
+
+            auto expectedPairs = FindSortedPairs(allPairs, _aabbs);
+            auto actualPairs = FindSortedPairs(sweepAndPrune, _aabbs);
+
+            ASSERT_FALSE(expectedPairs.empty());
+            ASSERT_EQ(actualPairs, expectedPairs);
+        }
+    }
+}
+
+TEST_F(SweepAndPruneBroadphaseTests, FindOverlappingPairs_GivenWorkerPool_ReportsSamePairsAsAllPairsForEachAxes)
+{
+    AllPairsBroadphase allPairs;
+    WorkerPool workers(4);
+
+    for (auto axes : { SweepAndPruneAxes::X, SweepAndPruneAxes::Y, SweepAndPruneAxes::Both })
+    {
+        _aabbs = AabbStorage();
+        AddRandomAabbs(1500);
+        SweepAndPruneBroadphase sweepAndPrune(axes);
+
+        auto expectedPairs = FindSortedPairs(allPairs, _aabbs);
+        auto actualPairs = FindSortedPairs(sweepAndPrune, _aabbs, workers);
+
+        ASSERT_FALSE(expectedPairs.empty());
+        ASSERT_EQ(actualPairs, expectedPairs);
+        ASSERT_EQ(FindSortedPairs(allPairs, _aabbs, workers), expectedPairs);
+    }
+}
+
+TEST_F(SweepAndPruneBroadphaseTests, FindOverlappingPairs_GivenSomeAabbsAsleep_ReportsSamePairsAsAllPairsForEachAxes)
+{
+    AllPairsBroadphase allPairs;
+    WorkerPool workers(4);
+
+    for (auto axes : { SweepAndPruneAxes::X, SweepAndPruneAxes::Y, SweepAndPruneAxes::Both })
+    {
+        _aabbs = AabbStorage();
+        AddRandomAabbs(1500);
+        SweepAndPruneBroadphase sweepAndPrune(axes);
+        SweepAndPruneBroadphase sweepAndPruneWithWorkers(axes);
+        std::mt19937 random(246);
+        std::uniform_real_distribution<float> moveDistribution(-3.0f, 3.0f);
+
+        // Most AABBs asleep, so pairs of sleeping ones would dominate if
+        // they were tested.
+        for (int call = 0; call < 5; call++)
+        {
+            for (uint32_t i = 0; i < _aabbs.Count(); i++)
+            {
+                _aabbs.IsAwake()[i] = std::uniform_int_distribution<int>(0, 9)(random) == 0;
+                if (_aabbs.IsAwake()[i])
+                {
+                    Aabb aabb(_aabbs, i);
+                    aabb.Position(aabb.Position() + glm::vec2(moveDistribution(random), moveDistribution(random)));
+                }
+            }
+
+            auto expectedPairs = FindSortedPairs(allPairs, _aabbs);
+            auto actualPairs = FindSortedPairs(sweepAndPrune, _aabbs);
+            auto actualPairsWithWorkers = FindSortedPairs(sweepAndPruneWithWorkers, _aabbs, workers);
+
+            ASSERT_FALSE(expectedPairs.empty());
+            ASSERT_EQ(actualPairs, expectedPairs);
+            ASSERT_EQ(actualPairsWithWorkers, expectedPairs);
+        }
+    }
+}
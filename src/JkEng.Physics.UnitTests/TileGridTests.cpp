@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "TileGrid.h"
+
+using namespace testing;
+using namespace JkEng::Physics;
+
+class TileGridTests : public Test
+{
+public:
+    TileGridTests()
+    {
+
+    }
+
+protected:
+    // Rows that are not a multiple of 64 cells wide so rows start part way
+    // through a word.
+    static constexpr uint32_t Columns = 37;
+    static constexpr uint32_t Rows = 23;
+    static constexpr float CellSize = 1.5f;
+    const glm::vec2 GridPosition = glm::vec2(-10.0f, 5.0f);
+
+    TileGridDefinition CreateRandomDefinition(std::mt19937& random)
+    {
+        std::bernoulli_distribution isSolidDistribution(0.1);
+        TileGridDefinition definition(GridPosition, Columns, Rows, CellSize, std::any());
+        for (uint32_t row = 0; row < Rows; row++)
+        {
+            for (uint32_t column = 0; column < Columns; column++)
+            {
+                definition.SetSolid(column, row, isSolidDistribution(random));
+            }
+        }
+        return definition;
+    }
+
+    // Half of the bounds have edges exactly on cell edges.
+    Bounds RandomBounds(std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> positionDistribution(-15.0f, 55.0f);
+        std::uniform_real_distribution<float> sizeDistribution(0.0f, 5.0f);
+        std::uniform_int_distribution<int> cellDistribution(-3, 40);
+        std::bernoulli_distribution onCellEdgeDistribution(0.5);
+        if (onCellEdgeDistribution(random))
+        {
+            float minX = GridPosition.x + cellDistribution(random) * CellSize;
+            float minY = GridPosition.y + cellDistribution(random) * CellSize;
+            return { minX, minY, minX + CellSize * (cellDistribution(random) % 3), minY + CellSize * (cellDistribution(random) % 3) };
+        }
+
+        float minX = positionDistribution(random);
+        float minY = positionDistribution(random);
+        return { minX, minY, minX + sizeDistribution(random), minY + sizeDistribution(random) };
+    }
+
+    static Bounds CellBounds(const TileGridDefinition& definition, uint32_t column, uint32_t row)
+    {
+        float minX = definition.Position().x + column * definition.CellSize();
+        float minY = definition.Position().y + row * definition.CellSize();
+        return { minX, minY, minX + definition.CellSize(), minY + definition.CellSize() };
+    }
+};
+
+TEST_F(TileGridTests, Overlaps_GivenRandomBounds_MatchesTestingEverySolidCellAsAnAabb)
+{
+    std::mt19937 random(42);
+    TileGridDefinition definition = CreateRandomDefinition(random);
+    TileGrid tileGrid(definition);
+
+    for (int i = 0; i < 2000; i++)
+    {
+        Bounds bounds = RandomBounds(random);
+        bool expected = false;
+        for (uint32_t row = 0; row < Rows; row++)
+        {
+            for (uint32_t column = 0; column < Columns; column++)
+            {
+                expected |= definition.IsSolid(column, row) && CellBounds(definition, column, row).Overlaps(bounds);
+            }
+        }
+
+        ASSERT_EQ(tileGrid.Overlaps(bounds), expected) << "Iteration " << i;
+    }
+}
+
+TEST_F(TileGridTests, OverlapsWhileMoving_GivenRandomMoves_MatchesTestingEverySolidCellAsAnAabb)
+{
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> deltaDistribution(-20.0f, 20.0f);
+    TileGridDefinition definition = CreateRandomDefinition(random);
+    TileGrid tileGrid(definition);
+
+    for (int i = 0; i < 2000; i++)
+    {
+        Bounds bounds = RandomBounds(random);
+        float deltaX = deltaDistribution(random);
+        float deltaY = i % 4 == 0 ? 0.0f : deltaDistribution(random);
+        bool expected = false;
+        for (uint32_t row = 0; row < Rows; row++)
+        {
+            for (uint32_t column = 0; column < Columns; column++)
+            {
+                expected |= definition.IsSolid(column, row)
+                    && bounds.OverlapsWhileMoving(CellBounds(definition, column, row), deltaX, deltaY);
+            }
+        }
+
+        ASSERT_EQ(tileGrid.OverlapsWhileMoving(bounds, deltaX, deltaY), expected) << "Iteration " << i;
+    }
+}
+
+TEST_F(TileGridTests, FindOverlappingPairs_GivenSleepingAndFilteredAabbs_OnlyPairsAwakeAabbsTouchingSolidCells)
+{
+    TileGridDefinition definition(glm::vec2(0.0f, 0.0f), 4, 1, 1.0f, std::any());
+    definition.SetSolid(1, 0);
+    definition.CollisionFilter(0x1, 0x1);
+    TileGrid tileGrid(definition);
+
+    AabbStorage movableAabbs;
+    movableAabbs.Add(glm::vec2(1.2f, 0.2f), glm::vec2(0.5f, 0.5f), glm::vec2(), glm::vec2(), nullptr, std::any());
+    movableAabbs.Add(glm::vec2(2.0f, 0.2f), glm::vec2(0.5f, 0.5f), glm::vec2(), glm::vec2(), nullptr, std::any());
+    movableAabbs.Add(glm::vec2(3.2f, 0.2f), glm::vec2(0.5f, 0.5f), glm::vec2(), glm::vec2(), nullptr, std::any());
+    movableAabbs.Add(glm::vec2(1.2f, 0.2f), glm::vec2(0.5f, 0.5f), glm::vec2(), glm::vec2(), nullptr, std::any());
+    movableAabbs.Add(glm::vec2(1.2f, 0.2f), glm::vec2(0.5f, 0.5f), glm::vec2(), glm::vec2(), nullptr, std::any());
+    movableAabbs.IsAwake()[3] = 0;
+    movableAabbs.CollisionCategory()[4] = 0x2;
+
+    std::vector<OverlappingPair> pairs;
+    tileGrid.FindOverlappingPairs(movableAabbs, 0, movableAabbs.Count(), 7, pairs);
+
+    // The second AABB only shares an edge with the solid cell.
+    std::vector<OverlappingPair> expectedPairs = { { 0, 7 }, { 1, 7 } };
+    ASSERT_EQ(pairs, expectedPairs);
+}
+
+TEST_F(TileGridTests, TileGridDefinition_GivenCellOutsideGridOrWrongNumberOfWords_Throws)
+{
+    TileGridDefinition definition(glm::vec2(0.0f, 0.0f), 65, 2, 1.0f, std::any());
+
+    ASSERT_THROW(definition.SetSolid(65, 0), std::out_of_range);
+    ASSERT_THROW(definition.IsSolid(0, 2), std::out_of_range);
+    ASSERT_THROW(definition.SolidBits(std::vector<uint64_t>(2)), std::invalid_argument);
+    ASSERT_THROW(TileGridDefinition(glm::vec2(), 1, 1, 0.0f, std::any()), std::invalid_argument);
+
+    definition.SolidBits(std::vector<uint64_t>(3, ~0ull));
+    ASSERT_TRUE(definition.IsSolid(64, 1));
+}
+
+TEST_F(TileGridTests, Raycast_GivenRandomRays_FindsSameFirstSolidCellAsTestingEveryCell)
+{
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> originDistribution(-15.0f, 55.0f);
+    std::uniform_real_distribution<float> deltaDistribution(-40.0f, 40.0f);
+    TileGridDefinition definition = CreateRandomDefinition(random);
+    TileGrid tileGrid(definition);
+
+    for (int i = 0; i < 2000; i++)
+    {
+        float originX = originDistribution(random);
+        float originY = originDistribution(random);
+        float deltaX = i % 8 == 0 ? 0.0f : deltaDistribution(random);
+        float deltaY = i % 8 == 1 ? 0.0f : deltaDistribution(random);
+        Bounds origin = { originX, originY, originX, originY };
+        bool expectedHit = false;
+        float expectedFraction = 2.0f;
+        for (uint32_t row = 0; row < Rows; row++)
+        {
+            for (uint32_t column = 0; column < Columns; column++)
+            {
+                float fraction;
+                if (definition.IsSolid(column, row)
+                    && origin.OverlapsWhileMoving(CellBounds(definition, column, row), deltaX, deltaY, fraction))
+                {
+                    expectedHit = true;
+                    expectedFraction = std::min(expectedFraction, fraction);
+                }
+            }
+        }
+
+        float fraction = -1.0f;
+        ASSERT_EQ(tileGrid.Raycast(originX, originY, deltaX, deltaY, fraction), expectedHit) << "Iteration " << i;
+        if (expectedHit)
+        {
+            ASSERT_NEAR(fraction, expectedFraction, 0.0001f) << "Iteration " << i;
+        }
+    }
+}
+
+TEST_F(TileGridTests, DistanceSquaredToSolidCell_GivenRandomPoints_MatchesClosestOfEverySolidCell)
+{
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> positionDistribution(-30.0f, 70.0f);
+    TileGridDefinition definition = CreateRandomDefinition(random);
+    TileGrid tileGrid(definition);
+
+    for (int i = 0; i < 2000; i++)
+    {
+        float x = positionDistribution(random);
+        float y = positionDistribution(random);
+        float expected = std::numeric_limits<float>::infinity();
+        for (uint32_t row = 0; row < Rows; row++)
+        {
+            for (uint32_t column = 0; column < Columns; column++)
+            {
+                if (definition.IsSolid(column, row))
+                {
+                    expected = std::min(expected, CellBounds(definition, column, row).DistanceSquaredTo(x, y));
+                }
+            }
+        }
+
+        ASSERT_EQ(tileGrid.DistanceSquaredToSolidCell(x, y, std::numeric_limits<float>::infinity()), expected) << "Iteration " << i;
+        ASSERT_EQ(tileGrid.DistanceSquaredToSolidCell(x, y, expected), expected) << "Iteration " << i;
+        if (expected > 0.0f)
+        {
+            ASSERT_EQ(tileGrid.DistanceSquaredToSolidCell(x, y, expected * 0.99f), std::numeric_limits<float>::infinity()) << "Iteration " << i;
+        }
+    }
+}
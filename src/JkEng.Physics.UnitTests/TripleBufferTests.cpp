@@ -0,0 +1,84 @@
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "TripleBuffer.h"
+
+using namespace testing;
+using namespace JkEng::Physics;
+
+class TripleBufferTests : public Test
+{
+public:
+    TripleBufferTests()
+    {
+
+    }
+};
+
+TEST_F(TripleBufferTests, Front_GivenNothingPublished_ReturnsDefaultValue)
+{
+    TripleBuffer<int> buffer;
+
+    ASSERT_EQ(buffer.Front(), 0);
+}
+
+TEST_F(TripleBufferTests, Front_GivenSeveralPublishedSinceLastRead_ReturnsLastAndKeepsItUntilNextPublish)
+{
+    TripleBuffer<int> buffer;
+    for (int value = 1; value <= 5; value++)
+    {
+        buffer.Back() = value;
+        buffer.Publish();
+    }
+
+    ASSERT_EQ(buffer.Front(), 5);
+    ASSERT_EQ(buffer.Front(), 5);
+
+    buffer.Back() = 6;
+    ASSERT_EQ(buffer.Front(), 5);
+    buffer.Publish();
+    ASSERT_EQ(buffer.Front(), 6);
+}
+
+TEST_F(TripleBufferTests, Front_GivenWriterOnAnotherThread_NeverSeesPartlyWrittenOrOlderValues)
+{
+    // Every element of a published value is the same, so a value the
+    // writer was still filling in would show up as a mix.
+    typedef std::array<uint64_t, 64> Value;
+    constexpr uint64_t PublishCount = 200000;
+    TripleBuffer<Value> buffer;
+    std::atomic<bool> isWriting = true;
+
+    std::thread writer([&]
+    {
+        for (uint64_t i = 1; i <= PublishCount; i++)
+        {
+            buffer.Back().fill(i);
+            buffer.Publish();
+        }
+        isWriting = false;
+    });
+
+    uint64_t lastSeen = 0;
+    bool wasTorn = false;
+    bool wentBackwards = false;
+    while (isWriting || lastSeen != PublishCount)
+    {
+        const Value& value = buffer.Front();
+        for (uint64_t element : value)
+        {
+            wasTorn |= element != value[0];
+        }
+        wentBackwards |= value[0] < lastSeen;
+        lastSeen = value[0];
+    }
+    writer.join();
+
+    ASSERT_FALSE(wasTorn);
+    ASSERT_FALSE(wentBackwards);
+    ASSERT_EQ(lastSeen, PublishCount);
+}
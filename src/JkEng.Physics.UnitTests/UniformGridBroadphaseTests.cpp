@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Aabb.h"
+#include "AllPairsBroadphase.h"
+#include "UniformGridBroadphase.h"
+#include "WorkerPool.h"
+
+using namespace testing;
+using namespace JkEng::Physics;
+
+class UniformGridBroadphaseTests : public Test
+{
+public:
+    UniformGridBroadphaseTests()
+    {
+
+    }
+
+protected:
+    AabbStorage _aabbs;
+
+    void AddAabb(glm::vec2 position, glm::vec2 size)
+    {
+        _aabbs.Add(position, size, glm::vec2(), glm::vec2(), nullptr, std::any());
+    }
+
+    static std::vector<OverlappingPair> FindSortedPairs(IBroadphase& broadphase, const AabbStorage& aabbs)
+    {
+        std::vector<OverlappingPair> pairs;
+        broadphase.FindOverlappingPairs(aabbs, pairs);
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+    static std::vector<OverlappingPair> FindSortedPairs(IBroadphase& broadphase, const AabbStorage& aabbs, WorkerPool& workers)
+    {
+        std::vector<std::vector<OverlappingPair>> pairsPerWorker(workers.WorkerCount());
+        broadphase.FindOverlappingPairs(aabbs, workers, pairsPerWorker);
+
+        std::vector<OverlappingPair> pairs;
+        for (auto& workerPairs : pairsPerWorker)
+        {
+            pairs.insert(pairs.end(), workerPairs.begin(), workerPairs.end());
+        }
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+};
+
+TEST_F(UniformGridBroadphaseTests, FindOverlappingPairs_GivenTwoAabbsSharingManyCells_ReportsPairExactlyOnce)
+{
+    AddAabb(glm::vec2(0.0f, 0.0f), glm::vec2(10.0f, 10.0f));
+    AddAabb(glm::vec2(1.0f, 1.0f), glm::vec2(10.0f, 10.0f));
+    UniformGridBroadphase broadphase(1.0f);
+
+    auto pairs = FindSortedPairs(broadphase, _aabbs);
+
+    ASSERT_EQ(pairs.size(), 1u);
+    EXPECT_EQ(pairs[0].index0, 0u);
+    EXPECT_EQ(pairs[0].index1, 1u);
+}
+
+TEST_F(UniformGridBroadphaseTests, FindOverlappingPairs_GivenAabbsInNeighbouringCellsThatDoNotOverlap_ReportsNoPairs)
+{
+    AddAabb(glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f));
+    AddAabb(glm::vec2(1.5f, 0.0f), glm::vec2(1.0f, 1.0f));
+    AddAabb(glm::vec2(0.0f, 1.5f), glm::vec2(1.0f, 1.0f));
+    UniformGridBroadphase broadphase(2.0f);
+
+    auto pairs = FindSortedPairs(broadphase, _aabbs);
+
+    ASSERT_TRUE(pairs.empty());
+}
+
+TEST_F(UniformGridBroadphaseTests, FindOverlappingPairs_GivenAabbsTouchingAcrossCellBoundaryAtNegativeCoordinates_ReportsPair)
+{
+    AddAabb(glm::vec2(-3.0f, -3.0f), glm::vec2(1.0f, 1.0f));
+    AddAabb(glm::vec2(-2.0f, -2.0f), glm::vec2(1.0f, 1.0f));
+    UniformGridBroadphase broadphase(2.0f);
+
+    auto pairs = FindSortedPairs(broadphase, _aabbs);
+
+    ASSERT_EQ(pairs.size(), 1u);
+}
+
+TEST_F(UniformGridBroadphaseTests, FindOverlappingPairs_GivenAabbsCoveringMillionsOfCellsAwakeAndAsleep_ReportsSamePairsAsAllPairs)
+{
+    std::mt19937 random(4321);
+    std::uniform_real_distribution<float> positionDistribution(-50.0f, 50.0f);
+    for (int i = 0; i < 300; i++)
+    {
+        AddAabb(glm::vec2(positionDistribution(random), positionDistribution(random)), glm::vec2(1.0f, 1.0f));
+    }
+    AddAabb(glm::vec2(-1.0e6f, -1.0e6f), glm::vec2(2.0e6f, 2.0e6f));
+    AddAabb(glm::vec2(-1.0e6f, 0.0f), glm::vec2(2.0e6f, 0.5f));
+    AddAabb(glm::vec2(0.0f, -1.0e6f), glm::vec2(0.5f, 2.0e6f));
+    AddAabb(glm::vec2(-30.0f, -30.0f), glm::vec2(60.0f, 60.0f));
+    for (uint32_t i = 0; i < _aabbs.Count(); i += 3)
+    {
+        _aabbs.IsAwake()[i] = 0;
+    }
+    AllPairsBroadphase allPairs;
+    UniformGridBroadphase grid(1.0f);
+    UniformGridBroadphase gridWithWorkers(1.0f);
+    WorkerPool workers(4);
+
+    auto expectedPairs = FindSortedPairs(allPairs, _aabbs);
+
+    ASSERT_FALSE(expectedPairs.empty());
+    ASSERT_EQ(FindSortedPairs(grid, _aabbs), expectedPairs);
+    ASSERT_EQ(FindSortedPairs(gridWithWorkers, _aabbs, workers), expectedPairs);
+}
+
+TEST_F(UniformGridBroadphaseTests, FindOverlappingPairs_GivenAabbsFarOutsideCellRange_ReportsSamePairsAsAllPairs)
+{
+    AddAabb(glm::vec2(1.0e12f, 1.0e12f), glm::vec2(1.0e6f, 1.0e6f));
+    AddAabb(glm::vec2(1.0e12f + 5.0e5f, 1.0e12f), glm::vec2(1.0e6f, 1.0e6f));
+    AddAabb(glm::vec2(2.0e12f, 1.0e12f), glm::vec2(1.0e6f, 1.0e6f));
+    AddAabb(glm::vec2(-1.0e30f, -1.0e30f), glm::vec2(1.0e24f, 1.0e24f));
+    AddAabb(glm::vec2(-1.0e30f, -1.0e30f), glm::vec2(1.0e24f, 1.0e24f));
+    AddAabb(glm::vec2(3.0e38f, 0.0f), glm::vec2(1.0f, 1.0f));
+    AddAabb(glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f));
+    AddAabb(glm::vec2(0.5f, 0.5f), glm::vec2(1.0f, 1.0f));
+    AllPairsBroadphase allPairs;
+    UniformGridBroadphase grid(1.0f);
+
+    auto expectedPairs = FindSortedPairs(allPairs, _aabbs);
+
+    ASSERT_EQ(expectedPairs.size(), 3u);
+    ASSERT_EQ(FindSortedPairs(grid, _aabbs), expectedPairs);
+}
+
+TEST_F(UniformGridBroadphaseTests, FindOverlappingPairs_GivenRandomMixOfSizes_ReportsSamePairsAsAllPairs)
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> positionDistribution(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> sizeDistribution(0.5f, 40.0f);
+    for (int i = 0; i < 500; i++)
+    {
+        AddAabb(
+            glm::vec2(positionDistribution(random), positionDistribution(random)),
+            glm::vec2(sizeDistribution(random), sizeDistribution(random)));
+    }
+    AllPairsBroadphase allPairs;
+    UniformGridBroadphase grid(8.0f);
+
+    auto expectedPairs = FindSortedPairs(allPairs, _aabbs);
+    auto actualPairs = FindSortedPairs(grid, _aabbs);
+
+    ASSERT_FALSE(expectedPairs.empty());
+    ASSERT_EQ(actualPairs, expectedPairs);
+}
+
+TEST_F(UniformGridBroadphaseTests, FindOverlappingPairs_GivenWorkerPool_ReportsSamePairsAsAllPairs)
+{
+    std::mt19937 random(2468);
+    std::uniform_real_distribution<float> positionDistribution(-400.0f, 400.0f);
+    std::uniform_real_distribution<float> sizeDistribution(0.5f, 40.0f);
+    for (int i = 0; i < 2000; i++)
+    {
+        AddAabb(
+            glm::vec2(positionDistribution(random), positionDistribution(random)),
+            glm::vec2(sizeDistribution(random), sizeDistribution(random)));
+    }
+    AllPairsBroadphase allPairs;
+    UniformGridBroadphase grid(8.0f);
+    WorkerPool workers(4);
+
+    auto expectedPairs = FindSortedPairs(allPairs, _aabbs);
+    auto actualPairs = FindSortedPairs(grid, _aabbs, workers);
+
+    ASSERT_FALSE(expectedPairs.empty());
+    ASSERT_EQ(actualPairs, expectedPairs);
+}
+
+TEST_F(UniformGridBroadphaseTests, FindOverlappingPairs_GivenAabbsFallingAsleepWakingAndRemovedBetweenCalls_ReportsSamePairsAsAllPairs)
+{
+    std::mt19937 random(3579);
+    std::uniform_real_distribution<float> positionDistribution(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> sizeDistribution(0.5f, 20.0f);
+    std::uniform_real_distribution<float> moveDistribution(-3.0f, 3.0f);
+    for (int i = 0; i < 600; i++)
+    {
+        AddAabb(
+            glm::vec2(positionDistribution(random), positionDistribution(random)),
+            glm::vec2(sizeDistribution(random), sizeDistribution(random)));
+    }
+    AllPairsBroadphase allPairs;
+    UniformGridBroadphase grid(8.0f);
+    UniformGridBroadphase gridWithWorkers(8.0f);
+    WorkerPool workers(4);
+
+    // Calls where nothing changes reuse the sleeping AABBs' table, and
+    // removals move sleeping AABBs to other indices.
+    for (int call = 0; call < 12; call++)
+    {
+        if (call % 3 != 2)
+        {
+            for (uint32_t i = 0; i < _aabbs.Count(); i++)
+            {
+                if (std::uniform_int_distribution<int>(0, 9)(random) == 0)
+                {
+                    _aabbs.IsAwake()[i] ^= 1;
+                }
+                if (_aabbs.IsAwake()[i])
+                {
+                    Aabb aabb(_aabbs, i);
+                    aabb.Position(aabb.Position() + glm::vec2(moveDistribution(random), moveDistribution(random)));
+                }
+            }
+            for (int removal = 0; removal < 5; removal++)
+            {
+                _aabbs.SwapRemove(std::uniform_int_distribution<uint32_t>(0, _aabbs.Count() - 1)(random));
+            }
+        }
+
+        auto expectedPairs = FindSortedPairs(allPairs, _aabbs);
+        auto actualPairs = FindSortedPairs(grid, _aabbs);
+        auto actualPairsWithWorkers = FindSortedPairs(gridWithWorkers, _aabbs, workers);
+
+        ASSERT_FALSE(expectedPairs.empty());
+        ASSERT_EQ(actualPairs, expectedPairs);
+        ASSERT_EQ(actualPairsWithWorkers, expectedPairs);
+    }
+}
@@ -0,0 +1,74 @@
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "WorkerPool.h"
+
+using namespace testing;
+using namespace JkEng::Physics;
+
+class WorkerPoolTests : public Test
+{
+public:
+    WorkerPoolTests()
+    {
+
+    }
+};
+
+TEST_F(WorkerPoolTests, Run_GivenManyTasks_RunsEachTaskExactlyOnceOnAValidWorker)
+{
+    WorkerPool workers(4);
+    std::vector<std::atomic<int>> runCounts(1000);
+    std::atomic<bool> workerIndexOutOfRange = false;
+
+    // Run several batches to make sure the pool can be reused.
+    for (int batch = 0; batch < 3; batch++)
+    {
+        workers.Run(static_cast<uint32_t>(runCounts.size()), [&](uint32_t taskIndex, uint32_t workerIndex)
+        {
+            runCounts[taskIndex]++;
+            if (workerIndex >= workers.WorkerCount())
+            {
+                workerIndexOutOfRange = true;
+            }
+        });
+    }
+
+    ASSERT_EQ(workers.WorkerCount(), 4u);
+    ASSERT_FALSE(workerIndexOutOfRange);
+    for (auto& runCount : runCounts)
+    {
+        ASSERT_EQ(runCount, 3);
+    }
+}
+
+TEST_F(WorkerPoolTests, Run_GivenTaskThatThrows_RethrowsAfterOtherTasksFinish)
+{
+    WorkerPool workers(3);
+    std::atomic<int> finishedTasks = 0;
+
+    ASSERT_THROW(
+        workers.Run(100, [&](uint32_t taskIndex, uint32_t)
+        {
+            if (taskIndex == 10)
+            {
+                throw std::runtime_error("task failed");
+            }
+            finishedTasks++;
+        }),
+        std::runtime_error);
+    ASSERT_EQ(finishedTasks, 99);
+
+    // The pool is still usable afterwards.
+    finishedTasks = 0;
+    workers.Run(10, [&](uint32_t, uint32_t) { finishedTasks++; });
+    ASSERT_EQ(finishedTasks, 10);
+}
+
+TEST_F(WorkerPoolTests, Constructor_GivenZeroWorkers_Throws)
+{
+    ASSERT_THROW(WorkerPool(0), std::invalid_argument);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-volatile"
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <glm/glm.hpp>
+#pragma clang diagnostic pop
+
+#include "AabbStorage.h"
+#include "IMovableAabb2d.h"
+
+namespace JkEng::Physics
+{
+    // A thin view of one AABB in an AabbStorage.  Copying an Aabb copies
+    // the view, not the AABB.
+    class Aabb final : public IMovableAabb2d
+    {
+    public:
+        Aabb(AabbStorage& storage, uint32_t index)
+          : _storage(&storage),
+            _index(index)
+        {
+
+        }
+
+        inline uint32_t Index() const { return _index; }
+
+        // Points the view at another AABB, for when storage moves the one
+        // it was viewing.
+        inline void SetIndex(uint32_t index) { _index = index; }
+
+        inline bool IsColliding(const Aabb &other) const
+        {
+            return LeftXMin() <= other.RightXMax() && RightXMax() >= other.LeftXMin()
+                && BottomYMin() <= other.TopYMax() && TopYMax() >= other.BottomYMin();
+        }
+
+        inline const IReadOnlyAabb2d::CollisionHandler& CollisionHandler() const
+        {
+            return _storage->CollisionHandler(_index);
+        }
+
+        inline float LeftXMin() const { return _storage->MinX()[_index]; }
+        inline float RightXMax() const { return _storage->MaxX()[_index]; }
+        inline float BottomYMin() const { return _storage->MinY()[_index]; }
+        inline float TopYMax() const { return _storage->MaxY()[_index]; }
+
+        virtual glm::vec2 Size() const override
+        {
+            _storage->CheckAccessThread();
+            return glm::vec2(RightXMax() - LeftXMin(), TopYMax() - BottomYMin());
+        }
+
+        virtual glm::vec2 Position() const override
+        {
+            _storage->CheckAccessThread();
+            return glm::vec2(LeftXMin(), BottomYMin());
+        }
+
+        virtual glm::vec2 Velocity() const override
+        {
+            _storage->CheckAccessThread();
+            return glm::vec2(_storage->VelocityX()[_index], _storage->VelocityY()[_index]);
+        }
+
+        virtual glm::vec2 Acceleration() const override
+        {
+            _storage->CheckAccessThread();
+            return glm::vec2(_storage->AccelerationX()[_index], _storage->AccelerationY()[_index]);
+        }
+
+        virtual const std::any& ObjectInfo() const override { return _storage->ObjectInfo(_index); }
+        virtual std::any& ObjectInfo() override
+        {
+            _storage->BeforeObjectInfoWrite(_index);
+            return _storage->ObjectInfo(_index);
+        }
+
+        virtual uint64_t UserData() const override
+        {
+            _storage->CheckAccessThread();
+            return _storage->UserData()[_index];
+        }
+
+        virtual void UserData(uint64_t userData) override
+        {
+            _storage->BeforeWrite(_index);
+            _storage->UserData()[_index] = userData;
+        }
+
+        virtual void Size(const glm::vec2& size) override
+        {
+            SetPositionAndSize(Position(), size);
+        }
+
+        virtual void Position(const glm::vec2& position) override
+        {
+            SetPositionAndSize(position, Size());
+        }
+
+        virtual void Velocity(const glm::vec2 velocity) override
+        {
+            _storage->BeforeMove(_index);
+            _storage->BeforeWrite(_index);
+            _storage->VelocityX()[_index] = velocity.x;
+            _storage->VelocityY()[_index] = velocity.y;
+        }
+
+        virtual void Acceleration(const glm::vec2 acceleration) override
+        {
+            _storage->BeforeMove(_index);
+            _storage->BeforeWrite(_index);
+            _storage->AccelerationX()[_index] = acceleration.x;
+            _storage->AccelerationY()[_index] = acceleration.y;
+        }
+
+    private:
+        AabbStorage* _storage;
+        uint32_t _index;
+
+        void SetPositionAndSize(const glm::vec2& position, const glm::vec2& size);
+    };
+}
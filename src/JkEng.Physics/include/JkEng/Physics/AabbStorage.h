@@ -0,0 +1,397 @@
+#pragma once
+
+#include <algorithm>
+#include <any>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-volatile"
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <glm/glm.hpp>
+#pragma clang diagnostic pop
+
+#include "Bounds.h"
+#include "CollisionFilter.h"
+#include "IReadOnlyAabb2d.h"
+#include "ReadOnlyAabb2dView.h"
+
+namespace JkEng::Physics
+{
+    // A copy of the state of every AABB in an AabbStorage that changes as
+    // it moves, see AabbStorage::SaveKinematics.  Reused copies only
+    // allocate when there are more AABBs than the last time.
+    struct AabbKinematics
+    {
+        uint32_t count = 0;
+        std::vector<std::byte> bytes;
+    };
+
+    // Structure-of-arrays storage for every AABB in a scene.
+    //
+    // The state read every step (bounds, velocity, acceleration, the
+    // collision filter bits, whether the AABB is asleep or fast, its
+    // inverse mass and its position before the step) is kept in one
+    // contiguous array per component so the integration and overlap loops
+    // stream through memory.  The collision handler and object info are
+    // only needed when a collision is found so they live in a separate
+    // "cold" array with the same indices.
+    //
+    // Performance Note: Before this the scene kept a std::vector of 112
+    // byte objects holding all of this inline, so the overlap loop pulled
+    // ~2 cache lines per AABB to read 16 bytes of bounds.
+    class AabbStorage final
+    {
+    public:
+        uint32_t Add(
+            const glm::vec2& position,
+            const glm::vec2& size,
+            glm::vec2 velocity,
+            glm::vec2 acceleration,
+            IReadOnlyAabb2d::CollisionHandler collisionHandler,
+            std::any objectInfo);
+
+        uint32_t Add(
+            float leftXMin,
+            float rightXMax,
+            float bottomYMin,
+            float topYMax,
+            glm::vec2 velocity,
+            glm::vec2 acceleration,
+            IReadOnlyAabb2d::CollisionHandler collisionHandler,
+            std::any objectInfo);
+
+        // Removes the AABB at index by moving the last AABB into its place,
+        // so the last AABB's index changes to index.  Must not be called
+        // while preserving pre-step state.
+        void SwapRemove(uint32_t index);
+
+        void Reserve(size_t count);
+
+        inline uint32_t Count() const { return static_cast<uint32_t>(_minX.size()); }
+
+        // Copies the bounds, velocity, acceleration, previous position and
+        // user data of every AABB, which is everything IMovableAabb2d can
+        // change.  Each array is copied whole, so saving and restoring
+        // cost about as much as copying that many bytes.
+        void SaveKinematics(AabbKinematics& kinematics) const;
+
+        // Puts back what SaveKinematics copied.  kinematics must have been
+        // saved with the same AABBs at the same indices.
+        void RestoreKinematics(const AabbKinematics& kinematics);
+
+        inline float* MinX() { return _minX.data(); }
+        inline float* MinY() { return _minY.data(); }
+        inline float* MaxX() { return _maxX.data(); }
+        inline float* MaxY() { return _maxY.data(); }
+        inline float* VelocityX() { return _velocityX.data(); }
+        inline float* VelocityY() { return _velocityY.data(); }
+        inline float* AccelerationX() { return _accelerationX.data(); }
+        inline float* AccelerationY() { return _accelerationY.data(); }
+        inline uint64_t* UserData() { return _userData.data(); }
+        inline uint32_t* CollisionCategory() { return _collisionCategory.data(); }
+        inline uint32_t* CollisionMask() { return _collisionMask.data(); }
+        inline uint8_t* IsAwake() { return _isAwake.data(); }
+        inline float* PreviousMinX() { return _previousMinX.data(); }
+        inline float* PreviousMinY() { return _previousMinY.data(); }
+        inline uint32_t* StepsAtRest() { return _stepsAtRest.data(); }
+        inline uint8_t* IsFast() { return _isFast.data(); }
+        inline float* InverseMass() { return _inverseMass.data(); }
+
+        inline const float* MinX() const { return _minX.data(); }
+        inline const float* MinY() const { return _minY.data(); }
+        inline const float* MaxX() const { return _maxX.data(); }
+        inline const float* MaxY() const { return _maxY.data(); }
+        inline const float* VelocityX() const { return _velocityX.data(); }
+        inline const float* VelocityY() const { return _velocityY.data(); }
+        inline const float* AccelerationX() const { return _accelerationX.data(); }
+        inline const float* AccelerationY() const { return _accelerationY.data(); }
+        inline const uint64_t* UserData() const { return _userData.data(); }
+        inline const uint32_t* CollisionCategory() const { return _collisionCategory.data(); }
+        inline const uint32_t* CollisionMask() const { return _collisionMask.data(); }
+        inline const uint8_t* IsAwake() const { return _isAwake.data(); }
+        inline const float* PreviousMinX() const { return _previousMinX.data(); }
+        inline const float* PreviousMinY() const { return _previousMinY.data(); }
+        inline const uint32_t* StepsAtRest() const { return _stepsAtRest.data(); }
+        inline const uint8_t* IsFast() const { return _isFast.data(); }
+        inline const float* InverseMass() const { return _inverseMass.data(); }
+
+        // Two AABBs are only tested when each one's category is in the
+        // other's mask.  See ShouldCollide for AABBs in one storage.
+        static inline bool CategoriesCollide(uint32_t category0, uint32_t mask0, uint32_t category1, uint32_t mask1)
+        {
+            return (category0 & mask1) != 0 && (category1 & mask0) != 0;
+        }
+
+        // Sleeping AABBs do not move, so a pair that is asleep on both
+        // sides is skipped too.
+        inline bool ShouldCollide(uint32_t index0, uint32_t index1) const
+        {
+            return (_isAwake[index0] | _isAwake[index1]) != 0 && CategoriesCollide(
+                _collisionCategory[index0], _collisionMask[index0],
+                _collisionCategory[index1], _collisionMask[index1]);
+        }
+
+        inline bool IsColliding(uint32_t index0, uint32_t index1) const
+        {
+            return _minX[index0] <= _maxX[index1] && _maxX[index0] >= _minX[index1]
+                && _minY[index0] <= _maxY[index1] && _maxY[index0] >= _minY[index1];
+        }
+
+        // Copies the positions of the AABBs in [begin, end) to the
+        // previous positions, which render interpolation starts from.
+        inline void SavePreviousPositions(uint32_t begin, uint32_t end)
+        {
+            std::copy(_minX.begin() + begin, _minX.begin() + end, _previousMinX.begin() + begin);
+            std::copy(_minY.begin() + begin, _minY.begin() + end, _previousMinY.begin() + begin);
+        }
+
+        // Called before anything that moves an AABB.  A sleeping AABB is
+        // woken and remembered until TakeWokenIndices so the scene can wake
+        // everything it was asleep with.
+        inline void BeforeMove(uint32_t index)
+        {
+            CheckAccessThread();
+            _boundsVersion++;
+            if (!_isAwake[index])
+            {
+                _isAwake[index] = 1;
+                _wokenIndices.push_back(index);
+            }
+        }
+
+        // Goes up whenever an AABB may have been added, removed or moved,
+        // so anything built from the bounds can tell it is out of date.
+        // Code that writes the bounds arrays directly rather than after
+        // BeforeMove must call BoundsChanged.
+        inline uint64_t BoundsVersion() const { return _boundsVersion; }
+        inline void BoundsChanged() { _boundsVersion++; }
+
+        // While the id it points to is set, CheckAccessThread, BeforeMove
+        // and BeforeWrite throw std::logic_error on every other thread.  The
+        // id belongs to the owner so the storage can still be copied and
+        // moved.
+        inline void AccessThread(const std::atomic<std::thread::id>* accessThread) { _accessThread = accessThread; }
+
+        // Called before reading an AABB for anyone outside the scene.  Only
+        // asks which thread this is when access is restricted.
+        inline void CheckAccessThread() const
+        {
+            if (!IsAccessThread())
+            {
+                ThrowNotAccessThread();
+            }
+        }
+
+        inline bool IsAccessThread() const
+        {
+            if (_accessThread == nullptr)
+            {
+                return true;
+            }
+
+            std::thread::id accessThread = _accessThread->load(std::memory_order_acquire);
+            return accessThread == std::thread::id() || accessThread == std::this_thread::get_id();
+        }
+
+        inline bool HasWokenIndices() const { return !_wokenIndices.empty(); }
+
+        // Swaps the indices woken through BeforeMove since the last call
+        // into wokenIndices.
+        inline void TakeWokenIndices(std::vector<uint32_t>& wokenIndices)
+        {
+            wokenIndices.clear();
+            std::swap(wokenIndices, _wokenIndices);
+        }
+
+        inline Bounds BoundsOf(uint32_t index) const
+        {
+            return { _minX[index], _minY[index], _maxX[index], _maxY[index] };
+        }
+
+        // The bounds the AABB had before the step, at its current size.
+        inline Bounds PreviousBoundsOf(uint32_t index) const
+        {
+            return {
+                _previousMinX[index],
+                _previousMinY[index],
+                _previousMinX[index] + (_maxX[index] - _minX[index]),
+                _previousMinY[index] + (_maxY[index] - _minY[index]) };
+        }
+
+        inline const IReadOnlyAabb2d::CollisionHandler& CollisionHandler(uint32_t index) const
+        {
+            return _cold[index].collisionHandler;
+        }
+
+        inline const std::any& ObjectInfo(uint32_t index) const { return _cold[index].objectInfo; }
+        inline std::any& ObjectInfo(uint32_t index) { return _cold[index].objectInfo; }
+
+        inline void SetContactEventHandler(
+            uint32_t index,
+            IReadOnlyAabb2d::ContactEventHandler contactEventHandler,
+            bool receivePersistEvents)
+        {
+            _cold[index].contactEventHandler = std::move(contactEventHandler);
+            _cold[index].receivePersistEvents = receivePersistEvents;
+        }
+
+        inline const IReadOnlyAabb2d::ContactEventHandler& ContactEventHandler(uint32_t index) const
+        {
+            return _cold[index].contactEventHandler;
+        }
+
+        inline bool ReceivePersistEvents(uint32_t index) const
+        {
+            return _cold[index].receivePersistEvents;
+        }
+
+        inline void SetCollisionViewHandler(uint32_t index, Physics::CollisionViewHandler collisionViewHandler)
+        {
+            _cold[index].collisionViewHandler = std::move(collisionViewHandler);
+        }
+
+        inline const Physics::CollisionViewHandler& CollisionViewHandler(uint32_t index) const
+        {
+            return _cold[index].collisionViewHandler;
+        }
+
+        // While preserving, the state of an AABB is saved the first time it
+        // is written so the PreStep functions still return the state from
+        // when preserving began.  Anything that writes an AABB must call
+        // BeforeWrite (or BeforeObjectInfoWrite for its object info) first.
+        void BeginPreservingPreStepState();
+        void EndPreservingPreStepState();
+        inline bool IsPreserving() const { return _isPreserving; }
+
+        inline void BeforeWrite(uint32_t index)
+        {
+            CheckAccessThread();
+            if (_isPreserving && _preservedStateIndices[index] == NotPreserved)
+            {
+                PreserveState(index);
+            }
+        }
+
+        // Object info is only ever written by its owner, so other threads
+        // can reach it while access is restricted.  Preserving only happens
+        // on the access thread, so they skip it without reading its state.
+        inline void BeforeObjectInfoWrite(uint32_t index)
+        {
+            if (!IsAccessThread() || !_isPreserving)
+            {
+                return;
+            }
+
+            BeforeWrite(index);
+            auto& preserved = _preservedStates[_preservedStateIndices[index]];
+            if (!preserved.objectInfo.has_value())
+            {
+                preserved.objectInfo = _cold[index].objectInfo;
+            }
+        }
+
+        inline Bounds PreStepBounds(uint32_t index) const
+        {
+            const PreservedState* preserved = FindPreservedState(index);
+            return preserved != nullptr ? preserved->bounds : BoundsOf(index);
+        }
+
+        inline glm::vec2 PreStepVelocity(uint32_t index) const
+        {
+            const PreservedState* preserved = FindPreservedState(index);
+            return preserved != nullptr ? preserved->velocity : glm::vec2(_velocityX[index], _velocityY[index]);
+        }
+
+        inline glm::vec2 PreStepAcceleration(uint32_t index) const
+        {
+            const PreservedState* preserved = FindPreservedState(index);
+            return preserved != nullptr ? preserved->acceleration : glm::vec2(_accelerationX[index], _accelerationY[index]);
+        }
+
+        inline uint64_t PreStepUserData(uint32_t index) const
+        {
+            const PreservedState* preserved = FindPreservedState(index);
+            return preserved != nullptr ? preserved->userData : _userData[index];
+        }
+
+        inline const std::any& PreStepObjectInfo(uint32_t index) const
+        {
+            const PreservedState* preserved = FindPreservedState(index);
+            return preserved != nullptr && preserved->objectInfo.has_value()
+                ? *preserved->objectInfo
+                : _cold[index].objectInfo;
+        }
+
+    private:
+        static constexpr uint32_t NotPreserved = ~0u;
+
+        [[noreturn]] void ThrowNotAccessThread() const;
+
+        struct PreservedState
+        {
+            Bounds bounds;
+            glm::vec2 velocity;
+            glm::vec2 acceleration;
+            uint64_t userData;
+
+            // Only copied when the object info is written since copying a
+            // std::any can allocate.
+            std::optional<std::any> objectInfo;
+        };
+
+        struct ColdData
+        {
+            IReadOnlyAabb2d::CollisionHandler collisionHandler;
+            std::any objectInfo;
+            IReadOnlyAabb2d::ContactEventHandler contactEventHandler;
+            bool receivePersistEvents = true;
+            Physics::CollisionViewHandler collisionViewHandler;
+        };
+
+        std::vector<float> _minX;
+        std::vector<float> _minY;
+        std::vector<float> _maxX;
+        std::vector<float> _maxY;
+        std::vector<float> _velocityX;
+        std::vector<float> _velocityY;
+        std::vector<float> _accelerationX;
+        std::vector<float> _accelerationY;
+        std::vector<uint64_t> _userData;
+        std::vector<uint32_t> _collisionCategory;
+        std::vector<uint32_t> _collisionMask;
+        std::vector<uint8_t> _isAwake;
+        std::vector<float> _previousMinX;
+        std::vector<float> _previousMinY;
+        std::vector<uint32_t> _stepsAtRest;
+        std::vector<uint8_t> _isFast;
+        std::vector<float> _inverseMass;
+        std::vector<uint32_t> _wokenIndices;
+        uint64_t _boundsVersion = 0;
+        const std::atomic<std::thread::id>* _accessThread = nullptr;
+
+        // A deque so handlers stay where they are while they run, even if
+        // they add AABBs.
+        std::deque<ColdData> _cold;
+
+        bool _isPreserving = false;
+        std::vector<uint32_t> _preservedStateIndices;
+        std::vector<PreservedState> _preservedStates;
+        std::vector<uint32_t> _preservedAabbIndices;
+
+        void PreserveState(uint32_t index);
+
+        inline const PreservedState* FindPreservedState(uint32_t index) const
+        {
+            return _isPreserving && _preservedStateIndices[index] != NotPreserved
+                ? &_preservedStates[_preservedStateIndices[index]]
+                : nullptr;
+        }
+    };
+}
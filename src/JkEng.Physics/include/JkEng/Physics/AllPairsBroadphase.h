@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "IBroadphase.h"
+#include "OverlapTester.h"
+
+namespace JkEng::Physics
+{
+    class AllPairsBroadphase final : public IBroadphase
+    {
+    public:
+        void FindOverlappingPairs(
+            const AabbStorage& aabbs,
+            std::vector<OverlappingPair>& pairs) override;
+
+        void FindOverlappingPairs(
+            const AabbStorage& aabbs,
+            WorkerPool& workers,
+            std::vector<std::vector<OverlappingPair>>& pairsPerWorker) override;
+
+    private:
+        // Each task tests this many AABBs against every later AABB.
+        static constexpr uint32_t AabbsPerTask = 32;
+
+        OverlapTester _overlapTester;
+        std::vector<uint64_t> _hits;
+        std::vector<std::vector<uint64_t>> _hitsPerWorker;
+
+        void FindOverlappingPairs(
+            const AabbStorage& aabbs,
+            uint32_t outerBegin,
+            uint32_t outerEnd,
+            std::vector<uint64_t>& hits,
+            std::vector<OverlappingPair>& pairs) const;
+    };
+}
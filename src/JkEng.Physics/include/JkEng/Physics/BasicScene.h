@@ -0,0 +1,546 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Aabb.h"
+#include "AabbStorage.h"
+#include "AllPairsBroadphase.h"
+#include "CollisionHandlerPolicies.h"
+#include "Contact.h"
+#include "ContactPairCache.h"
+#include "ContactResolver.h"
+#include "DynamicTreeBroadphase.h"
+#include "IBroadphase.h"
+#include "Integrator.h"
+#include "MovableAabbTree.h"
+#include "IScene.h"
+#include "SceneDefinition.h"
+#include "StaticAabbTree.h"
+#include "SweepAndPruneBroadphase.h"
+#include "TileGrid.h"
+#include "UniformGridBroadphase.h"
+#include "WorkerPool.h"
+
+namespace JkEng::Physics
+{
+    class SceneDefinition;
+
+    // The scene, with the broadphase and the way collisions reach handlers
+    // chosen at compile time.  Engine::CreateScene picks one of these at
+    // run time, or build one directly to have the broadphase and the
+    // handler called without any virtual or std::function call, such as:
+    //
+    //   BasicScene<SweepAndPruneBroadphase, FunctorHandlers<Bounce>> scene(definition, Bounce{ ... });
+    //
+    // Broadphase is IBroadphase to pick the broadphase at run time from the
+    // SceneDefinition, or one of the final broadphase classes to call it
+    // without virtual dispatch, in which case the definition's Broadphase
+    // and PartitionBroadphaseByCollisionFilter are ignored.  HandlerPolicy
+    // is one of the policies in CollisionHandlerPolicies.h or a class of
+    // the same shape.  The definition's CollisionHandlers is ignored.
+    //
+    // Member functions are defined in BasicScene.inl.  The combinations
+    // Engine::CreateScene can pick are instantiated once in the library.
+    template<typename Broadphase, typename HandlerPolicy>
+    class BasicScene final : public IScene
+    {
+    public:
+        BasicScene(const SceneDefinition& definition, HandlerPolicy handlerPolicy = HandlerPolicy());
+
+        // The views handed out through AfterCreatePtr point back into the
+        // scene so it must stay where it was constructed.
+        BasicScene(const BasicScene&) = delete;
+        BasicScene& operator=(const BasicScene&) = delete;
+
+        void Update(float deltaTime) override;
+        // Makes reading or writing a body, through IMovableAabb2d or the bulk
+        // accessors, from any thread but thread throw std::logic_error,
+        // until called again with std::thread::id().  Object info and
+        // spatial queries are not restricted.  For ThreadedScene.
+        void RestrictAccessToThread(std::thread::id thread) { _accessThread.store(thread, std::memory_order_release); }
+
+        float TimeNotYetSimulated() override { return _timeNotYetSimulated; }
+        float StepDuration() const override { return _stepDuration; }
+        uint32_t BodyIdCount() const override { return static_cast<uint32_t>(_bodySlots.size()); }
+        void InterpolatedPositions(std::span<glm::vec2> positions) const override;
+
+        void Positions(std::span<glm::vec2> positions) const override;
+        void Velocities(std::span<glm::vec2> velocities) const override;
+        void Accelerations(std::span<glm::vec2> accelerations) const override;
+        void SetPositions(std::span<const BodyHandle> bodies, std::span<const glm::vec2> positions) override;
+        void SetVelocities(std::span<const BodyHandle> bodies, std::span<const glm::vec2> velocities) override;
+        void SetAccelerations(std::span<const BodyHandle> bodies, std::span<const glm::vec2> accelerations) override;
+        void SetPositions(std::span<const glm::vec2> positions) override;
+        void SetVelocities(std::span<const glm::vec2> velocities) override;
+        void SetAccelerations(std::span<const glm::vec2> accelerations) override;
+
+        // Writes where each movable AABB is, where it was before the last
+        // step and its velocity to index bodyId of each span, which must
+        // have room for BodyIdCount() entries.  For ThreadedScene.
+        void CopyMovableState(
+            std::span<glm::vec2> positions,
+            std::span<glm::vec2> previousPositions,
+            std::span<glm::vec2> velocities) const;
+
+        void SaveState(uint32_t frame) override;
+        bool RestoreState(uint32_t frame) override;
+
+        BodyHandle AddBody(const MovableAabb2dDefinition& definition) override;
+        void RemoveBody(BodyHandle handle) override;
+        bool IsValid(BodyHandle handle) const override;
+        BodyHandle HandleOf(uint32_t bodyId) const override;
+        IMovableAabb2d* Body(BodyHandle handle) override;
+        bool IsSleeping(BodyHandle handle) const override;
+
+        uint32_t QueryPoint(glm::vec2 point, std::span<uint32_t> bodyIds, uint32_t categoryMask) const override;
+        uint32_t QueryRegion(glm::vec2 position, glm::vec2 size, std::span<uint32_t> bodyIds, uint32_t categoryMask) const override;
+        bool Raycast(glm::vec2 origin, glm::vec2 direction, RaycastHit& hit, uint32_t categoryMask) const override;
+        uint32_t RaycastAll(glm::vec2 origin, glm::vec2 direction, std::span<RaycastHit> hits, uint32_t categoryMask) const override;
+        uint32_t NearestK(glm::vec2 point, std::span<NearestBody> nearest, uint32_t categoryMask) const override;
+        uint32_t RaycastBatch(std::span<const Ray> rays, std::span<RaycastHit> hits, uint32_t categoryMask) const override;
+        void QueryRegionBatch(
+            std::span<const Region> regions,
+            std::span<uint32_t> bodyIds,
+            std::span<uint32_t> counts,
+            uint32_t categoryMask) const override;
+
+    private:
+        static constexpr uint32_t NoFreeSlot = ~0u;
+        static constexpr uint32_t NoIsland = ~0u;
+        static constexpr uint32_t NoIndex = ~0u;
+
+        // Keeps the best results offered so far in results, which is a heap
+        // with the worst kept result at the front until SortBestResults.
+        template<typename Result, typename IsBetter>
+        static void KeepBestResult(std::span<Result> results, uint32_t& keptCount, const Result& result, IsBetter isBetter)
+        {
+            if (keptCount < results.size())
+            {
+                results[keptCount++] = result;
+                std::push_heap(results.begin(), results.begin() + keptCount, isBetter);
+            }
+            else if (!results.empty() && isBetter(result, results.front()))
+            {
+                std::pop_heap(results.begin(), results.end(), isBetter);
+                results.back() = result;
+                std::push_heap(results.begin(), results.end(), isBetter);
+            }
+        }
+
+        template<typename Result, typename IsBetter>
+        static void SortBestResults(std::span<Result> results, uint32_t keptCount, IsBetter isBetter)
+        {
+            std::sort_heap(results.begin(), results.begin() + keptCount, isBetter);
+        }
+
+        // Ties are broken by body id so results do not depend on the order
+        // bodies are visited in.
+        static bool IsCloserHit(const RaycastHit& hit0, const RaycastHit& hit1)
+        {
+            return hit0.fraction != hit1.fraction ? hit0.fraction < hit1.fraction : hit0.bodyId < hit1.bodyId;
+        }
+
+        static bool IsNearerBody(const NearestBody& body0, const NearestBody& body1)
+        {
+            return body0.distance != body1.distance ? body0.distance < body1.distance : body0.bodyId < body1.bodyId;
+        }
+
+        // One per body id.  The slots of removed bodies are reused, so
+        // adding and removing bodies never searches or shifts anything.
+        struct BodySlot
+        {
+            // The view handed out for the body.  Its index follows the
+            // body's AABB as removals move it around _aabbs.
+            Aabb view;
+
+            // Starts at 1 so default constructed handles never match, and
+            // goes up every time the body in the slot is removed.
+            uint32_t generation;
+            bool isAlive;
+
+            // The next free slot while this one is free.
+            uint32_t nextFreeSlot;
+
+            // The island in _sleepingIslands while the body is asleep.
+            uint32_t island;
+        };
+
+        // Bodies that fell asleep together because they touched, and every
+        // contact they had then.  Sleeping bodies do not move, so the
+        // contacts still hold when the island wakes.
+        struct SleepingIsland
+        {
+            std::vector<uint32_t> bodyIds;
+            std::vector<Contact> contacts;
+        };
+
+        // A slot's generation and its AABB's index in _aabbs, which is
+        // NoIndex unless the slot holds a movable AABB.
+        struct HandleIndex
+        {
+            uint32_t generation;
+            uint32_t index;
+        };
+
+        // One buffer of the ring SaveState writes to.
+        struct SavedState
+        {
+            bool isSaved = false;
+            uint32_t frame = 0;
+            uint64_t bodySetVersion = 0;
+            float timeNotYetSimulated = 0.0f;
+            AabbKinematics aabbs;
+            std::vector<Contact> contacts;
+        };
+
+        // What a spatial query needs besides the scene.  Each worker has its
+        // own so batches can run queries in parallel.
+        struct QueryScratch
+        {
+            std::vector<int32_t> stack;
+        };
+
+        float _timeNotYetSimulated;
+        float _stepDuration;
+
+        // Performance Note: It is substantially faster to keep all Aabbs
+        // contiguous in memory versus doing std::vector<unique_ptr<Aabb>>
+        // The latter makes collision checks for 1000 objects about ~50-55%
+        // longer.  AabbStorage takes that further by splitting each
+        // component into its own array.
+        //
+        // Removing a body moves the last AABB into its place to keep the
+        // arrays dense, so _bodyIds maps each index back to its body id.
+        AabbStorage _aabbs;
+        std::vector<uint32_t> _bodyIds;
+
+        // A deque so the views handed out through AfterCreatePtr stay
+        // where they are as more slots are added.
+        std::deque<BodySlot> _bodySlots;
+        uint32_t _firstFreeSlot = NoFreeSlot;
+
+        // One per slot, kept in step with it.  Finding an element of a
+        // deque takes a division and two dependent loads, which dominated
+        // checking handles in the bulk setters.
+        std::vector<HandleIndex> _handleIndices;
+
+        // Body ids from here on, one per static AABB and then one per tile
+        // grid, are static bodies, see StaticAabbTree and TileGrid.  Their
+        // slots are never freed and their views are never used.  Static
+        // pairs number tile grids after the static AABBs too.
+        uint32_t _firstStaticBodyId;
+        StaticAabbTree _staticAabbs;
+        std::vector<TileGrid> _tileGrids;
+
+        Integrator _integrator;
+        std::unique_ptr<Broadphase> _broadphase;
+
+        // Only created when the definition asks for more than one thread.
+        std::unique_ptr<WorkerPool> _workers;
+
+        // Reused every step to avoid allocating.  Static pairs hold a
+        // movable index and a static index rather than two movable indices.
+        std::vector<OverlappingPair> _overlappingPairs;
+        std::vector<OverlappingPair> _staticOverlappingPairs;
+        std::vector<std::vector<OverlappingPair>> _overlappingPairsPerWorker;
+        std::vector<std::vector<OverlappingPair>> _staticOverlappingPairsPerWorker;
+        std::vector<std::vector<Contact>> _contactsPerWorker;
+        std::vector<Contact> _mergedContacts;
+        std::vector<std::vector<int32_t>> _staticQueryStackPerWorker;
+
+        // The contacts found in the current step, in ascending order.
+        std::vector<Contact> _contacts;
+        HandlerPolicy _handlerPolicy;
+        ContactsHandler _contactsHandler;
+
+        // Only kept up to date when something wants contact events.
+        bool _trackContactEvents;
+        ContactPairCache _contactPairCache;
+        std::vector<ContactEvent> _contactEvents;
+        ContactEventsHandler _contactEventsHandler;
+
+        // Sleeping is off when _stepsBeforeSleep is 0.
+        uint32_t _stepsBeforeSleep;
+        float _sleepVelocityThresholdSquared;
+        float _sleepAccelerationThresholdSquared;
+        std::vector<SleepingIsland> _sleepingIslands;
+        std::vector<uint32_t> _freeSleepingIslands;
+
+        // The number of bodies in _sleepingIslands.
+        uint32_t _sleepingBodyCount = 0;
+
+        // Reused by UpdateSleep and WakeWokenBodies to avoid allocating.
+        std::vector<uint32_t> _islandParents;
+        std::vector<uint8_t> _islandCanSleep;
+        std::vector<uint32_t> _islandOfRoot;
+        std::vector<uint32_t> _newSleepingIslands;
+        std::vector<uint32_t> _wokenIndices;
+
+        // Only used when the definition asks for collisions to be resolved.
+        bool _resolveCollisions;
+        ContactResolver _contactResolver;
+
+        // Fast AABBs are only swept when there are any.  While the
+        // broadphase runs, the AABBs in _sweptIndices hold their swept
+        // bounds and _unsweptBounds holds their actual ones.
+        uint32_t _fastBodyCount = 0;
+        std::vector<uint32_t> _sweptIndices;
+        std::vector<Bounds> _unsweptBounds;
+
+        // Scratch space for spatial queries, which are const, one per
+        // worker.  Single queries use the first.  Queries bring
+        // _movableAabbTree up to date before looking at movable AABBs.
+        mutable MovableAabbTree _movableAabbTree;
+        mutable std::vector<QueryScratch> _queryScratchPerWorker;
+
+        // Held by Update for as long as it steps and by every query, so
+        // queries made on other threads wait for the step in progress and
+        // then take turns with the tree, the scratch space and the workers.
+        // Handlers run on _steppingThread, which already holds it, so their
+        // queries don't lock.
+        mutable std::mutex _stepMutex;
+        std::atomic<std::thread::id> _steppingThread;
+
+        // See RestrictAccessToThread.  _aabbs checks it on every access.
+        std::atomic<std::thread::id> _accessThread;
+
+        // Saved states can only be restored while the same bodies are at
+        // the same indices, so this goes up whenever a body is added or
+        // removed.
+        uint64_t _bodySetVersion = 0;
+        std::vector<SavedState> _savedStates;
+        std::vector<ContactEvent> _restoredContactEvents;
+
+        // Bodies removed since _contactPairCache was last updated.
+        std::vector<uint32_t> _removedBodyIds;
+
+        // Removing a body moves another AABB, which contacts still to be
+        // dispatched may refer to, so removals wait until dispatch ends.
+        bool _isDispatching = false;
+        std::vector<BodyHandle> _pendingRemovals;
+
+        // Each integration task moves this many AABBs.
+        static constexpr uint32_t AabbsPerIntegrateTask = 16384;
+
+        // Each task looks up this many movable AABBs in _staticAabbs and
+        // _tileGrids.
+        static constexpr uint32_t AabbsPerStaticQueryTask = 1024;
+
+        // Each task runs this many of a batch's spatial queries.
+        static constexpr uint32_t QueriesPerBatchTask = 64;
+
+        static std::unique_ptr<Broadphase> CreateBroadphase(const SceneDefinition& definition);
+
+        // The broadphase the definition asks for, for when Broadphase is
+        // IBroadphase.
+        static std::unique_ptr<IBroadphase> CreateAnyBroadphase(const SceneDefinition& definition);
+
+        // Adds the AABB and gives it a slot, without telling the broadphase.
+        BodyHandle CreateBody(const MovableAabb2dDefinition& definition);
+
+        uint32_t AllocateSlot();
+        void DestroyBody(BodyHandle handle);
+
+        void Integrate();
+
+        // Puts islands whose bodies have all been at rest for long enough
+        // to sleep.  Reads this step's contacts, so must run before they
+        // are cleared or bodies are removed.
+        void UpdateSleep();
+        uint32_t FindIslandRoot(uint32_t index);
+
+        // Wakes the islands of AABBs woken through IMovableAabb2d.
+        void WakeWokenBodies();
+
+        // Wakes every body in the island.  Its contacts are appended to
+        // _contacts when pairs for this step have already been found
+        // without them, and otherwise thawed in the pair cache so the next
+        // step finds them again.
+        void WakeIsland(uint32_t island, bool appendContacts);
+
+        // Fills _overlappingPairs and _staticOverlappingPairs, or their per
+        // worker versions when there are workers.
+        void FindOverlappingPairs();
+        void FindStaticOverlappingPairs();
+
+        // Grows each awake fast AABB's bounds to cover its whole path this
+        // step so the broadphase finds everything it passed, then puts the
+        // actual bounds back.
+        void BeginSweepingFastBodies();
+        void EndSweepingFastBodies();
+
+        inline bool IsStaticBody(uint32_t bodyId) const
+        {
+            // Ids below _firstStaticBodyId wrap around to large values.
+            return bodyId - _firstStaticBodyId < _staticAabbs.Aabbs().Count() + _tileGrids.size();
+        }
+
+        inline bool IsTileGridBody(uint32_t bodyId) const
+        {
+            return bodyId - _firstStaticBodyId - _staticAabbs.Aabbs().Count() < _tileGrids.size();
+        }
+
+        inline const TileGrid& TileGridOf(uint32_t bodyId) const
+        {
+            return _tileGrids[bodyId - _firstStaticBodyId - _staticAabbs.Aabbs().Count()];
+        }
+
+        // The storage holding a static body and its index there.
+        inline std::pair<const AabbStorage*, uint32_t> StaticAabbOf(uint32_t bodyId) const
+        {
+            if (IsTileGridBody(bodyId))
+            {
+                return { &TileGridOf(bodyId).Aabbs(), 0 };
+            }
+            return { &_staticAabbs.Aabbs(), bodyId - _firstStaticBodyId };
+        }
+
+        inline uint32_t IndexOf(uint32_t bodyId) const
+        {
+            return _bodySlots[bodyId].view.Index();
+        }
+
+        // The index in _aabbs of the movable AABB a handle matches, or
+        // NoIndex if it matches none.
+        inline uint32_t MovableIndexOf(BodyHandle handle) const
+        {
+            if (handle.bodyId >= _handleIndices.size())
+            {
+                return NoIndex;
+            }
+            const HandleIndex& handleIndex = _handleIndices[handle.bodyId];
+            return handleIndex.generation == handle.generation ? handleIndex.index : NoIndex;
+        }
+
+        // Throws std::invalid_argument unless a span of size can be indexed
+        // by body id.
+        void CheckBodyIdSpan(const char* function, size_t size) const;
+
+        // Writes x[index], y[index] of each movable AABB to
+        // values[bodyId], for the bulk getters.
+        void CopyByBodyId(const float* x, const float* y, std::span<glm::vec2> values) const;
+
+        // Sets x[index], y[index] of each movable AABB to values[bodyId],
+        // for the bulk velocity and acceleration setters.
+        void SetByBodyId(const char* function, float* x, float* y, std::span<const glm::vec2> values);
+
+        // Sets x[index], y[index] of each of bodies to its value, for the
+        // bulk velocity and acceleration setters.
+        void SetByHandle(
+            const char* function,
+            float* x,
+            float* y,
+            std::span<const BodyHandle> bodies,
+            std::span<const glm::vec2> values);
+
+        // Locks _stepMutex unless called from a handler while stepping.
+        inline std::unique_lock<std::mutex> LockForQuery() const
+        {
+            if (_steppingThread.load(std::memory_order_relaxed) == std::this_thread::get_id())
+            {
+                return std::unique_lock<std::mutex>();
+            }
+            return std::unique_lock<std::mutex>(_stepMutex);
+        }
+
+        // Calls callback(index) for every movable AABB whose bounds pass
+        // isWanted and whose category is in categoryMask, see
+        // DynamicAabbTree::ForEachLeaf.  _movableAabbTree must be up to
+        // date.
+        template<typename IsWanted, typename Callback>
+        void ForEachMovable(
+            IsWanted isWanted,
+            uint32_t categoryMask,
+            QueryScratch& scratch,
+            Callback callback) const
+        {
+            const uint32_t* categories = _aabbs.CollisionCategory();
+            _movableAabbTree.ForEachAabb(isWanted, scratch.stack, [&](uint32_t index)
+            {
+                if ((categories[index] & categoryMask) != 0)
+                {
+                    callback(index);
+                }
+            });
+        }
+
+        uint32_t QueryBounds(
+            const Bounds& bounds,
+            std::span<uint32_t> bodyIds,
+            uint32_t categoryMask,
+            QueryScratch& scratch) const;
+
+        // Unless countEveryHit, skips parts of the trees further along the
+        // ray than every kept hit, so the count returned only says whether
+        // anything was hit.
+        uint32_t RaycastAll(
+            glm::vec2 origin,
+            glm::vec2 direction,
+            std::span<RaycastHit> hits,
+            uint32_t categoryMask,
+            bool countEveryHit,
+            QueryScratch& scratch) const;
+
+        // Calls query(queryIndex, scratch) for every queryIndex in
+        // [0, queryCount), spread across the workers when there are any.
+        void RunQueryBatch(uint32_t queryCount, const std::function<void(uint32_t, QueryScratch&)>& query) const;
+
+        // Appends the pairs as contacts between body ids.
+        void AppendContacts(
+            const std::vector<OverlappingPair>& pairs,
+            const std::vector<OverlappingPair>& staticPairs,
+            std::vector<Contact>& contacts) const;
+
+        ReadOnlyAabb2dView ViewOf(uint32_t bodyId) const;
+        Bounds BoundsOf(uint32_t bodyId) const;
+        Bounds PreviousBoundsOf(uint32_t bodyId) const;
+        bool IsFastBody(uint32_t bodyId) const;
+
+        // Fast bodies collide when their paths through the step cross,
+        // the rest when they overlap at the end of it.
+        bool IsColliding(const Contact& contact) const;
+        bool IsSweptColliding(uint32_t bodyA, uint32_t bodyB) const;
+
+        // Fills _contacts sorted in ascending order, which is the same for
+        // every broadphase and thread count.
+        void FindContacts();
+        void DispatchContacts();
+
+        // Hands body and a view of otherBody to the handler policy.
+        void DispatchCollision(uint32_t body, uint32_t otherBody);
+
+        void DispatchContactEvents();
+
+        // Pushes the AABBs of this step's contacts apart, see
+        // SceneDefinition::ResolveCollisions.  Runs after dispatch so it
+        // sees wherever handlers left the AABBs.
+        void ResolveCollisions();
+
+        // Calls body's contact event handler with a view of otherBody if it
+        // wants this type of event.
+        void DispatchContactEvent(ContactEventType type, uint32_t body, uint32_t otherBody);
+    };
+
+    extern template class BasicScene<IBroadphase, FunctionHandlers>;
+    extern template class BasicScene<AllPairsBroadphase, FunctionHandlers>;
+    extern template class BasicScene<UniformGridBroadphase, FunctionHandlers>;
+    extern template class BasicScene<SweepAndPruneBroadphase, FunctionHandlers>;
+    extern template class BasicScene<DynamicTreeBroadphase, FunctionHandlers>;
+    extern template class BasicScene<IBroadphase, NoHandlers>;
+    extern template class BasicScene<AllPairsBroadphase, NoHandlers>;
+    extern template class BasicScene<UniformGridBroadphase, NoHandlers>;
+    extern template class BasicScene<SweepAndPruneBroadphase, NoHandlers>;
+    extern template class BasicScene<DynamicTreeBroadphase, NoHandlers>;
+}
+
+#include "BasicScene.inl"
+
@@ -0,0 +1,1623 @@
+// Member function definitions for BasicScene, included at the end of
+// BasicScene.h so scenes with any broadphase and handler policy can be
+// instantiated.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Aabb.h"
+#include "AllPairsBroadphase.h"
+#include "DynamicTreeBroadphase.h"
+#include "PartitionedBroadphase.h"
+#include "PreStepReadOnlyAabb2d.h"
+#include "SweepAndPruneBroadphase.h"
+#include "UniformGridBroadphase.h"
+
+namespace JkEng::Physics
+{
+    template<typename Broadphase, typename HandlerPolicy>
+    BasicScene<Broadphase, HandlerPolicy>::BasicScene(const SceneDefinition& definition, HandlerPolicy handlerPolicy)
+      : _timeNotYetSimulated(0.0f),
+        _stepDuration(definition.StepDuration()),
+        _firstStaticBodyId(static_cast<uint32_t>(definition.MovableAabb2dDefinitions().size())),
+        _staticAabbs(definition.StaticAabb2dDefinitions()),
+        _tileGrids(definition.TileGridDefinitions().begin(), definition.TileGridDefinitions().end()),
+        _broadphase(CreateBroadphase(definition)),
+        _handlerPolicy(std::move(handlerPolicy)),
+        _contactsHandler(definition.ContactsHandler()),
+        _trackContactEvents(definition.ContactEventsHandler() != nullptr),
+        _contactEventsHandler(definition.ContactEventsHandler()),
+        _stepsBeforeSleep(definition.StepsBeforeSleep()),
+        _sleepVelocityThresholdSquared(definition.SleepVelocityThreshold() * definition.SleepVelocityThreshold()),
+        _sleepAccelerationThresholdSquared(definition.SleepAccelerationThreshold() * definition.SleepAccelerationThreshold()),
+        _resolveCollisions(definition.ResolveCollisions())
+    {
+        if (definition.ThreadCount() > 1)
+        {
+            _workers = std::make_unique<WorkerPool>(definition.ThreadCount());
+            _overlappingPairsPerWorker.resize(_workers->WorkerCount());
+            _staticOverlappingPairsPerWorker.resize(_workers->WorkerCount());
+            _contactsPerWorker.resize(_workers->WorkerCount());
+        }
+        _staticQueryStackPerWorker.resize(_workers ? _workers->WorkerCount() : 1);
+        _queryScratchPerWorker.resize(_workers ? _workers->WorkerCount() : 1);
+        _savedStates.resize(definition.SavedStateCount());
+
+        auto& movableAabbDefinitions = definition.MovableAabb2dDefinitions();
+        _aabbs.AccessThread(&_accessThread);
+        _aabbs.Reserve(movableAabbDefinitions.size());
+        _bodyIds.reserve(movableAabbDefinitions.size());
+        for (auto& movableAabb2dDefinition : movableAabbDefinitions)
+        {
+            CreateBody(movableAabb2dDefinition);
+        }
+
+        // Static AABBs and tile grids take the ids after the movable ones.
+        for (size_t i = 0; i < _staticAabbs.Aabbs().Count() + _tileGrids.size(); i++)
+        {
+            AllocateSlot();
+        }
+
+        // Sized now so saving the first frames does not allocate.  None of
+        // them counts as saved until SaveState.
+        for (auto& saved : _savedStates)
+        {
+            _aabbs.SaveKinematics(saved.aabbs);
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    BodyHandle BasicScene<Broadphase, HandlerPolicy>::AddBody(const MovableAabb2dDefinition& definition)
+    {
+        BodyHandle handle = CreateBody(definition);
+        _broadphase->AabbAdded(_aabbs, IndexOf(handle.bodyId));
+        return handle;
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::RemoveBody(BodyHandle handle)
+    {
+        if (!IsValid(handle))
+        {
+            return;
+        }
+
+        if (IsStaticBody(handle.bodyId))
+        {
+            std::stringstream ss;
+            ss << "Body " << handle.bodyId << " is static and can not be removed";
+            throw std::invalid_argument(ss.str());
+        }
+
+        if (_isDispatching)
+        {
+            _pendingRemovals.push_back(handle);
+            return;
+        }
+
+        DestroyBody(handle);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    bool BasicScene<Broadphase, HandlerPolicy>::IsValid(BodyHandle handle) const
+    {
+        if (handle.bodyId >= _bodySlots.size())
+        {
+            return false;
+        }
+
+        auto& slot = _bodySlots[handle.bodyId];
+        return slot.isAlive && slot.generation == handle.generation;
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    BodyHandle BasicScene<Broadphase, HandlerPolicy>::HandleOf(uint32_t bodyId) const
+    {
+        if (bodyId >= _bodySlots.size() || !_bodySlots[bodyId].isAlive)
+        {
+            return BodyHandle();
+        }
+        return { bodyId, _bodySlots[bodyId].generation };
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    IMovableAabb2d* BasicScene<Broadphase, HandlerPolicy>::Body(BodyHandle handle)
+    {
+        if (!IsValid(handle) || IsStaticBody(handle.bodyId))
+        {
+            return nullptr;
+        }
+        return &_bodySlots[handle.bodyId].view;
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::InterpolatedPositions(std::span<glm::vec2> positions) const
+    {
+        _aabbs.CheckAccessThread();
+        CheckBodyIdSpan("InterpolatedPositions", positions.size());
+
+        float alpha = _timeNotYetSimulated / _stepDuration;
+        const float* minX = _aabbs.MinX();
+        const float* minY = _aabbs.MinY();
+        const float* previousMinX = _aabbs.PreviousMinX();
+        const float* previousMinY = _aabbs.PreviousMinY();
+        for (uint32_t i = 0; i < _aabbs.Count(); i++)
+        {
+            positions[_bodyIds[i]] = glm::vec2(
+                previousMinX[i] + (minX[i] - previousMinX[i]) * alpha,
+                previousMinY[i] + (minY[i] - previousMinY[i]) * alpha);
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::Positions(std::span<glm::vec2> positions) const
+    {
+        _aabbs.CheckAccessThread();
+        CheckBodyIdSpan("Positions", positions.size());
+        CopyByBodyId(_aabbs.MinX(), _aabbs.MinY(), positions);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::Velocities(std::span<glm::vec2> velocities) const
+    {
+        _aabbs.CheckAccessThread();
+        CheckBodyIdSpan("Velocities", velocities.size());
+        CopyByBodyId(_aabbs.VelocityX(), _aabbs.VelocityY(), velocities);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::Accelerations(std::span<glm::vec2> accelerations) const
+    {
+        _aabbs.CheckAccessThread();
+        CheckBodyIdSpan("Accelerations", accelerations.size());
+        CopyByBodyId(_aabbs.AccelerationX(), _aabbs.AccelerationY(), accelerations);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::SetPositions(std::span<const BodyHandle> bodies, std::span<const glm::vec2> positions)
+    {
+        if (bodies.size() != positions.size())
+        {
+            std::stringstream ss;
+            ss << "SetPositions was given " << bodies.size() << " bodies but " << positions.size() << " values";
+            throw std::invalid_argument(ss.str());
+        }
+
+        // Moves each AABB without changing its size, the same as
+        // Aabb::Position.
+        float* minX = _aabbs.MinX();
+        float* minY = _aabbs.MinY();
+        float* maxX = _aabbs.MaxX();
+        float* maxY = _aabbs.MaxY();
+        for (size_t i = 0; i < bodies.size(); i++)
+        {
+            uint32_t index = MovableIndexOf(bodies[i]);
+            if (index == NoIndex)
+            {
+                continue;
+            }
+
+            _aabbs.BeforeMove(index);
+            _aabbs.BeforeWrite(index);
+            float width = maxX[index] - minX[index];
+            float height = maxY[index] - minY[index];
+            minX[index] = positions[i].x;
+            minY[index] = positions[i].y;
+            maxX[index] = positions[i].x + width;
+            maxY[index] = positions[i].y + height;
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::SetVelocities(std::span<const BodyHandle> bodies, std::span<const glm::vec2> velocities)
+    {
+        SetByHandle("SetVelocities", _aabbs.VelocityX(), _aabbs.VelocityY(), bodies, velocities);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::SetAccelerations(std::span<const BodyHandle> bodies, std::span<const glm::vec2> accelerations)
+    {
+        SetByHandle("SetAccelerations", _aabbs.AccelerationX(), _aabbs.AccelerationY(), bodies, accelerations);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::SetPositions(std::span<const glm::vec2> positions)
+    {
+        CheckBodyIdSpan("SetPositions", positions.size());
+
+        uint32_t aabbCount = _aabbs.Count();
+        float* minX = _aabbs.MinX();
+        float* minY = _aabbs.MinY();
+        float* maxX = _aabbs.MaxX();
+        float* maxY = _aabbs.MaxY();
+        for (uint32_t i = 0; i < aabbCount; i++)
+        {
+            _aabbs.BeforeMove(i);
+            _aabbs.BeforeWrite(i);
+            const glm::vec2& position = positions[_bodyIds[i]];
+            float width = maxX[i] - minX[i];
+            float height = maxY[i] - minY[i];
+            minX[i] = position.x;
+            minY[i] = position.y;
+            maxX[i] = position.x + width;
+            maxY[i] = position.y + height;
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::SetVelocities(std::span<const glm::vec2> velocities)
+    {
+        SetByBodyId("SetVelocities", _aabbs.VelocityX(), _aabbs.VelocityY(), velocities);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::SetAccelerations(std::span<const glm::vec2> accelerations)
+    {
+        SetByBodyId("SetAccelerations", _aabbs.AccelerationX(), _aabbs.AccelerationY(), accelerations);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::CopyMovableState(
+        std::span<glm::vec2> positions,
+        std::span<glm::vec2> previousPositions,
+        std::span<glm::vec2> velocities) const
+    {
+        CopyByBodyId(_aabbs.MinX(), _aabbs.MinY(), positions);
+        CopyByBodyId(_aabbs.PreviousMinX(), _aabbs.PreviousMinY(), previousPositions);
+        CopyByBodyId(_aabbs.VelocityX(), _aabbs.VelocityY(), velocities);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::CheckBodyIdSpan(const char* function, size_t size) const
+    {
+        if (size < BodyIdCount())
+        {
+            std::stringstream ss;
+            ss << function << " needs room for " << BodyIdCount() << " values but was given " << size;
+            throw std::invalid_argument(ss.str());
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::CopyByBodyId(const float* x, const float* y, std::span<glm::vec2> values) const
+    {
+        for (uint32_t i = 0; i < _aabbs.Count(); i++)
+        {
+            values[_bodyIds[i]] = glm::vec2(x[i], y[i]);
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::SetByBodyId(const char* function, float* x, float* y, std::span<const glm::vec2> values)
+    {
+        CheckBodyIdSpan(function, values.size());
+
+        // With nothing asleep or being preserved there is nothing to do per
+        // AABB but copy.
+        uint32_t aabbCount = _aabbs.Count();
+        if (_sleepingBodyCount == 0 && !_aabbs.IsPreserving())
+        {
+            for (uint32_t i = 0; i < aabbCount; i++)
+            {
+                x[i] = values[_bodyIds[i]].x;
+                y[i] = values[_bodyIds[i]].y;
+            }
+            return;
+        }
+
+        for (uint32_t i = 0; i < aabbCount; i++)
+        {
+            _aabbs.BeforeMove(i);
+            _aabbs.BeforeWrite(i);
+            x[i] = values[_bodyIds[i]].x;
+            y[i] = values[_bodyIds[i]].y;
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::SetByHandle(
+        const char* function,
+        float* x,
+        float* y,
+        std::span<const BodyHandle> bodies,
+        std::span<const glm::vec2> values)
+    {
+        if (bodies.size() != values.size())
+        {
+            std::stringstream ss;
+            ss << function << " was given " << bodies.size() << " bodies but " << values.size() << " values";
+            throw std::invalid_argument(ss.str());
+        }
+
+        for (size_t i = 0; i < bodies.size(); i++)
+        {
+            uint32_t index = MovableIndexOf(bodies[i]);
+            if (index == NoIndex)
+            {
+                continue;
+            }
+
+            _aabbs.BeforeMove(index);
+            _aabbs.BeforeWrite(index);
+            x[index] = values[i].x;
+            y[index] = values[i].y;
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    bool BasicScene<Broadphase, HandlerPolicy>::IsSleeping(BodyHandle handle) const
+    {
+        return IsValid(handle)
+            && !IsStaticBody(handle.bodyId)
+            && !_aabbs.IsAwake()[IndexOf(handle.bodyId)];
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    uint32_t BasicScene<Broadphase, HandlerPolicy>::QueryPoint(glm::vec2 point, std::span<uint32_t> bodyIds, uint32_t categoryMask) const
+    {
+        auto lock = LockForQuery();
+        _movableAabbTree.Update(_aabbs);
+        return QueryBounds({ point.x, point.y, point.x, point.y }, bodyIds, categoryMask, _queryScratchPerWorker[0]);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    uint32_t BasicScene<Broadphase, HandlerPolicy>::QueryRegion(glm::vec2 position, glm::vec2 size, std::span<uint32_t> bodyIds, uint32_t categoryMask) const
+    {
+        auto lock = LockForQuery();
+        _movableAabbTree.Update(_aabbs);
+        return QueryBounds(
+            { position.x, position.y, position.x + size.x, position.y + size.y },
+            bodyIds,
+            categoryMask,
+            _queryScratchPerWorker[0]);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    uint32_t BasicScene<Broadphase, HandlerPolicy>::QueryBounds(
+        const Bounds& bounds,
+        std::span<uint32_t> bodyIds,
+        uint32_t categoryMask,
+        QueryScratch& scratch) const
+    {
+        uint32_t foundCount = 0;
+        auto found = [&](uint32_t bodyId)
+        {
+            if (foundCount < bodyIds.size())
+            {
+                bodyIds[foundCount] = bodyId;
+            }
+            foundCount++;
+        };
+
+        // Leaves of both trees hold the exact bounds.
+        ForEachMovable(
+            [&](const Bounds& nodeBounds) { return nodeBounds.Overlaps(bounds); },
+            categoryMask,
+            scratch,
+            [&](uint32_t index)
+            {
+                found(_bodyIds[index]);
+            });
+
+        const uint32_t* staticCategories = _staticAabbs.Aabbs().CollisionCategory();
+        _staticAabbs.ForEachAabb(
+            [&](const Bounds& nodeBounds) { return nodeBounds.Overlaps(bounds); },
+            scratch.stack,
+            [&](uint32_t staticIndex)
+            {
+                if ((staticCategories[staticIndex] & categoryMask) != 0)
+                {
+                    found(_firstStaticBodyId + staticIndex);
+                }
+            });
+
+        uint32_t firstTileGridBodyId = _firstStaticBodyId + _staticAabbs.Aabbs().Count();
+        for (uint32_t i = 0; i < _tileGrids.size(); i++)
+        {
+            auto& tileGrid = _tileGrids[i];
+            if ((tileGrid.Aabbs().CollisionCategory()[0] & categoryMask) != 0 && tileGrid.Overlaps(bounds))
+            {
+                found(firstTileGridBodyId + i);
+            }
+        }
+        return foundCount;
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    bool BasicScene<Broadphase, HandlerPolicy>::Raycast(glm::vec2 origin, glm::vec2 direction, RaycastHit& hit, uint32_t categoryMask) const
+    {
+        auto lock = LockForQuery();
+        _movableAabbTree.Update(_aabbs);
+        return RaycastAll(origin, direction, std::span<RaycastHit>(&hit, 1), categoryMask, false, _queryScratchPerWorker[0]) > 0;
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    uint32_t BasicScene<Broadphase, HandlerPolicy>::RaycastAll(glm::vec2 origin, glm::vec2 direction, std::span<RaycastHit> hits, uint32_t categoryMask) const
+    {
+        auto lock = LockForQuery();
+        _movableAabbTree.Update(_aabbs);
+        return RaycastAll(origin, direction, hits, categoryMask, true, _queryScratchPerWorker[0]);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    uint32_t BasicScene<Broadphase, HandlerPolicy>::RaycastAll(
+        glm::vec2 origin,
+        glm::vec2 direction,
+        std::span<RaycastHit> hits,
+        uint32_t categoryMask,
+        bool countEveryHit,
+        QueryScratch& scratch) const
+    {
+        // The ray is a point moving from origin by direction.
+        Bounds start = { origin.x, origin.y, origin.x, origin.y };
+        uint32_t hitCount = 0;
+        uint32_t keptCount = 0;
+        auto hitAt = [&](uint32_t bodyId, float fraction)
+        {
+            hitCount++;
+            KeepBestResult(hits, keptCount, { bodyId, fraction }, IsCloserHit);
+        };
+
+        auto isWanted = [&](const Bounds& nodeBounds)
+        {
+            float firstTouch;
+            return start.OverlapsWhileMoving(nodeBounds, direction.x, direction.y, firstTouch)
+                && (countEveryHit || keptCount < hits.size() || firstTouch <= hits.front().fraction);
+        };
+
+        ForEachMovable(isWanted, categoryMask, scratch, [&](uint32_t index)
+        {
+            float fraction;
+            if (start.OverlapsWhileMoving(_aabbs.BoundsOf(index), direction.x, direction.y, fraction))
+            {
+                hitAt(_bodyIds[index], fraction);
+            }
+        });
+
+        const AabbStorage& staticAabbs = _staticAabbs.Aabbs();
+        _staticAabbs.ForEachAabb(
+            isWanted,
+            scratch.stack,
+            [&](uint32_t staticIndex)
+            {
+                float fraction;
+                if ((staticAabbs.CollisionCategory()[staticIndex] & categoryMask) != 0
+                    && start.OverlapsWhileMoving(staticAabbs.BoundsOf(staticIndex), direction.x, direction.y, fraction))
+                {
+                    hitAt(_firstStaticBodyId + staticIndex, fraction);
+                }
+            });
+
+        uint32_t firstTileGridBodyId = _firstStaticBodyId + staticAabbs.Count();
+        for (uint32_t i = 0; i < _tileGrids.size(); i++)
+        {
+            auto& tileGrid = _tileGrids[i];
+            float fraction;
+            if ((tileGrid.Aabbs().CollisionCategory()[0] & categoryMask) != 0
+                && tileGrid.Raycast(origin.x, origin.y, direction.x, direction.y, fraction))
+            {
+                hitAt(firstTileGridBodyId + i, fraction);
+            }
+        }
+
+        SortBestResults(hits, keptCount, IsCloserHit);
+        return hitCount;
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    uint32_t BasicScene<Broadphase, HandlerPolicy>::NearestK(glm::vec2 point, std::span<NearestBody> nearest, uint32_t categoryMask) const
+    {
+        // Squared distances until the end.
+        uint32_t keptCount = 0;
+        auto consider = [&](uint32_t bodyId, float distanceSquared)
+        {
+            KeepBestResult(nearest, keptCount, { bodyId, distanceSquared }, IsNearerBody);
+        };
+        auto furthestKept = [&]()
+        {
+            return keptCount < nearest.size() ? std::numeric_limits<float>::infinity() : nearest.front().distance;
+        };
+
+        if (nearest.empty())
+        {
+            return 0;
+        }
+
+        auto lock = LockForQuery();
+        _movableAabbTree.Update(_aabbs);
+
+        // Both trees are searched closest first and skip nodes further away
+        // than the furthest kept, so once the heap fills up only nodes near
+        // point are visited.
+        auto& stack = _queryScratchPerWorker[0].stack;
+        auto distance = [&](const Bounds& bounds) { return bounds.DistanceSquaredTo(point.x, point.y); };
+        auto isWanted = [&](const Bounds& nodeBounds) { return distance(nodeBounds) <= furthestKept(); };
+        const uint32_t* categories = _aabbs.CollisionCategory();
+        _movableAabbTree.ForEachAabbClosestFirst(isWanted, distance, stack, [&](uint32_t index)
+        {
+            if ((categories[index] & categoryMask) != 0)
+            {
+                consider(_bodyIds[index], distance(_aabbs.BoundsOf(index)));
+            }
+        });
+
+        const AabbStorage& staticAabbs = _staticAabbs.Aabbs();
+        _staticAabbs.ForEachAabbClosestFirst(
+            isWanted,
+            distance,
+            stack,
+            [&](uint32_t staticIndex)
+            {
+                if ((staticAabbs.CollisionCategory()[staticIndex] & categoryMask) != 0)
+                {
+                    consider(_firstStaticBodyId + staticIndex, distance(staticAabbs.BoundsOf(staticIndex)));
+                }
+            });
+
+        uint32_t firstTileGridBodyId = _firstStaticBodyId + staticAabbs.Count();
+        for (uint32_t i = 0; i < _tileGrids.size(); i++)
+        {
+            auto& tileGrid = _tileGrids[i];
+            if ((tileGrid.Aabbs().CollisionCategory()[0] & categoryMask) == 0)
+            {
+                continue;
+            }
+
+            float distanceSquared = tileGrid.DistanceSquaredToSolidCell(point.x, point.y, furthestKept());
+            if (distanceSquared != std::numeric_limits<float>::infinity())
+            {
+                consider(firstTileGridBodyId + i, distanceSquared);
+            }
+        }
+
+        SortBestResults(nearest, keptCount, IsNearerBody);
+        for (uint32_t i = 0; i < keptCount; i++)
+        {
+            nearest[i].distance = std::sqrt(nearest[i].distance);
+        }
+        return keptCount;
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    uint32_t BasicScene<Broadphase, HandlerPolicy>::RaycastBatch(std::span<const Ray> rays, std::span<RaycastHit> hits, uint32_t categoryMask) const
+    {
+        if (hits.size() < rays.size())
+        {
+            std::stringstream ss;
+            ss << "RaycastBatch needs " << rays.size() << " hits but was given " << hits.size();
+            throw std::invalid_argument(ss.str());
+        }
+
+        auto lock = LockForQuery();
+        _movableAabbTree.Update(_aabbs);
+        std::atomic<uint32_t> hitCount = 0;
+        RunQueryBatch(static_cast<uint32_t>(rays.size()), [&](uint32_t rayIndex, QueryScratch& scratch)
+        {
+            auto& ray = rays[rayIndex];
+            RaycastHit& hit = hits[rayIndex];
+            if (RaycastAll(ray.origin, ray.direction, std::span<RaycastHit>(&hit, 1), categoryMask, false, scratch) > 0)
+            {
+                hitCount.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                hit = { RaycastHit::NoBody, 1.0f };
+            }
+        });
+        return hitCount;
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::QueryRegionBatch(
+        std::span<const Region> regions,
+        std::span<uint32_t> bodyIds,
+        std::span<uint32_t> counts,
+        uint32_t categoryMask) const
+    {
+        if (counts.size() < regions.size())
+        {
+            std::stringstream ss;
+            ss << "QueryRegionBatch needs " << regions.size() << " counts but was given " << counts.size();
+            throw std::invalid_argument(ss.str());
+        }
+        if (regions.empty())
+        {
+            return;
+        }
+
+        auto lock = LockForQuery();
+        _movableAabbTree.Update(_aabbs);
+        size_t bodyIdsPerRegion = bodyIds.size() / regions.size();
+        RunQueryBatch(static_cast<uint32_t>(regions.size()), [&](uint32_t regionIndex, QueryScratch& scratch)
+        {
+            auto& region = regions[regionIndex];
+            counts[regionIndex] = QueryBounds(
+                { region.position.x, region.position.y, region.position.x + region.size.x, region.position.y + region.size.y },
+                bodyIds.subspan(regionIndex * bodyIdsPerRegion, bodyIdsPerRegion),
+                categoryMask,
+                scratch);
+        });
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::RunQueryBatch(uint32_t queryCount, const std::function<void(uint32_t, QueryScratch&)>& query) const
+    {
+        if (!_workers)
+        {
+            for (uint32_t queryIndex = 0; queryIndex < queryCount; queryIndex++)
+            {
+                query(queryIndex, _queryScratchPerWorker[0]);
+            }
+            return;
+        }
+
+        uint32_t taskCount = (queryCount + QueriesPerBatchTask - 1) / QueriesPerBatchTask;
+        _workers->Run(taskCount, [&](uint32_t taskIndex, uint32_t workerIndex)
+        {
+            QueryScratch& scratch = _queryScratchPerWorker[workerIndex];
+            uint32_t end = std::min(queryCount, (taskIndex + 1) * QueriesPerBatchTask);
+            for (uint32_t queryIndex = taskIndex * QueriesPerBatchTask; queryIndex < end; queryIndex++)
+            {
+                query(queryIndex, scratch);
+            }
+        });
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::SaveState(uint32_t frame)
+    {
+        auto& saved = _savedStates[frame % _savedStates.size()];
+        saved.isSaved = true;
+        saved.frame = frame;
+        saved.bodySetVersion = _bodySetVersion;
+        saved.timeNotYetSimulated = _timeNotYetSimulated;
+        _aabbs.SaveKinematics(saved.aabbs);
+        saved.contacts.assign(_contacts.begin(), _contacts.end());
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    bool BasicScene<Broadphase, HandlerPolicy>::RestoreState(uint32_t frame)
+    {
+        auto& saved = _savedStates[frame % _savedStates.size()];
+        if (!saved.isSaved || saved.frame != frame || saved.bodySetVersion != _bodySetVersion || _isDispatching)
+        {
+            return false;
+        }
+
+        // Bodies may have been somewhere else when they fell asleep, so wake
+        // them all rather than leave islands that no longer touch.
+        WakeWokenBodies();
+        for (uint32_t island = 0; island < _sleepingIslands.size(); island++)
+        {
+            if (!_sleepingIslands[island].bodyIds.empty())
+            {
+                WakeIsland(island, false);
+            }
+        }
+        std::fill(_aabbs.StepsAtRest(), _aabbs.StepsAtRest() + _aabbs.Count(), 0);
+
+        _timeNotYetSimulated = saved.timeNotYetSimulated;
+        _aabbs.RestoreKinematics(saved.aabbs);
+        _contacts.assign(saved.contacts.begin(), saved.contacts.end());
+
+        // The next step's events are relative to the restored contacts.
+        if (_trackContactEvents)
+        {
+            _contactPairCache.Clear();
+            _contactPairCache.Update(_contacts, _restoredContactEvents);
+        }
+        return true;
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    uint32_t BasicScene<Broadphase, HandlerPolicy>::AllocateSlot()
+    {
+        uint32_t bodyId = _firstFreeSlot;
+        if (bodyId == NoFreeSlot)
+        {
+            bodyId = static_cast<uint32_t>(_bodySlots.size());
+            _bodySlots.push_back({ Aabb(_aabbs, 0), 1, true, NoFreeSlot, NoIsland });
+            _handleIndices.push_back({ 1, NoIndex });
+            return bodyId;
+        }
+
+        auto& slot = _bodySlots[bodyId];
+        _firstFreeSlot = slot.nextFreeSlot;
+        slot.isAlive = true;
+        slot.nextFreeSlot = NoFreeSlot;
+        return bodyId;
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    BodyHandle BasicScene<Broadphase, HandlerPolicy>::CreateBody(const MovableAabb2dDefinition& definition)
+    {
+        _handlerPolicy.CheckDefinition(definition);
+        _bodySetVersion++;
+        uint32_t index = _aabbs.Add(
+            definition.Position(),
+            definition.Size(),
+            glm::vec2(),
+            glm::vec2(),
+            definition.CollisionHandler(),
+            definition.ObjectInfo());
+        _aabbs.UserData()[index] = definition.UserData();
+        _aabbs.CollisionCategory()[index] = definition.CollisionCategory();
+        _aabbs.CollisionMask()[index] = definition.CollisionMask();
+        _aabbs.InverseMass()[index] = definition.IsImmovable() ? 0.0f : 1.0f / definition.Mass();
+        if (definition.IsFast())
+        {
+            _aabbs.IsFast()[index] = 1;
+            _fastBodyCount++;
+        }
+
+        if (definition.CollisionViewHandler())
+        {
+            _aabbs.SetCollisionViewHandler(index, definition.CollisionViewHandler());
+        }
+
+        if (definition.ContactEventHandler())
+        {
+            _aabbs.SetContactEventHandler(
+                index,
+                definition.ContactEventHandler(),
+                definition.ReceivePersistEvents());
+            _trackContactEvents = true;
+        }
+
+        uint32_t bodyId = AllocateSlot();
+        _bodyIds.push_back(bodyId);
+        auto& slot = _bodySlots[bodyId];
+        slot.view.SetIndex(index);
+        _handleIndices[bodyId] = { slot.generation, index };
+
+        // The deque never moves its elements when it grows, so this pointer
+        // stays valid until the body is removed.
+        definition.SetAfterCreatePtr(&slot.view);
+        return { bodyId, slot.generation };
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::DestroyBody(BodyHandle handle)
+    {
+        // The same body may have been queued for removal more than once.
+        if (!IsValid(handle))
+        {
+            return;
+        }
+
+        uint32_t bodyId = handle.bodyId;
+        _bodySetVersion++;
+
+        // Whatever the body was asleep with may rest on it.
+        WakeWokenBodies();
+        if (_bodySlots[bodyId].island != NoIsland)
+        {
+            WakeIsland(_bodySlots[bodyId].island, false);
+        }
+
+        uint32_t index = IndexOf(bodyId);
+        uint32_t lastIndex = _aabbs.Count() - 1;
+        _fastBodyCount -= _aabbs.IsFast()[index];
+        _aabbs.SwapRemove(index);
+        _broadphase->AabbRemoved(_aabbs, index, lastIndex);
+
+        uint32_t movedBodyId = _bodyIds[lastIndex];
+        _bodyIds[index] = movedBodyId;
+        _bodyIds.pop_back();
+        _bodySlots[movedBodyId].view.SetIndex(index);
+        _handleIndices[movedBodyId].index = index;
+
+        auto& slot = _bodySlots[bodyId];
+        slot.isAlive = false;
+
+        // Skip 0 when the generation wraps so default handles never match.
+        if (++slot.generation == 0)
+        {
+            slot.generation = 1;
+        }
+        _handleIndices[bodyId] = { slot.generation, NoIndex };
+        slot.nextFreeSlot = _firstFreeSlot;
+        _firstFreeSlot = bodyId;
+
+        if (_trackContactEvents)
+        {
+            _removedBodyIds.push_back(bodyId);
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::Update(float deltaTime)
+    {
+        // Queries on other threads wait until every step is done.
+        std::lock_guard<std::mutex> lock(_stepMutex);
+        _steppingThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        struct SteppingThreadReset
+        {
+            std::atomic<std::thread::id>& steppingThread;
+            ~SteppingThreadReset() { steppingThread.store(std::thread::id(), std::memory_order_relaxed); }
+        } steppingThreadReset{ _steppingThread };
+
+        // Whatever is left over is shown by blending the last two steps, see
+        // InterpolatedPositions.
+        _timeNotYetSimulated += deltaTime;
+        while(_timeNotYetSimulated >= _stepDuration)
+        {
+            _timeNotYetSimulated -= _stepDuration;
+            WakeWokenBodies();
+            Integrate();
+            FindContacts();
+            DispatchContacts();
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::Integrate()
+    {
+        // Sleeping AABBs have their previous positions set to their current
+        // ones when they fall asleep, so there is nothing to save either.
+        uint32_t aabbCount = _aabbs.Count();
+        if (_sleepingBodyCount == aabbCount)
+        {
+            return;
+        }
+        _aabbs.BoundsChanged();
+
+        // Skipping sleeping AABBs costs a little per AABB, so only pay for it
+        // when some are asleep.
+        auto integrate = [&](uint32_t begin, uint32_t end)
+        {
+            // Saved here rather than in a separate pass so each range is only
+            // brought into cache once.
+            _aabbs.SavePreviousPositions(begin, end);
+            if (_sleepingBodyCount == 0)
+            {
+                _integrator.Integrate(_aabbs, begin, end, _stepDuration);
+            }
+            else
+            {
+                _integrator.IntegrateAwake(_aabbs, begin, end, _stepDuration);
+            }
+        };
+
+        if (!_workers)
+        {
+            integrate(0, aabbCount);
+            return;
+        }
+
+        uint32_t taskCount = (aabbCount + AabbsPerIntegrateTask - 1) / AabbsPerIntegrateTask;
+        _workers->Run(taskCount, [&](uint32_t taskIndex, uint32_t)
+        {
+            uint32_t begin = taskIndex * AabbsPerIntegrateTask;
+            uint32_t end = std::min(begin + AabbsPerIntegrateTask, aabbCount);
+            integrate(begin, end);
+        });
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::FindStaticOverlappingPairs()
+    {
+        uint32_t staticAabbCount = _staticAabbs.Aabbs().Count();
+        if (staticAabbCount == 0 && _tileGrids.empty())
+        {
+            return;
+        }
+
+        auto findPairs = [&](uint32_t begin, uint32_t end, uint32_t workerIndex, std::vector<OverlappingPair>& pairs)
+        {
+            if (staticAabbCount > 0)
+            {
+                _staticAabbs.FindOverlappingPairs(_aabbs, begin, end, _staticQueryStackPerWorker[workerIndex], pairs);
+            }
+            for (uint32_t i = 0; i < _tileGrids.size(); i++)
+            {
+                _tileGrids[i].FindOverlappingPairs(_aabbs, begin, end, staticAabbCount + i, pairs);
+            }
+        };
+
+        uint32_t aabbCount = _aabbs.Count();
+        if (!_workers)
+        {
+            findPairs(0, aabbCount, 0, _staticOverlappingPairs);
+            return;
+        }
+
+        uint32_t taskCount = (aabbCount + AabbsPerStaticQueryTask - 1) / AabbsPerStaticQueryTask;
+        _workers->Run(taskCount, [&](uint32_t taskIndex, uint32_t workerIndex)
+        {
+            uint32_t begin = taskIndex * AabbsPerStaticQueryTask;
+            uint32_t end = std::min(begin + AabbsPerStaticQueryTask, aabbCount);
+            findPairs(begin, end, workerIndex, _staticOverlappingPairsPerWorker[workerIndex]);
+        });
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::FindOverlappingPairs()
+    {
+        // Nothing can have started or stopped touching when everything is
+        // asleep.
+        bool isAllAsleep = _sleepingBodyCount == _aabbs.Count();
+        if (!_workers)
+        {
+            _overlappingPairs.clear();
+            _staticOverlappingPairs.clear();
+        }
+        else
+        {
+            for (uint32_t workerIndex = 0; workerIndex < _workers->WorkerCount(); workerIndex++)
+            {
+                _overlappingPairsPerWorker[workerIndex].clear();
+                _staticOverlappingPairsPerWorker[workerIndex].clear();
+            }
+        }
+        if (isAllAsleep)
+        {
+            return;
+        }
+
+        BeginSweepingFastBodies();
+        if (!_workers)
+        {
+            _broadphase->FindOverlappingPairs(_aabbs, _overlappingPairs);
+        }
+        else
+        {
+            _broadphase->FindOverlappingPairs(_aabbs, *_workers, _overlappingPairsPerWorker);
+        }
+        FindStaticOverlappingPairs();
+        EndSweepingFastBodies();
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::BeginSweepingFastBodies()
+    {
+        _sweptIndices.clear();
+        _unsweptBounds.clear();
+        if (_fastBodyCount == 0)
+        {
+            return;
+        }
+
+        // Sleeping AABBs did not move.
+        const uint8_t* isFast = _aabbs.IsFast();
+        const uint8_t* isAwake = _aabbs.IsAwake();
+        for (uint32_t i = 0; i < _aabbs.Count(); i++)
+        {
+            if ((isFast[i] & isAwake[i]) == 0)
+            {
+                continue;
+            }
+
+            Bounds bounds = _aabbs.BoundsOf(i);
+            Bounds swept = Bounds::Union(bounds, _aabbs.PreviousBoundsOf(i));
+            _sweptIndices.push_back(i);
+            _unsweptBounds.push_back(bounds);
+            _aabbs.MinX()[i] = swept.minX;
+            _aabbs.MinY()[i] = swept.minY;
+            _aabbs.MaxX()[i] = swept.maxX;
+            _aabbs.MaxY()[i] = swept.maxY;
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::EndSweepingFastBodies()
+    {
+        for (size_t i = 0; i < _sweptIndices.size(); i++)
+        {
+            uint32_t index = _sweptIndices[i];
+            _aabbs.MinX()[index] = _unsweptBounds[i].minX;
+            _aabbs.MinY()[index] = _unsweptBounds[i].minY;
+            _aabbs.MaxX()[index] = _unsweptBounds[i].maxX;
+            _aabbs.MaxY()[index] = _unsweptBounds[i].maxY;
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::AppendContacts(
+        const std::vector<OverlappingPair>& pairs,
+        const std::vector<OverlappingPair>& staticPairs,
+        std::vector<Contact>& contacts) const
+    {
+        // Pairs found by a fast AABB's swept bounds only touch if their
+        // paths actually cross.
+        bool hasFastBodies = _fastBodyCount > 0;
+        const uint8_t* isFast = _aabbs.IsFast();
+        for (auto& pair : pairs)
+        {
+            uint32_t bodyId0 = _bodyIds[pair.index0];
+            uint32_t bodyId1 = _bodyIds[pair.index1];
+            if (hasFastBodies
+                && (isFast[pair.index0] | isFast[pair.index1]) != 0
+                && !IsSweptColliding(bodyId0, bodyId1))
+            {
+                continue;
+            }
+            contacts.push_back({ std::min(bodyId0, bodyId1), std::max(bodyId0, bodyId1) });
+        }
+
+        // Bodies added after the scene was created have ids after the static
+        // AABBs, so either side can be the static one.
+        for (auto& pair : staticPairs)
+        {
+            uint32_t bodyId0 = _bodyIds[pair.index0];
+            uint32_t bodyId1 = _firstStaticBodyId + pair.index1;
+            if (hasFastBodies && isFast[pair.index0] != 0 && !IsSweptColliding(bodyId0, bodyId1))
+            {
+                continue;
+            }
+            contacts.push_back({ std::min(bodyId0, bodyId1), std::max(bodyId0, bodyId1) });
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::FindContacts()
+    {
+        FindOverlappingPairs();
+
+        // Dispatch in ascending order of body ids so handlers are called in
+        // the same sequence for every broadphase and thread count.
+        _contacts.clear();
+        if (!_workers)
+        {
+            AppendContacts(_overlappingPairs, _staticOverlappingPairs, _contacts);
+            std::sort(_contacts.begin(), _contacts.end());
+        }
+        else
+        {
+            // Which worker found a pair depends on timing, so sort each
+            // worker's contacts and merge them into one list in a fixed order.
+            _workers->Run(_workers->WorkerCount(), [&](uint32_t taskIndex, uint32_t)
+            {
+                auto& contacts = _contactsPerWorker[taskIndex];
+                contacts.clear();
+                AppendContacts(_overlappingPairsPerWorker[taskIndex], _staticOverlappingPairsPerWorker[taskIndex], contacts);
+                std::sort(contacts.begin(), contacts.end());
+            });
+
+            for (auto& contacts : _contactsPerWorker)
+            {
+                _mergedContacts.resize(_contacts.size() + contacts.size());
+                std::merge(
+                    _contacts.begin(), _contacts.end(),
+                    contacts.begin(), contacts.end(),
+                    _mergedContacts.begin());
+                std::swap(_contacts, _mergedContacts);
+            }
+        }
+
+        // Awake bodies touching sleeping ones wake them, along with the
+        // contacts of their islands that were not looked for.
+        if (_sleepingBodyCount > 0)
+        {
+            size_t foundContactCount = _contacts.size();
+            for (size_t i = 0; i < foundContactCount; i++)
+            {
+                for (uint32_t bodyId : { _contacts[i].bodyA, _contacts[i].bodyB })
+                {
+                    if (!IsStaticBody(bodyId) && _bodySlots[bodyId].island != NoIsland)
+                    {
+                        WakeIsland(_bodySlots[bodyId].island, true);
+                    }
+                }
+            }
+            if (_contacts.size() != foundContactCount)
+            {
+                std::sort(_contacts.begin(), _contacts.end());
+            }
+        }
+
+        if (_trackContactEvents)
+        {
+            // A removed body's id may already belong to a new body, so its
+            // old contacts must go before this step's are recorded.
+            if (!_removedBodyIds.empty())
+            {
+                std::sort(_removedBodyIds.begin(), _removedBodyIds.end());
+                _contactPairCache.RemoveBodies(_removedBodyIds);
+                _removedBodyIds.clear();
+            }
+
+            _contactEvents.clear();
+            _contactPairCache.Update(_contacts, _contactEvents);
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::DispatchContacts()
+    {
+        // Handlers are shown the other body as it was when contacts were found.
+        // Storage keeps a copy of a body only when a handler first changes it,
+        // so handlers that just read cost nothing extra.
+        _aabbs.BeginPreservingPreStepState();
+        _isDispatching = true;
+
+        // Ends dispatching even if a handler throws, so afterwards bodies can
+        // be added and removed as usual and later handlers are not shown state
+        // preserved during this step.
+        struct DispatchingReset
+        {
+            BasicScene& scene;
+            ~DispatchingReset()
+            {
+                scene._isDispatching = false;
+                scene._aabbs.EndPreservingPreStepState();
+            }
+        };
+
+        {
+            DispatchingReset dispatchingReset{ *this };
+            if (_contactsHandler)
+            {
+                _contactsHandler(std::span<const Contact>(_contacts));
+            }
+            else if constexpr (HandlerPolicy::IsDispatching)
+            {
+                for (auto& contact : _contacts)
+                {
+                    // An earlier handler in this step may have moved or resized
+                    // either of these, so check they still collide.
+                    if (IsColliding(contact))
+                    {
+                        DispatchCollision(contact.bodyA, contact.bodyB);
+                        DispatchCollision(contact.bodyB, contact.bodyA);
+                    }
+                }
+            }
+
+            if (_trackContactEvents)
+            {
+                DispatchContactEvents();
+            }
+        }
+
+        WakeWokenBodies();
+        if (_resolveCollisions)
+        {
+            ResolveCollisions();
+        }
+        UpdateSleep();
+
+        for (auto& handle : _pendingRemovals)
+        {
+            DestroyBody(handle);
+        }
+        _pendingRemovals.clear();
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::ResolveCollisions()
+    {
+        if (_contacts.empty())
+        {
+            return;
+        }
+
+        _contactResolver.Begin(_aabbs.Count());
+        const float* inverseMass = _aabbs.InverseMass();
+        for (auto& contact : _contacts)
+        {
+            // Bodies added after the scene was created have ids after the
+            // static ones, so either side can be static.  Make it bodyB.
+            uint32_t bodyA = contact.bodyA;
+            uint32_t bodyB = contact.bodyB;
+            if (IsStaticBody(bodyA))
+            {
+                std::swap(bodyA, bodyB);
+            }
+
+            uint32_t indexA = IndexOf(bodyA);
+            Bounds boundsA = _aabbs.BoundsOf(indexA);
+            if (IsTileGridBody(bodyB))
+            {
+                if (inverseMass[indexA] > 0.0f)
+                {
+                    TileGridOf(bodyB).ForEachSeparatingMove(boundsA, [&](float moveX, float moveY)
+                    {
+                        _contactResolver.AddMove(indexA, moveX, moveY);
+                    });
+                }
+                continue;
+            }
+
+            // Handlers may have moved either body out of the way already.
+            float moveX;
+            float moveY;
+            if (!boundsA.SeparatingMoves(BoundsOf(bodyB), moveX, moveY))
+            {
+                continue;
+            }
+
+            bool isStaticB = IsStaticBody(bodyB);
+            uint32_t indexB = isStaticB ? 0 : IndexOf(bodyB);
+            float inverseMassA = inverseMass[indexA];
+            float inverseMassB = isStaticB ? 0.0f : inverseMass[indexB];
+            float inverseMassSum = inverseMassA + inverseMassB;
+            if (inverseMassSum == 0.0f)
+            {
+                continue;
+            }
+
+            if (std::abs(moveX) < std::abs(moveY))
+            {
+                moveY = 0.0f;
+            }
+            else
+            {
+                moveX = 0.0f;
+            }
+
+            float shareA = inverseMassA / inverseMassSum;
+            _contactResolver.AddMove(indexA, moveX * shareA, moveY * shareA);
+            if (!isStaticB)
+            {
+                float shareB = inverseMassB / inverseMassSum;
+                _contactResolver.AddMove(indexB, -moveX * shareB, -moveY * shareB);
+            }
+        }
+        _contactResolver.Apply(_aabbs);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    ReadOnlyAabb2dView BasicScene<Broadphase, HandlerPolicy>::ViewOf(uint32_t bodyId) const
+    {
+        if (IsStaticBody(bodyId))
+        {
+            auto [aabbs, index] = StaticAabbOf(bodyId);
+            return ReadOnlyAabb2dView(*aabbs, index, bodyId);
+        }
+        return ReadOnlyAabb2dView(_aabbs, IndexOf(bodyId), bodyId);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    Bounds BasicScene<Broadphase, HandlerPolicy>::BoundsOf(uint32_t bodyId) const
+    {
+        if (IsStaticBody(bodyId))
+        {
+            auto [aabbs, index] = StaticAabbOf(bodyId);
+            return aabbs->BoundsOf(index);
+        }
+        return _aabbs.BoundsOf(IndexOf(bodyId));
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    Bounds BasicScene<Broadphase, HandlerPolicy>::PreviousBoundsOf(uint32_t bodyId) const
+    {
+        return IsStaticBody(bodyId) ? BoundsOf(bodyId) : _aabbs.PreviousBoundsOf(IndexOf(bodyId));
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    bool BasicScene<Broadphase, HandlerPolicy>::IsFastBody(uint32_t bodyId) const
+    {
+        return _fastBodyCount > 0
+            && !IsStaticBody(bodyId)
+            && _aabbs.IsFast()[IndexOf(bodyId)] != 0;
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    bool BasicScene<Broadphase, HandlerPolicy>::IsColliding(const Contact& contact) const
+    {
+        if (IsFastBody(contact.bodyA) || IsFastBody(contact.bodyB))
+        {
+            return IsSweptColliding(contact.bodyA, contact.bodyB);
+        }
+        if (IsTileGridBody(contact.bodyA))
+        {
+            return TileGridOf(contact.bodyA).Overlaps(BoundsOf(contact.bodyB));
+        }
+        if (IsTileGridBody(contact.bodyB))
+        {
+            return TileGridOf(contact.bodyB).Overlaps(BoundsOf(contact.bodyA));
+        }
+        return BoundsOf(contact.bodyA).Overlaps(BoundsOf(contact.bodyB));
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    bool BasicScene<Broadphase, HandlerPolicy>::IsSweptColliding(uint32_t bodyA, uint32_t bodyB) const
+    {
+        // Tile grids never move, so only the other body's path matters.
+        if (IsTileGridBody(bodyA))
+        {
+            std::swap(bodyA, bodyB);
+        }
+        if (IsTileGridBody(bodyB))
+        {
+            Bounds previous = PreviousBoundsOf(bodyA);
+            Bounds current = BoundsOf(bodyA);
+            return TileGridOf(bodyB).OverlapsWhileMoving(previous, current.minX - previous.minX, current.minY - previous.minY);
+        }
+
+        // Both move in a straight line through the step, so test A's path
+        // relative to B against where B started.
+        Bounds previousA = PreviousBoundsOf(bodyA);
+        Bounds previousB = PreviousBoundsOf(bodyB);
+        Bounds currentA = BoundsOf(bodyA);
+        Bounds currentB = BoundsOf(bodyB);
+        float deltaX = (currentA.minX - previousA.minX) - (currentB.minX - previousB.minX);
+        float deltaY = (currentA.minY - previousA.minY) - (currentB.minY - previousB.minY);
+        return previousA.OverlapsWhileMoving(previousB, deltaX, deltaY);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::DispatchCollision(uint32_t body, uint32_t otherBody)
+    {
+        if (IsStaticBody(body))
+        {
+            return;
+        }
+
+        _handlerPolicy.Dispatch(_aabbs, IndexOf(body), _bodySlots[body].view, ViewOf(otherBody));
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::DispatchContactEvents()
+    {
+        if (_contactEventsHandler)
+        {
+            _contactEventsHandler(std::span<const ContactEvent>(_contactEvents));
+            return;
+        }
+
+        // Events are not re-checked like collisions are.  The pair cache has
+        // already recorded them, so skipping one here would leave a Begin
+        // without an End or the other way around.
+        for (auto& event : _contactEvents)
+        {
+            DispatchContactEvent(event.type, event.contact.bodyA, event.contact.bodyB);
+            DispatchContactEvent(event.type, event.contact.bodyB, event.contact.bodyA);
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::DispatchContactEvent(ContactEventType type, uint32_t body, uint32_t otherBody)
+    {
+        // Static AABBs have no handlers.
+        if (IsStaticBody(body))
+        {
+            return;
+        }
+
+        uint32_t index = IndexOf(body);
+        auto& handler = _aabbs.ContactEventHandler(index);
+        bool isPersist = type == ContactEventType::Persist;
+        if (handler && (!isPersist || _aabbs.ReceivePersistEvents(index)))
+        {
+            handler(type, PreStepReadOnlyAabb2d(ViewOf(otherBody)));
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    uint32_t BasicScene<Broadphase, HandlerPolicy>::FindIslandRoot(uint32_t index)
+    {
+        while (_islandParents[index] != index)
+        {
+            // Path halving keeps the trees shallow.
+            _islandParents[index] = _islandParents[_islandParents[index]];
+            index = _islandParents[index];
+        }
+        return index;
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::UpdateSleep()
+    {
+        if (_stepsBeforeSleep == 0)
+        {
+            return;
+        }
+
+        uint32_t aabbCount = _aabbs.Count();
+        const float* velocityX = _aabbs.VelocityX();
+        const float* velocityY = _aabbs.VelocityY();
+        const float* accelerationX = _aabbs.AccelerationX();
+        const float* accelerationY = _aabbs.AccelerationY();
+        const uint8_t* isAwake = _aabbs.IsAwake();
+        uint32_t* stepsAtRest = _aabbs.StepsAtRest();
+        bool isAnyReady = false;
+        for (uint32_t i = 0; i < aabbCount; i++)
+        {
+            bool isAtRest = velocityX[i] * velocityX[i] + velocityY[i] * velocityY[i] < _sleepVelocityThresholdSquared
+                && accelerationX[i] * accelerationX[i] + accelerationY[i] * accelerationY[i] < _sleepAccelerationThresholdSquared;
+            stepsAtRest[i] = isAtRest ? std::min(stepsAtRest[i] + 1, _stepsBeforeSleep) : 0;
+            isAnyReady |= isAwake[i] && stepsAtRest[i] == _stepsBeforeSleep;
+        }
+
+        if (!isAnyReady)
+        {
+            return;
+        }
+
+        // Join bodies that touch into islands.  Sleeping bodies are never in
+        // this step's contacts with awake ones, they would have been woken.
+        _islandParents.resize(aabbCount);
+        for (uint32_t i = 0; i < aabbCount; i++)
+        {
+            _islandParents[i] = i;
+        }
+        for (auto& contact : _contacts)
+        {
+            if (!IsStaticBody(contact.bodyA) && !IsStaticBody(contact.bodyB))
+            {
+                _islandParents[FindIslandRoot(IndexOf(contact.bodyA))] = FindIslandRoot(IndexOf(contact.bodyB));
+            }
+        }
+
+        // An island only sleeps when every body in it is ready to.
+        _islandCanSleep.assign(aabbCount, 1);
+        for (uint32_t i = 0; i < aabbCount; i++)
+        {
+            if (!isAwake[i] || stepsAtRest[i] < _stepsBeforeSleep)
+            {
+                _islandCanSleep[FindIslandRoot(i)] = 0;
+            }
+        }
+
+        _islandOfRoot.assign(aabbCount, NoIsland);
+        _newSleepingIslands.clear();
+        float* writableVelocityX = _aabbs.VelocityX();
+        float* writableVelocityY = _aabbs.VelocityY();
+        uint8_t* writableIsAwake = _aabbs.IsAwake();
+        for (uint32_t i = 0; i < aabbCount; i++)
+        {
+            uint32_t root = FindIslandRoot(i);
+            if (!_islandCanSleep[root])
+            {
+                continue;
+            }
+
+            if (_islandOfRoot[root] == NoIsland)
+            {
+                if (_freeSleepingIslands.empty())
+                {
+                    _islandOfRoot[root] = static_cast<uint32_t>(_sleepingIslands.size());
+                    _sleepingIslands.emplace_back();
+                }
+                else
+                {
+                    _islandOfRoot[root] = _freeSleepingIslands.back();
+                    _freeSleepingIslands.pop_back();
+                }
+                _newSleepingIslands.push_back(_islandOfRoot[root]);
+            }
+
+            uint32_t bodyId = _bodyIds[i];
+            _sleepingIslands[_islandOfRoot[root]].bodyIds.push_back(bodyId);
+            _bodySlots[bodyId].island = _islandOfRoot[root];
+            writableIsAwake[i] = 0;
+            writableVelocityX[i] = 0.0f;
+            writableVelocityY[i] = 0.0f;
+            _aabbs.PreviousMinX()[i] = _aabbs.MinX()[i];
+            _aabbs.PreviousMinY()[i] = _aabbs.MinY()[i];
+            _sleepingBodyCount++;
+        }
+
+        // Every contact of a body in a new island is with the same island or
+        // with a static AABB.
+        for (auto& contact : _contacts)
+        {
+            uint32_t movableBodyId = IsStaticBody(contact.bodyA) ? contact.bodyB : contact.bodyA;
+            uint32_t island = _bodySlots[movableBodyId].island;
+            if (island != NoIsland && _islandOfRoot[FindIslandRoot(IndexOf(movableBodyId))] == island)
+            {
+                _sleepingIslands[island].contacts.push_back(contact);
+            }
+        }
+
+        if (_trackContactEvents)
+        {
+            for (uint32_t island : _newSleepingIslands)
+            {
+                _contactPairCache.Freeze(_sleepingIslands[island].contacts);
+            }
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::WakeWokenBodies()
+    {
+        if (!_aabbs.HasWokenIndices())
+        {
+            return;
+        }
+
+        _aabbs.TakeWokenIndices(_wokenIndices);
+        for (uint32_t index : _wokenIndices)
+        {
+            uint32_t island = _bodySlots[_bodyIds[index]].island;
+            if (island != NoIsland)
+            {
+                WakeIsland(island, false);
+            }
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    void BasicScene<Broadphase, HandlerPolicy>::WakeIsland(uint32_t island, bool appendContacts)
+    {
+        auto& sleepingIsland = _sleepingIslands[island];
+        for (uint32_t bodyId : sleepingIsland.bodyIds)
+        {
+            uint32_t index = IndexOf(bodyId);
+            _aabbs.IsAwake()[index] = 1;
+            _aabbs.StepsAtRest()[index] = 0;
+            _bodySlots[bodyId].island = NoIsland;
+        }
+        _sleepingBodyCount -= static_cast<uint32_t>(sleepingIsland.bodyIds.size());
+
+        if (appendContacts)
+        {
+            _contacts.insert(_contacts.end(), sleepingIsland.contacts.begin(), sleepingIsland.contacts.end());
+        }
+        else if (_trackContactEvents)
+        {
+            _contactPairCache.Thaw(sleepingIsland.contacts);
+        }
+
+        sleepingIsland.bodyIds.clear();
+        sleepingIsland.contacts.clear();
+        _freeSleepingIslands.push_back(island);
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    std::unique_ptr<Broadphase> BasicScene<Broadphase, HandlerPolicy>::CreateBroadphase(const SceneDefinition& definition)
+    {
+        if constexpr (std::is_same_v<Broadphase, UniformGridBroadphase>)
+        {
+            return std::make_unique<UniformGridBroadphase>(definition.GridCellSize());
+        }
+        else if constexpr (std::is_same_v<Broadphase, SweepAndPruneBroadphase>)
+        {
+            return std::make_unique<SweepAndPruneBroadphase>(definition.SweepAndPruneAxes());
+        }
+        else if constexpr (std::is_same_v<Broadphase, DynamicTreeBroadphase>)
+        {
+            return std::make_unique<DynamicTreeBroadphase>(definition.DynamicTreeMargin());
+        }
+        else if constexpr (std::is_same_v<Broadphase, AllPairsBroadphase>)
+        {
+            return std::make_unique<AllPairsBroadphase>();
+        }
+        else
+        {
+            return CreateAnyBroadphase(definition);
+        }
+    }
+
+    template<typename Broadphase, typename HandlerPolicy>
+    std::unique_ptr<IBroadphase> BasicScene<Broadphase, HandlerPolicy>::CreateAnyBroadphase(const SceneDefinition& definition)
+    {
+        // Copies the settings so partitions can be created after the
+        // definition is gone.
+        auto createBroadphase = [
+            broadphase = definition.Broadphase(),
+            gridCellSize = definition.GridCellSize(),
+            sweepAndPruneAxes = definition.SweepAndPruneAxes(),
+            dynamicTreeMargin = definition.DynamicTreeMargin()]() -> std::unique_ptr<IBroadphase>
+        {
+            switch (broadphase)
+            {
+                case BroadphaseType::UniformGrid:
+                    return std::make_unique<UniformGridBroadphase>(gridCellSize);
+                case BroadphaseType::SweepAndPrune:
+                    return std::make_unique<SweepAndPruneBroadphase>(sweepAndPruneAxes);
+                case BroadphaseType::DynamicTree:
+                    return std::make_unique<DynamicTreeBroadphase>(dynamicTreeMargin);
+                case BroadphaseType::AllPairs:
+                default:
+                    return std::make_unique<AllPairsBroadphase>();
+            }
+        };
+
+        if (definition.PartitionBroadphaseByCollisionFilter())
+        {
+            return std::make_unique<PartitionedBroadphase>(createBroadphase);
+        }
+        return createBroadphase();
+    }
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+
+namespace JkEng::Physics
+{
+    // Identifies a body in a Physics::IScene.  bodyId is the same id
+    // contacts and ReadOnlyAabb2dView::BodyId use, and is reused after the
+    // body is removed, but with a new generation so old handles to it stop
+    // matching.  A default constructed handle never matches a body.
+    struct BodyHandle
+    {
+        uint32_t bodyId = 0;
+        uint32_t generation = 0;
+
+        auto operator<=>(const BodyHandle&) const = default;
+    };
+}
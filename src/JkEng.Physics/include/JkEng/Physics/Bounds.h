@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+
+namespace JkEng::Physics
+{
+    // Plain axis-aligned bounds used by the acceleration structures.
+    struct Bounds
+    {
+        float minX;
+        float minY;
+        float maxX;
+        float maxY;
+
+        bool operator==(const Bounds&) const = default;
+
+        inline bool Overlaps(const Bounds& other) const
+        {
+            return minX <= other.maxX && maxX >= other.minX
+                && minY <= other.maxY && maxY >= other.minY;
+        }
+
+        // Whether these bounds touch other at any point while moving by
+        // (deltaX, deltaY) relative to it, and if so the fraction of the
+        // move at which they first touch.
+        inline bool OverlapsWhileMoving(const Bounds& other, float deltaX, float deltaY, float& firstTouch) const
+        {
+            // The fractions of the move spent overlapping along each axis.
+            float enter = 0.0f;
+            float exit = 1.0f;
+            auto clipAxis = [&](float min, float max, float otherMin, float otherMax, float delta)
+            {
+                if (delta == 0.0f)
+                {
+                    return min <= otherMax && max >= otherMin;
+                }
+
+                float entersAt = (otherMin - max) / delta;
+                float exitsAt = (otherMax - min) / delta;
+                if (delta < 0.0f)
+                {
+                    std::swap(entersAt, exitsAt);
+                }
+                enter = std::max(enter, entersAt);
+                exit = std::min(exit, exitsAt);
+                return enter <= exit;
+            };
+            if (!clipAxis(minX, maxX, other.minX, other.maxX, deltaX)
+                || !clipAxis(minY, maxY, other.minY, other.maxY, deltaY))
+            {
+                return false;
+            }
+            firstTouch = enter;
+            return true;
+        }
+
+        inline bool OverlapsWhileMoving(const Bounds& other, float deltaX, float deltaY) const
+        {
+            float firstTouch;
+            return OverlapsWhileMoving(other, deltaX, deltaY, firstTouch);
+        }
+
+        // The moves along each axis that would take these bounds out of
+        // other the short way round, or false when they only touch or do
+        // not overlap at all.
+        inline bool SeparatingMoves(const Bounds& other, float& moveX, float& moveY) const
+        {
+            if (!(minX < other.maxX && maxX > other.minX && minY < other.maxY && maxY > other.minY))
+            {
+                return false;
+            }
+
+            moveX = minX + maxX < other.minX + other.maxX ? other.minX - maxX : other.maxX - minX;
+            moveY = minY + maxY < other.minY + other.maxY ? other.minY - maxY : other.maxY - minY;
+            return true;
+        }
+
+        // The squared distance from (x, y) to the closest point of these
+        // bounds, which is 0 inside them.
+        inline float DistanceSquaredTo(float x, float y) const
+        {
+            float distanceX = std::max({ minX - x, 0.0f, x - maxX });
+            float distanceY = std::max({ minY - y, 0.0f, y - maxY });
+            return distanceX * distanceX + distanceY * distanceY;
+        }
+
+        inline bool Contains(const Bounds& other) const
+        {
+            return minX <= other.minX && maxX >= other.maxX
+                && minY <= other.minY && maxY >= other.maxY;
+        }
+
+        inline float Perimeter() const
+        {
+            return 2.0f * ((maxX - minX) + (maxY - minY));
+        }
+
+        inline Bounds Expanded(float margin) const
+        {
+            return { minX - margin, minY - margin, maxX + margin, maxY + margin };
+        }
+
+        static inline Bounds Union(const Bounds& a, const Bounds& b)
+        {
+            return {
+                std::min(a.minX, b.minX),
+                std::min(a.minY, b.minY),
+                std::max(a.maxX, b.maxX),
+                std::max(a.maxY, b.maxY) };
+        }
+    };
+}
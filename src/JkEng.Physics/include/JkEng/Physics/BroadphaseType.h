@@ -0,0 +1,32 @@
+#pragma once
+
+namespace JkEng::Physics
+{
+    // Selects how a Physics::IScene finds the pairs of AABBs that need an
+    // exact overlap test each step.
+    enum class BroadphaseType
+    {
+        // Tests every pair of AABBs.  Cost grows quadratically with the
+        // number of AABBs but there is nothing to tune.
+        AllPairs,
+
+        // Buckets AABBs into the cells of a uniform grid (see
+        // SceneDefinition::GridCellSize) and only tests AABBs that share
+        // a cell.  Works best when most AABBs are about the size of a cell.
+        UniformGrid,
+
+        // Keeps the AABB bounds sorted along one or both axes (see
+        // SceneDefinition::SweepAndPruneAxes) from step to step and sweeps
+        // the sorted bounds for overlaps.  Re-sorting is close to linear
+        // when AABBs only move a little each step, and it works best when
+        // AABBs are spread out along the swept axis such as in a
+        // side-scroller.
+        SweepAndPrune,
+
+        // Keeps AABBs, padded by SceneDefinition::DynamicTreeMargin, in a
+        // bounding volume hierarchy that is only changed when an AABB moves
+        // out of its padded bounds.  Handles scenes that mix very small and
+        // very large AABBs or cluster them unevenly better than the grid.
+        DynamicTree
+    };
+}
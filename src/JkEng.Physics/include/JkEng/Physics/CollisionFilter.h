@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+namespace JkEng::Physics
+{
+    // Every AABB belongs to the categories set in its category bits and
+    // collides with the categories set in its mask bits.  Two AABBs are
+    // only tested against each other when each one's category is in the
+    // other's mask, so for example bullets can leave their own category
+    // out of their mask to never collide with each other.
+    constexpr uint32_t DefaultCollisionCategory = 0x00000001;
+    constexpr uint32_t DefaultCollisionMask = 0xFFFFFFFF;
+}
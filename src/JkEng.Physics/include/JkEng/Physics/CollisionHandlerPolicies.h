@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "AabbStorage.h"
+#include "IMovableAabb2d.h"
+#include "MovableAabb2dDefinition.h"
+#include "PreStepReadOnlyAabb2d.h"
+#include "ReadOnlyAabb2dView.h"
+
+namespace JkEng::Physics
+{
+    // How a BasicScene tells movable AABBs about their collisions.  The
+    // scene keeps the policy it was constructed with, which has:
+    //
+    // - IsDispatching, false to leave the loop over contacts that calls
+    //   Dispatch out of the scene altogether.
+    // - Dispatch(aabbs, index, body, otherView), called for the movable
+    //   AABB body, at index in aabbs, with a view of the body it collided
+    //   with.
+    // - CheckDefinition(definition), called for every movable AABB before
+    //   it is added, to reject handlers the policy would never call.
+    //
+    // The scene-wide ContactsHandler and contact events work the same
+    // whatever the policy, and a ContactsHandler is called instead of
+    // Dispatch.
+
+    // Throws std::invalid_argument if definition has a collision handler
+    // or collision view handler, for policies that never call them.
+    inline void RejectCollisionHandlers(const MovableAabb2dDefinition& definition, const char* policy)
+    {
+        if (definition.CollisionHandler() || definition.CollisionViewHandler())
+        {
+            throw std::invalid_argument(
+                std::string("MovableAabb2dDefinition has a collision handler but the scene does not call them, ")
+                + policy);
+        }
+    }
+
+    // Calls the CollisionHandler and CollisionViewHandler each movable
+    // AABB was defined with.
+    struct FunctionHandlers
+    {
+        static constexpr bool IsDispatching = true;
+
+        inline void Dispatch(
+            const AabbStorage& aabbs,
+            uint32_t index,
+            IMovableAabb2d& /*body*/,
+            const ReadOnlyAabb2dView& otherView) const
+        {
+            if (auto& collisionHandler = aabbs.CollisionHandler(index))
+            {
+                collisionHandler(PreStepReadOnlyAabb2d(otherView));
+            }
+            if (auto& collisionViewHandler = aabbs.CollisionViewHandler(index))
+            {
+                collisionViewHandler(otherView);
+            }
+        }
+
+        inline void CheckDefinition(const MovableAabb2dDefinition& /*definition*/) const
+        {
+
+        }
+    };
+
+    // Calls nothing per collision, for scenes whose contacts are only read
+    // through the ContactsHandler, contact events or queries.
+    struct NoHandlers
+    {
+        static constexpr bool IsDispatching = false;
+
+        inline void Dispatch(
+            const AabbStorage& /*aabbs*/,
+            uint32_t /*index*/,
+            IMovableAabb2d& /*body*/,
+            const ReadOnlyAabb2dView& /*otherView*/) const
+        {
+
+        }
+
+        inline void CheckDefinition(const MovableAabb2dDefinition& definition) const
+        {
+            RejectCollisionHandlers(definition, "see SceneDefinition::CollisionHandlers");
+        }
+    };
+
+    // The scene-wide handler of FunctionPointerHandlers, which is also
+    // how FunctorHandlers calls its functor.  body is the movable AABB that
+    // collided and can be written, and otherBody shows what it hit as it
+    // was when the step's contacts were found.
+    typedef void (*CollisionFunction)(IMovableAabb2d& body, const ReadOnlyAabb2dView& otherBody);
+
+    // Calls one function for every collision of every movable AABB through
+    // a plain function pointer, rather than a std::function per AABB.
+    // Movable AABBs can not have handlers of their own.
+    class FunctionPointerHandlers
+    {
+    public:
+        static constexpr bool IsDispatching = true;
+
+        explicit FunctionPointerHandlers(CollisionFunction function)
+          : _function(function)
+        {
+            if (_function == nullptr)
+            {
+                throw std::invalid_argument("FunctionPointerHandlers needs a function to call");
+            }
+        }
+
+        inline void Dispatch(
+            const AabbStorage& /*aabbs*/,
+            uint32_t /*index*/,
+            IMovableAabb2d& body,
+            const ReadOnlyAabb2dView& otherView) const
+        {
+            _function(body, otherView);
+        }
+
+        inline void CheckDefinition(const MovableAabb2dDefinition& definition) const
+        {
+            RejectCollisionHandlers(definition, "it calls FunctionPointerHandlers' function instead");
+        }
+
+    private:
+        CollisionFunction _function;
+    };
+
+    // Calls functor(body, otherBody), in the same way as a CollisionFunction,
+    // for every collision of every movable AABB.  The functor's type is
+    // known at compile time, so its call can be inlined into the loop over
+    // contacts.  Movable AABBs can not have handlers of their own.
+    template<typename Functor>
+    class FunctorHandlers
+    {
+    public:
+        static constexpr bool IsDispatching = true;
+
+        explicit FunctorHandlers(Functor functor = Functor())
+          : _functor(std::move(functor))
+        {
+
+        }
+
+        inline void Dispatch(
+            const AabbStorage& /*aabbs*/,
+            uint32_t /*index*/,
+            IMovableAabb2d& body,
+            const ReadOnlyAabb2dView& otherView)
+        {
+            _functor(body, otherView);
+        }
+
+        inline void CheckDefinition(const MovableAabb2dDefinition& definition) const
+        {
+            RejectCollisionHandlers(definition, "it calls FunctorHandlers' functor instead");
+        }
+
+    private:
+        Functor _functor;
+    };
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <span>
+
+namespace JkEng::Physics
+{
+    // Two bodies whose AABBs overlapped after a step.  Bodies are
+    // identified by the order their definitions were added to the
+    // SceneDefinition, starting at 0, and bodyA is always less than bodyB.
+    // Bodies added with IScene::AddBody reuse the ids of removed bodies or
+    // take the ids after every definition's.
+    struct Contact
+    {
+        uint32_t bodyA;
+        uint32_t bodyB;
+
+        auto operator<=>(const Contact&) const = default;
+    };
+
+    // Receives every contact found in one step at once, in ascending
+    // order.  The span is only valid during the call.
+    typedef std::function<void(std::span<const Contact>)> ContactsHandler;
+
+    enum class ContactEventType : uint8_t
+    {
+        // The bodies touch after this step but did not after the last.
+        Begin,
+
+        // The bodies touched after the last step and still do.
+        Persist,
+
+        // The bodies touched after the last step but no longer do.
+        End
+    };
+
+    struct ContactEvent
+    {
+        Contact contact;
+        ContactEventType type;
+
+        auto operator<=>(const ContactEvent&) const = default;
+    };
+
+    // Receives every contact event from one step at once, in ascending
+    // order of contact.  The span is only valid during the call.
+    typedef std::function<void(std::span<const ContactEvent>)> ContactEventsHandler;
+}
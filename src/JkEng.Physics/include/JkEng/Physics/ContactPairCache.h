@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Contact.h"
+
+namespace JkEng::Physics
+{
+    // Remembers which contacts existed after the last step so each step's
+    // contacts can be turned into Begin, Persist and End events.
+    //
+    // Contacts are kept in a dense array for iteration, indexed by an open
+    // addressing hash table (linear probing, power of two capacity, kept
+    // at most half full) keyed by the pair of body ids.  Removal shifts
+    // later entries of the probe run back instead of leaving tombstones,
+    // so lookups never slow down as contacts come and go.
+    class ContactPairCache final
+    {
+    public:
+        // Records this step's contacts and appends an event for each one:
+        // Begin if it was not in the last step and Persist if it was.  An
+        // End event is appended for every contact from the last step that
+        // is gone, and all of the events are kept in ascending order of
+        // contact.  contacts must be in ascending order.
+        void Update(std::span<const Contact> contacts, std::vector<ContactEvent>& events);
+
+        // Forgets every contact involving one of bodyIds without an End
+        // event, for bodies that no longer exist.  bodyIds must be in
+        // ascending order.
+        void RemoveBodies(std::span<const uint32_t> bodyIds);
+
+        // Frozen contacts are kept without being reported by Update,
+        // neither as Persist nor as End, until they turn up in Update's
+        // contacts again or are thawed.  Used for contacts between
+        // sleeping bodies, which are not looked for.
+        void Freeze(std::span<const Contact> contacts);
+
+        // Treats the contacts as present in the last step again, so the
+        // next Update reports each one as Persist or End.
+        void Thaw(std::span<const Contact> contacts);
+
+        inline size_t Count() const { return _entries.size(); }
+
+        bool Contains(const Contact& contact) const;
+
+        void Clear();
+
+    private:
+        static constexpr uint64_t EmptyKey = ~0ull;
+        static constexpr uint32_t MinSlotCount = 64;
+        static constexpr uint32_t FrozenStep = ~0u;
+
+        struct Slot
+        {
+            uint64_t key;
+            uint32_t entryIndex;
+        };
+
+        struct Entry
+        {
+            uint64_t key;
+            uint32_t lastStep;
+        };
+
+        std::vector<Slot> _slots;
+        uint32_t _slotMask = 0;
+        std::vector<Entry> _entries;
+        uint32_t _step = 0;
+        std::vector<ContactEvent> _endEvents;
+        std::vector<ContactEvent> _mergedEvents;
+
+        static inline uint64_t KeyOf(const Contact& contact)
+        {
+            return (static_cast<uint64_t>(contact.bodyA) << 32) | contact.bodyB;
+        }
+
+        static inline Contact ContactOf(uint64_t key)
+        {
+            return { static_cast<uint32_t>(key >> 32), static_cast<uint32_t>(key) };
+        }
+
+        inline uint32_t HomeSlot(uint64_t key) const
+        {
+            // Fibonacci hashing spreads the sequential body ids that
+            // neighbouring contacts share over the whole table.
+            return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & _slotMask;
+        }
+
+        // The slot holding key, or the empty slot where it would go.
+        uint32_t FindSlot(uint64_t key) const;
+
+        void SetLastStep(std::span<const Contact> contacts, uint32_t lastStep);
+        void Rehash(uint32_t slotCount);
+        void EraseSlot(uint32_t slot);
+    };
+}
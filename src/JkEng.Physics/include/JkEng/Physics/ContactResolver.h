@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "AabbStorage.h"
+
+namespace JkEng::Physics
+{
+    // Gathers the moves that separate overlapping AABBs and then makes them
+    // all in one pass over the storage.
+    //
+    // Each AABB keeps the largest move asked for in each direction along
+    // each axis rather than a sum.  An AABB resting across two floor tiles
+    // is pushed up by both but only needs to move once, and taking the
+    // largest does not depend on the order moves are added in.
+    class ContactResolver final
+    {
+    public:
+        // Forgets every move and makes room for aabbCount AABBs.
+        void Begin(uint32_t aabbCount);
+
+        inline void AddMove(uint32_t index, float moveX, float moveY)
+        {
+            _left[index] = std::min(_left[index], moveX);
+            _right[index] = std::max(_right[index], moveX);
+            _down[index] = std::min(_down[index], moveY);
+            _up[index] = std::max(_up[index], moveY);
+        }
+
+        // Moves every AABB by its moves and stops it moving back into
+        // whatever it was pushed away from.
+        void Apply(AabbStorage& aabbs) const;
+
+    private:
+        std::vector<float> _left;
+        std::vector<float> _right;
+        std::vector<float> _down;
+        std::vector<float> _up;
+    };
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Bounds.h"
+
+namespace JkEng::Physics
+{
+    // A bounding volume hierarchy of leaf bounds that supports inserting
+    // and removing leaves one at a time.
+    //
+    // Inserting picks the sibling that grows the tree's total perimeter the
+    // least and then rotates nodes on the way back up to keep the tree
+    // balanced.  When many leaves change at once it is cheaper to update
+    // them in place and Refit, or Rebuild the whole tree top-down.
+    //
+    // Leaves are identified by the node index Insert returns, which stays
+    // valid until the leaf is removed or the tree is cleared.
+    class DynamicAabbTree final
+    {
+    public:
+        static constexpr int32_t NullNode = -1;
+
+        int32_t Insert(const Bounds& bounds, uint32_t userIndex);
+        void Remove(int32_t leaf);
+
+        // Removes and re-inserts the leaf with new bounds.
+        void Reinsert(int32_t leaf, const Bounds& bounds);
+
+        // Changes the bounds of a leaf without fixing its ancestors.  Call
+        // Refit or Rebuild after changing leaves this way.
+        inline void SetLeafBounds(int32_t leaf, const Bounds& bounds)
+        {
+            _nodes[leaf].bounds = bounds;
+        }
+
+        inline const Bounds& LeafBounds(int32_t leaf) const
+        {
+            return _nodes[leaf].bounds;
+        }
+
+        inline void SetLeafUserIndex(int32_t leaf, uint32_t userIndex)
+        {
+            _nodes[leaf].userIndex = userIndex;
+        }
+
+        // Recomputes the bounds of every internal node from its children
+        // without changing the shape of the tree.
+        void Refit();
+
+        // Discards every internal node and builds a new tree over the
+        // leaves by splitting them at the median along the longer axis.
+        void Rebuild();
+
+        void Clear();
+
+        // The sum of the perimeters of the internal nodes, which is roughly
+        // proportional to the cost of a query.  Walks every node.
+        float Cost() const;
+
+        typedef std::pair<int32_t, int32_t> NodePair;
+
+        // Calls callback(userIndex0, userIndex1) once for every pair of
+        // leaves whose bounds overlap by descending the tree against itself.
+        template<typename Callback>
+        void ForEachOverlappingPair(Callback callback)
+        {
+            if (_root == NullNode)
+            {
+                return;
+            }
+
+            ForEachOverlappingPair(NodePair(_root, _root), _pairStack, callback);
+        }
+
+        // Calls callback(userIndex) for every leaf whose bounds overlap the
+        // given bounds.  stack is scratch space owned by the caller, so
+        // separate threads can query the same tree.
+        template<typename Callback>
+        void ForEachOverlappingLeaf(const Bounds& bounds, std::vector<int32_t>& stack, Callback callback) const
+        {
+            ForEachLeaf(
+                [&bounds](const Bounds& nodeBounds) { return nodeBounds.Overlaps(bounds); },
+                stack,
+                callback);
+        }
+
+        // Calls callback(userIndex) for every leaf whose bounds pass
+        // isWanted, only descending into nodes whose bounds pass it too.
+        // isWanted is asked again for every node, so it can get stricter
+        // as leaves are found, such as a ray that ends at its closest hit
+        // so far.
+        template<typename IsWanted, typename Callback>
+        void ForEachLeaf(IsWanted isWanted, std::vector<int32_t>& stack, Callback callback) const
+        {
+            if (_root == NullNode)
+            {
+                return;
+            }
+
+            stack.clear();
+            stack.push_back(_root);
+            while (!stack.empty())
+            {
+                auto& node = _nodes[stack.back()];
+                stack.pop_back();
+                if (!isWanted(node.bounds))
+                {
+                    continue;
+                }
+
+                if (node.IsLeaf())
+                {
+                    callback(node.userIndex);
+                }
+                else
+                {
+                    stack.push_back(node.child0);
+                    stack.push_back(node.child1);
+                }
+            }
+        }
+
+        // Same as ForEachLeaf, but of the two children of a node the one
+        // with the smaller distance(bounds) is descended into first.  A
+        // search that only wants leaves closer than the ones found so far,
+        // such as for nearest neighbours, then finds close leaves early
+        // and skips more of the tree.
+        template<typename IsWanted, typename Distance, typename Callback>
+        void ForEachLeafClosestFirst(IsWanted isWanted, Distance distance, std::vector<int32_t>& stack, Callback callback) const
+        {
+            if (_root == NullNode)
+            {
+                return;
+            }
+
+            stack.clear();
+            stack.push_back(_root);
+            while (!stack.empty())
+            {
+                auto& node = _nodes[stack.back()];
+                stack.pop_back();
+                if (!isWanted(node.bounds))
+                {
+                    continue;
+                }
+
+                if (node.IsLeaf())
+                {
+                    callback(node.userIndex);
+                }
+                else if (distance(_nodes[node.child0].bounds) <= distance(_nodes[node.child1].bounds))
+                {
+                    stack.push_back(node.child1);
+                    stack.push_back(node.child0);
+                }
+                else
+                {
+                    stack.push_back(node.child0);
+                    stack.push_back(node.child1);
+                }
+            }
+        }
+
+        // Splits the search ForEachOverlappingPair does into independent
+        // node pairs, expanding level by level until there are at least
+        // minPartCount or nothing is left to expand.  Searching every part
+        // with the overload below finds every pair of leaves exactly once,
+        // so parts can be searched on separate threads.
+        void SplitOverlappingPairSearch(
+            size_t minPartCount,
+            std::vector<NodePair>& parts,
+            std::vector<NodePair>& scratch) const;
+
+        // Calls callback(userIndex0, userIndex1) for every pair of
+        // overlapping leaves found under one part from
+        // SplitOverlappingPairSearch.  stack is scratch space owned by the
+        // caller.
+        template<typename Callback>
+        void ForEachOverlappingPair(NodePair part, std::vector<NodePair>& stack, Callback callback) const
+        {
+            stack.clear();
+            stack.push_back(part);
+            while (!stack.empty())
+            {
+                NodePair nodePair = stack.back();
+                stack.pop_back();
+                ExpandNodePair(nodePair, stack, callback);
+            }
+        }
+
+    private:
+        struct Node
+        {
+            Bounds bounds;
+
+            // The next free node while this node is on the free list.
+            int32_t parent;
+            int32_t child0;
+            int32_t child1;
+
+            // 0 for leaves and -1 for free nodes.
+            int32_t height;
+            uint32_t userIndex;
+
+            inline bool IsLeaf() const { return child0 == NullNode; }
+        };
+
+        std::vector<Node> _nodes;
+        int32_t _root = NullNode;
+        int32_t _freeList = NullNode;
+        std::vector<NodePair> _pairStack;
+        std::vector<int32_t> _leaves;
+
+        // Calls callback if both nodes are overlapping leaves, otherwise
+        // appends the child pairs that still need to be searched.
+        template<typename Callback>
+        inline void ExpandNodePair(NodePair nodePair, std::vector<NodePair>& pending, Callback callback) const
+        {
+            auto [index0, index1] = nodePair;
+            auto& node0 = _nodes[index0];
+            auto& node1 = _nodes[index1];
+
+            if (index0 == index1)
+            {
+                if (!node0.IsLeaf())
+                {
+                    pending.emplace_back(node0.child0, node0.child0);
+                    pending.emplace_back(node0.child1, node0.child1);
+                    pending.emplace_back(node0.child0, node0.child1);
+                }
+                return;
+            }
+
+            if (!node0.bounds.Overlaps(node1.bounds))
+            {
+                return;
+            }
+
+            if (node0.IsLeaf() && node1.IsLeaf())
+            {
+                callback(node0.userIndex, node1.userIndex);
+            }
+            else if (node1.IsLeaf()
+                || (!node0.IsLeaf() && node0.bounds.Perimeter() >= node1.bounds.Perimeter()))
+            {
+                pending.emplace_back(node0.child0, index1);
+                pending.emplace_back(node0.child1, index1);
+            }
+            else
+            {
+                pending.emplace_back(index0, node1.child0);
+                pending.emplace_back(index0, node1.child1);
+            }
+        }
+
+        int32_t AllocateNode();
+        void FreeNode(int32_t index);
+        void InsertLeaf(int32_t leaf);
+        void RemoveLeaf(int32_t leaf);
+        int32_t Balance(int32_t index);
+        void FixUpwardsFrom(int32_t index);
+        void RefitNode(int32_t index);
+        int32_t BuildTopDown(int32_t* leaves, size_t leafCount);
+    };
+}
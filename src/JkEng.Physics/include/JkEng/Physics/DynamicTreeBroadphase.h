@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "DynamicAabbTree.h"
+#include "IBroadphase.h"
+
+namespace JkEng::Physics
+{
+    // Broadphase that keeps each AABB, padded by a margin, as a leaf of a
+    // DynamicAabbTree and finds pairs by descending the tree against
+    // itself.
+    //
+    // A leaf only changes when its AABB moves outside of the padded
+    // bounds.  When only a few leaves change they are re-inserted one at a
+    // time.  When many change the leaves are updated in place and the tree
+    // is refit, and if refitting has made the tree much worse than it was
+    // after the last rebuild it is rebuilt from scratch.
+    class DynamicTreeBroadphase final : public IBroadphase
+    {
+    public:
+        DynamicTreeBroadphase(float margin);
+
+        void FindOverlappingPairs(
+            const AabbStorage& aabbs,
+            std::vector<OverlappingPair>& pairs) override;
+
+        void FindOverlappingPairs(
+            const AabbStorage& aabbs,
+            WorkerPool& workers,
+            std::vector<std::vector<OverlappingPair>>& pairsPerWorker) override;
+
+        void AabbAdded(const AabbStorage& aabbs, uint32_t index) override;
+        void AabbRemoved(const AabbStorage& aabbs, uint32_t index, uint32_t lastIndex) override;
+
+    private:
+        // Split the pair search into about this many parts per worker so
+        // uneven parts still balance out.
+        static constexpr size_t SearchPartsPerWorker = 16;
+
+        // Re-insert one at a time when at most this fraction of the leaves
+        // have moved out of their padded bounds.
+        static constexpr float MaxReinsertFraction = 0.1f;
+
+        // Rebuild when refitting has made the tree this many times more
+        // costly than it was right after the last rebuild.
+        static constexpr float MaxRefitCostGrowth = 2.0f;
+
+        float _margin;
+        DynamicAabbTree _tree;
+        std::vector<int32_t> _leaves;
+        std::vector<uint32_t> _escapedAabbIndices;
+        float _costAfterRebuild = 0.0f;
+        std::vector<DynamicAabbTree::NodePair> _searchParts;
+        std::vector<DynamicAabbTree::NodePair> _searchPartsScratch;
+        std::vector<std::vector<DynamicAabbTree::NodePair>> _stacksPerWorker;
+
+        inline Bounds PaddedBounds(const AabbStorage& aabbs, uint32_t index) const
+        {
+            return aabbs.BoundsOf(index).Expanded(_margin);
+        }
+
+        void RebuildTree(const AabbStorage& aabbs);
+        void UpdateTree(const AabbStorage& aabbs);
+        void RebuildOrUpdateTree(const AabbStorage& aabbs);
+    };
+}
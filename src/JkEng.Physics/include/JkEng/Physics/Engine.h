@@ -4,15 +4,24 @@
 
 #include "IMovableAabb2d.h"
 #include "IScene.h"
+#include "IThreadedScene.h"
 #include "SceneDefinition.h"
 
 namespace JkEng::Physics
 {
-    class Scene;
-
     class Engine
     {
     public:
+        // Builds the scene specialized for the definition's broadphase and
+        // SceneDefinition::CollisionHandlers, so the broadphase is called
+        // without virtual dispatch and scenes without collision handlers
+        // skip the loop that would call them.  Construct a BasicScene
+        // directly to choose both at compile time instead, including a
+        // handler policy of your own.
         std::unique_ptr<IScene> CreateScene(const SceneDefinition& definition);
+
+        // A scene that steps itself on a physics thread once started, see
+        // IThreadedScene.
+        std::unique_ptr<IThreadedScene> CreateThreadedScene(const SceneDefinition& definition);
     };
 }
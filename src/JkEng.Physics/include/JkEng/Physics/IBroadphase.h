@@ -0,0 +1,58 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <vector>
+
+#include "AabbStorage.h"
+#include "WorkerPool.h"
+
+namespace JkEng::Physics
+{
+    // Indices (into the scene's AABB storage) of two AABBs whose bounds
+    // overlap.  index0 is always less than index1.
+    struct OverlappingPair
+    {
+        uint32_t index0;
+        uint32_t index1;
+
+        auto operator<=>(const OverlappingPair&) const = default;
+    };
+
+    class IBroadphase
+    {
+    public:
+        virtual ~IBroadphase() = default;
+
+        // Appends every pair of aabbs that overlap to pairs exactly once.
+        // The order pairs are appended in is up to the implementation.
+        virtual void FindOverlappingPairs(
+            const AabbStorage& aabbs,
+            std::vector<OverlappingPair>& pairs) = 0;
+
+        // Finds the same pairs as above with the work spread over workers.
+        // Each worker appends to pairsPerWorker[workerIndex], which must
+        // have an entry per worker, and every pair is appended by exactly
+        // one worker.
+        virtual void FindOverlappingPairs(
+            const AabbStorage& aabbs,
+            WorkerPool& workers,
+            std::vector<std::vector<OverlappingPair>>& pairsPerWorker) = 0;
+
+        // Called after the AABB at index was appended to aabbs, so
+        // broadphases that keep state from step to step can update it
+        // instead of starting over.
+        virtual void AabbAdded(const AabbStorage& /*aabbs*/, uint32_t /*index*/)
+        {
+
+        }
+
+        // Called after aabbs.SwapRemove(index) moved the AABB that was at
+        // lastIndex to index.  index equals lastIndex when the removed AABB
+        // was the last one.
+        virtual void AabbRemoved(const AabbStorage& /*aabbs*/, uint32_t /*index*/, uint32_t /*lastIndex*/)
+        {
+
+        }
+    };
+}
@@ -12,6 +12,9 @@
 
 namespace JkEng::Physics
 {
+    // While an IThreadedScene's physics thread runs, reading or writing
+    // anything but object info from any other thread throws
+    // std::logic_error, see IThreadedScene.
     class IMovableAabb2d : public IReadOnlyAabb2d
     {
     public:
@@ -21,6 +24,7 @@ namespace JkEng::Physics
         using IReadOnlyAabb2d::Position;
         using IReadOnlyAabb2d::Velocity;
         using IReadOnlyAabb2d::Acceleration;
+        using IReadOnlyAabb2d::UserData;
         using IReadOnlyAabb2d::ObjectInfo;
         using IReadOnlyAabb2d::ObjectInfoAs;
 
@@ -28,6 +32,7 @@ namespace JkEng::Physics
         virtual void Position(const glm::vec2& position) = 0;
         virtual void Velocity(const glm::vec2 velocity) = 0;
         virtual void Acceleration(const glm::vec2 acceleration) = 0;
+        virtual void UserData(uint64_t userData) = 0;
         virtual std::any& ObjectInfo() = 0;
 
         template<typename T>
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <any>
+#include <cstdint>
 #include <functional>
 
 #pragma clang diagnostic push
@@ -9,18 +10,30 @@
 #include <glm/glm.hpp>
 #pragma clang diagnostic pop
 
+#include "Contact.h"
+
 namespace JkEng::Physics
 {
     class IReadOnlyAabb2d
     {
     public:
         typedef std::function<void(const IReadOnlyAabb2d&)> CollisionHandler;
+        typedef std::function<void(ContactEventType, const IReadOnlyAabb2d&)> ContactEventHandler;
 
         virtual ~IReadOnlyAabb2d() = default;
+
+        // These return by value because implementations are free to keep
+        // the x and y components in separate arrays.
         virtual glm::vec2 Size() const = 0;
-        virtual const glm::vec2& Position() const = 0;
-        virtual const glm::vec2& Velocity() const = 0;
-        virtual const glm::vec2& Acceleration() const = 0;
+        virtual glm::vec2 Position() const = 0;
+        virtual glm::vec2 Velocity() const = 0;
+        virtual glm::vec2 Acceleration() const = 0;
+
+        // A fixed 64 bit slot for anything that identifies the object, such
+        // as an index or a pointer, that can be read without the allocation
+        // and type check of ObjectInfo.
+        virtual uint64_t UserData() const = 0;
+
         virtual const std::any& ObjectInfo() const = 0;
 
         template<typename T>
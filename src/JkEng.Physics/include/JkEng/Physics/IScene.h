@@ -1,13 +1,204 @@
 #pragma once
 
+#include <cstdint>
+#include <span>
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-volatile"
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <glm/glm.hpp>
+#pragma clang diagnostic pop
+
+#include "BodyHandle.h"
+#include "CollisionFilter.h"
+#include "SpatialQueries.h"
+
 namespace JkEng::Physics
 {
+    class IMovableAabb2d;
+    class MovableAabb2dDefinition;
+
     class IScene
     {
     public:
+        // The default StepDuration, see SceneDefinition::StepDuration.
         static constexpr float StepTime = 1.0f / 60.0f;
         virtual ~IScene() = default;
         virtual void Update(float deltaTime) = 0;
         virtual float TimeNotYetSimulated() = 0;
+
+        // The time simulated by each step.
+        virtual float StepDuration() const = 0;
+
+        // One more than the largest body id in use, which is the size an
+        // array indexed by body id needs.
+        virtual uint32_t BodyIdCount() const = 0;
+
+        // Writes the position of each movable AABB to positions[bodyId],
+        // blended from where it was before the last step to where it is
+        // now by TimeNotYetSimulated() / StepDuration().  Rendering these instead
+        // of the current positions keeps motion smooth when frames come
+        // more often than steps.  Entries for static AABBs and unused ids
+        // are left alone.  Throws std::invalid_argument when positions is
+        // shorter than BodyIdCount().
+        virtual void InterpolatedPositions(std::span<glm::vec2> positions) const = 0;
+
+        // Bulk versions of IMovableAabb2d's accessors, for systems that
+        // move many bodies each frame.  They read and write the scene's
+        // arrays directly instead of making a virtual call per body.
+
+        // Write the position, velocity or acceleration of each movable AABB
+        // to index bodyId of the span, leaving entries for static AABBs and
+        // unused ids alone.  Throw std::invalid_argument when the span is
+        // shorter than BodyIdCount().
+        virtual void Positions(std::span<glm::vec2> positions) const = 0;
+        virtual void Velocities(std::span<glm::vec2> velocities) const = 0;
+        virtual void Accelerations(std::span<glm::vec2> accelerations) const = 0;
+
+        // Set the position, velocity or acceleration of bodies[i] to
+        // values[i], the same as calling IMovableAabb2d for each in order.
+        // Handles that do not match a movable AABB are skipped.  Throw
+        // std::invalid_argument when the spans are different sizes.
+        virtual void SetPositions(std::span<const BodyHandle> bodies, std::span<const glm::vec2> positions) = 0;
+        virtual void SetVelocities(std::span<const BodyHandle> bodies, std::span<const glm::vec2> velocities) = 0;
+        virtual void SetAccelerations(std::span<const BodyHandle> bodies, std::span<const glm::vec2> accelerations) = 0;
+
+        // Set the position, velocity or acceleration of every movable AABB
+        // to index bodyId of the span, ignoring entries for static AABBs
+        // and unused ids.  The fastest way to update every body: read them
+        // all with Positions(), change them, and write them back with
+        // SetPositions().  Throw std::invalid_argument when the span is
+        // shorter than BodyIdCount().
+        virtual void SetPositions(std::span<const glm::vec2> positions) = 0;
+        virtual void SetVelocities(std::span<const glm::vec2> velocities) = 0;
+        virtual void SetAccelerations(std::span<const glm::vec2> accelerations) = 0;
+
+        // Copies the state of every movable AABB that changes as the scene
+        // runs (position, size, velocity, acceleration, user data and
+        // where it was before the last step), this step's contacts and
+        // TimeNotYetSimulated() into one of a ring of buffers, see
+        // SceneDefinition::SavedStateCount.  frame is any number the caller
+        // chooses, such as its frame counter, and replaces whatever was
+        // saved for the frame SavedStateCount before it.  Nothing is
+        // allocated once the buffers have grown to fit the scene.
+        virtual void SaveState(uint32_t frame) = 0;
+
+        // Puts back the state saved for frame, for rollback.  Returns false
+        // and changes nothing if that frame was not saved or has since
+        // been replaced, if bodies have been added or removed since it was
+        // saved, or when called from a handler.  Sleeping is not saved:
+        // every body is awake after a restore, so rollback only repeats a
+        // run exactly when sleeping is off.  Collision handlers and object
+        // info are not touched.
+        virtual bool RestoreState(uint32_t frame) = 0;
+
+        // Spatial queries look at every body as it is now, including static
+        // AABBs, tile grids and sleeping bodies, and only at bodies whose
+        // collision category shares a bit with categoryMask.  Results are
+        // written to the caller's span and nothing is allocated once the
+        // scene's scratch space has grown to fit.  Movable AABBs are found
+        // through a tree over their bounds that the first query after any
+        // of them were added, removed or moved brings up to date, so the
+        // first query after a step costs more than the ones after it.
+        //
+        // Queries can be made from any thread, even while Update runs on
+        // another.  They wait for Update to finish and for each other, so
+        // they always see the scene between steps, except from a handler,
+        // where they see it part way through the step without waiting.
+        // Writes made outside Update, such as through IMovableAabb2d or
+        // AddBody, must still not overlap a query.
+
+        // Writes the id of every body containing point, in no particular
+        // order, and returns how many there are.  Only the first
+        // bodyIds.size() are written when there are more.
+        virtual uint32_t QueryPoint(
+            glm::vec2 point,
+            std::span<uint32_t> bodyIds,
+            uint32_t categoryMask = DefaultCollisionMask) const = 0;
+
+        // Same as QueryPoint for every body overlapping the region.
+        virtual uint32_t QueryRegion(
+            glm::vec2 position,
+            glm::vec2 size,
+            std::span<uint32_t> bodyIds,
+            uint32_t categoryMask = DefaultCollisionMask) const = 0;
+
+        // Finds the first body touched by the segment from origin to
+        // origin + direction.  Returns false when nothing is touched.
+        virtual bool Raycast(
+            glm::vec2 origin,
+            glm::vec2 direction,
+            RaycastHit& hit,
+            uint32_t categoryMask = DefaultCollisionMask) const = 0;
+
+        // Writes the closest hits.size() bodies touched by the segment from
+        // origin to origin + direction, closest first, and returns how
+        // many bodies it touched in total.  A tile grid is hit once, where
+        // the segment first touches a solid cell.
+        virtual uint32_t RaycastAll(
+            glm::vec2 origin,
+            glm::vec2 direction,
+            std::span<RaycastHit> hits,
+            uint32_t categoryMask = DefaultCollisionMask) const = 0;
+
+        // Writes the nearest.size() bodies closest to point, closest first,
+        // and returns how many were written.  The distance to a tile grid
+        // is the distance to its closest solid cell.
+        virtual uint32_t NearestK(
+            glm::vec2 point,
+            std::span<NearestBody> nearest,
+            uint32_t categoryMask = DefaultCollisionMask) const = 0;
+
+        // Batches run their queries across the scene's threads (see
+        // SceneDefinition::ThreadCount), so they suit many queries at once
+        // such as line of sight checks for every enemy.  Made from another
+        // thread while the scene steps, a batch runs between two calls to
+        // Update with every ray or region seeing the same state.
+
+        // Writes the first hit of rays[i] to hits[i], or a hit with bodyId
+        // RaycastHit::NoBody and fraction 1 when it touches nothing, and
+        // returns how many rays hit something.  Throws
+        // std::invalid_argument when hits is shorter than rays.
+        virtual uint32_t RaycastBatch(
+            std::span<const Ray> rays,
+            std::span<RaycastHit> hits,
+            uint32_t categoryMask = DefaultCollisionMask) const = 0;
+
+        // Runs QueryRegion for each of regions.  bodyIds is split into
+        // equal parts, one per region in order, and counts[i] is how many
+        // bodies overlap regions[i], which can be more than its part holds.
+        // Throws std::invalid_argument when counts is shorter than regions.
+        virtual void QueryRegionBatch(
+            std::span<const Region> regions,
+            std::span<uint32_t> bodyIds,
+            std::span<uint32_t> counts,
+            uint32_t categoryMask = DefaultCollisionMask) const = 0;
+
+        // Adds a movable AABB to the scene and initializes the definition's
+        // AfterCreatePtr.  Can be called from handlers, in which case the
+        // AABB takes part from the next step.
+        virtual BodyHandle AddBody(const MovableAabb2dDefinition& definition) = 0;
+
+        // Removes a movable AABB.  Handles that no longer match a body are
+        // ignored, so removing twice is harmless.  Called from a handler,
+        // the AABB is removed once every handler for the step has run.
+        // Its contacts are forgotten without End events.  Throws
+        // std::invalid_argument for static AABBs, which can not be removed.
+        virtual void RemoveBody(BodyHandle handle) = 0;
+
+        virtual bool IsValid(BodyHandle handle) const = 0;
+
+        // The current handle of a body id, such as one from a Contact or
+        // ReadOnlyAabb2dView::BodyId, or a handle that matches nothing if
+        // no body has that id.
+        virtual BodyHandle HandleOf(uint32_t bodyId) const = 0;
+
+        // Whether the body a handle matches is asleep, see
+        // SceneDefinition::StepsBeforeSleep.  Static AABBs never sleep.
+        virtual bool IsSleeping(BodyHandle handle) const = 0;
+
+        // The movable AABB a handle matches, or null if it matches none.
+        // The pointer stays valid until the body is removed.
+        virtual IMovableAabb2d* Body(BodyHandle handle) = 0;
     };
 }
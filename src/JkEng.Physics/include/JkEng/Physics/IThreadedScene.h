@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-volatile"
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <glm/glm.hpp>
+#pragma clang diagnostic pop
+
+#include "BodyHandle.h"
+#include "IScene.h"
+#include "SceneSnapshot.h"
+
+namespace JkEng::Physics
+{
+    // A scene stepped at its fixed rate on a physics thread of its own, so
+    // a slow step never holds up the thread that renders it.  After every
+    // step the physics thread publishes a SceneSnapshot, which
+    // LatestSnapshot reads without locking or waiting.  Writes to bodies
+    // are queued and applied in order just before the next step.
+    //
+    // Handlers run on the physics thread.  While it runs, bodies belong to
+    // it: IMovableAabb2d pointers, including AfterCreatePtr handles, can
+    // not be used from any other thread.  Reading or writing a body
+    // through one, or through Scene()'s bulk accessors, throws
+    // std::logic_error rather than racing the step.  Read bodies through
+    // LatestSnapshot and write them with the setters below instead.  Only
+    // object info, which the scene never writes, and Scene()'s spatial
+    // queries, which wait for the step in progress, can still be used.
+    class IThreadedScene
+    {
+    public:
+        // How many steps the physics thread can fall behind before it
+        // stops trying to catch up, see Start.
+        static constexpr uint32_t MaxStepsBehind = 8;
+
+        // Stops the physics thread.
+        virtual ~IThreadedScene() = default;
+
+        // The scene the physics thread steps.  Apart from spatial queries,
+        // only use it while the thread is stopped, for example to add
+        // bodies or save state.
+        virtual IScene& Scene() = 0;
+
+        // Publishes the scene as it is now and starts stepping it every
+        // StepDuration.  When steps take longer than that the thread runs
+        // them back to back to catch up, and once MaxStepsBehind behind it
+        // drops the missed time instead.  Does nothing if already running.
+        // If a handler stopped the thread and Stop has not been called
+        // since, calls it first, which rethrows what the handler threw.
+        virtual void Start() = 0;
+
+        // Waits for the step in progress to finish, stops the thread and
+        // applies any writes still queued.  If a handler threw on the
+        // physics thread, the thread stopped then and the exception is
+        // rethrown here.
+        virtual void Stop() = 0;
+
+        // False once the thread has stopped, including when a handler
+        // threw and Stop has not been called yet.
+        virtual bool IsRunning() const = 0;
+
+        // The most recently published state.  Never blocks, but must only
+        // be called from one thread at a time, and the snapshot returned
+        // is only valid until the next call.
+        virtual const SceneSnapshot& LatestSnapshot() = 0;
+
+        // These queue the same writes as IMovableAabb2d and can be called
+        // from any thread.  Writes to handles that no longer match a
+        // movable AABB when they are applied are ignored.
+        virtual void SetPosition(BodyHandle handle, glm::vec2 position) = 0;
+        virtual void SetSize(BodyHandle handle, glm::vec2 size) = 0;
+        virtual void SetVelocity(BodyHandle handle, glm::vec2 velocity) = 0;
+        virtual void SetAcceleration(BodyHandle handle, glm::vec2 acceleration) = 0;
+        virtual void SetUserData(BodyHandle handle, uint64_t userData) = 0;
+
+        // Queues IScene::RemoveBody.
+        virtual void RemoveBody(BodyHandle handle) = 0;
+    };
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+namespace JkEng::Physics
+{
+    // The instruction sets the SIMD kernels in JkEng.Physics are written
+    // for.  See CpuFeatures for which are available at runtime.
+    enum class InstructionSet
+    {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+#include "AabbStorage.h"
+#include "InstructionSet.h"
+
+namespace JkEng::Physics
+{
+    // Advances the velocity of every AABB in an AabbStorage by its
+    // acceleration and then moves both of its corners by its velocity.
+    //
+    // The SIMD kernels do the same multiplies and adds in the same order
+    // as the scalar kernel (no fused multiply-add) so all of them produce
+    // bit-for-bit identical results.
+    class Integrator final
+    {
+    public:
+        // Uses the best instruction set the CPU supports.
+        Integrator();
+
+        // Uses the given instruction set, which must be supported.
+        explicit Integrator(InstructionSet instructionSet);
+
+        inline InstructionSet SelectedInstructionSet() const { return _instructionSet; }
+
+        inline void Integrate(AabbStorage& aabbs, float stepTime) const
+        {
+            _kernel(aabbs, 0, aabbs.Count(), stepTime);
+        }
+
+        // Integrates only the AABBs in [begin, end) so separate ranges can
+        // be integrated on separate threads.
+        inline void Integrate(AabbStorage& aabbs, uint32_t begin, uint32_t end, float stepTime) const
+        {
+            _kernel(aabbs, begin, end, stepTime);
+        }
+
+        // Like Integrate but leaves sleeping AABBs exactly as they are.
+        inline void IntegrateAwake(AabbStorage& aabbs, uint32_t begin, uint32_t end, float stepTime) const
+        {
+            _awakeKernel(aabbs, begin, end, stepTime);
+        }
+
+    private:
+        typedef void (*Kernel)(AabbStorage& aabbs, uint32_t begin, uint32_t end, float stepTime);
+
+        InstructionSet _instructionSet;
+        Kernel _kernel;
+        Kernel _awakeKernel;
+    };
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <sstream>
+#include <stdexcept>
+
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-volatile"
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
@@ -8,7 +11,9 @@
 
 #include <JkEng/AfterCreatePtr.h>
 
+#include "CollisionFilter.h"
 #include "IReadOnlyAabb2d.h"
+#include "ReadOnlyAabb2dView.h"
 
 namespace JkEng::Physics
 {
@@ -27,10 +32,7 @@ namespace JkEng::Physics
           : _aabbAfterCreate(aabbAfterCreate),
             _position(std::move(position)),
             _size(std::move(size)),
-            _collisionHandler(
-                collisionHandler != nullptr
-                    ? std::move(collisionHandler)
-                    : [](const IReadOnlyAabb2d&){}),
+            _collisionHandler(std::move(collisionHandler)),
             _objectInfo(std::move(objectInfo))
         {
 
@@ -46,6 +48,8 @@ namespace JkEng::Physics
             return _size;
         }
 
+        // Empty when the definition was given a null handler, which the
+        // scene skips rather than calling.
         inline const IReadOnlyAabb2d::CollisionHandler& CollisionHandler() const
         {
             return _collisionHandler;
@@ -56,6 +60,117 @@ namespace JkEng::Physics
             return _objectInfo;
         }
 
+        // Called with Begin when this AABB starts touching another, Persist
+        // for every later step they still touch and End for the first step
+        // they no longer do.  Handlers that only care when contacts start
+        // and stop can pass false for receivePersistEvents.  Called after
+        // the collision handlers for the step.
+        inline void ContactEventHandler(
+            IReadOnlyAabb2d::ContactEventHandler contactEventHandler,
+            bool receivePersistEvents = true)
+        {
+            _contactEventHandler = std::move(contactEventHandler);
+            _receivePersistEvents = receivePersistEvents;
+        }
+
+        inline const IReadOnlyAabb2d::ContactEventHandler& ContactEventHandler() const
+        {
+            return _contactEventHandler;
+        }
+
+        inline bool ReceivePersistEvents() const
+        {
+            return _receivePersistEvents;
+        }
+
+        // Called like the collision handler, after it, but with a
+        // ReadOnlyAabb2dView of the other AABB.
+        inline void CollisionViewHandler(Physics::CollisionViewHandler collisionViewHandler)
+        {
+            _collisionViewHandler = std::move(collisionViewHandler);
+        }
+
+        inline const Physics::CollisionViewHandler& CollisionViewHandler() const
+        {
+            return _collisionViewHandler;
+        }
+
+        inline void UserData(uint64_t userData)
+        {
+            _userData = userData;
+        }
+
+        inline uint64_t UserData() const
+        {
+            return _userData;
+        }
+
+        // See CollisionFilter.h.
+        inline void CollisionFilter(uint32_t category, uint32_t mask)
+        {
+            _collisionCategory = category;
+            _collisionMask = mask;
+        }
+
+        inline uint32_t CollisionCategory() const
+        {
+            return _collisionCategory;
+        }
+
+        inline uint32_t CollisionMask() const
+        {
+            return _collisionMask;
+        }
+
+        // Fast AABBs are swept from where they start each step to where
+        // they end up, so they hit anything in between even when they move
+        // past it within a single step.  Meant for bullets and the like,
+        // since sweeping makes each step's collision checks for the AABB
+        // cover its whole path.
+        inline void IsFast(bool isFast)
+        {
+            _isFast = isFast;
+        }
+
+        inline bool IsFast() const
+        {
+            return _isFast;
+        }
+
+        // How hard the AABB is to push when SceneDefinition::ResolveCollisions
+        // separates it from another movable AABB.  Two overlapping AABBs
+        // are each moved in proportion to the other's share of their
+        // combined mass.  1 by default.
+        inline void Mass(float mass)
+        {
+            if (!(mass > 0.0f))
+            {
+                std::stringstream ss;
+                ss << "Mass " << mass << " must be greater than zero";
+                throw std::invalid_argument(ss.str());
+            }
+            _mass = mass;
+        }
+
+        inline float Mass() const
+        {
+            return _mass;
+        }
+
+        // Immovable AABBs are never moved by SceneDefinition::ResolveCollisions,
+        // so anything pushed against one moves all the way out instead.
+        // Meant for moving platforms and the like whose position is set by
+        // the game.
+        inline void IsImmovable(bool isImmovable)
+        {
+            _isImmovable = isImmovable;
+        }
+
+        inline bool IsImmovable() const
+        {
+            return _isImmovable;
+        }
+
         inline void SetAfterCreatePtr(IMovableAabb2d* movableAabb) const
         {
             if (_aabbAfterCreate != nullptr)
@@ -70,5 +185,14 @@ namespace JkEng::Physics
         glm::vec2 _size;
         IReadOnlyAabb2d::CollisionHandler _collisionHandler;
         std::any _objectInfo;
+        IReadOnlyAabb2d::ContactEventHandler _contactEventHandler;
+        bool _receivePersistEvents = true;
+        Physics::CollisionViewHandler _collisionViewHandler;
+        uint64_t _userData = 0;
+        uint32_t _collisionCategory = DefaultCollisionCategory;
+        uint32_t _collisionMask = DefaultCollisionMask;
+        bool _isFast = false;
+        float _mass = 1.0f;
+        bool _isImmovable = false;
     };
 }
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "AabbStorage.h"
+#include "DynamicAabbTree.h"
+
+namespace JkEng::Physics
+{
+    // A tree over the exact bounds of the movable AABBs of a scene for
+    // spatial queries.  The broadphases can't be asked since they only
+    // know where AABBs were during the last step, and handlers or game
+    // code may have moved them since.
+    //
+    // The tree is brought up to date the first time a query needs it
+    // after anything was added, removed or moved, so a scene that is only
+    // queried between steps pays for it at most once per step.  Like
+    // DynamicTreeBroadphase it refits in place while the AABBs are the
+    // same ones, and rebuilds when they are not or when refitting has made
+    // the tree much worse.
+    class MovableAabbTree final
+    {
+    public:
+        inline bool IsUpToDate(const AabbStorage& aabbs) const
+        {
+            return _version == aabbs.BoundsVersion();
+        }
+
+        void Update(const AabbStorage& aabbs);
+
+        // Calls callback(index) for every AABB whose bounds pass isWanted,
+        // see DynamicAabbTree::ForEachLeaf.  The tree must be up to date.
+        template<typename IsWanted, typename Callback>
+        void ForEachAabb(IsWanted isWanted, std::vector<int32_t>& stack, Callback callback) const
+        {
+            _tree.ForEachLeaf(isWanted, stack, callback);
+        }
+
+        // See DynamicAabbTree::ForEachLeafClosestFirst.
+        template<typename IsWanted, typename Distance, typename Callback>
+        void ForEachAabbClosestFirst(IsWanted isWanted, Distance distance, std::vector<int32_t>& stack, Callback callback) const
+        {
+            _tree.ForEachLeafClosestFirst(isWanted, distance, stack, callback);
+        }
+
+    private:
+        // Rebuild when refitting has made the tree this many times more
+        // costly than it was right after the last rebuild.
+        static constexpr float MaxRefitCostGrowth = 2.0f;
+
+        DynamicAabbTree _tree;
+        std::vector<int32_t> _leaves;
+        float _costAfterRebuild = 0.0f;
+        uint64_t _version = std::numeric_limits<uint64_t>::max();
+
+        void Rebuild(const AabbStorage& aabbs);
+    };
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include "AabbStorage.h"
+#include "Bounds.h"
+#include "InstructionSet.h"
+
+namespace JkEng::Physics
+{
+    // Pointers to the four bound components of a run of candidate AABBs
+    // that are stored structure-of-arrays style.
+    struct CandidateBounds
+    {
+        const float* minX;
+        const float* minY;
+        const float* maxX;
+        const float* maxY;
+
+        static inline CandidateBounds Of(const AabbStorage& aabbs)
+        {
+            return { aabbs.MinX(), aabbs.MinY(), aabbs.MaxX(), aabbs.MaxY() };
+        }
+
+        inline CandidateBounds Offset(uint32_t count) const
+        {
+            return { minX + count, minY + count, maxX + count, maxY + count };
+        }
+    };
+
+    // Candidate bounds gathered from scattered AABB indices into contiguous
+    // arrays so they can be handed to OverlapTester.
+    class PackedCandidateBounds final
+    {
+    public:
+        inline uint32_t Count() const { return static_cast<uint32_t>(_minX.size()); }
+
+        inline CandidateBounds Candidates() const
+        {
+            return { _minX.data(), _minY.data(), _maxX.data(), _maxY.data() };
+        }
+
+        inline void Clear()
+        {
+            _minX.clear();
+            _minY.clear();
+            _maxX.clear();
+            _maxY.clear();
+        }
+
+        inline void Add(const AabbStorage& aabbs, uint32_t index)
+        {
+            _minX.push_back(aabbs.MinX()[index]);
+            _minY.push_back(aabbs.MinY()[index]);
+            _maxX.push_back(aabbs.MaxX()[index]);
+            _maxY.push_back(aabbs.MaxY()[index]);
+        }
+
+        // Moves the last candidate into position and drops the last.
+        inline void SwapRemove(uint32_t position)
+        {
+            _minX[position] = _minX.back();
+            _minY[position] = _minY.back();
+            _maxX[position] = _maxX.back();
+            _maxY[position] = _maxY.back();
+            _minX.pop_back();
+            _minY.pop_back();
+            _maxX.pop_back();
+            _maxY.pop_back();
+        }
+
+    private:
+        std::vector<float> _minX;
+        std::vector<float> _minY;
+        std::vector<float> _maxX;
+        std::vector<float> _maxY;
+    };
+
+    // Tests one AABB against many candidate AABBs at a time and writes the
+    // result as a bitset with one bit per candidate, so callers only branch
+    // on actual hits instead of on every comparison.
+    //
+    // The SSE2 and AVX2 kernels test a block of 8 candidates per loop
+    // iteration and turn the comparison into 8 bits with movemask.  The
+    // scalar kernel produces the same bits one candidate at a time.
+    class OverlapTester final
+    {
+    public:
+        // Uses the best instruction set the CPU supports.
+        OverlapTester();
+
+        // Uses the given instruction set, which must be supported.
+        explicit OverlapTester(InstructionSet instructionSet);
+
+        inline InstructionSet SelectedInstructionSet() const { return _instructionSet; }
+
+        static constexpr uint32_t HitWordCount(uint32_t candidateCount)
+        {
+            return (candidateCount + 63) / 64;
+        }
+
+        // Sets bit i % 64 of hits[i / 64] when bounds overlaps candidate i
+        // and clears it otherwise.  Bits past candidateCount in the last
+        // word are cleared.  hits must hold HitWordCount(candidateCount)
+        // words.
+        inline void Test(
+            const Bounds& bounds,
+            CandidateBounds candidates,
+            uint32_t candidateCount,
+            uint64_t* hits) const
+        {
+            _kernel(bounds, candidates, candidateCount, hits);
+        }
+
+        // Same as Test but sizes the hits vector first.
+        inline void Test(
+            const Bounds& bounds,
+            CandidateBounds candidates,
+            uint32_t candidateCount,
+            std::vector<uint64_t>& hits) const
+        {
+            hits.resize(HitWordCount(candidateCount));
+            _kernel(bounds, candidates, candidateCount, hits.data());
+        }
+
+        // Calls callback with the index of every candidate whose bit is set,
+        // in ascending order.
+        template<typename Callback>
+        static inline void ForEachHit(const uint64_t* hits, uint32_t candidateCount, Callback&& callback)
+        {
+            uint32_t wordCount = HitWordCount(candidateCount);
+            for (uint32_t wordIndex = 0; wordIndex < wordCount; wordIndex++)
+            {
+                uint64_t word = hits[wordIndex];
+                while (word != 0)
+                {
+                    callback(wordIndex * 64 + static_cast<uint32_t>(std::countr_zero(word)));
+                    word &= word - 1;
+                }
+            }
+        }
+
+    private:
+        typedef void (*Kernel)(
+            const Bounds& bounds,
+            CandidateBounds candidates,
+            uint32_t candidateCount,
+            uint64_t* hits);
+
+        InstructionSet _instructionSet;
+        Kernel _kernel;
+    };
+}
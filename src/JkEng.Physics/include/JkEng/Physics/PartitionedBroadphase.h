@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "IBroadphase.h"
+#include "SwapRemoveIds.h"
+
+namespace JkEng::Physics
+{
+    // Splits the AABBs into partitions that share the same collision
+    // category and mask and gives each partition its own broadphase, so
+    // AABBs that can never collide are never bucketed, sorted or tested
+    // together.
+    //
+    // Pairs inside a partition are found by the partition's broadphase, and
+    // only when the category collides with itself.  Pairs across two
+    // partitions are found by sweeping both partitions sorted along x, and
+    // only for partitions whose filters let them collide.
+    class PartitionedBroadphase final : public IBroadphase
+    {
+    public:
+        typedef std::function<std::unique_ptr<IBroadphase>()> BroadphaseFactory;
+
+        // createBroadphase is called once for every partition.
+        explicit PartitionedBroadphase(BroadphaseFactory createBroadphase);
+
+        void FindOverlappingPairs(
+            const AabbStorage& aabbs,
+            std::vector<OverlappingPair>& pairs) override;
+
+        void FindOverlappingPairs(
+            const AabbStorage& aabbs,
+            WorkerPool& workers,
+            std::vector<std::vector<OverlappingPair>>& pairsPerWorker) override;
+
+        void AabbAdded(const AabbStorage& aabbs, uint32_t index) override;
+        void AabbRemoved(const AabbStorage& aabbs, uint32_t index, uint32_t lastIndex) override;
+
+    private:
+        struct Partition
+        {
+            uint32_t category;
+            uint32_t mask;
+
+            // The scene indices of the AABBs in this partition and a copy
+            // of their bounds at the same positions.
+            std::vector<uint32_t> aabbIndices;
+            AabbStorage aabbs;
+
+            // Positions in aabbs sorted by minimum x.  Removing an AABB
+            // only forgets its id in ids, and until the next search this
+            // holds ids rather than positions.
+            std::vector<uint32_t> sortedByMinX;
+            SwapRemoveIds ids;
+
+            // Null when the category does not collide with itself.
+            std::unique_ptr<IBroadphase> broadphase;
+            std::vector<OverlappingPair> pairs;
+            std::vector<std::vector<OverlappingPair>> pairsPerWorker;
+        };
+
+        BroadphaseFactory _createBroadphase;
+        std::vector<Partition> _partitions;
+
+        // The partition of every scene AABB and its position in it.
+        std::vector<uint32_t> _partitionOf;
+        std::vector<uint32_t> _positionOf;
+
+        // Pairs of positions in _partitions whose AABBs can collide.
+        std::vector<std::pair<uint32_t, uint32_t>> _crossPartitionPairs;
+
+        void UpdatePartitions(const AabbStorage& aabbs);
+        void CreatePartitions(const AabbStorage& aabbs);
+
+        // The partition for the filter of the AABB at aabbIndex, or
+        // _partitions.size() when there is none yet.
+        uint32_t FindPartition(const AabbStorage& aabbs, uint32_t aabbIndex) const;
+
+        void AddToPartition(const AabbStorage& aabbs, uint32_t aabbIndex, uint32_t partitionIndex);
+
+        // Appends the pairs found by partition's broadphase translated to
+        // scene indices.
+        static void AppendPartitionPairs(
+            const Partition& partition,
+            const std::vector<OverlappingPair>& partitionPairs,
+            std::vector<OverlappingPair>& pairs);
+
+        static void FindCrossPartitionPairs(
+            const Partition& partition0,
+            const Partition& partition1,
+            std::vector<OverlappingPair>& pairs);
+    };
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-volatile"
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <glm/glm.hpp>
+#pragma clang diagnostic pop
+
+#include "IReadOnlyAabb2d.h"
+#include "ReadOnlyAabb2dView.h"
+
+namespace JkEng::Physics
+{
+    // Passes a ReadOnlyAabb2dView to handlers that take an IReadOnlyAabb2d,
+    // so they also see the state from when contacts were found without
+    // copying it.
+    class PreStepReadOnlyAabb2d final : public IReadOnlyAabb2d
+    {
+    public:
+        PreStepReadOnlyAabb2d(const ReadOnlyAabb2dView& view)
+            : _view(view)
+        {
+
+        }
+
+        glm::vec2 Position() const override
+        {
+            return _view.Position();
+        }
+
+        glm::vec2 Size() const override
+        {
+            return _view.Size();
+        }
+
+        glm::vec2 Velocity() const override
+        {
+            return _view.Velocity();
+        }
+
+        glm::vec2 Acceleration() const override
+        {
+            return _view.Acceleration();
+        }
+
+        uint64_t UserData() const override
+        {
+            return _view.UserData();
+        }
+
+        const std::any& ObjectInfo() const override
+        {
+            return _view.ObjectInfo();
+        }
+
+    private:
+        ReadOnlyAabb2dView _view;
+    };
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <any>
+#include <cstdint>
+#include <functional>
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-volatile"
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <glm/glm.hpp>
+#pragma clang diagnostic pop
+
+namespace JkEng::Physics
+{
+    class AabbStorage;
+
+    // A read-only view of one body as it was when the step's contacts were
+    // found, even if a handler has changed it since.  It only holds a
+    // pointer and a body id, so making one copies nothing, and none of its
+    // functions are virtual.  Only valid during the call it was passed to.
+    class ReadOnlyAabb2dView final
+    {
+    public:
+        ReadOnlyAabb2dView(const AabbStorage& storage, uint32_t index, uint32_t bodyId)
+          : _storage(&storage),
+            _index(index),
+            _bodyId(bodyId)
+        {
+
+        }
+
+        // The position of the body's definition in the SceneDefinition, with
+        // static AABBs numbered after the movable ones.
+        inline uint32_t BodyId() const { return _bodyId; }
+
+        glm::vec2 Size() const;
+        glm::vec2 Position() const;
+        glm::vec2 Velocity() const;
+        glm::vec2 Acceleration() const;
+        uint64_t UserData() const;
+        const std::any& ObjectInfo() const;
+
+        template<typename T>
+        inline const T& ObjectInfoAs() const
+        {
+            return std::any_cast<const T&>(ObjectInfo());
+        }
+
+    private:
+        const AabbStorage* _storage;
+        uint32_t _index;
+        uint32_t _bodyId;
+    };
+
+    typedef std::function<void(const ReadOnlyAabb2dView&)> CollisionViewHandler;
+}
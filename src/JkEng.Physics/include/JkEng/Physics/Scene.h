@@ -0,0 +1,11 @@
+#pragma once
+
+#include "BasicScene.h"
+#include "CollisionHandlerPolicies.h"
+#include "IBroadphase.h"
+
+namespace JkEng::Physics
+{
+    // The scene with every choice left to the SceneDefinition at run time.
+    typedef BasicScene<IBroadphase, FunctionHandlers> Scene;
+}
@@ -1,8 +1,17 @@
 #pragma once
 
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
 #include <vector>
 
+#include "BroadphaseType.h"
+#include "Contact.h"
+#include "IScene.h"
 #include "MovableAabb2dDefinition.h"
+#include "StaticAabb2dDefinition.h"
+#include "SweepAndPruneAxes.h"
+#include "TileGridDefinition.h"
 
 namespace JkEng::Physics
 {
@@ -19,7 +28,305 @@ namespace JkEng::Physics
             return _movableAabb2dDefinitions;
         }
 
+        // Static AABBs are numbered after the movable ones, so the body id
+        // of the first static AABB is the number of movable AABBs.  Bodies
+        // added to the scene later never take these ids.
+        inline void AddStaticAabb2d(StaticAabb2dDefinition staticAabb2dDefinition)
+        {
+            _staticAabb2dDefinitions.push_back(std::move(staticAabb2dDefinition));
+        }
+
+        inline const std::vector<StaticAabb2dDefinition>& StaticAabb2dDefinitions() const
+        {
+            return _staticAabb2dDefinitions;
+        }
+
+        // Tile grids are numbered after the static AABBs, in the order they
+        // were added.
+        inline void AddTileGrid(TileGridDefinition tileGridDefinition)
+        {
+            _tileGridDefinitions.push_back(std::move(tileGridDefinition));
+        }
+
+        inline const std::vector<TileGridDefinition>& TileGridDefinitions() const
+        {
+            return _tileGridDefinitions;
+        }
+
+        inline void Broadphase(BroadphaseType broadphase)
+        {
+            _broadphase = broadphase;
+        }
+
+        inline BroadphaseType Broadphase() const
+        {
+            return _broadphase;
+        }
+
+        // Width and height of the cells used by BroadphaseType::UniformGrid.
+        // A good starting point is the size of a typical AABB in the scene.
+        inline void GridCellSize(float gridCellSize)
+        {
+            if (!(gridCellSize > 0.0f))
+            {
+                std::stringstream ss;
+                ss << "GridCellSize " << gridCellSize << " must be greater than zero";
+                throw std::invalid_argument(ss.str());
+            }
+            _gridCellSize = gridCellSize;
+        }
+
+        inline float GridCellSize() const
+        {
+            return _gridCellSize;
+        }
+
+        inline void SweepAndPruneAxes(Physics::SweepAndPruneAxes sweepAndPruneAxes)
+        {
+            _sweepAndPruneAxes = sweepAndPruneAxes;
+        }
+
+        inline Physics::SweepAndPruneAxes SweepAndPruneAxes() const
+        {
+            return _sweepAndPruneAxes;
+        }
+
+        // How far the bounds kept by BroadphaseType::DynamicTree extend past
+        // each AABB.  Larger margins mean AABBs can move further before the
+        // tree has to change, at the cost of testing more pairs whose
+        // padded bounds overlap but whose actual bounds do not.
+        inline void DynamicTreeMargin(float dynamicTreeMargin)
+        {
+            if (dynamicTreeMargin < 0.0f)
+            {
+                std::stringstream ss;
+                ss << "DynamicTreeMargin " << dynamicTreeMargin << " must not be negative";
+                throw std::invalid_argument(ss.str());
+            }
+            _dynamicTreeMargin = dynamicTreeMargin;
+        }
+
+        inline float DynamicTreeMargin() const
+        {
+            return _dynamicTreeMargin;
+        }
+
+        // Gives every distinct collision filter (see CollisionFilter.h) its
+        // own broadphase, so AABBs whose filters never let them collide
+        // are never bucketed or sorted together.  Worth it when large
+        // groups of AABBs ignore each other, such as bullets and pickups.
+        inline void PartitionBroadphaseByCollisionFilter(bool partitionBroadphaseByCollisionFilter)
+        {
+            _partitionBroadphaseByCollisionFilter = partitionBroadphaseByCollisionFilter;
+        }
+
+        inline bool PartitionBroadphaseByCollisionFilter() const
+        {
+            return _partitionBroadphaseByCollisionFilter;
+        }
+
+        // The time simulated by each step, IScene::StepTime by default.
+        // Longer steps are cheaper but let AABBs move further between
+        // collision checks, so AABBs that move further than their own size
+        // or that of what they should hit in one step should be marked
+        // with MovableAabb2dDefinition::IsFast.
+        inline void StepDuration(float stepDuration)
+        {
+            if (!(stepDuration > 0.0f))
+            {
+                std::stringstream ss;
+                ss << "StepDuration " << stepDuration << " must be greater than zero";
+                throw std::invalid_argument(ss.str());
+            }
+            _stepDuration = stepDuration;
+        }
+
+        inline float StepDuration() const
+        {
+            return _stepDuration;
+        }
+
+        // How many threads Update uses to integrate and find collisions,
+        // counting the thread that calls Update.  Collision handlers are
+        // always called on the thread that calls Update, in the same order
+        // for every thread count.
+        inline void ThreadCount(uint32_t threadCount)
+        {
+            if (threadCount == 0)
+            {
+                std::stringstream ss;
+                ss << "ThreadCount " << threadCount << " must be greater than zero";
+                throw std::invalid_argument(ss.str());
+            }
+            _threadCount = threadCount;
+        }
+
+        inline uint32_t ThreadCount() const
+        {
+            return _threadCount;
+        }
+
+        // How many steps in a row a movable AABB's velocity and
+        // acceleration must stay under the sleep thresholds before it goes
+        // to sleep.  Bodies that touch only sleep together, once all of
+        // them have been at rest this long.  Sleeping AABBs are not moved
+        // and pairs of them are not tested, so neither their collision
+        // handlers nor contacts are reported for each other.  An AABB
+        // wakes, along with everything it fell asleep with, when an awake
+        // AABB touches it or its position, size, velocity or acceleration
+        // is set.  0, the default, turns sleeping off.
+        //
+        // The uniform grid and sweep and prune broadphases only test
+        // sleeping AABBs against awake ones, so a scene that is mostly
+        // asleep costs them little more than a pass over the AABBs.  The
+        // dynamic tree still visits sleeping leaves when searching for
+        // pairs and all pairs still tests every pair.
+        inline void StepsBeforeSleep(uint32_t stepsBeforeSleep)
+        {
+            _stepsBeforeSleep = stepsBeforeSleep;
+        }
+
+        inline uint32_t StepsBeforeSleep() const
+        {
+            return _stepsBeforeSleep;
+        }
+
+        // The velocity magnitude under which an AABB counts as at rest.
+        // Its velocity is set to zero when it goes to sleep.
+        inline void SleepVelocityThreshold(float sleepVelocityThreshold)
+        {
+            if (sleepVelocityThreshold < 0.0f)
+            {
+                std::stringstream ss;
+                ss << "SleepVelocityThreshold " << sleepVelocityThreshold << " must not be negative";
+                throw std::invalid_argument(ss.str());
+            }
+            _sleepVelocityThreshold = sleepVelocityThreshold;
+        }
+
+        inline float SleepVelocityThreshold() const
+        {
+            return _sleepVelocityThreshold;
+        }
+
+        // The acceleration magnitude under which an AABB counts as at
+        // rest.  Its acceleration is kept while it sleeps.
+        inline void SleepAccelerationThreshold(float sleepAccelerationThreshold)
+        {
+            if (sleepAccelerationThreshold < 0.0f)
+            {
+                std::stringstream ss;
+                ss << "SleepAccelerationThreshold " << sleepAccelerationThreshold << " must not be negative";
+                throw std::invalid_argument(ss.str());
+            }
+            _sleepAccelerationThreshold = sleepAccelerationThreshold;
+        }
+
+        inline float SleepAccelerationThreshold() const
+        {
+            return _sleepAccelerationThreshold;
+        }
+
+        // Pushes overlapping AABBs apart after the collision handlers for
+        // each step have run.  Every contact that still overlaps asks for
+        // the shortest move along one axis that separates its AABBs, split
+        // between them by MovableAabb2dDefinition::Mass.  Static AABBs and
+        // tile grids never move.  An AABB pushed the same way by several
+        // contacts moves as far as the largest one asks, and its velocity
+        // towards anything it was pushed away from is set to zero.  All of
+        // the moves are worked out before any is made, so the result does
+        // not depend on the order of contacts or handlers.  Floors and walls
+        // made of many tiles are better as tile grids than as separate
+        // static AABBs, which can catch AABBs sliding along them on the
+        // seams between tiles.  Off by default.
+        inline void ResolveCollisions(bool resolveCollisions)
+        {
+            _resolveCollisions = resolveCollisions;
+        }
+
+        inline bool ResolveCollisions() const
+        {
+            return _resolveCollisions;
+        }
+
+        // How many frames IScene::SaveState keeps before reusing the
+        // oldest one's buffer.  8 by default, enough to roll back 8 frames.
+        inline void SavedStateCount(uint32_t savedStateCount)
+        {
+            if (savedStateCount == 0)
+            {
+                std::stringstream ss;
+                ss << "SavedStateCount " << savedStateCount << " must be greater than zero";
+                throw std::invalid_argument(ss.str());
+            }
+            _savedStateCount = savedStateCount;
+        }
+
+        inline uint32_t SavedStateCount() const
+        {
+            return _savedStateCount;
+        }
+
+        // When set, every step's contacts are passed to this handler in one
+        // call instead of calling the collision handler of each AABB.
+        inline void ContactsHandler(Physics::ContactsHandler contactsHandler)
+        {
+            _contactsHandler = std::move(contactsHandler);
+        }
+
+        inline const Physics::ContactsHandler& ContactsHandler() const
+        {
+            return _contactsHandler;
+        }
+
+        // Whether movable AABBs can have collision handlers and collision
+        // view handlers, which is the default.  Turned off, the scene is
+        // built without the per contact loop that calls them, for scenes
+        // that only read contacts through the ContactsHandler, contact
+        // events or queries, and adding a movable AABB with either handler
+        // throws std::invalid_argument.  Only read by Engine::CreateScene; a
+        // BasicScene built directly does what its HandlerPolicy does.
+        inline void CollisionHandlers(bool collisionHandlers)
+        {
+            _collisionHandlers = collisionHandlers;
+        }
+
+        inline bool CollisionHandlers() const
+        {
+            return _collisionHandlers;
+        }
+
+        // When set, every step's contact events are passed to this handler
+        // in one call instead of calling the contact event handler of each
+        // AABB.
+        inline void ContactEventsHandler(Physics::ContactEventsHandler contactEventsHandler)
+        {
+            _contactEventsHandler = std::move(contactEventsHandler);
+        }
+
+        inline const Physics::ContactEventsHandler& ContactEventsHandler() const
+        {
+            return _contactEventsHandler;
+        }
+
     private:
         std::vector<MovableAabb2dDefinition> _movableAabb2dDefinitions;
+        std::vector<StaticAabb2dDefinition> _staticAabb2dDefinitions;
+        std::vector<TileGridDefinition> _tileGridDefinitions;
+        BroadphaseType _broadphase = BroadphaseType::AllPairs;
+        float _gridCellSize = 16.0f;
+        Physics::SweepAndPruneAxes _sweepAndPruneAxes = Physics::SweepAndPruneAxes::X;
+        float _dynamicTreeMargin = 1.0f;
+        bool _partitionBroadphaseByCollisionFilter = false;
+        float _stepDuration = IScene::StepTime;
+        uint32_t _threadCount = 1;
+        uint32_t _stepsBeforeSleep = 0;
+        float _sleepVelocityThreshold = 0.05f;
+        float _sleepAccelerationThreshold = 0.05f;
+        bool _resolveCollisions = false;
+        uint32_t _savedStateCount = 8;
+        Physics::ContactsHandler _contactsHandler;
+        bool _collisionHandlers = true;
+        Physics::ContactEventsHandler _contactEventsHandler;
     };
 }
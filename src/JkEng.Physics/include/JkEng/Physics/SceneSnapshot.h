@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-volatile"
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <glm/glm.hpp>
+#pragma clang diagnostic pop
+
+namespace JkEng::Physics
+{
+    // The state of a scene's movable AABBs after a step, published by
+    // IThreadedScene for the render thread.  The vectors are indexed by
+    // body id and hold BodyIdCount() entries.  Entries for static AABBs
+    // and unused ids are not meaningful.
+    struct SceneSnapshot
+    {
+        // How many steps the physics thread had run, or 0 for the state
+        // before the first.
+        uint64_t stepCount = 0;
+
+        // When the step was due.  Blending from previousPositions to
+        // positions over the StepDuration that follows keeps motion smooth,
+        // see InterpolatedPosition.
+        std::chrono::steady_clock::time_point stepTime;
+
+        std::vector<glm::vec2> positions;
+        std::vector<glm::vec2> previousPositions;
+        std::vector<glm::vec2> velocities;
+
+        inline uint32_t BodyIdCount() const
+        {
+            return static_cast<uint32_t>(positions.size());
+        }
+
+        // The position of a body alpha of the way from where it was before
+        // the step, at 0, to where it is after it, at 1.
+        inline glm::vec2 InterpolatedPosition(uint32_t bodyId, float alpha) const
+        {
+            return previousPositions[bodyId] + (positions[bodyId] - previousPositions[bodyId]) * alpha;
+        }
+    };
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-volatile"
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <glm/glm.hpp>
+#pragma clang diagnostic pop
+
+namespace JkEng::Physics
+{
+    // A segment from origin to origin + direction, for IScene::RaycastBatch.
+    struct Ray
+    {
+        glm::vec2 origin;
+        glm::vec2 direction;
+    };
+
+    // The area from position to position + size, for
+    // IScene::QueryRegionBatch.
+    struct Region
+    {
+        glm::vec2 position;
+        glm::vec2 size;
+    };
+
+    // A body hit by IScene::Raycast, IScene::RaycastAll or
+    // IScene::RaycastBatch.
+    struct RaycastHit
+    {
+        // The bodyId IScene::RaycastBatch gives rays that hit nothing.
+        static constexpr uint32_t NoBody = ~0u;
+
+        uint32_t bodyId;
+
+        // How far along the ray the body was first touched, from 0 at the
+        // ray's origin to 1 at origin + direction.
+        float fraction;
+
+        auto operator<=>(const RaycastHit&) const = default;
+    };
+
+    // A body found by IScene::NearestK.
+    struct NearestBody
+    {
+        uint32_t bodyId;
+
+        // From the query point to the closest point of the body, which is
+        // 0 when the point is inside it.
+        float distance;
+
+        auto operator<=>(const NearestBody&) const = default;
+    };
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <any>
+#include <cstdint>
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-volatile"
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <glm/glm.hpp>
+#pragma clang diagnostic pop
+
+#include "CollisionFilter.h"
+
+namespace JkEng::Physics
+{
+    // An AABB that never moves, such as a floor, wall or tile.  Static AABBs
+    // are only ever tested against movable ones and have no handlers of
+    // their own; movable AABBs that touch one are told through their
+    // handlers as usual.
+    class StaticAabb2dDefinition final
+    {
+    public:
+        StaticAabb2dDefinition(
+            glm::vec2 position,
+            glm::vec2 size,
+            std::any objectInfo)
+
+          : _position(std::move(position)),
+            _size(std::move(size)),
+            _objectInfo(std::move(objectInfo))
+        {
+
+        }
+
+        inline const glm::vec2& Position() const
+        {
+            return _position;
+        }
+
+        inline const glm::vec2& Size() const
+        {
+            return _size;
+        }
+
+        inline const std::any& ObjectInfo() const
+        {
+            return _objectInfo;
+        }
+
+        inline void UserData(uint64_t userData)
+        {
+            _userData = userData;
+        }
+
+        inline uint64_t UserData() const
+        {
+            return _userData;
+        }
+
+        // See CollisionFilter.h.
+        inline void CollisionFilter(uint32_t category, uint32_t mask)
+        {
+            _collisionCategory = category;
+            _collisionMask = mask;
+        }
+
+        inline uint32_t CollisionCategory() const
+        {
+            return _collisionCategory;
+        }
+
+        inline uint32_t CollisionMask() const
+        {
+            return _collisionMask;
+        }
+
+    private:
+        glm::vec2 _position;
+        glm::vec2 _size;
+        std::any _objectInfo;
+        uint64_t _userData = 0;
+        uint32_t _collisionCategory = DefaultCollisionCategory;
+        uint32_t _collisionMask = DefaultCollisionMask;
+    };
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "AabbStorage.h"
+#include "DynamicAabbTree.h"
+#include "IBroadphase.h"
+#include "StaticAabb2dDefinition.h"
+
+namespace JkEng::Physics
+{
+    // The static AABBs of a scene and a tree over them that is built once
+    // and never changed.  Only movable AABBs are looked up in it, so pairs
+    // of static AABBs are never considered.
+    class StaticAabbTree final
+    {
+    public:
+        StaticAabbTree(const std::vector<StaticAabb2dDefinition>& definitions);
+
+        inline const AabbStorage& Aabbs() const
+        {
+            return _aabbs;
+        }
+
+        // Appends { movableIndex, staticIndex } for every static AABB that
+        // overlaps one of the awake movable AABBs in [begin, end).  stack is
+        // scratch space owned by the caller, so separate threads can search
+        // separate ranges.
+        void FindOverlappingPairs(
+            const AabbStorage& movableAabbs,
+            uint32_t begin,
+            uint32_t end,
+            std::vector<int32_t>& stack,
+            std::vector<OverlappingPair>& pairs) const;
+
+        // Calls callback(staticIndex) for every static AABB whose bounds
+        // pass isWanted, see DynamicAabbTree::ForEachLeaf.
+        template<typename IsWanted, typename Callback>
+        void ForEachAabb(IsWanted isWanted, std::vector<int32_t>& stack, Callback callback) const
+        {
+            _tree.ForEachLeaf(isWanted, stack, callback);
+        }
+
+        // See DynamicAabbTree::ForEachLeafClosestFirst.
+        template<typename IsWanted, typename Distance, typename Callback>
+        void ForEachAabbClosestFirst(IsWanted isWanted, Distance distance, std::vector<int32_t>& stack, Callback callback) const
+        {
+            _tree.ForEachLeafClosestFirst(isWanted, distance, stack, callback);
+        }
+
+    private:
+        AabbStorage _aabbs;
+        DynamicAabbTree _tree;
+
+        // Every category and mask bit used by any static AABB.
+        uint32_t _categoryUnion = 0;
+        uint32_t _maskUnion = 0;
+    };
+}
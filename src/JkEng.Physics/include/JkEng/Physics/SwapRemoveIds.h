@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace JkEng::Physics
+{
+    // Gives each index of an array that is kept dense with swap-removal an
+    // id that stays the same when other elements are removed, so lists
+    // holding ids can be brought up to date in one pass later rather than
+    // searched on every removal.
+    //
+    // After Reset every id is its element's index.  Adding hands out the
+    // next id, removing forgets the removed element's id and moves the
+    // last element's id to the removed index, the same as the array.
+    class SwapRemoveIds final
+    {
+    public:
+        static constexpr uint32_t Removed = ~0u;
+
+        // Starts over with count elements, each with its index as its id.
+        inline void Reset(uint32_t count)
+        {
+            _indexOfId.resize(count);
+            _idOfIndex.resize(count);
+            std::iota(_indexOfId.begin(), _indexOfId.end(), 0u);
+            std::iota(_idOfIndex.begin(), _idOfIndex.end(), 0u);
+            _hasRemovals = false;
+        }
+
+        // The number of elements in the array.
+        inline uint32_t Count() const { return static_cast<uint32_t>(_idOfIndex.size()); }
+
+        // Whether ids and indices differ, which only removal can cause.
+        inline bool HasRemovals() const { return _hasRemovals; }
+
+        // Returns the id of an element appended to the array.
+        inline uint32_t Add()
+        {
+            uint32_t id = static_cast<uint32_t>(_indexOfId.size());
+            _indexOfId.push_back(Count());
+            _idOfIndex.push_back(id);
+            return id;
+        }
+
+        inline void SwapRemove(uint32_t index)
+        {
+            uint32_t lastIndex = Count() - 1;
+            _indexOfId[_idOfIndex[index]] = Removed;
+            if (index != lastIndex)
+            {
+                uint32_t movedId = _idOfIndex[lastIndex];
+                _indexOfId[movedId] = index;
+                _idOfIndex[index] = movedId;
+            }
+            _idOfIndex.pop_back();
+            _hasRemovals = true;
+        }
+
+        // The index of the element with id, or Removed.
+        inline uint32_t IndexOf(uint32_t id) const { return _indexOfId[id]; }
+
+    private:
+        std::vector<uint32_t> _indexOfId;
+        std::vector<uint32_t> _idOfIndex;
+        bool _hasRemovals = false;
+    };
+}
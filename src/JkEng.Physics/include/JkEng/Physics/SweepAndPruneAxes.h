@@ -0,0 +1,16 @@
+#pragma once
+
+namespace JkEng::Physics
+{
+    // Axes BroadphaseType::SweepAndPrune keeps sorted.
+    enum class SweepAndPruneAxes
+    {
+        X,
+        Y,
+
+        // Keeps both axes sorted and sweeps along whichever one the AABBs
+        // are more spread out on each step.  Costs an extra sort per step
+        // but adapts when the scene is not laid out along one axis.
+        Both
+    };
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "IBroadphase.h"
+#include "OverlapTester.h"
+#include "SwapRemoveIds.h"
+#include "SweepAndPruneAxes.h"
+
+namespace JkEng::Physics
+{
+    // Broadphase that keeps the min and max endpoints of every AABB sorted
+    // along one or both axes and sweeps the sorted endpoints for overlaps.
+    //
+    // The endpoint lists persist between calls and are re-sorted with an
+    // insertion sort, which is close to linear when AABBs only move a
+    // little between calls.  Removing an AABB only forgets its id, and its
+    // endpoints are dropped by the next sort's pass over the lists.
+    //
+    // Sleeping AABBs are swept like the rest but only tested against awake
+    // ones, so in a scene that is mostly asleep the sweep is mostly a walk
+    // over the endpoints.
+    class SweepAndPruneBroadphase final : public IBroadphase
+    {
+    public:
+        SweepAndPruneBroadphase(SweepAndPruneAxes axes);
+
+        void FindOverlappingPairs(
+            const AabbStorage& aabbs,
+            std::vector<OverlappingPair>& pairs) override;
+
+        void FindOverlappingPairs(
+            const AabbStorage& aabbs,
+            WorkerPool& workers,
+            std::vector<std::vector<OverlappingPair>>& pairsPerWorker) override;
+
+        void AabbAdded(const AabbStorage& aabbs, uint32_t index) override;
+        void AabbRemoved(const AabbStorage& aabbs, uint32_t index, uint32_t lastIndex) override;
+
+    private:
+        struct Endpoint
+        {
+            float value;
+
+            // The index of the AABB shifted left one bit with the low bit
+            // set for a max endpoint.  Between a removal and the next sort
+            // this is the AABB's id in _ids instead.
+            uint32_t aabbIndexAndIsMax;
+
+            inline uint32_t AabbIndex() const { return aabbIndexAndIsMax >> 1; }
+            inline bool IsMax() const { return (aabbIndexAndIsMax & 1u) != 0; }
+
+            // Min endpoints sort before max endpoints with the same value
+            // so AABBs that are only touching are still reported.
+            inline bool operator<(const Endpoint& other) const
+            {
+                return value < other.value
+                    || (value == other.value && IsMax() < other.IsMax());
+            }
+        };
+
+        // AABBs whose min endpoint has been swept past but whose max
+        // endpoint has not.  positions maps an AABB index to its position
+        // in aabbIndices so it can be removed in constant time.  bounds
+        // holds the bounds of aabbIndices in the same order so the whole
+        // list can be tested with one OverlapTester call.
+        struct ActiveList
+        {
+            std::vector<uint32_t> aabbIndices;
+            std::vector<uint32_t> positions;
+            PackedCandidateBounds bounds;
+            std::vector<uint64_t> hits;
+
+            void Clear(uint32_t aabbCount);
+            void Add(const AabbStorage& aabbs, uint32_t aabbIndex);
+            void Remove(uint32_t aabbIndex);
+        };
+
+        // The active AABBs kept apart by whether they are awake, since two
+        // sleeping AABBs are never tested against each other.
+        struct ActiveLists
+        {
+            ActiveList awake;
+            ActiveList sleeping;
+
+            void Clear(uint32_t aabbCount);
+            void Add(const AabbStorage& aabbs, uint32_t aabbIndex);
+            void Remove(const AabbStorage& aabbs, uint32_t aabbIndex);
+        };
+
+        // Below this many active AABBs the call into OverlapTester costs
+        // more than testing them one at a time.
+        static constexpr uint32_t MinActiveCountForOverlapTester = 16;
+
+        // Each parallel task sweeps this many consecutive endpoints.
+        static constexpr uint32_t EndpointsPerTask = 4096;
+
+        SweepAndPruneAxes _axes;
+        std::vector<Endpoint> _endpointsX;
+        std::vector<Endpoint> _endpointsY;
+
+        // Follows the AABBs added and removed since the last sort.  Its
+        // count differs from the AABBs' when the broadphase was not told
+        // about some, and the lists are rebuilt.
+        SwapRemoveIds _ids;
+        OverlapTester _overlapTester;
+        ActiveLists _active;
+
+        // Used by the parallel sweep.  The AABBs active at the start of
+        // task t are _taskStartActive[_taskStartActiveOffsets[t]] up to the
+        // next task's offset.
+        std::vector<ActiveLists> _activePerWorker;
+        std::vector<uint32_t> _taskStartActive;
+        std::vector<uint32_t> _taskStartActiveOffsets;
+
+        static void RebuildEndpoints(std::vector<Endpoint>& endpoints, size_t aabbCount);
+        static void UpdateEndpoints(std::vector<Endpoint>& endpoints, const AabbStorage& aabbs, bool isXAxis);
+        static void InsertionSort(std::vector<Endpoint>& endpoints);
+        static void SortEndpoints(std::vector<Endpoint>& endpoints, const AabbStorage& aabbs, bool isXAxis);
+        static float Spread(const std::vector<Endpoint>& endpoints);
+
+        // Drops the endpoints of AABBs removed since the last sort and
+        // gives the rest their AABB's index again.  Keeps their order.
+        void CompactEndpoints(std::vector<Endpoint>& endpoints) const;
+
+        // Sorts the endpoints of the axes in use and returns the ones to
+        // sweep.
+        const std::vector<Endpoint>& SortEndpoints(const AabbStorage& aabbs);
+
+        // Sweeps endpoints [begin, end) starting from the given active
+        // lists, which must hold the AABBs active at begin.
+        void Sweep(
+            const std::vector<Endpoint>& endpoints,
+            const AabbStorage& aabbs,
+            uint32_t begin,
+            uint32_t end,
+            ActiveLists& active,
+            std::vector<OverlappingPair>& pairs) const;
+
+        // Appends a pair for every AABB in active that collides with the
+        // one at aabbIndex.
+        void TestActive(
+            const AabbStorage& aabbs,
+            uint32_t aabbIndex,
+            ActiveList& active,
+            std::vector<OverlappingPair>& pairs) const;
+    };
+}
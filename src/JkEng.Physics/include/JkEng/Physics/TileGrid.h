@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "AabbStorage.h"
+#include "Bounds.h"
+#include "IBroadphase.h"
+#include "TileGridDefinition.h"
+
+namespace JkEng::Physics
+{
+    // The solid cells of a TileGridDefinition.  Every lookup only reads
+    // the cells a set of bounds covers, so the cost does not depend on the
+    // size of the grid.
+    class TileGrid final
+    {
+    public:
+        TileGrid(const TileGridDefinition& definition);
+
+        // Holds a single AABB covering the whole grid, which is what
+        // handlers are shown.
+        inline const AabbStorage& Aabbs() const
+        {
+            return _aabbs;
+        }
+
+        // Whether any solid cell touches bounds.
+        bool Overlaps(const Bounds& bounds) const;
+
+        // Whether any solid cell touches bounds at some point while it
+        // moves by (deltaX, deltaY).
+        bool OverlapsWhileMoving(const Bounds& bounds, float deltaX, float deltaY) const;
+
+        // Whether the segment from (originX, originY) to (originX + deltaX,
+        // originY + deltaY) touches a solid cell, and if so the fraction of
+        // the way along it where it first does.  Walks only the cells the
+        // segment passes through.
+        bool Raycast(float originX, float originY, float deltaX, float deltaY, float& fraction) const;
+
+        // The squared distance from (x, y) to the closest solid cell, or
+        // infinity when there is none within maxDistanceSquared.  Searches
+        // rings of cells outwards, so stops early when a close cell is
+        // found.
+        float DistanceSquaredToSolidCell(float x, float y, float maxDistanceSquared) const;
+
+        // Calls move(moveX, moveY) with the shortest move along one axis
+        // that takes bounds out of each solid cell it overlaps.  Moves
+        // into a neighbouring solid cell are never chosen, since that edge
+        // is inside a solid area, so an AABB sliding along a row of cells
+        // is not caught on the seams between them.
+        template<typename Move>
+        void ForEachSeparatingMove(const Bounds& bounds, Move move) const
+        {
+            if (!_bounds.Overlaps(bounds))
+            {
+                return;
+            }
+
+            // Cells outside the grid are empty.
+            auto isOpen = [this](int64_t column, int64_t row)
+            {
+                return column < 0 || column >= _columns || row < 0 || row >= _rows || !IsSolid(column, row);
+            };
+
+            CellRange cells = CellsCoveredBy(bounds);
+            for (int64_t row = cells.firstRow; row <= cells.lastRow; row++)
+            {
+                for (int64_t column = cells.firstColumn; column <= cells.lastColumn; column++)
+                {
+                    float moveX;
+                    float moveY;
+                    if (!IsSolid(column, row) || !bounds.SeparatingMoves(CellBounds(column, row), moveX, moveY))
+                    {
+                        continue;
+                    }
+
+                    bool isXOpen = isOpen(column + (moveX < 0.0f ? -1 : 1), row);
+                    bool isYOpen = isOpen(column, row + (moveY < 0.0f ? -1 : 1));
+                    if (isXOpen && (!isYOpen || std::abs(moveX) < std::abs(moveY)))
+                    {
+                        move(moveX, 0.0f);
+                    }
+                    else if (isYOpen)
+                    {
+                        move(0.0f, moveY);
+                    }
+                }
+            }
+        }
+
+        // Appends { movableIndex, staticIndex } for every awake movable AABB
+        // in [begin, end) that touches a solid cell.
+        void FindOverlappingPairs(
+            const AabbStorage& movableAabbs,
+            uint32_t begin,
+            uint32_t end,
+            uint32_t staticIndex,
+            std::vector<OverlappingPair>& pairs) const;
+
+    private:
+        // An inclusive range of cells, empty when first > last.
+        struct CellRange
+        {
+            int64_t firstColumn;
+            int64_t lastColumn;
+            int64_t firstRow;
+            int64_t lastRow;
+        };
+
+        AabbStorage _aabbs;
+        Bounds _bounds;
+        uint32_t _columns;
+        uint32_t _rows;
+        float _cellSize;
+        std::vector<uint64_t> _solidBits;
+
+        // The cells bounds touches, including those it only shares an edge
+        // with.
+        CellRange CellsCoveredBy(const Bounds& bounds) const;
+
+        // Whether any of the bits in [firstBit, lastBit] is set.
+        bool IsAnySolid(uint64_t firstBit, uint64_t lastBit) const;
+
+        // The column or row holding position, or the nearest one to it.
+        inline int64_t ClampedCellAt(float position, float gridMin, uint32_t cellCount) const
+        {
+            auto cell = static_cast<int64_t>(std::floor((position - gridMin) / _cellSize));
+            return std::clamp<int64_t>(cell, 0, static_cast<int64_t>(cellCount) - 1);
+        }
+
+        inline bool IsSolid(int64_t column, int64_t row) const
+        {
+            uint64_t bit = static_cast<uint64_t>(column + row * _columns);
+            return (_solidBits[bit / 64] >> (bit % 64)) & 1;
+        }
+
+        inline Bounds CellBounds(int64_t column, int64_t row) const
+        {
+            float minX = _bounds.minX + column * _cellSize;
+            float minY = _bounds.minY + row * _cellSize;
+            return { minX, minY, minX + _cellSize, minY + _cellSize };
+        }
+    };
+}
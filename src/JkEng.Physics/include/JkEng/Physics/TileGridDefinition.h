@@ -0,0 +1,168 @@
+#pragma once
+
+#include <any>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-volatile"
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <glm/glm.hpp>
+#pragma clang diagnostic pop
+
+#include "CollisionFilter.h"
+
+namespace JkEng::Physics
+{
+    // A grid of equally sized cells, each either solid or empty, that
+    // never moves.  A whole tile map level is one tile grid rather than one
+    // static AABB per solid tile: each cell costs a single bit, and a
+    // movable AABB is only checked against the cells its bounds cover.
+    //
+    // To the rest of the scene a tile grid is a single static body covering
+    // the whole grid.  A movable AABB touching any of its solid cells gets
+    // one contact with it, and its handlers are shown the grid's bounds,
+    // object info and user data.
+    class TileGridDefinition final
+    {
+    public:
+        // An empty grid whose bottom left corner is at position.  Column 0
+        // is on the left and row 0 at the bottom.
+        TileGridDefinition(
+            glm::vec2 position,
+            uint32_t columns,
+            uint32_t rows,
+            float cellSize,
+            std::any objectInfo)
+
+          : _position(std::move(position)),
+            _columns(columns),
+            _rows(rows),
+            _cellSize(cellSize),
+            _solidBits(WordCount(columns, rows)),
+            _objectInfo(std::move(objectInfo))
+        {
+            if (!(cellSize > 0.0f))
+            {
+                std::stringstream ss;
+                ss << "TileGridDefinition cellSize " << cellSize << " must be greater than zero";
+                throw std::invalid_argument(ss.str());
+            }
+        }
+
+        inline const glm::vec2& Position() const
+        {
+            return _position;
+        }
+
+        inline uint32_t Columns() const
+        {
+            return _columns;
+        }
+
+        inline uint32_t Rows() const
+        {
+            return _rows;
+        }
+
+        inline float CellSize() const
+        {
+            return _cellSize;
+        }
+
+        inline void SetSolid(uint32_t column, uint32_t row, bool isSolid = true)
+        {
+            uint64_t bit = BitOf(column, row);
+            uint64_t& word = _solidBits[bit / 64];
+            word = isSolid ? word | (1ull << (bit % 64)) : word & ~(1ull << (bit % 64));
+        }
+
+        inline bool IsSolid(uint32_t column, uint32_t row) const
+        {
+            uint64_t bit = BitOf(column, row);
+            return (_solidBits[bit / 64] >> (bit % 64)) & 1;
+        }
+
+        // Replaces every cell at once.  Cells are numbered row by row from
+        // the bottom, so cell column + row * Columns() is bit
+        // (column + row * Columns()) % 64 of word
+        // (column + row * Columns()) / 64.
+        inline void SolidBits(std::vector<uint64_t> solidBits)
+        {
+            if (solidBits.size() != _solidBits.size())
+            {
+                std::stringstream ss;
+                ss << "SolidBits has " << solidBits.size() << " words but a " << _columns << "x" << _rows
+                    << " grid needs " << _solidBits.size();
+                throw std::invalid_argument(ss.str());
+            }
+            _solidBits = std::move(solidBits);
+        }
+
+        inline const std::vector<uint64_t>& SolidBits() const
+        {
+            return _solidBits;
+        }
+
+        inline const std::any& ObjectInfo() const
+        {
+            return _objectInfo;
+        }
+
+        inline void UserData(uint64_t userData)
+        {
+            _userData = userData;
+        }
+
+        inline uint64_t UserData() const
+        {
+            return _userData;
+        }
+
+        // See CollisionFilter.h.
+        inline void CollisionFilter(uint32_t category, uint32_t mask)
+        {
+            _collisionCategory = category;
+            _collisionMask = mask;
+        }
+
+        inline uint32_t CollisionCategory() const
+        {
+            return _collisionCategory;
+        }
+
+        inline uint32_t CollisionMask() const
+        {
+            return _collisionMask;
+        }
+
+    private:
+        glm::vec2 _position;
+        uint32_t _columns;
+        uint32_t _rows;
+        float _cellSize;
+        std::vector<uint64_t> _solidBits;
+        std::any _objectInfo;
+        uint64_t _userData = 0;
+        uint32_t _collisionCategory = DefaultCollisionCategory;
+        uint32_t _collisionMask = DefaultCollisionMask;
+
+        static inline size_t WordCount(uint32_t columns, uint32_t rows)
+        {
+            return (static_cast<size_t>(columns) * rows + 63) / 64;
+        }
+
+        inline uint64_t BitOf(uint32_t column, uint32_t row) const
+        {
+            if (column >= _columns || row >= _rows)
+            {
+                std::stringstream ss;
+                ss << "Cell " << column << ", " << row << " is outside the " << _columns << "x" << _rows << " grid";
+                throw std::out_of_range(ss.str());
+            }
+            return column + static_cast<uint64_t>(row) * _columns;
+        }
+    };
+}
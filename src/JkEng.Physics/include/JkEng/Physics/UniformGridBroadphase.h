@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "Bounds.h"
+#include "IBroadphase.h"
+
+namespace JkEng::Physics
+{
+    // Broadphase that buckets AABBs by the uniform grid cells they cover
+    // and only tests AABBs that share a cell.
+    //
+    // Cells are hashed into a table that is rebuilt every call, so there
+    // is no level size to configure and no state to keep in sync as AABBs
+    // move.  Cell coordinates are clamped to MaxCellCoordinate either side
+    // of the origin, so AABBs beyond that all share the cells at the edge,
+    // which is correct but slow.  An AABB is added to every cell it covers,
+    // unless that is more than MaxCellsPerAabb cells, in which case it is
+    // kept out of the table and tested against every other AABB.
+    //
+    // Sleeping AABBs go in a table of their own that is only rebuilt when
+    // they change, and awake AABBs look up their cells in it, so in a
+    // scene that is mostly asleep each call only checks that the sleeping
+    // AABBs are where they were.
+    class UniformGridBroadphase final : public IBroadphase
+    {
+    public:
+        UniformGridBroadphase(float cellSize);
+
+        void FindOverlappingPairs(
+            const AabbStorage& aabbs,
+            std::vector<OverlappingPair>& pairs) override;
+
+        void FindOverlappingPairs(
+            const AabbStorage& aabbs,
+            WorkerPool& workers,
+            std::vector<std::vector<OverlappingPair>>& pairsPerWorker) override;
+
+    private:
+        // Each task searches this many hash buckets.
+        static constexpr uint32_t BucketsPerTask = 1024;
+
+        static constexpr int32_t MaxCellCoordinate = 1 << 20;
+        static constexpr size_t MaxCellsPerAabb = 256;
+
+        struct CellRange
+        {
+            int32_t minX;
+            int32_t minY;
+            int32_t maxX;
+            int32_t maxY;
+        };
+
+        struct CellEntry
+        {
+            int32_t cellX;
+            int32_t cellY;
+            uint32_t aabbIndex;
+        };
+
+        // entries grouped by hash bucket.  The entries for bucket b are
+        // [bucketStarts[b], bucketStarts[b + 1]) and are in ascending
+        // aabbIndex order.  AABBs covering more than MaxCellsPerAabb cells
+        // are in oversizeIndices instead.
+        struct CellTable
+        {
+            std::vector<uint32_t> bucketStarts;
+            std::vector<CellEntry> entries;
+            std::vector<uint32_t> oversizeIndices;
+
+            inline uint32_t BucketCount() const { return static_cast<uint32_t>(bucketStarts.size() - 1); }
+        };
+
+        float _inverseCellSize;
+        std::vector<CellRange> _cellRanges;
+
+        std::vector<uint32_t> _awakeIndices;
+        CellTable _awake;
+
+        // The sleeping AABBs and their bounds when _sleeping was built.
+        std::vector<uint32_t> _sleepingIndices;
+        std::vector<Bounds> _sleepingBounds;
+        CellTable _sleeping;
+
+        // Marks the AABBs in either table's oversizeIndices.  Only filled
+        // while there are any.
+        std::vector<uint8_t> _isOversize;
+
+        // Clamped so the cast is defined however far away value is, and
+        // NaN goes to the lowest cell.
+        inline int32_t CellCoordinate(float value) const
+        {
+            float cell = std::floor(value * _inverseCellSize);
+            if (!(cell > -MaxCellCoordinate))
+            {
+                return -MaxCellCoordinate;
+            }
+            if (cell > MaxCellCoordinate)
+            {
+                return MaxCellCoordinate;
+            }
+            return static_cast<int32_t>(cell);
+        }
+
+        static inline uint32_t HashCell(int32_t cellX, int32_t cellY)
+        {
+            return (static_cast<uint32_t>(cellX) * 73856093u)
+                ^ (static_cast<uint32_t>(cellY) * 19349663u);
+        }
+
+        // Fills _awakeIndices and rebuilds _sleeping if the sleeping AABBs
+        // are not the ones it was built from.
+        void BuildTables(const AabbStorage& aabbs);
+
+        // Returns false when the sleeping AABBs or their bounds changed.
+        bool UpdateSleepingIndices(const AabbStorage& aabbs);
+
+        void BuildTable(const AabbStorage& aabbs, const std::vector<uint32_t>& aabbIndices, CellTable& table);
+
+        // Pairs found from the cell holding the bottom left corner of their
+        // intersection are reported, so each pair is reported once.
+        inline bool IsReportingCell(const AabbStorage& aabbs, uint32_t index0, uint32_t index1, const CellEntry& entry) const
+        {
+            return CellCoordinate(std::max(aabbs.MinX()[index0], aabbs.MinX()[index1])) == entry.cellX
+                && CellCoordinate(std::max(aabbs.MinY()[index0], aabbs.MinY()[index1])) == entry.cellY;
+        }
+
+        // Searches the awake buckets [bucketBegin, bucketEnd) for pairs of
+        // awake AABBs, and the sleeping AABBs sharing their cells.
+        void FindOverlappingPairs(
+            const AabbStorage& aabbs,
+            uint32_t bucketBegin,
+            uint32_t bucketEnd,
+            std::vector<OverlappingPair>& pairs) const;
+
+        // Tests every oversize AABB against every AABB, skipping pairs
+        // that are both asleep.
+        void FindOversizePairs(const AabbStorage& aabbs, std::vector<OverlappingPair>& pairs) const;
+    };
+}
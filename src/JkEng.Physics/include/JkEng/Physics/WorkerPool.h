@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace JkEng::Physics
+{
+    // A fixed set of threads that run batches of tasks for the scene.
+    //
+    // The thread calling Run works through tasks too, so a pool with a
+    // worker count of N only starts N - 1 threads.  Tasks are handed out
+    // one at a time from a shared counter, so many small tasks balance
+    // better than one large task per worker.
+    class WorkerPool final
+    {
+    public:
+        typedef std::function<void(uint32_t taskIndex, uint32_t workerIndex)> Task;
+
+        explicit WorkerPool(uint32_t workerCount);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        inline uint32_t WorkerCount() const { return static_cast<uint32_t>(_threads.size()) + 1; }
+
+        // Calls task once for every taskIndex in [0, taskCount) and returns
+        // once they have all finished.  The calling thread is worker 0 and
+        // every workerIndex is less than WorkerCount.  A worker only runs
+        // one task at a time, so state indexed by workerIndex can be used
+        // without locking.  If any task throws, the first exception is
+        // rethrown here after the rest have finished.
+        void Run(uint32_t taskCount, const Task& task);
+
+    private:
+        std::vector<std::thread> _threads;
+
+        std::mutex _mutex;
+        std::condition_variable _batchStarted;
+        std::condition_variable _batchFinished;
+
+        // Guarded by _mutex.
+        uint64_t _batch = 0;
+        uint32_t _runningThreads = 0;
+        bool _stopping = false;
+        std::exception_ptr _exception;
+
+        // Only written while no batch is running.
+        const Task* _task = nullptr;
+        uint32_t _taskCount = 0;
+        std::atomic<uint32_t> _nextTaskIndex = 0;
+
+        void ThreadMain(uint32_t workerIndex);
+        void RunTasks(uint32_t workerIndex);
+    };
+}
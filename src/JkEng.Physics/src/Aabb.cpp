@@ -4,6 +4,11 @@ using namespace JkEng::Physics;
 
 void Aabb::SetPositionAndSize(const glm::vec2& position, const glm::vec2& size)
 {
-    _bottomLeft = position;
-    _topRight = position + size;
+    _storage->BeforeMove(_index);
+    _storage->BeforeWrite(_index);
+    glm::vec2 topRight = position + size;
+    _storage->MinX()[_index] = position.x;
+    _storage->MinY()[_index] = position.y;
+    _storage->MaxX()[_index] = topRight.x;
+    _storage->MaxY()[_index] = topRight.y;
 }
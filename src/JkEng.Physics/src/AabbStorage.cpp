@@ -0,0 +1,211 @@
+#include "AabbStorage.h"
+
+#include <cassert>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+using namespace JkEng::Physics;
+
+void AabbStorage::ThrowNotAccessThread() const
+{
+    std::stringstream message;
+    message << "Bodies can only be read or written from thread " << _accessThread->load()
+        << " while it steps the scene, not from thread " << std::this_thread::get_id()
+        << ".  Read IThreadedScene::LatestSnapshot and queue writes through IThreadedScene instead.";
+    throw std::logic_error(message.str());
+}
+
+uint32_t AabbStorage::Add(
+    const glm::vec2& position,
+    const glm::vec2& size,
+    glm::vec2 velocity,
+    glm::vec2 acceleration,
+    IReadOnlyAabb2d::CollisionHandler collisionHandler,
+    std::any objectInfo)
+{
+    glm::vec2 topRight = position + size;
+    return Add(
+        position.x,
+        topRight.x,
+        position.y,
+        topRight.y,
+        velocity,
+        acceleration,
+        std::move(collisionHandler),
+        std::move(objectInfo));
+}
+
+uint32_t AabbStorage::Add(
+    float leftXMin,
+    float rightXMax,
+    float bottomYMin,
+    float topYMax,
+    glm::vec2 velocity,
+    glm::vec2 acceleration,
+    IReadOnlyAabb2d::CollisionHandler collisionHandler,
+    std::any objectInfo)
+{
+    uint32_t index = Count();
+    _boundsVersion++;
+    _minX.push_back(leftXMin);
+    _minY.push_back(bottomYMin);
+    _maxX.push_back(rightXMax);
+    _maxY.push_back(topYMax);
+    _velocityX.push_back(velocity.x);
+    _velocityY.push_back(velocity.y);
+    _accelerationX.push_back(acceleration.x);
+    _accelerationY.push_back(acceleration.y);
+    _userData.push_back(0);
+    _collisionCategory.push_back(DefaultCollisionCategory);
+    _collisionMask.push_back(DefaultCollisionMask);
+    _isAwake.push_back(1);
+    _previousMinX.push_back(leftXMin);
+    _previousMinY.push_back(bottomYMin);
+    _stepsAtRest.push_back(0);
+    _isFast.push_back(0);
+    _inverseMass.push_back(1.0f);
+    _cold.push_back({ std::move(collisionHandler), std::move(objectInfo), nullptr, true, nullptr });
+    if (_isPreserving)
+    {
+        _preservedStateIndices.push_back(NotPreserved);
+    }
+    return index;
+}
+
+void AabbStorage::SwapRemove(uint32_t index)
+{
+    assert(!_isPreserving && "AabbStorage: SwapRemove must not be called while preserving pre-step state");
+
+    auto swapRemove = [index](auto& values)
+    {
+        values[index] = std::move(values.back());
+        values.pop_back();
+    };
+    _boundsVersion++;
+    swapRemove(_minX);
+    swapRemove(_minY);
+    swapRemove(_maxX);
+    swapRemove(_maxY);
+    swapRemove(_velocityX);
+    swapRemove(_velocityY);
+    swapRemove(_accelerationX);
+    swapRemove(_accelerationY);
+    swapRemove(_userData);
+    swapRemove(_collisionCategory);
+    swapRemove(_collisionMask);
+    swapRemove(_isAwake);
+    swapRemove(_previousMinX);
+    swapRemove(_previousMinY);
+    swapRemove(_stepsAtRest);
+    swapRemove(_isFast);
+    swapRemove(_inverseMass);
+    swapRemove(_cold);
+}
+
+void AabbStorage::Reserve(size_t count)
+{
+    _minX.reserve(count);
+    _minY.reserve(count);
+    _maxX.reserve(count);
+    _maxY.reserve(count);
+    _velocityX.reserve(count);
+    _velocityY.reserve(count);
+    _accelerationX.reserve(count);
+    _accelerationY.reserve(count);
+    _userData.reserve(count);
+    _collisionCategory.reserve(count);
+    _collisionMask.reserve(count);
+    _isAwake.reserve(count);
+    _previousMinX.reserve(count);
+    _previousMinY.reserve(count);
+    _stepsAtRest.reserve(count);
+    _isFast.reserve(count);
+    _inverseMass.reserve(count);
+}
+
+void AabbStorage::BeginPreservingPreStepState()
+{
+    _preservedStateIndices.resize(Count(), NotPreserved);
+    _isPreserving = true;
+}
+
+void AabbStorage::EndPreservingPreStepState()
+{
+    for (uint32_t index : _preservedAabbIndices)
+    {
+        _preservedStateIndices[index] = NotPreserved;
+    }
+    _preservedAabbIndices.clear();
+    _preservedStates.clear();
+    _isPreserving = false;
+}
+
+namespace
+{
+    // Calls copy(array, bytes per AABB) for each array SaveKinematics
+    // copies, in the order they are laid out in AabbKinematics::bytes.
+    template<typename Storage, typename Copy>
+    void ForEachKinematicArray(Storage& storage, Copy copy)
+    {
+        copy(storage.MinX(), sizeof(float));
+        copy(storage.MinY(), sizeof(float));
+        copy(storage.MaxX(), sizeof(float));
+        copy(storage.MaxY(), sizeof(float));
+        copy(storage.VelocityX(), sizeof(float));
+        copy(storage.VelocityY(), sizeof(float));
+        copy(storage.AccelerationX(), sizeof(float));
+        copy(storage.AccelerationY(), sizeof(float));
+        copy(storage.PreviousMinX(), sizeof(float));
+        copy(storage.PreviousMinY(), sizeof(float));
+        copy(storage.UserData(), sizeof(uint64_t));
+    }
+
+    constexpr size_t KinematicBytesPerAabb = 10 * sizeof(float) + sizeof(uint64_t);
+}
+
+void AabbStorage::SaveKinematics(AabbKinematics& kinematics) const
+{
+    kinematics.count = Count();
+    kinematics.bytes.resize(Count() * KinematicBytesPerAabb);
+    if (Count() == 0)
+    {
+        return;
+    }
+
+    std::byte* destination = kinematics.bytes.data();
+    ForEachKinematicArray(*this, [&](const void* array, size_t bytesPerAabb)
+    {
+        std::memcpy(destination, array, Count() * bytesPerAabb);
+        destination += Count() * bytesPerAabb;
+    });
+}
+
+void AabbStorage::RestoreKinematics(const AabbKinematics& kinematics)
+{
+    assert(kinematics.count == Count());
+    if (Count() == 0)
+    {
+        return;
+    }
+
+    _boundsVersion++;
+    const std::byte* source = kinematics.bytes.data();
+    ForEachKinematicArray(*this, [&](void* array, size_t bytesPerAabb)
+    {
+        std::memcpy(array, source, Count() * bytesPerAabb);
+        source += Count() * bytesPerAabb;
+    });
+}
+
+void AabbStorage::PreserveState(uint32_t index)
+{
+    _preservedStateIndices[index] = static_cast<uint32_t>(_preservedStates.size());
+    _preservedAabbIndices.push_back(index);
+    _preservedStates.push_back({
+        BoundsOf(index),
+        glm::vec2(_velocityX[index], _velocityY[index]),
+        glm::vec2(_accelerationX[index], _accelerationY[index]),
+        _userData[index],
+        std::nullopt });
+}
@@ -0,0 +1,61 @@
+#include "AllPairsBroadphase.h"
+
+#include <algorithm>
+
+using namespace JkEng::Physics;
+
+void AllPairsBroadphase::FindOverlappingPairs(
+    const AabbStorage& aabbs,
+    uint32_t outerBegin,
+    uint32_t outerEnd,
+    std::vector<uint64_t>& hits,
+    std::vector<OverlappingPair>& pairs) const
+{
+    CandidateBounds candidates = CandidateBounds::Of(aabbs);
+
+    uint32_t aabbCount = aabbs.Count();
+    for (uint32_t outerIndex = outerBegin; outerIndex < outerEnd; outerIndex++)
+    {
+        // Test against every later AABB in one call and then only visit
+        // the ones that were hit.
+        uint32_t firstInnerIndex = outerIndex + 1;
+        uint32_t innerCount = aabbCount - firstInnerIndex;
+        _overlapTester.Test(aabbs.BoundsOf(outerIndex), candidates.Offset(firstInnerIndex), innerCount, hits);
+        // Overlaps are rare next to the number of candidates, so the filter
+        // is cheaper applied to the hits than in the kernel.
+        OverlapTester::ForEachHit(hits.data(), innerCount, [&](uint32_t hit)
+        {
+            uint32_t innerIndex = firstInnerIndex + hit;
+            if (aabbs.ShouldCollide(outerIndex, innerIndex))
+            {
+                pairs.push_back({outerIndex, innerIndex});
+            }
+        });
+    }
+}
+
+void AllPairsBroadphase::FindOverlappingPairs(
+    const AabbStorage& aabbs,
+    std::vector<OverlappingPair>& pairs)
+{
+    FindOverlappingPairs(aabbs, 0, aabbs.Count(), _hits, pairs);
+}
+
+void AllPairsBroadphase::FindOverlappingPairs(
+    const AabbStorage& aabbs,
+    WorkerPool& workers,
+    std::vector<std::vector<OverlappingPair>>& pairsPerWorker)
+{
+    _hitsPerWorker.resize(workers.WorkerCount());
+
+    // Earlier AABBs are tested against more AABBs so the first tasks take
+    // the longest, but they are also handed out first.
+    uint32_t aabbCount = aabbs.Count();
+    uint32_t taskCount = (aabbCount + AabbsPerTask - 1) / AabbsPerTask;
+    workers.Run(taskCount, [&](uint32_t taskIndex, uint32_t workerIndex)
+    {
+        uint32_t outerBegin = taskIndex * AabbsPerTask;
+        uint32_t outerEnd = std::min(outerBegin + AabbsPerTask, aabbCount);
+        FindOverlappingPairs(aabbs, outerBegin, outerEnd, _hitsPerWorker[workerIndex], pairsPerWorker[workerIndex]);
+    });
+}
@@ -0,0 +1,19 @@
+#include "BasicScene.h"
+
+#include "CollisionHandlerPolicies.h"
+
+// The scenes Engine::CreateScene can pick are built once here rather than
+// in every file that uses them, see the extern templates in BasicScene.h.
+namespace JkEng::Physics
+{
+    template class BasicScene<IBroadphase, FunctionHandlers>;
+    template class BasicScene<AllPairsBroadphase, FunctionHandlers>;
+    template class BasicScene<UniformGridBroadphase, FunctionHandlers>;
+    template class BasicScene<SweepAndPruneBroadphase, FunctionHandlers>;
+    template class BasicScene<DynamicTreeBroadphase, FunctionHandlers>;
+    template class BasicScene<IBroadphase, NoHandlers>;
+    template class BasicScene<AllPairsBroadphase, NoHandlers>;
+    template class BasicScene<UniformGridBroadphase, NoHandlers>;
+    template class BasicScene<SweepAndPruneBroadphase, NoHandlers>;
+    template class BasicScene<DynamicTreeBroadphase, NoHandlers>;
+}
@@ -0,0 +1,186 @@
+#include "ContactPairCache.h"
+
+#include <algorithm>
+#include <bit>
+
+using namespace JkEng::Physics;
+
+uint32_t ContactPairCache::FindSlot(uint64_t key) const
+{
+    uint32_t slot = HomeSlot(key);
+    while (_slots[slot].key != key && _slots[slot].key != EmptyKey)
+    {
+        slot = (slot + 1) & _slotMask;
+    }
+    return slot;
+}
+
+bool ContactPairCache::Contains(const Contact& contact) const
+{
+    return !_slots.empty() && _slots[FindSlot(KeyOf(contact))].key != EmptyKey;
+}
+
+void ContactPairCache::Clear()
+{
+    _entries.clear();
+    std::fill(_slots.begin(), _slots.end(), Slot{ EmptyKey, 0 });
+}
+
+void ContactPairCache::RemoveBodies(std::span<const uint32_t> bodyIds)
+{
+    if (bodyIds.empty() || _entries.empty())
+    {
+        return;
+    }
+
+    auto isRemoved = [&](uint32_t bodyId)
+    {
+        return std::binary_search(bodyIds.begin(), bodyIds.end(), bodyId);
+    };
+
+    for (uint32_t entryIndex = 0; entryIndex < _entries.size();)
+    {
+        auto& entry = _entries[entryIndex];
+        Contact contact = ContactOf(entry.key);
+        if (!isRemoved(contact.bodyA) && !isRemoved(contact.bodyB))
+        {
+            entryIndex++;
+            continue;
+        }
+
+        EraseSlot(FindSlot(entry.key));
+        entry = _entries.back();
+        _entries.pop_back();
+        if (entryIndex < _entries.size())
+        {
+            _slots[FindSlot(entry.key)].entryIndex = entryIndex;
+        }
+    }
+}
+
+void ContactPairCache::Freeze(std::span<const Contact> contacts)
+{
+    SetLastStep(contacts, FrozenStep);
+}
+
+void ContactPairCache::Thaw(std::span<const Contact> contacts)
+{
+    SetLastStep(contacts, _step);
+}
+
+void ContactPairCache::SetLastStep(std::span<const Contact> contacts, uint32_t lastStep)
+{
+    if (_slots.empty())
+    {
+        return;
+    }
+
+    for (auto& contact : contacts)
+    {
+        uint32_t slot = FindSlot(KeyOf(contact));
+        if (_slots[slot].key != EmptyKey)
+        {
+            _entries[_slots[slot].entryIndex].lastStep = lastStep;
+        }
+    }
+}
+
+void ContactPairCache::Rehash(uint32_t slotCount)
+{
+    _slots.assign(slotCount, Slot{ EmptyKey, 0 });
+    _slotMask = slotCount - 1;
+    for (uint32_t entryIndex = 0; entryIndex < _entries.size(); entryIndex++)
+    {
+        uint64_t key = _entries[entryIndex].key;
+        _slots[FindSlot(key)] = { key, entryIndex };
+    }
+}
+
+void ContactPairCache::EraseSlot(uint32_t slot)
+{
+    // Move later entries of the probe run back into the hole when the hole
+    // is between their home slot and where they are now, so every entry
+    // stays reachable from its home slot without a tombstone.
+    uint32_t hole = slot;
+    uint32_t next = (hole + 1) & _slotMask;
+    while (_slots[next].key != EmptyKey)
+    {
+        uint32_t home = HomeSlot(_slots[next].key);
+        if (((next - home) & _slotMask) >= ((next - hole) & _slotMask))
+        {
+            _slots[hole] = _slots[next];
+            hole = next;
+        }
+        next = (next + 1) & _slotMask;
+    }
+    _slots[hole].key = EmptyKey;
+}
+
+void ContactPairCache::Update(std::span<const Contact> contacts, std::vector<ContactEvent>& events)
+{
+    _step++;
+
+    size_t maxEntryCount = _entries.size() + contacts.size();
+    if (maxEntryCount * 2 > _slots.size())
+    {
+        Rehash(std::bit_ceil(std::max<uint32_t>(MinSlotCount, static_cast<uint32_t>(maxEntryCount * 2))));
+    }
+
+    size_t firstEvent = events.size();
+    for (auto& contact : contacts)
+    {
+        uint64_t key = KeyOf(contact);
+        uint32_t slot = FindSlot(key);
+        if (_slots[slot].key == EmptyKey)
+        {
+            _slots[slot] = { key, static_cast<uint32_t>(_entries.size()) };
+            _entries.push_back({ key, _step });
+            events.push_back({ contact, ContactEventType::Begin });
+        }
+        else
+        {
+            _entries[_slots[slot].entryIndex].lastStep = _step;
+            events.push_back({ contact, ContactEventType::Persist });
+        }
+    }
+
+    // Anything not seen this step has ended.  Swap-remove it from the dense
+    // array and point the moved entry's slot at its new position.
+    _endEvents.clear();
+    for (uint32_t entryIndex = 0; entryIndex < _entries.size();)
+    {
+        auto& entry = _entries[entryIndex];
+        if (entry.lastStep == _step || entry.lastStep == FrozenStep)
+        {
+            entryIndex++;
+            continue;
+        }
+
+        _endEvents.push_back({ ContactOf(entry.key), ContactEventType::End });
+        EraseSlot(FindSlot(entry.key));
+
+        entry = _entries.back();
+        _entries.pop_back();
+        if (entryIndex < _entries.size())
+        {
+            _slots[FindSlot(entry.key)].entryIndex = entryIndex;
+        }
+    }
+
+    if (_endEvents.empty())
+    {
+        return;
+    }
+
+    // The Begin and Persist events are already in contact order.  A contact
+    // can not both end and be present, so merging in the sorted End events
+    // keeps the whole list in contact order.
+    std::sort(_endEvents.begin(), _endEvents.end());
+    _mergedEvents.resize(events.size() - firstEvent + _endEvents.size());
+    std::merge(
+        events.begin() + firstEvent, events.end(),
+        _endEvents.begin(), _endEvents.end(),
+        _mergedEvents.begin());
+    events.resize(firstEvent);
+    events.insert(events.end(), _mergedEvents.begin(), _mergedEvents.end());
+}
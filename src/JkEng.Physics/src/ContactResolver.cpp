@@ -0,0 +1,44 @@
+#include "ContactResolver.h"
+
+using namespace JkEng::Physics;
+
+void ContactResolver::Begin(uint32_t aabbCount)
+{
+    _left.assign(aabbCount, 0.0f);
+    _right.assign(aabbCount, 0.0f);
+    _down.assign(aabbCount, 0.0f);
+    _up.assign(aabbCount, 0.0f);
+}
+
+void ContactResolver::Apply(AabbStorage& aabbs) const
+{
+    float* minX = aabbs.MinX();
+    float* minY = aabbs.MinY();
+    float* maxX = aabbs.MaxX();
+    float* maxY = aabbs.MaxY();
+    float* velocityX = aabbs.VelocityX();
+    float* velocityY = aabbs.VelocityY();
+    const float* left = _left.data();
+    const float* right = _right.data();
+    const float* down = _down.data();
+    const float* up = _up.data();
+    aabbs.BoundsChanged();
+
+    // Branch free so the compiler can vectorize it.  AABBs with no moves
+    // are moved by zero and keep their velocity.
+    uint32_t aabbCount = static_cast<uint32_t>(_left.size());
+    for (uint32_t i = 0; i < aabbCount; i++)
+    {
+        float moveX = left[i] + right[i];
+        float moveY = down[i] + up[i];
+        minX[i] += moveX;
+        maxX[i] += moveX;
+        minY[i] += moveY;
+        maxY[i] += moveY;
+
+        bool stopX = (left[i] < 0.0f && velocityX[i] > 0.0f) | (right[i] > 0.0f && velocityX[i] < 0.0f);
+        bool stopY = (down[i] < 0.0f && velocityY[i] > 0.0f) | (up[i] > 0.0f && velocityY[i] < 0.0f);
+        velocityX[i] = stopX ? 0.0f : velocityX[i];
+        velocityY[i] = stopY ? 0.0f : velocityY[i];
+    }
+}
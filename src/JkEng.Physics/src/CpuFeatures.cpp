@@ -0,0 +1,60 @@
+#include "CpuFeatures.h"
+
+#if JKENG_PHYSICS_X86_SIMD && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+using namespace JkEng::Physics;
+
+namespace
+{
+    bool DetectAvx2()
+    {
+#if JKENG_PHYSICS_X86_SIMD && defined(_MSC_VER)
+        int registers[4];
+        __cpuid(registers, 1);
+        bool osSavesYmmRegisters = (registers[2] & (1 << 27)) != 0
+            && (_xgetbv(0) & 0x6) == 0x6;
+
+        __cpuidex(registers, 7, 0);
+        bool cpuHasAvx2 = (registers[1] & (1 << 5)) != 0;
+        return osSavesYmmRegisters && cpuHasAvx2;
+#elif JKENG_PHYSICS_X86_SIMD
+        // Also checks that the operating system saves the YMM registers.
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+}
+
+bool CpuFeatures::HasAvx2()
+{
+    static const bool hasAvx2 = DetectAvx2();
+    return hasAvx2;
+}
+
+bool CpuFeatures::IsSupported(InstructionSet instructionSet)
+{
+    switch (instructionSet)
+    {
+        case InstructionSet::Avx2:
+            return HasAvx2();
+        case InstructionSet::Sse2:
+            return JKENG_PHYSICS_X86_SIMD != 0;
+        case InstructionSet::Scalar:
+        default:
+            return true;
+    }
+}
+
+InstructionSet CpuFeatures::BestSupportedInstructionSet()
+{
+    if (IsSupported(InstructionSet::Avx2))
+    {
+        return InstructionSet::Avx2;
+    }
+    return IsSupported(InstructionSet::Sse2) ? InstructionSet::Sse2 : InstructionSet::Scalar;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+// SIMD kernels in JkEng.Physics are only written for x86-64, where SSE2
+// is always available and AVX2 is detected at runtime.  Everything else
+// uses the scalar kernels.
+#if defined(__x86_64__) || defined(_M_X64)
+#define JKENG_PHYSICS_X86_SIMD 1
+#else
+#define JKENG_PHYSICS_X86_SIMD 0
+#endif
+
+// Marks a function as allowed to use AVX2 instructions even though the
+// rest of the library is built for baseline x86-64.  Such functions must
+// only be called after CpuFeatures::HasAvx2 returns true.  MSVC allows
+// AVX2 intrinsics anywhere so it needs no attribute.
+#if JKENG_PHYSICS_X86_SIMD && !defined(_MSC_VER)
+#define JKENG_PHYSICS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define JKENG_PHYSICS_TARGET_AVX2
+#endif
+
+#include "InstructionSet.h"
+
+namespace JkEng::Physics
+{
+    class CpuFeatures final
+    {
+    public:
+        // True when the CPU and operating system both support AVX2.
+        static bool HasAvx2();
+
+        static bool IsSupported(InstructionSet instructionSet);
+        static InstructionSet BestSupportedInstructionSet();
+    };
+}
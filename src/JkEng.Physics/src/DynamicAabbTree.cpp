@@ -0,0 +1,444 @@
+#include "DynamicAabbTree.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace JkEng::Physics;
+
+int32_t DynamicAabbTree::AllocateNode()
+{
+    int32_t index;
+    if (_freeList != NullNode)
+    {
+        index = _freeList;
+        _freeList = _nodes[index].parent;
+    }
+    else
+    {
+        index = static_cast<int32_t>(_nodes.size());
+        _nodes.emplace_back();
+    }
+
+    auto& node = _nodes[index];
+    node.parent = NullNode;
+    node.child0 = NullNode;
+    node.child1 = NullNode;
+    node.height = 0;
+    node.userIndex = 0;
+    return index;
+}
+
+void DynamicAabbTree::FreeNode(int32_t index)
+{
+    _nodes[index].parent = _freeList;
+    _nodes[index].height = -1;
+    _freeList = index;
+}
+
+int32_t DynamicAabbTree::Insert(const Bounds& bounds, uint32_t userIndex)
+{
+    int32_t leaf = AllocateNode();
+    _nodes[leaf].bounds = bounds;
+    _nodes[leaf].userIndex = userIndex;
+    InsertLeaf(leaf);
+    return leaf;
+}
+
+void DynamicAabbTree::Remove(int32_t leaf)
+{
+    assert(_nodes[leaf].IsLeaf() && "DynamicAabbTree: Remove must be given a leaf");
+    RemoveLeaf(leaf);
+    FreeNode(leaf);
+}
+
+void DynamicAabbTree::Reinsert(int32_t leaf, const Bounds& bounds)
+{
+    RemoveLeaf(leaf);
+    _nodes[leaf].bounds = bounds;
+    InsertLeaf(leaf);
+}
+
+void DynamicAabbTree::Clear()
+{
+    _nodes.clear();
+    _root = NullNode;
+    _freeList = NullNode;
+}
+
+float DynamicAabbTree::Cost() const
+{
+    float cost = 0.0f;
+    for (auto& node : _nodes)
+    {
+        if (node.height > 0)
+        {
+            cost += node.bounds.Perimeter();
+        }
+    }
+    return cost;
+}
+
+void DynamicAabbTree::InsertLeaf(int32_t leaf)
+{
+    if (_root == NullNode)
+    {
+        _root = leaf;
+        _nodes[leaf].parent = NullNode;
+        return;
+    }
+
+    // Walk down choosing whichever child grows the tree the least, or
+    // stop when making a new parent right here is cheaper than descending.
+    Bounds leafBounds = _nodes[leaf].bounds;
+    int32_t index = _root;
+    while (!_nodes[index].IsLeaf())
+    {
+        auto& node = _nodes[index];
+        float perimeter = node.bounds.Perimeter();
+        float combinedPerimeter = Bounds::Union(node.bounds, leafBounds).Perimeter();
+
+        float cost = 2.0f * combinedPerimeter;
+        float inheritanceCost = 2.0f * (combinedPerimeter - perimeter);
+
+        auto descendCost = [&](int32_t childIndex)
+        {
+            auto& child = _nodes[childIndex];
+            float childCombinedPerimeter = Bounds::Union(leafBounds, child.bounds).Perimeter();
+            return child.IsLeaf()
+                ? childCombinedPerimeter + inheritanceCost
+                : childCombinedPerimeter - child.bounds.Perimeter() + inheritanceCost;
+        };
+
+        float cost0 = descendCost(node.child0);
+        float cost1 = descendCost(node.child1);
+        if (cost < cost0 && cost < cost1)
+        {
+            break;
+        }
+
+        index = cost0 < cost1 ? node.child0 : node.child1;
+    }
+
+    int32_t sibling = index;
+    int32_t oldParent = _nodes[sibling].parent;
+    int32_t newParent = AllocateNode();
+    _nodes[newParent].parent = oldParent;
+    _nodes[newParent].bounds = Bounds::Union(leafBounds, _nodes[sibling].bounds);
+    _nodes[newParent].height = _nodes[sibling].height + 1;
+    _nodes[newParent].child0 = sibling;
+    _nodes[newParent].child1 = leaf;
+    _nodes[sibling].parent = newParent;
+    _nodes[leaf].parent = newParent;
+
+    if (oldParent != NullNode)
+    {
+        if (_nodes[oldParent].child0 == sibling)
+        {
+            _nodes[oldParent].child0 = newParent;
+        }
+        else
+        {
+            _nodes[oldParent].child1 = newParent;
+        }
+    }
+    else
+    {
+        _root = newParent;
+    }
+
+    FixUpwardsFrom(_nodes[leaf].parent);
+}
+
+void DynamicAabbTree::RemoveLeaf(int32_t leaf)
+{
+    if (leaf == _root)
+    {
+        _root = NullNode;
+        return;
+    }
+
+    int32_t parent = _nodes[leaf].parent;
+    int32_t grandParent = _nodes[parent].parent;
+    int32_t sibling = _nodes[parent].child0 == leaf
+        ? _nodes[parent].child1
+        : _nodes[parent].child0;
+
+    FreeNode(parent);
+    if (grandParent != NullNode)
+    {
+        if (_nodes[grandParent].child0 == parent)
+        {
+            _nodes[grandParent].child0 = sibling;
+        }
+        else
+        {
+            _nodes[grandParent].child1 = sibling;
+        }
+        _nodes[sibling].parent = grandParent;
+        FixUpwardsFrom(grandParent);
+    }
+    else
+    {
+        _root = sibling;
+        _nodes[sibling].parent = NullNode;
+    }
+}
+
+void DynamicAabbTree::FixUpwardsFrom(int32_t index)
+{
+    while (index != NullNode)
+    {
+        index = Balance(index);
+
+        auto& node = _nodes[index];
+        auto& child0 = _nodes[node.child0];
+        auto& child1 = _nodes[node.child1];
+        node.height = 1 + std::max(child0.height, child1.height);
+        node.bounds = Bounds::Union(child0.bounds, child1.bounds);
+
+        index = node.parent;
+    }
+}
+
+// Performs a left or right rotation if the node at index is imbalanced.
+// Returns the index of the node that is now at the position index was.
+int32_t DynamicAabbTree::Balance(int32_t indexA)
+{
+    Node& a = _nodes[indexA];
+    if (a.IsLeaf() || a.height < 2)
+    {
+        return indexA;
+    }
+
+    int32_t indexB = a.child0;
+    int32_t indexC = a.child1;
+    Node& b = _nodes[indexB];
+    Node& c = _nodes[indexC];
+
+    int32_t balance = c.height - b.height;
+
+    auto replaceChild = [this](int32_t parent, int32_t oldChild, int32_t newChild)
+    {
+        if (parent == NullNode)
+        {
+            _root = newChild;
+        }
+        else if (_nodes[parent].child0 == oldChild)
+        {
+            _nodes[parent].child0 = newChild;
+        }
+        else
+        {
+            _nodes[parent].child1 = newChild;
+        }
+    };
+
+    // Rotate C up
+    if (balance > 1)
+    {
+        int32_t indexF = c.child0;
+        int32_t indexG = c.child1;
+        Node& f = _nodes[indexF];
+        Node& g = _nodes[indexG];
+
+        c.child0 = indexA;
+        c.parent = a.parent;
+        a.parent = indexC;
+        replaceChild(c.parent, indexA, indexC);
+
+        if (f.height > g.height)
+        {
+            c.child1 = indexF;
+            a.child1 = indexG;
+            g.parent = indexA;
+            a.bounds = Bounds::Union(b.bounds, g.bounds);
+            c.bounds = Bounds::Union(a.bounds, f.bounds);
+            a.height = 1 + std::max(b.height, g.height);
+            c.height = 1 + std::max(a.height, f.height);
+        }
+        else
+        {
+            c.child1 = indexG;
+            a.child1 = indexF;
+            f.parent = indexA;
+            a.bounds = Bounds::Union(b.bounds, f.bounds);
+            c.bounds = Bounds::Union(a.bounds, g.bounds);
+            a.height = 1 + std::max(b.height, f.height);
+            c.height = 1 + std::max(a.height, g.height);
+        }
+
+        return indexC;
+    }
+
+    // Rotate B up
+    if (balance < -1)
+    {
+        int32_t indexD = b.child0;
+        int32_t indexE = b.child1;
+        Node& d = _nodes[indexD];
+        Node& e = _nodes[indexE];
+
+        b.child0 = indexA;
+        b.parent = a.parent;
+        a.parent = indexB;
+        replaceChild(b.parent, indexA, indexB);
+
+        if (d.height > e.height)
+        {
+            b.child1 = indexD;
+            a.child0 = indexE;
+            e.parent = indexA;
+            a.bounds = Bounds::Union(c.bounds, e.bounds);
+            b.bounds = Bounds::Union(a.bounds, d.bounds);
+            a.height = 1 + std::max(c.height, e.height);
+            b.height = 1 + std::max(a.height, d.height);
+        }
+        else
+        {
+            b.child1 = indexE;
+            a.child0 = indexD;
+            d.parent = indexA;
+            a.bounds = Bounds::Union(c.bounds, d.bounds);
+            b.bounds = Bounds::Union(a.bounds, e.bounds);
+            a.height = 1 + std::max(c.height, d.height);
+            b.height = 1 + std::max(a.height, e.height);
+        }
+
+        return indexB;
+    }
+
+    return indexA;
+}
+
+void DynamicAabbTree::Refit()
+{
+    if (_root != NullNode)
+    {
+        RefitNode(_root);
+    }
+}
+
+void DynamicAabbTree::RefitNode(int32_t index)
+{
+    auto& node = _nodes[index];
+    if (node.IsLeaf())
+    {
+        return;
+    }
+
+    RefitNode(node.child0);
+    RefitNode(node.child1);
+    node.bounds = Bounds::Union(_nodes[node.child0].bounds, _nodes[node.child1].bounds);
+}
+
+void DynamicAabbTree::Rebuild()
+{
+    _leaves.clear();
+    int32_t nodeCount = static_cast<int32_t>(_nodes.size());
+    for (int32_t index = 0; index < nodeCount; index++)
+    {
+        auto& node = _nodes[index];
+        if (node.height < 0)
+        {
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            _leaves.push_back(index);
+        }
+        else
+        {
+            FreeNode(index);
+        }
+    }
+
+    _root = _leaves.empty() ? NullNode : BuildTopDown(_leaves.data(), _leaves.size());
+    if (_root != NullNode)
+    {
+        _nodes[_root].parent = NullNode;
+    }
+}
+
+int32_t DynamicAabbTree::BuildTopDown(int32_t* leaves, size_t leafCount)
+{
+    if (leafCount == 1)
+    {
+        return leaves[0];
+    }
+
+    auto centerX = [this](int32_t index) { return _nodes[index].bounds.minX + _nodes[index].bounds.maxX; };
+    auto centerY = [this](int32_t index) { return _nodes[index].bounds.minY + _nodes[index].bounds.maxY; };
+
+    float minX = centerX(leaves[0]);
+    float maxX = minX;
+    float minY = centerY(leaves[0]);
+    float maxY = minY;
+    for (size_t i = 1; i < leafCount; i++)
+    {
+        minX = std::min(minX, centerX(leaves[i]));
+        maxX = std::max(maxX, centerX(leaves[i]));
+        minY = std::min(minY, centerY(leaves[i]));
+        maxY = std::max(maxY, centerY(leaves[i]));
+    }
+
+    size_t half = leafCount / 2;
+    if (maxX - minX >= maxY - minY)
+    {
+        std::nth_element(leaves, leaves + half, leaves + leafCount,
+            [&](int32_t i0, int32_t i1) { return centerX(i0) < centerX(i1); });
+    }
+    else
+    {
+        std::nth_element(leaves, leaves + half, leaves + leafCount,
+            [&](int32_t i0, int32_t i1) { return centerY(i0) < centerY(i1); });
+    }
+
+    int32_t child0 = BuildTopDown(leaves, half);
+    int32_t child1 = BuildTopDown(leaves + half, leafCount - half);
+
+    int32_t parent = AllocateNode();
+    auto& node = _nodes[parent];
+    node.child0 = child0;
+    node.child1 = child1;
+    node.height = 1 + std::max(_nodes[child0].height, _nodes[child1].height);
+    node.bounds = Bounds::Union(_nodes[child0].bounds, _nodes[child1].bounds);
+    _nodes[child0].parent = parent;
+    _nodes[child1].parent = parent;
+    return parent;
+}
+
+void DynamicAabbTree::SplitOverlappingPairSearch(
+    size_t minPartCount,
+    std::vector<NodePair>& parts,
+    std::vector<NodePair>& scratch) const
+{
+    parts.clear();
+    if (_root == NullNode)
+    {
+        return;
+    }
+
+    parts.emplace_back(_root, _root);
+    bool expandedAny = true;
+    while (expandedAny && parts.size() < minPartCount)
+    {
+        expandedAny = false;
+        scratch.clear();
+        for (auto nodePair : parts)
+        {
+            // Leave pairs of different leaves for the search so the
+            // callback is only ever called from there.
+            auto [index0, index1] = nodePair;
+            if (index0 != index1 && _nodes[index0].IsLeaf() && _nodes[index1].IsLeaf())
+            {
+                scratch.push_back(nodePair);
+                continue;
+            }
+
+            expandedAny = true;
+            ExpandNodePair(nodePair, scratch, [](uint32_t, uint32_t) { });
+        }
+        std::swap(parts, scratch);
+    }
+}
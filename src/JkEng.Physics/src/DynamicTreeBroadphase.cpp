@@ -0,0 +1,136 @@
+#include "DynamicTreeBroadphase.h"
+
+#include <algorithm>
+
+using namespace JkEng::Physics;
+
+DynamicTreeBroadphase::DynamicTreeBroadphase(float margin)
+  : _margin(margin)
+{
+
+}
+
+void DynamicTreeBroadphase::RebuildTree(const AabbStorage& aabbs)
+{
+    _tree.Clear();
+    _leaves.resize(aabbs.Count());
+    for (uint32_t i = 0; i < aabbs.Count(); i++)
+    {
+        _leaves[i] = _tree.Insert(PaddedBounds(aabbs, i), i);
+    }
+    _tree.Rebuild();
+    _costAfterRebuild = _tree.Cost();
+}
+
+void DynamicTreeBroadphase::UpdateTree(const AabbStorage& aabbs)
+{
+    _escapedAabbIndices.clear();
+    for (uint32_t i = 0; i < aabbs.Count(); i++)
+    {
+        if (!_tree.LeafBounds(_leaves[i]).Contains(aabbs.BoundsOf(i)))
+        {
+            _escapedAabbIndices.push_back(i);
+        }
+    }
+
+    if (_escapedAabbIndices.size() <= MaxReinsertFraction * aabbs.Count())
+    {
+        for (uint32_t aabbIndex : _escapedAabbIndices)
+        {
+            _tree.Reinsert(_leaves[aabbIndex], PaddedBounds(aabbs, aabbIndex));
+        }
+        return;
+    }
+
+    for (uint32_t aabbIndex : _escapedAabbIndices)
+    {
+        _tree.SetLeafBounds(_leaves[aabbIndex], PaddedBounds(aabbs, aabbIndex));
+    }
+    _tree.Refit();
+
+    if (_tree.Cost() > MaxRefitCostGrowth * _costAfterRebuild)
+    {
+        _tree.Rebuild();
+        _costAfterRebuild = _tree.Cost();
+    }
+}
+
+void DynamicTreeBroadphase::RebuildOrUpdateTree(const AabbStorage& aabbs)
+{
+    if (_leaves.size() != aabbs.Count())
+    {
+        RebuildTree(aabbs);
+    }
+    else
+    {
+        UpdateTree(aabbs);
+    }
+}
+
+void DynamicTreeBroadphase::AabbAdded(const AabbStorage& aabbs, uint32_t index)
+{
+    // Before the first step, or after a change that was not reported, the
+    // whole tree is rebuilt by the next search instead.
+    if (_leaves.size() != index)
+    {
+        return;
+    }
+
+    _leaves.push_back(_tree.Insert(PaddedBounds(aabbs, index), index));
+}
+
+void DynamicTreeBroadphase::AabbRemoved(const AabbStorage&, uint32_t index, uint32_t lastIndex)
+{
+    if (_leaves.size() != lastIndex + 1)
+    {
+        return;
+    }
+
+    _tree.Remove(_leaves[index]);
+    _leaves[index] = _leaves[lastIndex];
+    _tree.SetLeafUserIndex(_leaves[index], index);
+    _leaves.pop_back();
+}
+
+void DynamicTreeBroadphase::FindOverlappingPairs(
+    const AabbStorage& aabbs,
+    std::vector<OverlappingPair>& pairs)
+{
+    RebuildOrUpdateTree(aabbs);
+
+    _tree.ForEachOverlappingPair(
+        [&](uint32_t aabbIndex0, uint32_t aabbIndex1)
+        {
+            if (aabbs.ShouldCollide(aabbIndex0, aabbIndex1) && aabbs.IsColliding(aabbIndex0, aabbIndex1))
+            {
+                pairs.push_back({
+                    std::min(aabbIndex0, aabbIndex1),
+                    std::max(aabbIndex0, aabbIndex1)});
+            }
+        });
+}
+
+void DynamicTreeBroadphase::FindOverlappingPairs(
+    const AabbStorage& aabbs,
+    WorkerPool& workers,
+    std::vector<std::vector<OverlappingPair>>& pairsPerWorker)
+{
+    RebuildOrUpdateTree(aabbs);
+    _stacksPerWorker.resize(workers.WorkerCount());
+    _tree.SplitOverlappingPairSearch(workers.WorkerCount() * SearchPartsPerWorker, _searchParts, _searchPartsScratch);
+
+    workers.Run(static_cast<uint32_t>(_searchParts.size()), [&](uint32_t taskIndex, uint32_t workerIndex)
+    {
+        auto& pairs = pairsPerWorker[workerIndex];
+        _tree.ForEachOverlappingPair(_searchParts[taskIndex], _stacksPerWorker[workerIndex],
+            [&](uint32_t aabbIndex0, uint32_t aabbIndex1)
+            {
+                if (aabbs.ShouldCollide(aabbIndex0, aabbIndex1) && aabbs.IsColliding(aabbIndex0, aabbIndex1))
+                {
+                    pairs.push_back({
+                        std::min(aabbIndex0, aabbIndex1),
+                        std::max(aabbIndex0, aabbIndex1)});
+                }
+            });
+    });
+}
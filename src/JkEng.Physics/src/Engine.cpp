@@ -2,11 +2,49 @@
 
 #include <memory>
 
-#include "Scene.h"
+#include "BasicScene.h"
+#include "CollisionHandlerPolicies.h"
+#include "ThreadedScene.h"
 
 using namespace JkEng::Physics;
 
+namespace
+{
+    template<typename HandlerPolicy>
+    std::unique_ptr<IScene> CreateBasicScene(const SceneDefinition& definition)
+    {
+        // Partitions hold a broadphase per collision filter, which is only
+        // known at run time.
+        if (definition.PartitionBroadphaseByCollisionFilter())
+        {
+            return std::make_unique<BasicScene<IBroadphase, HandlerPolicy>>(definition);
+        }
+
+        switch (definition.Broadphase())
+        {
+            case BroadphaseType::UniformGrid:
+                return std::make_unique<BasicScene<UniformGridBroadphase, HandlerPolicy>>(definition);
+            case BroadphaseType::SweepAndPrune:
+                return std::make_unique<BasicScene<SweepAndPruneBroadphase, HandlerPolicy>>(definition);
+            case BroadphaseType::DynamicTree:
+                return std::make_unique<BasicScene<DynamicTreeBroadphase, HandlerPolicy>>(definition);
+            case BroadphaseType::AllPairs:
+            default:
+                return std::make_unique<BasicScene<AllPairsBroadphase, HandlerPolicy>>(definition);
+        }
+    }
+}
+
 std::unique_ptr<IScene> Engine::CreateScene(const SceneDefinition& definition)
 {
-    return std::make_unique<Scene>(definition);
+    if (definition.CollisionHandlers())
+    {
+        return CreateBasicScene<FunctionHandlers>(definition);
+    }
+    return CreateBasicScene<NoHandlers>(definition);
+}
+
+std::unique_ptr<IThreadedScene> Engine::CreateThreadedScene(const SceneDefinition& definition)
+{
+    return std::make_unique<ThreadedScene>(definition);
 }
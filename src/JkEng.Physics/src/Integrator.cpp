@@ -0,0 +1,206 @@
+#include "Integrator.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "CpuFeatures.h"
+
+#if JKENG_PHYSICS_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using namespace JkEng::Physics;
+
+namespace
+{
+    // With OnlyAwake, sleeping AABBs are left exactly as they are.
+    template <bool OnlyAwake>
+    void IntegrateScalar(AabbStorage& aabbs, uint32_t begin, uint32_t end, float stepTime)
+    {
+        float* minX = aabbs.MinX();
+        float* minY = aabbs.MinY();
+        float* maxX = aabbs.MaxX();
+        float* maxY = aabbs.MaxY();
+        float* velocityX = aabbs.VelocityX();
+        float* velocityY = aabbs.VelocityY();
+        const float* accelerationX = aabbs.AccelerationX();
+        const float* accelerationY = aabbs.AccelerationY();
+        const uint8_t* isAwake = aabbs.IsAwake();
+
+        for (uint32_t i = begin; i < end; i++)
+        {
+            if (OnlyAwake && !isAwake[i])
+            {
+                continue;
+            }
+
+            velocityX[i] += accelerationX[i] * stepTime;
+            velocityY[i] += accelerationY[i] * stepTime;
+
+            float displacementX = velocityX[i] * stepTime;
+            float displacementY = velocityY[i] * stepTime;
+            minX[i] += displacementX;
+            maxX[i] += displacementX;
+            minY[i] += displacementY;
+            maxY[i] += displacementY;
+        }
+    }
+
+#if JKENG_PHYSICS_X86_SIMD
+    // A lane mask that is all ones for each awake AABB in [i, i + 4).
+    inline __m128 AwakeMaskSse2(const uint8_t* isAwake, uint32_t i)
+    {
+        int32_t bytes;
+        std::memcpy(&bytes, isAwake + i, sizeof(bytes));
+        __m128i zero = _mm_setzero_si128();
+        __m128i lanes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+        return _mm_castsi128_ps(_mm_cmpgt_epi32(lanes, zero));
+    }
+
+    inline __m128 SelectSse2(__m128 mask, __m128 ifSet, __m128 ifClear)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, ifSet), _mm_andnot_ps(mask, ifClear));
+    }
+
+    template <bool OnlyAwake>
+    void IntegrateSse2(AabbStorage& aabbs, uint32_t begin, uint32_t end, float stepTime)
+    {
+        float* minX = aabbs.MinX();
+        float* minY = aabbs.MinY();
+        float* maxX = aabbs.MaxX();
+        float* maxY = aabbs.MaxY();
+        float* velocityX = aabbs.VelocityX();
+        float* velocityY = aabbs.VelocityY();
+        const float* accelerationX = aabbs.AccelerationX();
+        const float* accelerationY = aabbs.AccelerationY();
+
+        const uint8_t* isAwake = aabbs.IsAwake();
+
+        __m128 step = _mm_set1_ps(stepTime);
+        uint32_t i = begin;
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 oldVx = _mm_loadu_ps(velocityX + i);
+            __m128 oldVy = _mm_loadu_ps(velocityY + i);
+            __m128 vx = _mm_add_ps(oldVx, _mm_mul_ps(_mm_loadu_ps(accelerationX + i), step));
+            __m128 vy = _mm_add_ps(oldVy, _mm_mul_ps(_mm_loadu_ps(accelerationY + i), step));
+            __m128 dx = _mm_mul_ps(vx, step);
+            __m128 dy = _mm_mul_ps(vy, step);
+            __m128 newMinX = _mm_add_ps(_mm_loadu_ps(minX + i), dx);
+            __m128 newMaxX = _mm_add_ps(_mm_loadu_ps(maxX + i), dx);
+            __m128 newMinY = _mm_add_ps(_mm_loadu_ps(minY + i), dy);
+            __m128 newMaxY = _mm_add_ps(_mm_loadu_ps(maxY + i), dy);
+
+            // Select rather than add zero so sleeping AABBs keep their
+            // exact bits.
+            if constexpr (OnlyAwake)
+            {
+                __m128 awake = AwakeMaskSse2(isAwake, i);
+                vx = SelectSse2(awake, vx, oldVx);
+                vy = SelectSse2(awake, vy, oldVy);
+                newMinX = SelectSse2(awake, newMinX, _mm_loadu_ps(minX + i));
+                newMaxX = SelectSse2(awake, newMaxX, _mm_loadu_ps(maxX + i));
+                newMinY = SelectSse2(awake, newMinY, _mm_loadu_ps(minY + i));
+                newMaxY = SelectSse2(awake, newMaxY, _mm_loadu_ps(maxY + i));
+            }
+
+            _mm_storeu_ps(velocityX + i, vx);
+            _mm_storeu_ps(velocityY + i, vy);
+            _mm_storeu_ps(minX + i, newMinX);
+            _mm_storeu_ps(maxX + i, newMaxX);
+            _mm_storeu_ps(minY + i, newMinY);
+            _mm_storeu_ps(maxY + i, newMaxY);
+        }
+
+        IntegrateScalar<OnlyAwake>(aabbs, i, end, stepTime);
+    }
+
+    template <bool OnlyAwake>
+    JKENG_PHYSICS_TARGET_AVX2
+    void IntegrateAvx2(AabbStorage& aabbs, uint32_t begin, uint32_t end, float stepTime)
+    {
+        float* minX = aabbs.MinX();
+        float* minY = aabbs.MinY();
+        float* maxX = aabbs.MaxX();
+        float* maxY = aabbs.MaxY();
+        float* velocityX = aabbs.VelocityX();
+        float* velocityY = aabbs.VelocityY();
+        const float* accelerationX = aabbs.AccelerationX();
+        const float* accelerationY = aabbs.AccelerationY();
+
+        const uint8_t* isAwake = aabbs.IsAwake();
+
+        __m256 step = _mm256_set1_ps(stepTime);
+        uint32_t i = begin;
+        for (; i + 8 <= end; i += 8)
+        {
+            __m256 oldVx = _mm256_loadu_ps(velocityX + i);
+            __m256 oldVy = _mm256_loadu_ps(velocityY + i);
+            __m256 vx = _mm256_add_ps(oldVx, _mm256_mul_ps(_mm256_loadu_ps(accelerationX + i), step));
+            __m256 vy = _mm256_add_ps(oldVy, _mm256_mul_ps(_mm256_loadu_ps(accelerationY + i), step));
+            __m256 dx = _mm256_mul_ps(vx, step);
+            __m256 dy = _mm256_mul_ps(vy, step);
+            __m256 newMinX = _mm256_add_ps(_mm256_loadu_ps(minX + i), dx);
+            __m256 newMaxX = _mm256_add_ps(_mm256_loadu_ps(maxX + i), dx);
+            __m256 newMinY = _mm256_add_ps(_mm256_loadu_ps(minY + i), dy);
+            __m256 newMaxY = _mm256_add_ps(_mm256_loadu_ps(maxY + i), dy);
+
+            if constexpr (OnlyAwake)
+            {
+                __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(isAwake + i));
+                __m256 awake = _mm256_castsi256_ps(
+                    _mm256_cmpgt_epi32(_mm256_cvtepu8_epi32(bytes), _mm256_setzero_si256()));
+                vx = _mm256_blendv_ps(oldVx, vx, awake);
+                vy = _mm256_blendv_ps(oldVy, vy, awake);
+                newMinX = _mm256_blendv_ps(_mm256_loadu_ps(minX + i), newMinX, awake);
+                newMaxX = _mm256_blendv_ps(_mm256_loadu_ps(maxX + i), newMaxX, awake);
+                newMinY = _mm256_blendv_ps(_mm256_loadu_ps(minY + i), newMinY, awake);
+                newMaxY = _mm256_blendv_ps(_mm256_loadu_ps(maxY + i), newMaxY, awake);
+            }
+
+            _mm256_storeu_ps(velocityX + i, vx);
+            _mm256_storeu_ps(velocityY + i, vy);
+            _mm256_storeu_ps(minX + i, newMinX);
+            _mm256_storeu_ps(maxX + i, newMaxX);
+            _mm256_storeu_ps(minY + i, newMinY);
+            _mm256_storeu_ps(maxY + i, newMaxY);
+        }
+
+        IntegrateScalar<OnlyAwake>(aabbs, i, end, stepTime);
+    }
+#endif
+}
+
+Integrator::Integrator()
+  : Integrator(CpuFeatures::BestSupportedInstructionSet())
+{
+
+}
+
+Integrator::Integrator(InstructionSet instructionSet)
+  : _instructionSet(instructionSet),
+    _kernel(IntegrateScalar<false>),
+    _awakeKernel(IntegrateScalar<true>)
+{
+    if (!CpuFeatures::IsSupported(instructionSet))
+    {
+        throw std::invalid_argument("Integrator: instruction set is not supported by this CPU");
+    }
+
+#if JKENG_PHYSICS_X86_SIMD
+    switch (instructionSet)
+    {
+        case InstructionSet::Avx2:
+            _kernel = IntegrateAvx2<false>;
+            _awakeKernel = IntegrateAvx2<true>;
+            break;
+        case InstructionSet::Sse2:
+            _kernel = IntegrateSse2<false>;
+            _awakeKernel = IntegrateSse2<true>;
+            break;
+        case InstructionSet::Scalar:
+        default:
+            break;
+    }
+#endif
+}
@@ -0,0 +1,42 @@
+#include "MovableAabbTree.h"
+
+using namespace JkEng::Physics;
+
+void MovableAabbTree::Update(const AabbStorage& aabbs)
+{
+    if (IsUpToDate(aabbs))
+    {
+        return;
+    }
+
+    _version = aabbs.BoundsVersion();
+    if (_leaves.size() != aabbs.Count())
+    {
+        Rebuild(aabbs);
+        return;
+    }
+
+    for (uint32_t i = 0; i < aabbs.Count(); i++)
+    {
+        _tree.SetLeafBounds(_leaves[i], aabbs.BoundsOf(i));
+    }
+    _tree.Refit();
+
+    if (_tree.Cost() > MaxRefitCostGrowth * _costAfterRebuild)
+    {
+        _tree.Rebuild();
+        _costAfterRebuild = _tree.Cost();
+    }
+}
+
+void MovableAabbTree::Rebuild(const AabbStorage& aabbs)
+{
+    _tree.Clear();
+    _leaves.resize(aabbs.Count());
+    for (uint32_t i = 0; i < aabbs.Count(); i++)
+    {
+        _leaves[i] = _tree.Insert(aabbs.BoundsOf(i), i);
+    }
+    _tree.Rebuild();
+    _costAfterRebuild = _tree.Cost();
+}
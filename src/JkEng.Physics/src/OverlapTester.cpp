@@ -0,0 +1,154 @@
+#include "OverlapTester.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "CpuFeatures.h"
+
+#if JKENG_PHYSICS_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using namespace JkEng::Physics;
+
+namespace
+{
+    // Returns the hit bits for candidates [begin, end), which must span at
+    // most 64 candidates, with candidate begin in bit 0.
+    inline uint64_t TestScalarBits(
+        const Bounds& bounds,
+        const CandidateBounds& candidates,
+        uint32_t begin,
+        uint32_t end)
+    {
+        uint64_t bits = 0;
+        for (uint32_t i = begin; i < end; i++)
+        {
+            bool overlaps = bounds.minX <= candidates.maxX[i] && bounds.maxX >= candidates.minX[i]
+                && bounds.minY <= candidates.maxY[i] && bounds.maxY >= candidates.minY[i];
+            bits |= static_cast<uint64_t>(overlaps) << (i - begin);
+        }
+        return bits;
+    }
+
+    void TestScalar(
+        const Bounds& bounds,
+        CandidateBounds candidates,
+        uint32_t candidateCount,
+        uint64_t* hits)
+    {
+        for (uint32_t begin = 0; begin < candidateCount; begin += 64)
+        {
+            uint32_t end = std::min(begin + 64, candidateCount);
+            hits[begin / 64] = TestScalarBits(bounds, candidates, begin, end);
+        }
+    }
+
+#if JKENG_PHYSICS_X86_SIMD
+    void TestSse2(
+        const Bounds& bounds,
+        CandidateBounds candidates,
+        uint32_t candidateCount,
+        uint64_t* hits)
+    {
+        __m128 boundsMinX = _mm_set1_ps(bounds.minX);
+        __m128 boundsMinY = _mm_set1_ps(bounds.minY);
+        __m128 boundsMaxX = _mm_set1_ps(bounds.maxX);
+        __m128 boundsMaxY = _mm_set1_ps(bounds.maxY);
+
+        auto testFour = [&](uint32_t i)
+        {
+            __m128 overlapsX = _mm_and_ps(
+                _mm_cmple_ps(boundsMinX, _mm_loadu_ps(candidates.maxX + i)),
+                _mm_cmpge_ps(boundsMaxX, _mm_loadu_ps(candidates.minX + i)));
+            __m128 overlapsY = _mm_and_ps(
+                _mm_cmple_ps(boundsMinY, _mm_loadu_ps(candidates.maxY + i)),
+                _mm_cmpge_ps(boundsMaxY, _mm_loadu_ps(candidates.minY + i)));
+            return static_cast<uint64_t>(_mm_movemask_ps(_mm_and_ps(overlapsX, overlapsY)));
+        };
+
+        for (uint32_t begin = 0; begin < candidateCount; begin += 64)
+        {
+            uint32_t end = std::min(begin + 64, candidateCount);
+            uint64_t word = 0;
+            uint32_t i = begin;
+            for (; i + 8 <= end; i += 8)
+            {
+                word |= (testFour(i) | (testFour(i + 4) << 4)) << (i - begin);
+            }
+            if (i < end)
+            {
+                word |= TestScalarBits(bounds, candidates, i, end) << (i - begin);
+            }
+            hits[begin / 64] = word;
+        }
+    }
+
+    JKENG_PHYSICS_TARGET_AVX2
+    void TestAvx2(
+        const Bounds& bounds,
+        CandidateBounds candidates,
+        uint32_t candidateCount,
+        uint64_t* hits)
+    {
+        __m256 boundsMinX = _mm256_set1_ps(bounds.minX);
+        __m256 boundsMinY = _mm256_set1_ps(bounds.minY);
+        __m256 boundsMaxX = _mm256_set1_ps(bounds.maxX);
+        __m256 boundsMaxY = _mm256_set1_ps(bounds.maxY);
+
+        for (uint32_t begin = 0; begin < candidateCount; begin += 64)
+        {
+            uint32_t end = std::min(begin + 64, candidateCount);
+            uint64_t word = 0;
+            uint32_t i = begin;
+            for (; i + 8 <= end; i += 8)
+            {
+                __m256 overlapsX = _mm256_and_ps(
+                    _mm256_cmp_ps(boundsMinX, _mm256_loadu_ps(candidates.maxX + i), _CMP_LE_OQ),
+                    _mm256_cmp_ps(boundsMaxX, _mm256_loadu_ps(candidates.minX + i), _CMP_GE_OQ));
+                __m256 overlapsY = _mm256_and_ps(
+                    _mm256_cmp_ps(boundsMinY, _mm256_loadu_ps(candidates.maxY + i), _CMP_LE_OQ),
+                    _mm256_cmp_ps(boundsMaxY, _mm256_loadu_ps(candidates.minY + i), _CMP_GE_OQ));
+                uint64_t bits = static_cast<uint64_t>(_mm256_movemask_ps(_mm256_and_ps(overlapsX, overlapsY)));
+                word |= bits << (i - begin);
+            }
+            if (i < end)
+            {
+                word |= TestScalarBits(bounds, candidates, i, end) << (i - begin);
+            }
+            hits[begin / 64] = word;
+        }
+    }
+#endif
+}
+
+OverlapTester::OverlapTester()
+  : OverlapTester(CpuFeatures::BestSupportedInstructionSet())
+{
+
+}
+
+OverlapTester::OverlapTester(InstructionSet instructionSet)
+  : _instructionSet(instructionSet),
+    _kernel(TestScalar)
+{
+    if (!CpuFeatures::IsSupported(instructionSet))
+    {
+        throw std::invalid_argument("OverlapTester: instruction set is not supported by this CPU");
+    }
+
+#if JKENG_PHYSICS_X86_SIMD
+    switch (instructionSet)
+    {
+        case InstructionSet::Avx2:
+            _kernel = TestAvx2;
+            break;
+        case InstructionSet::Sse2:
+            _kernel = TestSse2;
+            break;
+        case InstructionSet::Scalar:
+        default:
+            break;
+    }
+#endif
+}
@@ -0,0 +1,340 @@
+#include "PartitionedBroadphase.h"
+
+#include <algorithm>
+
+using namespace JkEng::Physics;
+
+PartitionedBroadphase::PartitionedBroadphase(BroadphaseFactory createBroadphase)
+  : _createBroadphase(std::move(createBroadphase))
+{
+
+}
+
+uint32_t PartitionedBroadphase::FindPartition(const AabbStorage& aabbs, uint32_t aabbIndex) const
+{
+    // Scenes only use a handful of distinct filters.
+    uint32_t category = aabbs.CollisionCategory()[aabbIndex];
+    uint32_t mask = aabbs.CollisionMask()[aabbIndex];
+    uint32_t partitionIndex = 0;
+    while (partitionIndex < _partitions.size()
+        && (_partitions[partitionIndex].category != category || _partitions[partitionIndex].mask != mask))
+    {
+        partitionIndex++;
+    }
+    return partitionIndex;
+}
+
+void PartitionedBroadphase::AddToPartition(const AabbStorage& aabbs, uint32_t aabbIndex, uint32_t partitionIndex)
+{
+    auto& partition = _partitions[partitionIndex];
+    uint32_t position = partition.aabbs.Add(
+        aabbs.MinX()[aabbIndex],
+        aabbs.MaxX()[aabbIndex],
+        aabbs.MinY()[aabbIndex],
+        aabbs.MaxY()[aabbIndex],
+        glm::vec2(),
+        glm::vec2(),
+        nullptr,
+        std::any());
+    partition.aabbs.CollisionCategory()[position] = partition.category;
+    partition.aabbs.CollisionMask()[position] = partition.mask;
+    partition.aabbs.IsAwake()[position] = aabbs.IsAwake()[aabbIndex];
+    partition.aabbIndices.push_back(aabbIndex);
+    partition.sortedByMinX.push_back(partition.ids.Add());
+    _partitionOf.push_back(partitionIndex);
+    _positionOf.push_back(position);
+}
+
+void PartitionedBroadphase::CreatePartitions(const AabbStorage& aabbs)
+{
+    _partitions.clear();
+    _crossPartitionPairs.clear();
+    _partitionOf.clear();
+    _positionOf.clear();
+
+    for (uint32_t aabbIndex = 0; aabbIndex < aabbs.Count(); aabbIndex++)
+    {
+        uint32_t partitionIndex = FindPartition(aabbs, aabbIndex);
+        if (partitionIndex == _partitions.size())
+        {
+            auto& partition = _partitions.emplace_back();
+            partition.category = aabbs.CollisionCategory()[aabbIndex];
+            partition.mask = aabbs.CollisionMask()[aabbIndex];
+        }
+        AddToPartition(aabbs, aabbIndex, partitionIndex);
+    }
+
+    for (uint32_t index0 = 0; index0 < _partitions.size(); index0++)
+    {
+        auto& partition0 = _partitions[index0];
+        if (AabbStorage::CategoriesCollide(partition0.category, partition0.mask, partition0.category, partition0.mask))
+        {
+            partition0.broadphase = _createBroadphase();
+        }
+
+        for (uint32_t index1 = index0 + 1; index1 < _partitions.size(); index1++)
+        {
+            auto& partition1 = _partitions[index1];
+            if (AabbStorage::CategoriesCollide(partition0.category, partition0.mask, partition1.category, partition1.mask))
+            {
+                _crossPartitionPairs.emplace_back(index0, index1);
+            }
+        }
+    }
+}
+
+void PartitionedBroadphase::AabbAdded(const AabbStorage& aabbs, uint32_t index)
+{
+    // Otherwise the partitions are created from scratch by the next search.
+    if (_partitionOf.size() != index)
+    {
+        return;
+    }
+
+    uint32_t partitionIndex = FindPartition(aabbs, index);
+    if (partitionIndex == _partitions.size())
+    {
+        // A new filter changes which partitions can collide.
+        _partitions.clear();
+        _partitionOf.clear();
+        _positionOf.clear();
+        return;
+    }
+
+    AddToPartition(aabbs, index, partitionIndex);
+    auto& partition = _partitions[partitionIndex];
+    if (partition.broadphase)
+    {
+        partition.broadphase->AabbAdded(partition.aabbs, _positionOf[index]);
+    }
+}
+
+void PartitionedBroadphase::AabbRemoved(const AabbStorage&, uint32_t index, uint32_t lastIndex)
+{
+    if (_partitionOf.size() != lastIndex + 1)
+    {
+        return;
+    }
+
+    // Swap-remove the AABB from its partition the same way the scene did.
+    auto& partition = _partitions[_partitionOf[index]];
+    uint32_t position = _positionOf[index];
+    uint32_t lastPosition = partition.aabbs.Count() - 1;
+    partition.aabbs.SwapRemove(position);
+    partition.aabbIndices[position] = partition.aabbIndices[lastPosition];
+    partition.aabbIndices.pop_back();
+    if (position != lastPosition)
+    {
+        _positionOf[partition.aabbIndices[position]] = position;
+    }
+    partition.ids.SwapRemove(position);
+
+    if (partition.broadphase)
+    {
+        partition.broadphase->AabbRemoved(partition.aabbs, position, lastPosition);
+    }
+
+    // Then follow the scene AABB that moved into index.
+    if (index != lastIndex)
+    {
+        uint32_t movedPartition = _partitionOf[lastIndex];
+        uint32_t movedPosition = _positionOf[lastIndex];
+        _partitions[movedPartition].aabbIndices[movedPosition] = index;
+        _partitionOf[index] = movedPartition;
+        _positionOf[index] = movedPosition;
+    }
+    _partitionOf.pop_back();
+    _positionOf.pop_back();
+}
+
+void PartitionedBroadphase::UpdatePartitions(const AabbStorage& aabbs)
+{
+    if (_partitionOf.size() != aabbs.Count())
+    {
+        CreatePartitions(aabbs);
+    }
+    else
+    {
+        for (auto& partition : _partitions)
+        {
+            for (uint32_t position = 0; position < partition.aabbIndices.size(); position++)
+            {
+                uint32_t aabbIndex = partition.aabbIndices[position];
+                partition.aabbs.MinX()[position] = aabbs.MinX()[aabbIndex];
+                partition.aabbs.MinY()[position] = aabbs.MinY()[aabbIndex];
+                partition.aabbs.MaxX()[position] = aabbs.MaxX()[aabbIndex];
+                partition.aabbs.MaxY()[position] = aabbs.MaxY()[aabbIndex];
+                partition.aabbs.IsAwake()[position] = aabbs.IsAwake()[aabbIndex];
+            }
+        }
+    }
+
+    // Drop the AABBs removed since the last search from sortedByMinX,
+    // which keeps the rest in order.
+    for (auto& partition : _partitions)
+    {
+        if (!partition.ids.HasRemovals())
+        {
+            continue;
+        }
+
+        auto& sorted = partition.sortedByMinX;
+        size_t keptCount = 0;
+        for (uint32_t id : sorted)
+        {
+            uint32_t position = partition.ids.IndexOf(id);
+            if (position != SwapRemoveIds::Removed)
+            {
+                sorted[keptCount++] = position;
+            }
+        }
+        sorted.resize(keptCount);
+        partition.ids.Reset(partition.aabbs.Count());
+    }
+
+    if (_crossPartitionPairs.empty())
+    {
+        return;
+    }
+
+    // AABBs only move a little each step so insertion sort is close to
+    // linear.
+    for (auto& partition : _partitions)
+    {
+        const float* minX = partition.aabbs.MinX();
+        auto& sorted = partition.sortedByMinX;
+        for (size_t i = 1; i < sorted.size(); i++)
+        {
+            uint32_t position = sorted[i];
+            size_t j = i;
+            for (; j > 0 && minX[sorted[j - 1]] > minX[position]; j--)
+            {
+                sorted[j] = sorted[j - 1];
+            }
+            sorted[j] = position;
+        }
+    }
+}
+
+void PartitionedBroadphase::AppendPartitionPairs(
+    const Partition& partition,
+    const std::vector<OverlappingPair>& partitionPairs,
+    std::vector<OverlappingPair>& pairs)
+{
+    for (auto& pair : partitionPairs)
+    {
+        uint32_t aabbIndex0 = partition.aabbIndices[pair.index0];
+        uint32_t aabbIndex1 = partition.aabbIndices[pair.index1];
+        pairs.push_back({ std::min(aabbIndex0, aabbIndex1), std::max(aabbIndex0, aabbIndex1) });
+    }
+}
+
+void PartitionedBroadphase::FindCrossPartitionPairs(
+    const Partition& partition0,
+    const Partition& partition1,
+    std::vector<OverlappingPair>& pairs)
+{
+    auto& aabbs0 = partition0.aabbs;
+    auto& aabbs1 = partition1.aabbs;
+
+    auto addIfColliding = [&](uint32_t position0, uint32_t position1)
+    {
+        if ((aabbs0.IsAwake()[position0] | aabbs1.IsAwake()[position1]) != 0
+            && aabbs0.BoundsOf(position0).Overlaps(aabbs1.BoundsOf(position1)))
+        {
+            uint32_t aabbIndex0 = partition0.aabbIndices[position0];
+            uint32_t aabbIndex1 = partition1.aabbIndices[position1];
+            pairs.push_back({ std::min(aabbIndex0, aabbIndex1), std::max(aabbIndex0, aabbIndex1) });
+        }
+    };
+
+    // Two AABBs overlap along x exactly when the one that starts later
+    // starts inside the other, so every pair is found from the AABB that
+    // starts first.  Ties are found from partition0.
+    auto& sorted0 = partition0.sortedByMinX;
+    auto& sorted1 = partition1.sortedByMinX;
+    size_t first1 = 0;
+    for (uint32_t position0 : sorted0)
+    {
+        float minX = aabbs0.MinX()[position0];
+        float maxX = aabbs0.MaxX()[position0];
+        while (first1 < sorted1.size() && aabbs1.MinX()[sorted1[first1]] < minX)
+        {
+            first1++;
+        }
+        for (size_t i = first1; i < sorted1.size() && aabbs1.MinX()[sorted1[i]] <= maxX; i++)
+        {
+            addIfColliding(position0, sorted1[i]);
+        }
+    }
+
+    size_t first0 = 0;
+    for (uint32_t position1 : sorted1)
+    {
+        float minX = aabbs1.MinX()[position1];
+        float maxX = aabbs1.MaxX()[position1];
+        while (first0 < sorted0.size() && aabbs0.MinX()[sorted0[first0]] <= minX)
+        {
+            first0++;
+        }
+        for (size_t i = first0; i < sorted0.size() && aabbs0.MinX()[sorted0[i]] <= maxX; i++)
+        {
+            addIfColliding(sorted0[i], position1);
+        }
+    }
+}
+
+void PartitionedBroadphase::FindOverlappingPairs(
+    const AabbStorage& aabbs,
+    std::vector<OverlappingPair>& pairs)
+{
+    UpdatePartitions(aabbs);
+
+    for (auto& partition : _partitions)
+    {
+        if (partition.broadphase)
+        {
+            partition.pairs.clear();
+            partition.broadphase->FindOverlappingPairs(partition.aabbs, partition.pairs);
+            AppendPartitionPairs(partition, partition.pairs, pairs);
+        }
+    }
+
+    for (auto [index0, index1] : _crossPartitionPairs)
+    {
+        FindCrossPartitionPairs(_partitions[index0], _partitions[index1], pairs);
+    }
+}
+
+void PartitionedBroadphase::FindOverlappingPairs(
+    const AabbStorage& aabbs,
+    WorkerPool& workers,
+    std::vector<std::vector<OverlappingPair>>& pairsPerWorker)
+{
+    UpdatePartitions(aabbs);
+
+    for (auto& partition : _partitions)
+    {
+        if (!partition.broadphase)
+        {
+            continue;
+        }
+
+        partition.pairsPerWorker.resize(workers.WorkerCount());
+        for (auto& pairs : partition.pairsPerWorker)
+        {
+            pairs.clear();
+        }
+        partition.broadphase->FindOverlappingPairs(partition.aabbs, workers, partition.pairsPerWorker);
+        for (uint32_t workerIndex = 0; workerIndex < workers.WorkerCount(); workerIndex++)
+        {
+            AppendPartitionPairs(partition, partition.pairsPerWorker[workerIndex], pairsPerWorker[workerIndex]);
+        }
+    }
+
+    workers.Run(static_cast<uint32_t>(_crossPartitionPairs.size()), [&](uint32_t taskIndex, uint32_t workerIndex)
+    {
+        auto [index0, index1] = _crossPartitionPairs[taskIndex];
+        FindCrossPartitionPairs(_partitions[index0], _partitions[index1], pairsPerWorker[workerIndex]);
+    });
+}
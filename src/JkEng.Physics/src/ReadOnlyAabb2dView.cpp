@@ -0,0 +1,37 @@
+#include "ReadOnlyAabb2dView.h"
+
+#include "AabbStorage.h"
+
+using namespace JkEng::Physics;
+
+glm::vec2 ReadOnlyAabb2dView::Size() const
+{
+    Bounds bounds = _storage->PreStepBounds(_index);
+    return glm::vec2(bounds.maxX - bounds.minX, bounds.maxY - bounds.minY);
+}
+
+glm::vec2 ReadOnlyAabb2dView::Position() const
+{
+    Bounds bounds = _storage->PreStepBounds(_index);
+    return glm::vec2(bounds.minX, bounds.minY);
+}
+
+glm::vec2 ReadOnlyAabb2dView::Velocity() const
+{
+    return _storage->PreStepVelocity(_index);
+}
+
+glm::vec2 ReadOnlyAabb2dView::Acceleration() const
+{
+    return _storage->PreStepAcceleration(_index);
+}
+
+uint64_t ReadOnlyAabb2dView::UserData() const
+{
+    return _storage->PreStepUserData(_index);
+}
+
+const std::any& ReadOnlyAabb2dView::ObjectInfo() const
+{
+    return _storage->PreStepObjectInfo(_index);
+}
@@ -0,0 +1,64 @@
+#include "StaticAabbTree.h"
+
+using namespace JkEng::Physics;
+
+StaticAabbTree::StaticAabbTree(const std::vector<StaticAabb2dDefinition>& definitions)
+{
+    _aabbs.Reserve(definitions.size());
+    for (auto& definition : definitions)
+    {
+        uint32_t index = _aabbs.Add(
+            definition.Position(),
+            definition.Size(),
+            glm::vec2(),
+            glm::vec2(),
+            nullptr,
+            definition.ObjectInfo());
+        _aabbs.UserData()[index] = definition.UserData();
+        _aabbs.CollisionCategory()[index] = definition.CollisionCategory();
+        _aabbs.CollisionMask()[index] = definition.CollisionMask();
+        _categoryUnion |= definition.CollisionCategory();
+        _maskUnion |= definition.CollisionMask();
+        _tree.Insert(_aabbs.BoundsOf(index), index);
+    }
+
+    // Nothing is ever inserted or removed afterwards, so pay for the
+    // better top-down tree once.
+    _tree.Rebuild();
+}
+
+void StaticAabbTree::FindOverlappingPairs(
+    const AabbStorage& movableAabbs,
+    uint32_t begin,
+    uint32_t end,
+    std::vector<int32_t>& stack,
+    std::vector<OverlappingPair>& pairs) const
+{
+    const uint32_t* categories = movableAabbs.CollisionCategory();
+    const uint32_t* masks = movableAabbs.CollisionMask();
+    const uint8_t* isAwake = movableAabbs.IsAwake();
+    for (uint32_t movableIndex = begin; movableIndex < end; movableIndex++)
+    {
+        uint32_t category = categories[movableIndex];
+        uint32_t mask = masks[movableIndex];
+
+        // Skip the search for AABBs that collide with no static AABB, such
+        // as ones that pass through level geometry, and for sleeping AABBs
+        // which can not have started touching anything.
+        if (!isAwake[movableIndex] || !AabbStorage::CategoriesCollide(category, mask, _categoryUnion, _maskUnion))
+        {
+            continue;
+        }
+
+        _tree.ForEachOverlappingLeaf(
+            movableAabbs.BoundsOf(movableIndex),
+            stack,
+            [&](uint32_t staticIndex)
+            {
+                if (AabbStorage::CategoriesCollide(category, mask, _aabbs.CollisionCategory()[staticIndex], _aabbs.CollisionMask()[staticIndex]))
+                {
+                    pairs.push_back({ movableIndex, staticIndex });
+                }
+            });
+    }
+}
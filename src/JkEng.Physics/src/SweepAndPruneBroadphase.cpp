@@ -0,0 +1,343 @@
+#include "SweepAndPruneBroadphase.h"
+
+#include <algorithm>
+
+using namespace JkEng::Physics;
+
+SweepAndPruneBroadphase::SweepAndPruneBroadphase(SweepAndPruneAxes axes)
+  : _axes(axes)
+{
+
+}
+
+void SweepAndPruneBroadphase::RebuildEndpoints(std::vector<Endpoint>& endpoints, size_t aabbCount)
+{
+    endpoints.resize(aabbCount * 2);
+    for (size_t i = 0; i < aabbCount; i++)
+    {
+        uint32_t aabbIndex = static_cast<uint32_t>(i);
+        endpoints[i * 2] = { 0.0f, aabbIndex << 1 };
+        endpoints[i * 2 + 1] = { 0.0f, (aabbIndex << 1) | 1u };
+    }
+}
+
+void SweepAndPruneBroadphase::UpdateEndpoints(
+    std::vector<Endpoint>& endpoints,
+    const AabbStorage& aabbs,
+    bool isXAxis)
+{
+    const float* mins = isXAxis ? aabbs.MinX() : aabbs.MinY();
+    const float* maxes = isXAxis ? aabbs.MaxX() : aabbs.MaxY();
+    for (auto& endpoint : endpoints)
+    {
+        uint32_t aabbIndex = endpoint.AabbIndex();
+        endpoint.value = endpoint.IsMax() ? maxes[aabbIndex] : mins[aabbIndex];
+    }
+}
+
+void SweepAndPruneBroadphase::InsertionSort(std::vector<Endpoint>& endpoints)
+{
+    size_t endpointCount = endpoints.size();
+    for (size_t i = 1; i < endpointCount; i++)
+    {
+        Endpoint endpoint = endpoints[i];
+        size_t j = i;
+        while (j > 0 && endpoint < endpoints[j - 1])
+        {
+            endpoints[j] = endpoints[j - 1];
+            j--;
+        }
+        endpoints[j] = endpoint;
+    }
+}
+
+void SweepAndPruneBroadphase::SortEndpoints(
+    std::vector<Endpoint>& endpoints,
+    const AabbStorage& aabbs,
+    bool isXAxis)
+{
+    // The first call (or a change in AABB count) starts from an unsorted
+    // list, so use a full sort instead of the insertion sort.
+    bool rebuild = endpoints.size() != aabbs.Count() * 2u;
+    if (rebuild)
+    {
+        RebuildEndpoints(endpoints, aabbs.Count());
+    }
+
+    UpdateEndpoints(endpoints, aabbs, isXAxis);
+
+    if (rebuild)
+    {
+        std::sort(endpoints.begin(), endpoints.end());
+    }
+    else
+    {
+        InsertionSort(endpoints);
+    }
+}
+
+float SweepAndPruneBroadphase::Spread(const std::vector<Endpoint>& endpoints)
+{
+    return endpoints.empty() ? 0.0f : endpoints.back().value - endpoints.front().value;
+}
+
+void SweepAndPruneBroadphase::ActiveList::Clear(uint32_t aabbCount)
+{
+    aabbIndices.clear();
+    bounds.Clear();
+    positions.resize(aabbCount);
+}
+
+void SweepAndPruneBroadphase::ActiveList::Add(const AabbStorage& aabbs, uint32_t aabbIndex)
+{
+    positions[aabbIndex] = static_cast<uint32_t>(aabbIndices.size());
+    aabbIndices.push_back(aabbIndex);
+    bounds.Add(aabbs, aabbIndex);
+}
+
+void SweepAndPruneBroadphase::ActiveList::Remove(uint32_t aabbIndex)
+{
+    uint32_t position = positions[aabbIndex];
+    uint32_t movedAabbIndex = aabbIndices.back();
+    aabbIndices[position] = movedAabbIndex;
+    positions[movedAabbIndex] = position;
+    aabbIndices.pop_back();
+    bounds.SwapRemove(position);
+}
+
+void SweepAndPruneBroadphase::ActiveLists::Clear(uint32_t aabbCount)
+{
+    awake.Clear(aabbCount);
+    sleeping.Clear(aabbCount);
+}
+
+void SweepAndPruneBroadphase::ActiveLists::Add(const AabbStorage& aabbs, uint32_t aabbIndex)
+{
+    (aabbs.IsAwake()[aabbIndex] ? awake : sleeping).Add(aabbs, aabbIndex);
+}
+
+void SweepAndPruneBroadphase::ActiveLists::Remove(const AabbStorage& aabbs, uint32_t aabbIndex)
+{
+    (aabbs.IsAwake()[aabbIndex] ? awake : sleeping).Remove(aabbIndex);
+}
+
+void SweepAndPruneBroadphase::TestActive(
+    const AabbStorage& aabbs,
+    uint32_t aabbIndex,
+    ActiveList& active,
+    std::vector<OverlappingPair>& pairs) const
+{
+    // Every active AABB overlaps this one along the swept axis so only
+    // the full test is left.
+    auto addPair = [&](uint32_t activeAabbIndex)
+    {
+        pairs.push_back({
+            std::min(aabbIndex, activeAabbIndex),
+            std::max(aabbIndex, activeAabbIndex)});
+    };
+
+    uint32_t activeCount = active.bounds.Count();
+    if (activeCount < MinActiveCountForOverlapTester)
+    {
+        for (uint32_t activeAabbIndex : active.aabbIndices)
+        {
+            if (aabbs.ShouldCollide(aabbIndex, activeAabbIndex) && aabbs.IsColliding(aabbIndex, activeAabbIndex))
+            {
+                addPair(activeAabbIndex);
+            }
+        }
+    }
+    else
+    {
+        _overlapTester.Test(aabbs.BoundsOf(aabbIndex), active.bounds.Candidates(), activeCount, active.hits);
+        // Overlaps are rare next to the number of candidates, so the
+        // filter is cheaper applied to the hits than in the kernel.
+        OverlapTester::ForEachHit(active.hits.data(), activeCount, [&](uint32_t activePosition)
+        {
+            uint32_t activeAabbIndex = active.aabbIndices[activePosition];
+            if (aabbs.ShouldCollide(aabbIndex, activeAabbIndex))
+            {
+                addPair(activeAabbIndex);
+            }
+        });
+    }
+}
+
+void SweepAndPruneBroadphase::Sweep(
+    const std::vector<Endpoint>& endpoints,
+    const AabbStorage& aabbs,
+    uint32_t begin,
+    uint32_t end,
+    ActiveLists& active,
+    std::vector<OverlappingPair>& pairs) const
+{
+    const uint8_t* isAwake = aabbs.IsAwake();
+    for (uint32_t position = begin; position < end; position++)
+    {
+        auto& endpoint = endpoints[position];
+        uint32_t aabbIndex = endpoint.AabbIndex();
+        if (endpoint.IsMax())
+        {
+            active.Remove(aabbs, aabbIndex);
+            continue;
+        }
+
+        TestActive(aabbs, aabbIndex, active.awake, pairs);
+        if (isAwake[aabbIndex])
+        {
+            TestActive(aabbs, aabbIndex, active.sleeping, pairs);
+        }
+        active.Add(aabbs, aabbIndex);
+    }
+}
+
+void SweepAndPruneBroadphase::AabbAdded(const AabbStorage&, uint32_t index)
+{
+    // Otherwise the lists are rebuilt when next sorted.
+    if (_ids.Count() != index)
+    {
+        return;
+    }
+
+    // Appended endpoints get their values and are moved into place by the
+    // next sort.  The list for an axis that is not swept stays empty.
+    uint32_t id = _ids.Add();
+    if (_axes != SweepAndPruneAxes::Y)
+    {
+        _endpointsX.push_back({ 0.0f, id << 1 });
+        _endpointsX.push_back({ 0.0f, (id << 1) | 1u });
+    }
+    if (_axes != SweepAndPruneAxes::X)
+    {
+        _endpointsY.push_back({ 0.0f, id << 1 });
+        _endpointsY.push_back({ 0.0f, (id << 1) | 1u });
+    }
+}
+
+void SweepAndPruneBroadphase::AabbRemoved(const AabbStorage&, uint32_t index, uint32_t lastIndex)
+{
+    if (_ids.Count() != lastIndex + 1)
+    {
+        return;
+    }
+
+    // Searching the lists for the endpoints would make each removal cost
+    // as much as a sort, so leave them for CompactEndpoints.
+    _ids.SwapRemove(index);
+}
+
+void SweepAndPruneBroadphase::CompactEndpoints(std::vector<Endpoint>& endpoints) const
+{
+    size_t keptCount = 0;
+    for (auto& endpoint : endpoints)
+    {
+        uint32_t aabbIndex = _ids.IndexOf(endpoint.AabbIndex());
+        if (aabbIndex != SwapRemoveIds::Removed)
+        {
+            endpoints[keptCount++] = { endpoint.value, (aabbIndex << 1) | (endpoint.aabbIndexAndIsMax & 1u) };
+        }
+    }
+    endpoints.resize(keptCount);
+}
+
+const std::vector<SweepAndPruneBroadphase::Endpoint>& SweepAndPruneBroadphase::SortEndpoints(
+    const AabbStorage& aabbs)
+{
+    bool useX = _axes != SweepAndPruneAxes::Y;
+    bool useY = _axes != SweepAndPruneAxes::X;
+
+    if (_ids.Count() != aabbs.Count())
+    {
+        // The first call, or AABBs were added or removed without telling
+        // the broadphase.  Emptied lists are rebuilt below.
+        _endpointsX.clear();
+        _endpointsY.clear();
+        _ids.Reset(aabbs.Count());
+    }
+    else if (_ids.HasRemovals())
+    {
+        CompactEndpoints(_endpointsX);
+        CompactEndpoints(_endpointsY);
+        _ids.Reset(aabbs.Count());
+    }
+
+    if (useX)
+    {
+        SortEndpoints(_endpointsX, aabbs, true);
+    }
+
+    if (useY)
+    {
+        SortEndpoints(_endpointsY, aabbs, false);
+    }
+
+    if (useX && useY)
+    {
+        return Spread(_endpointsX) >= Spread(_endpointsY) ? _endpointsX : _endpointsY;
+    }
+    return useX ? _endpointsX : _endpointsY;
+}
+
+void SweepAndPruneBroadphase::FindOverlappingPairs(
+    const AabbStorage& aabbs,
+    std::vector<OverlappingPair>& pairs)
+{
+    auto& endpoints = SortEndpoints(aabbs);
+    _active.Clear(aabbs.Count());
+    Sweep(endpoints, aabbs, 0, static_cast<uint32_t>(endpoints.size()), _active, pairs);
+}
+
+void SweepAndPruneBroadphase::FindOverlappingPairs(
+    const AabbStorage& aabbs,
+    WorkerPool& workers,
+    std::vector<std::vector<OverlappingPair>>& pairsPerWorker)
+{
+    auto& endpoints = SortEndpoints(aabbs);
+    uint32_t aabbCount = aabbs.Count();
+    uint32_t endpointCount = static_cast<uint32_t>(endpoints.size());
+    uint32_t taskCount = (endpointCount + EndpointsPerTask - 1) / EndpointsPerTask;
+
+    // Walk the endpoints once without testing anything to record which
+    // AABBs are active where each task starts, so every task can sweep
+    // its own range from there.
+    _active.Clear(aabbCount);
+    _taskStartActive.clear();
+    _taskStartActiveOffsets.clear();
+    for (uint32_t position = 0; position < endpointCount; position++)
+    {
+        if (position % EndpointsPerTask == 0)
+        {
+            _taskStartActiveOffsets.push_back(static_cast<uint32_t>(_taskStartActive.size()));
+            for (auto* active : { &_active.awake, &_active.sleeping })
+            {
+                _taskStartActive.insert(_taskStartActive.end(), active->aabbIndices.begin(), active->aabbIndices.end());
+            }
+        }
+
+        auto& endpoint = endpoints[position];
+        if (endpoint.IsMax())
+        {
+            _active.Remove(aabbs, endpoint.AabbIndex());
+        }
+        else
+        {
+            _active.Add(aabbs, endpoint.AabbIndex());
+        }
+    }
+    _taskStartActiveOffsets.push_back(static_cast<uint32_t>(_taskStartActive.size()));
+
+    _activePerWorker.resize(workers.WorkerCount());
+    workers.Run(taskCount, [&](uint32_t taskIndex, uint32_t workerIndex)
+    {
+        auto& active = _activePerWorker[workerIndex];
+        active.Clear(aabbCount);
+        for (uint32_t i = _taskStartActiveOffsets[taskIndex]; i < _taskStartActiveOffsets[taskIndex + 1]; i++)
+        {
+            active.Add(aabbs, _taskStartActive[i]);
+        }
+
+        uint32_t begin = taskIndex * EndpointsPerTask;
+        uint32_t end = std::min(begin + EndpointsPerTask, endpointCount);
+        Sweep(endpoints, aabbs, begin, end, active, pairsPerWorker[workerIndex]);
+    });
+}
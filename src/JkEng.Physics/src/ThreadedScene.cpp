@@ -0,0 +1,216 @@
+#include "ThreadedScene.h"
+
+using namespace JkEng::Physics;
+
+ThreadedScene::ThreadedScene(const SceneDefinition& definition)
+  : _scene(std::make_unique<Physics::Scene>(definition)),
+    _stepDuration(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(_scene->StepDuration())))
+{
+
+}
+
+ThreadedScene::~ThreadedScene()
+{
+    // Anything a handler threw has nowhere to go from here.
+    Join();
+}
+
+void ThreadedScene::Start()
+{
+    if (_isRunning)
+    {
+        return;
+    }
+
+    // A thread a handler stopped is still joined by Stop, which rethrows
+    // what the handler threw.
+    if (_thread.joinable())
+    {
+        Stop();
+    }
+
+    Publish(Clock::now());
+
+    // Only return once the physics thread has restricted access to the
+    // scene, so nothing this thread does after Start can race a step.
+    std::promise<void> restricted;
+    std::future<void> isRestricted = restricted.get_future();
+    _isRunning = true;
+    _thread = std::thread(&ThreadedScene::ThreadMain, this, std::move(restricted));
+    isRestricted.wait();
+}
+
+void ThreadedScene::Stop()
+{
+    std::exception_ptr exception = Join();
+    ApplyCommands();
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+void ThreadedScene::SetPosition(BodyHandle handle, glm::vec2 position)
+{
+    Queue({ BodyCommandType::Position, handle, position, 0 });
+}
+
+void ThreadedScene::SetSize(BodyHandle handle, glm::vec2 size)
+{
+    Queue({ BodyCommandType::Size, handle, size, 0 });
+}
+
+void ThreadedScene::SetVelocity(BodyHandle handle, glm::vec2 velocity)
+{
+    Queue({ BodyCommandType::Velocity, handle, velocity, 0 });
+}
+
+void ThreadedScene::SetAcceleration(BodyHandle handle, glm::vec2 acceleration)
+{
+    Queue({ BodyCommandType::Acceleration, handle, acceleration, 0 });
+}
+
+void ThreadedScene::SetUserData(BodyHandle handle, uint64_t userData)
+{
+    Queue({ BodyCommandType::UserData, handle, glm::vec2(), userData });
+}
+
+void ThreadedScene::RemoveBody(BodyHandle handle)
+{
+    Queue({ BodyCommandType::Remove, handle, glm::vec2(), 0 });
+}
+
+void ThreadedScene::ThreadMain(std::promise<void> restricted)
+{
+    // However the thread exits, other threads can use the scene again.
+    struct RunningReset
+    {
+        ThreadedScene& scene;
+
+        ~RunningReset()
+        {
+            scene._scene->RestrictAccessToThread(std::thread::id());
+            scene._isRunning = false;
+        }
+    } runningReset{ *this };
+
+    _scene->RestrictAccessToThread(std::this_thread::get_id());
+    restricted.set_value();
+
+    // Start published the scene as it was, so the first step is due one
+    // step from now.
+    Clock::time_point stepTime = Clock::now() + _stepDuration;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (_stopRequested.wait_until(lock, stepTime, [this] { return _stopping; }))
+            {
+                return;
+            }
+        }
+
+        try
+        {
+            ApplyCommands();
+            _scene->Update(_scene->StepDuration());
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _exception = std::current_exception();
+            return;
+        }
+        _stepCount++;
+        Publish(stepTime);
+
+        stepTime += _stepDuration;
+        Clock::time_point now = Clock::now();
+        if (now - stepTime > _stepDuration * MaxStepsBehind)
+        {
+            stepTime = now;
+        }
+    }
+}
+
+std::exception_ptr ThreadedScene::Join()
+{
+    if (!_thread.joinable())
+    {
+        return nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _stopRequested.notify_one();
+    _thread.join();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = false;
+    std::exception_ptr exception;
+    std::swap(exception, _exception);
+    return exception;
+}
+
+void ThreadedScene::Queue(const BodyCommand& command)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _commands.push_back(command);
+}
+
+void ThreadedScene::ApplyCommands()
+{
+    // Whatever is left from a batch a handler threw in is dropped.
+    _commandsToApply.clear();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::swap(_commands, _commandsToApply);
+    }
+
+    for (const auto& command : _commandsToApply)
+    {
+        IMovableAabb2d* body = _scene->Body(command.handle);
+        if (body == nullptr)
+        {
+            continue;
+        }
+
+        switch (command.type)
+        {
+        case BodyCommandType::Position:
+            body->Position(command.value);
+            break;
+        case BodyCommandType::Size:
+            body->Size(command.value);
+            break;
+        case BodyCommandType::Velocity:
+            body->Velocity(command.value);
+            break;
+        case BodyCommandType::Acceleration:
+            body->Acceleration(command.value);
+            break;
+        case BodyCommandType::UserData:
+            body->UserData(command.userData);
+            break;
+        case BodyCommandType::Remove:
+            _scene->RemoveBody(command.handle);
+            break;
+        }
+    }
+    _commandsToApply.clear();
+}
+
+void ThreadedScene::Publish(Clock::time_point stepTime)
+{
+    SceneSnapshot& snapshot = _snapshots.Back();
+    uint32_t bodyIdCount = _scene->BodyIdCount();
+    snapshot.positions.resize(bodyIdCount);
+    snapshot.previousPositions.resize(bodyIdCount);
+    snapshot.velocities.resize(bodyIdCount);
+    _scene->CopyMovableState(snapshot.positions, snapshot.previousPositions, snapshot.velocities);
+    snapshot.stepCount = _stepCount;
+    snapshot.stepTime = stepTime;
+    _snapshots.Publish();
+}
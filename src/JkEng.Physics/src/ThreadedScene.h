@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "IThreadedScene.h"
+#include "Scene.h"
+#include "SceneDefinition.h"
+#include "SceneSnapshot.h"
+#include "TripleBuffer.h"
+
+namespace JkEng::Physics
+{
+    class ThreadedScene final : public IThreadedScene
+    {
+    public:
+        ThreadedScene(const SceneDefinition& definition);
+        ~ThreadedScene();
+
+        ThreadedScene(const ThreadedScene&) = delete;
+        ThreadedScene& operator=(const ThreadedScene&) = delete;
+
+        IScene& Scene() override { return *_scene; }
+
+        void Start() override;
+        void Stop() override;
+        bool IsRunning() const override { return _isRunning; }
+
+        const SceneSnapshot& LatestSnapshot() override { return _snapshots.Front(); }
+
+        void SetPosition(BodyHandle handle, glm::vec2 position) override;
+        void SetSize(BodyHandle handle, glm::vec2 size) override;
+        void SetVelocity(BodyHandle handle, glm::vec2 velocity) override;
+        void SetAcceleration(BodyHandle handle, glm::vec2 acceleration) override;
+        void SetUserData(BodyHandle handle, uint64_t userData) override;
+        void RemoveBody(BodyHandle handle) override;
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        enum class BodyCommandType
+        {
+            Position,
+            Size,
+            Velocity,
+            Acceleration,
+            UserData,
+            Remove
+        };
+
+        // A write queued for the next step.  value holds the vector written
+        // by every type but UserData and Remove.
+        struct BodyCommand
+        {
+            BodyCommandType type;
+            BodyHandle handle;
+            glm::vec2 value;
+            uint64_t userData;
+        };
+
+        std::unique_ptr<Physics::Scene> _scene;
+        Clock::duration _stepDuration;
+        uint64_t _stepCount = 0;
+
+        // Only the physics thread publishes while it runs, and Start
+        // publishes before it does.
+        TripleBuffer<SceneSnapshot> _snapshots;
+
+        std::thread _thread;
+
+        // Set by Start and cleared by the physics thread however it exits,
+        // so unlike _thread.joinable() it goes false once a handler throws.
+        std::atomic<bool> _isRunning = false;
+        std::mutex _mutex;
+        std::condition_variable _stopRequested;
+
+        // Guarded by _mutex.
+        bool _stopping = false;
+        std::vector<BodyCommand> _commands;
+        std::exception_ptr _exception;
+
+        // Swapped with _commands so commands can be queued while the last
+        // ones are applied.  Only touched by whichever thread steps.
+        std::vector<BodyCommand> _commandsToApply;
+
+        // Restricts access to the scene to this thread, then sets
+        // restricted and steps until stopped.
+        void ThreadMain(std::promise<void> restricted);
+
+        // Stops the physics thread if it is running and returns what a
+        // handler threw on it, if anything.
+        std::exception_ptr Join();
+
+        void Queue(const BodyCommand& command);
+        void ApplyCommands();
+        void Publish(Clock::time_point stepTime);
+    };
+}
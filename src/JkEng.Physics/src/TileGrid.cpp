@@ -0,0 +1,254 @@
+#include "TileGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace JkEng::Physics;
+
+TileGrid::TileGrid(const TileGridDefinition& definition)
+  : _columns(definition.Columns()),
+    _rows(definition.Rows()),
+    _cellSize(definition.CellSize()),
+    _solidBits(definition.SolidBits())
+{
+    glm::vec2 size(_columns * _cellSize, _rows * _cellSize);
+    _aabbs.Add(definition.Position(), size, glm::vec2(), glm::vec2(), nullptr, definition.ObjectInfo());
+    _aabbs.UserData()[0] = definition.UserData();
+    _aabbs.CollisionCategory()[0] = definition.CollisionCategory();
+    _aabbs.CollisionMask()[0] = definition.CollisionMask();
+    _bounds = _aabbs.BoundsOf(0);
+}
+
+TileGrid::CellRange TileGrid::CellsCoveredBy(const Bounds& bounds) const
+{
+    // A cell is touched when its far edge is at or past bounds' near edge,
+    // so a minimum exactly on an edge also covers the cell before it.
+    auto firstCell = [this](float min, float gridMin)
+    {
+        return static_cast<int64_t>(std::ceil((min - gridMin) / _cellSize)) - 1;
+    };
+    auto lastCell = [this](float max, float gridMin)
+    {
+        return static_cast<int64_t>(std::floor((max - gridMin) / _cellSize));
+    };
+
+    return {
+        std::max<int64_t>(firstCell(bounds.minX, _bounds.minX), 0),
+        std::min<int64_t>(lastCell(bounds.maxX, _bounds.minX), static_cast<int64_t>(_columns) - 1),
+        std::max<int64_t>(firstCell(bounds.minY, _bounds.minY), 0),
+        std::min<int64_t>(lastCell(bounds.maxY, _bounds.minY), static_cast<int64_t>(_rows) - 1) };
+}
+
+bool TileGrid::IsAnySolid(uint64_t firstBit, uint64_t lastBit) const
+{
+    uint64_t firstWord = firstBit / 64;
+    uint64_t lastWord = lastBit / 64;
+    for (uint64_t wordIndex = firstWord; wordIndex <= lastWord; wordIndex++)
+    {
+        uint64_t word = _solidBits[wordIndex];
+        if (wordIndex == firstWord)
+        {
+            word &= ~0ull << (firstBit % 64);
+        }
+        if (wordIndex == lastWord)
+        {
+            word &= ~0ull >> (63 - lastBit % 64);
+        }
+        if (word != 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TileGrid::Overlaps(const Bounds& bounds) const
+{
+    if (!_bounds.Overlaps(bounds))
+    {
+        return false;
+    }
+
+    // Each row of covered cells is a run of consecutive bits, so test it a
+    // word at a time.
+    CellRange cells = CellsCoveredBy(bounds);
+    for (int64_t row = cells.firstRow; row <= cells.lastRow; row++)
+    {
+        uint64_t rowStart = static_cast<uint64_t>(row) * _columns;
+        if (cells.firstColumn <= cells.lastColumn
+            && IsAnySolid(rowStart + cells.firstColumn, rowStart + cells.lastColumn))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TileGrid::OverlapsWhileMoving(const Bounds& bounds, float deltaX, float deltaY) const
+{
+    Bounds moved = { bounds.minX + deltaX, bounds.minY + deltaY, bounds.maxX + deltaX, bounds.maxY + deltaY };
+    Bounds swept = Bounds::Union(bounds, moved);
+    if (!_bounds.Overlaps(swept))
+    {
+        return false;
+    }
+
+    CellRange cells = CellsCoveredBy(swept);
+    for (int64_t row = cells.firstRow; row <= cells.lastRow; row++)
+    {
+        for (int64_t column = cells.firstColumn; column <= cells.lastColumn; column++)
+        {
+            if (IsSolid(column, row) && bounds.OverlapsWhileMoving(CellBounds(column, row), deltaX, deltaY))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool TileGrid::Raycast(float originX, float originY, float deltaX, float deltaY, float& fraction) const
+{
+    // Start where the segment enters the grid.
+    Bounds origin = { originX, originY, originX, originY };
+    float enter;
+    if (!origin.OverlapsWhileMoving(_bounds, deltaX, deltaY, enter))
+    {
+        return false;
+    }
+
+    int64_t column = ClampedCellAt(originX + deltaX * enter, _bounds.minX, _columns);
+    int64_t row = ClampedCellAt(originY + deltaY * enter, _bounds.minY, _rows);
+
+    // The fraction at which the segment next crosses into another column
+    // or row, and how much further it goes between crossings.
+    const float infinity = std::numeric_limits<float>::infinity();
+    auto firstCrossing = [this, infinity](int64_t cell, float origin, float delta, float gridMin)
+    {
+        if (delta == 0.0f)
+        {
+            return infinity;
+        }
+        float edge = gridMin + (cell + (delta > 0.0f ? 1 : 0)) * _cellSize;
+        return (edge - origin) / delta;
+    };
+    float nextColumnAt = firstCrossing(column, originX, deltaX, _bounds.minX);
+    float nextRowAt = firstCrossing(row, originY, deltaY, _bounds.minY);
+    float columnStep = deltaX == 0.0f ? infinity : _cellSize / std::abs(deltaX);
+    float rowStep = deltaY == 0.0f ? infinity : _cellSize / std::abs(deltaY);
+    int64_t columnDirection = deltaX > 0.0f ? 1 : -1;
+    int64_t rowDirection = deltaY > 0.0f ? 1 : -1;
+
+    float at = enter;
+    while (true)
+    {
+        if (IsSolid(column, row))
+        {
+            fraction = at;
+            return true;
+        }
+
+        if (nextColumnAt < nextRowAt)
+        {
+            at = nextColumnAt;
+            column += columnDirection;
+            nextColumnAt += columnStep;
+        }
+        else
+        {
+            at = nextRowAt;
+            row += rowDirection;
+            nextRowAt += rowStep;
+        }
+
+        if (at > 1.0f || column < 0 || column >= _columns || row < 0 || row >= _rows)
+        {
+            return false;
+        }
+    }
+}
+
+float TileGrid::DistanceSquaredToSolidCell(float x, float y, float maxDistanceSquared) const
+{
+    // No cell is closer to (x, y) than it is to (x, y) moved onto the grid,
+    // so rings can be counted from the cell there.
+    int64_t centerColumn = ClampedCellAt(x, _bounds.minX, _columns);
+    int64_t centerRow = ClampedCellAt(y, _bounds.minY, _rows);
+
+    float closest = std::numeric_limits<float>::infinity();
+    auto visitRun = [&](int64_t row, int64_t firstColumn, int64_t lastColumn)
+    {
+        firstColumn = std::max<int64_t>(firstColumn, 0);
+        lastColumn = std::min<int64_t>(lastColumn, static_cast<int64_t>(_columns) - 1);
+        if (row < 0 || row >= _rows || firstColumn > lastColumn)
+        {
+            return;
+        }
+
+        uint64_t rowStart = static_cast<uint64_t>(row) * _columns;
+        if (!IsAnySolid(rowStart + firstColumn, rowStart + lastColumn))
+        {
+            return;
+        }
+        for (int64_t column = firstColumn; column <= lastColumn; column++)
+        {
+            if (IsSolid(column, row))
+            {
+                closest = std::min(closest, CellBounds(column, row).DistanceSquaredTo(x, y));
+            }
+        }
+    };
+
+    int64_t maxRing = std::max(_columns, _rows);
+    for (int64_t ring = 0; ring <= maxRing; ring++)
+    {
+        // Every cell in this ring is at least ring - 1 whole cells away.
+        float nearestInRing = std::max<int64_t>(ring - 1, 0) * _cellSize;
+        if (nearestInRing * nearestInRing > std::min(closest, maxDistanceSquared))
+        {
+            break;
+        }
+
+        if (ring == 0)
+        {
+            visitRun(centerRow, centerColumn, centerColumn);
+            continue;
+        }
+
+        visitRun(centerRow - ring, centerColumn - ring, centerColumn + ring);
+        visitRun(centerRow + ring, centerColumn - ring, centerColumn + ring);
+        int64_t firstRow = std::max<int64_t>(centerRow - ring + 1, 0);
+        int64_t lastRow = std::min<int64_t>(centerRow + ring - 1, static_cast<int64_t>(_rows) - 1);
+        for (int64_t row = firstRow; row <= lastRow; row++)
+        {
+            visitRun(row, centerColumn - ring, centerColumn - ring);
+            visitRun(row, centerColumn + ring, centerColumn + ring);
+        }
+    }
+
+    return closest <= maxDistanceSquared ? closest : std::numeric_limits<float>::infinity();
+}
+
+void TileGrid::FindOverlappingPairs(
+    const AabbStorage& movableAabbs,
+    uint32_t begin,
+    uint32_t end,
+    uint32_t staticIndex,
+    std::vector<OverlappingPair>& pairs) const
+{
+    uint32_t category = _aabbs.CollisionCategory()[0];
+    uint32_t mask = _aabbs.CollisionMask()[0];
+    const uint32_t* categories = movableAabbs.CollisionCategory();
+    const uint32_t* masks = movableAabbs.CollisionMask();
+    const uint8_t* isAwake = movableAabbs.IsAwake();
+    for (uint32_t movableIndex = begin; movableIndex < end; movableIndex++)
+    {
+        if (isAwake[movableIndex]
+            && AabbStorage::CategoriesCollide(categories[movableIndex], masks[movableIndex], category, mask)
+            && Overlaps(movableAabbs.BoundsOf(movableIndex)))
+        {
+            pairs.push_back({ movableIndex, staticIndex });
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace JkEng::Physics
+{
+    // Hands values from one writing thread to one reading thread without
+    // either ever waiting for the other.
+    //
+    // The writer fills Back() and publishes it, the reader reads Front(),
+    // and the third buffer sits between them holding whichever was
+    // published last.  Publishing swaps the back buffer with that middle
+    // one, and the reader swaps it with the front buffer when it has been
+    // published since the reader last looked.  Each side only ever touches
+    // its own buffer, so a slow reader just skips values and a slow writer
+    // just leaves the reader with the last one.
+    template<typename T>
+    class TripleBuffer final
+    {
+    public:
+        // Only for the writer.
+        inline T& Back()
+        {
+            return _buffers[_back];
+        }
+
+        // Hands Back() to the reader.  Back() is another buffer afterwards,
+        // holding whatever was last written to it.
+        inline void Publish()
+        {
+            _back = _middle.exchange(_back | IsFreshBit, std::memory_order_acq_rel) & IndexMask;
+        }
+
+        // Only for the reader.  The last buffer published, or a value
+        // initialized one before anything has been.
+        inline const T& Front()
+        {
+            if ((_middle.load(std::memory_order_relaxed) & IsFreshBit) != 0)
+            {
+                _front = _middle.exchange(_front, std::memory_order_acq_rel) & IndexMask;
+            }
+            return _buffers[_front];
+        }
+
+    private:
+        // Set on the middle index when the writer published it and the
+        // reader has not taken it yet.
+        static constexpr uint32_t IsFreshBit = 4;
+        static constexpr uint32_t IndexMask = 3;
+
+        std::array<T, 3> _buffers{};
+        uint32_t _back = 0;
+        std::atomic<uint32_t> _middle = 1;
+        uint32_t _front = 2;
+    };
+}
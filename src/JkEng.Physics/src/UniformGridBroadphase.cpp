@@ -0,0 +1,295 @@
+#include "UniformGridBroadphase.h"
+
+#include <algorithm>
+#include <bit>
+
+using namespace JkEng::Physics;
+
+UniformGridBroadphase::UniformGridBroadphase(float cellSize)
+  : _inverseCellSize(1.0f / cellSize)
+{
+
+}
+
+bool UniformGridBroadphase::UpdateSleepingIndices(const AabbStorage& aabbs)
+{
+    // Sleeping AABBs only move by being woken, but an index can hold a
+    // different AABB after removals, so compare bounds as well.
+    const uint8_t* isAwake = aabbs.IsAwake();
+    _awakeIndices.clear();
+    bool isUnchanged = true;
+    size_t sleepingCount = 0;
+    for (uint32_t i = 0; i < aabbs.Count(); i++)
+    {
+        if (isAwake[i])
+        {
+            _awakeIndices.push_back(i);
+            continue;
+        }
+
+        Bounds bounds = aabbs.BoundsOf(i);
+        if (sleepingCount == _sleepingIndices.size())
+        {
+            _sleepingIndices.push_back(i);
+            _sleepingBounds.push_back(bounds);
+            isUnchanged = false;
+        }
+        else if (_sleepingIndices[sleepingCount] != i || _sleepingBounds[sleepingCount] != bounds)
+        {
+            _sleepingIndices[sleepingCount] = i;
+            _sleepingBounds[sleepingCount] = bounds;
+            isUnchanged = false;
+        }
+        sleepingCount++;
+    }
+
+    if (sleepingCount != _sleepingIndices.size())
+    {
+        _sleepingIndices.resize(sleepingCount);
+        _sleepingBounds.resize(sleepingCount);
+        isUnchanged = false;
+    }
+    return isUnchanged;
+}
+
+void UniformGridBroadphase::BuildTables(const AabbStorage& aabbs)
+{
+    if (!UpdateSleepingIndices(aabbs) || _sleeping.bucketStarts.empty())
+    {
+        BuildTable(aabbs, _sleepingIndices, _sleeping);
+    }
+    BuildTable(aabbs, _awakeIndices, _awake);
+
+    _isOversize.clear();
+    if (!_awake.oversizeIndices.empty() || !_sleeping.oversizeIndices.empty())
+    {
+        _isOversize.resize(aabbs.Count(), 0);
+        for (uint32_t index : _awake.oversizeIndices)
+        {
+            _isOversize[index] = 1;
+        }
+        for (uint32_t index : _sleeping.oversizeIndices)
+        {
+            _isOversize[index] = 1;
+        }
+    }
+}
+
+void UniformGridBroadphase::BuildTable(
+    const AabbStorage& aabbs,
+    const std::vector<uint32_t>& aabbIndices,
+    CellTable& table)
+{
+    const float* minX = aabbs.MinX();
+    const float* minY = aabbs.MinY();
+    const float* maxX = aabbs.MaxX();
+    const float* maxY = aabbs.MaxY();
+
+    size_t aabbCount = aabbIndices.size();
+    _cellRanges.resize(aabbCount);
+    table.oversizeIndices.clear();
+
+    size_t entryCount = 0;
+    for (size_t i = 0; i < aabbCount; i++)
+    {
+        uint32_t aabbIndex = aabbIndices[i];
+        auto& range = _cellRanges[i];
+        range.minX = CellCoordinate(minX[aabbIndex]);
+        range.minY = CellCoordinate(minY[aabbIndex]);
+        range.maxX = CellCoordinate(maxX[aabbIndex]);
+        range.maxY = CellCoordinate(maxY[aabbIndex]);
+
+        // Inverted bounds, such as from a negative size, cover no cells.
+        size_t cellCount = range.maxX < range.minX || range.maxY < range.minY ? 0 :
+            static_cast<size_t>(range.maxX - range.minX + 1)
+            * static_cast<size_t>(range.maxY - range.minY + 1);
+        if (cellCount > MaxCellsPerAabb)
+        {
+            table.oversizeIndices.push_back(aabbIndex);
+            range.maxX = range.minX - 1;
+            continue;
+        }
+        entryCount += cellCount;
+    }
+
+    // Keep the table at least twice the number of entries so that
+    // unrelated cells rarely land in the same bucket.
+    uint32_t bucketCount = std::bit_ceil(std::max<uint32_t>(16u, static_cast<uint32_t>(entryCount * 2)));
+    uint32_t bucketMask = bucketCount - 1;
+
+    auto& bucketStarts = table.bucketStarts;
+    bucketStarts.assign(bucketCount + 1, 0);
+    for (size_t i = 0; i < aabbCount; i++)
+    {
+        auto& range = _cellRanges[i];
+        for (int32_t cellY = range.minY; cellY <= range.maxY; cellY++)
+        {
+            for (int32_t cellX = range.minX; cellX <= range.maxX; cellX++)
+            {
+                bucketStarts[HashCell(cellX, cellY) & bucketMask]++;
+            }
+        }
+    }
+
+    // Turn the counts into the end of each bucket, then fill each bucket
+    // back to front while walking the AABBs in reverse so every bucket
+    // ends up starting at its start and sorted by aabbIndex.
+    for (uint32_t bucket = 1; bucket < bucketCount; bucket++)
+    {
+        bucketStarts[bucket] += bucketStarts[bucket - 1];
+    }
+    bucketStarts[bucketCount] = static_cast<uint32_t>(entryCount);
+
+    table.entries.resize(entryCount);
+    for (size_t i = aabbCount; i-- > 0;)
+    {
+        auto& range = _cellRanges[i];
+        for (int32_t cellY = range.minY; cellY <= range.maxY; cellY++)
+        {
+            for (int32_t cellX = range.minX; cellX <= range.maxX; cellX++)
+            {
+                uint32_t bucket = HashCell(cellX, cellY) & bucketMask;
+                table.entries[--bucketStarts[bucket]] = { cellX, cellY, aabbIndices[i] };
+            }
+        }
+    }
+}
+
+void UniformGridBroadphase::FindOverlappingPairs(
+    const AabbStorage& aabbs,
+    uint32_t bucketBegin,
+    uint32_t bucketEnd,
+    std::vector<OverlappingPair>& pairs) const
+{
+    uint32_t sleepingBucketMask = _sleeping.BucketCount() - 1;
+    bool hasSleeping = !_sleeping.entries.empty();
+
+    for (uint32_t bucket = bucketBegin; bucket < bucketEnd; bucket++)
+    {
+        uint32_t entriesEnd = _awake.bucketStarts[bucket + 1];
+        for (uint32_t outer = _awake.bucketStarts[bucket]; outer < entriesEnd; outer++)
+        {
+            auto& entry0 = _awake.entries[outer];
+            uint32_t index0 = entry0.aabbIndex;
+            for (uint32_t inner = outer + 1; inner < entriesEnd; inner++)
+            {
+                auto& entry1 = _awake.entries[inner];
+
+                // Different cells can hash to the same bucket.
+                if (entry0.cellX != entry1.cellX || entry0.cellY != entry1.cellY)
+                {
+                    continue;
+                }
+
+                uint32_t index1 = entry1.aabbIndex;
+                if (aabbs.ShouldCollide(index0, index1)
+                    && aabbs.IsColliding(index0, index1)
+                    && IsReportingCell(aabbs, index0, index1, entry0))
+                {
+                    pairs.push_back({index0, index1});
+                }
+            }
+
+            if (!hasSleeping)
+            {
+                continue;
+            }
+
+            uint32_t sleepingBucket = HashCell(entry0.cellX, entry0.cellY) & sleepingBucketMask;
+            uint32_t sleepingEnd = _sleeping.bucketStarts[sleepingBucket + 1];
+            for (uint32_t inner = _sleeping.bucketStarts[sleepingBucket]; inner < sleepingEnd; inner++)
+            {
+                auto& entry1 = _sleeping.entries[inner];
+                if (entry0.cellX != entry1.cellX || entry0.cellY != entry1.cellY)
+                {
+                    continue;
+                }
+
+                uint32_t index1 = entry1.aabbIndex;
+                if (aabbs.ShouldCollide(index0, index1)
+                    && aabbs.IsColliding(index0, index1)
+                    && IsReportingCell(aabbs, index0, index1, entry0))
+                {
+                    pairs.push_back({ std::min(index0, index1), std::max(index0, index1) });
+                }
+            }
+        }
+    }
+}
+
+void UniformGridBroadphase::FindOversizePairs(const AabbStorage& aabbs, std::vector<OverlappingPair>& pairs) const
+{
+    const uint8_t* isAwake = aabbs.IsAwake();
+    uint32_t count = aabbs.Count();
+
+    // Awake oversize AABBs against everything, taking pairs of two awake
+    // oversize AABBs from the lower index only.
+    for (uint32_t index0 : _awake.oversizeIndices)
+    {
+        for (uint32_t index1 = 0; index1 < count; index1++)
+        {
+            if (index1 == index0 || (index1 < index0 && _isOversize[index1] && isAwake[index1]))
+            {
+                continue;
+            }
+
+            if (aabbs.ShouldCollide(index0, index1) && aabbs.IsColliding(index0, index1))
+            {
+                pairs.push_back({ std::min(index0, index1), std::max(index0, index1) });
+            }
+        }
+    }
+
+    // Sleeping oversize AABBs against the awake AABBs in the table.
+    for (uint32_t index0 : _sleeping.oversizeIndices)
+    {
+        for (uint32_t index1 : _awakeIndices)
+        {
+            if (_isOversize[index1])
+            {
+                continue;
+            }
+
+            if (aabbs.ShouldCollide(index0, index1) && aabbs.IsColliding(index0, index1))
+            {
+                pairs.push_back({ std::min(index0, index1), std::max(index0, index1) });
+            }
+        }
+    }
+}
+
+void UniformGridBroadphase::FindOverlappingPairs(
+    const AabbStorage& aabbs,
+    std::vector<OverlappingPair>& pairs)
+{
+    BuildTables(aabbs);
+    FindOverlappingPairs(aabbs, 0, _awake.BucketCount(), pairs);
+    if (!_isOversize.empty())
+    {
+        FindOversizePairs(aabbs, pairs);
+    }
+}
+
+void UniformGridBroadphase::FindOverlappingPairs(
+    const AabbStorage& aabbs,
+    WorkerPool& workers,
+    std::vector<std::vector<OverlappingPair>>& pairsPerWorker)
+{
+    BuildTables(aabbs);
+
+    uint32_t bucketCount = _awake.BucketCount();
+    uint32_t taskCount = (bucketCount + BucketsPerTask - 1) / BucketsPerTask;
+    workers.Run(taskCount, [&](uint32_t taskIndex, uint32_t workerIndex)
+    {
+        uint32_t bucketBegin = taskIndex * BucketsPerTask;
+        uint32_t bucketEnd = std::min(bucketBegin + BucketsPerTask, bucketCount);
+        FindOverlappingPairs(aabbs, bucketBegin, bucketEnd, pairsPerWorker[workerIndex]);
+    });
+
+    // There are only ever a few, so they are tested after the workers
+    // rather than split between them.
+    if (!_isOversize.empty())
+    {
+        FindOversizePairs(aabbs, pairsPerWorker[0]);
+    }
+}
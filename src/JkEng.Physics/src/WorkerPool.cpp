@@ -0,0 +1,127 @@
+#include "WorkerPool.h"
+
+#include <sstream>
+#include <stdexcept>
+
+using namespace JkEng::Physics;
+
+WorkerPool::WorkerPool(uint32_t workerCount)
+{
+    if (workerCount == 0)
+    {
+        std::stringstream ss;
+        ss << "WorkerPool: workerCount " << workerCount << " must be greater than zero";
+        throw std::invalid_argument(ss.str());
+    }
+
+    _threads.reserve(workerCount - 1);
+    for (uint32_t workerIndex = 1; workerIndex < workerCount; workerIndex++)
+    {
+        _threads.emplace_back(&WorkerPool::ThreadMain, this, workerIndex);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _batchStarted.notify_all();
+
+    for (auto& thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+void WorkerPool::Run(uint32_t taskCount, const Task& task)
+{
+    if (_threads.empty() || taskCount <= 1)
+    {
+        for (uint32_t taskIndex = 0; taskIndex < taskCount; taskIndex++)
+        {
+            task(taskIndex, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _task = &task;
+        _taskCount = taskCount;
+        _nextTaskIndex.store(0, std::memory_order_relaxed);
+        _runningThreads = static_cast<uint32_t>(_threads.size());
+        _batch++;
+    }
+    _batchStarted.notify_all();
+
+    RunTasks(0);
+
+    std::exception_ptr exception;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _batchFinished.wait(lock, [this] { return _runningThreads == 0; });
+        _task = nullptr;
+        std::swap(exception, _exception);
+    }
+
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+void WorkerPool::ThreadMain(uint32_t workerIndex)
+{
+    uint64_t lastBatch = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _batchStarted.wait(lock, [&] { return _stopping || _batch != lastBatch; });
+            if (_stopping)
+            {
+                return;
+            }
+            lastBatch = _batch;
+        }
+
+        RunTasks(workerIndex);
+
+        bool isLastThread;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            isLastThread = --_runningThreads == 0;
+        }
+        if (isLastThread)
+        {
+            _batchFinished.notify_one();
+        }
+    }
+}
+
+void WorkerPool::RunTasks(uint32_t workerIndex)
+{
+    while (true)
+    {
+        uint32_t taskIndex = _nextTaskIndex.fetch_add(1, std::memory_order_relaxed);
+        if (taskIndex >= _taskCount)
+        {
+            return;
+        }
+
+        try
+        {
+            (*_task)(taskIndex, workerIndex);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_exception)
+            {
+                _exception = std::current_exception();
+            }
+        }
+    }
+}